@@ -0,0 +1,104 @@
+"""Several stand-ins for the REST API of a Flow Access Node, one of which fails now and then.
+
+Each node serves the requests of a state read and of a probe:
+  GET  /v1/blocks?height=sealed   -> the latest sealed block (header only); the height grows by one per second
+  POST /v1/scripts?block_height=N -> the script result {"value":"42","type":"Int64"}
+Node i (from 0) answers after i * LATENCY milliseconds, so the nodes rank by their index. Every EVERY seconds, the
+node that executed the latest script -- the one the client is using -- fails for LENGTH seconds:
+  close: it closes connections as soon as a request arrives, like a node that is restarting
+  hang:  it accepts requests, but never answers them, like an overloaded node or a half-open connection
+HTTP/1.1 with keep-alive, like the Access Node.
+
+Usage: python3 mock_access_nodes.py [first port] [nodes] [every s] [length s] [close|hang] [latency ms]
+       (defaults: 8081, 3, 30, 20, close, 25)
+"""
+
+import json
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+FIRST_PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 8081
+NODES = int(sys.argv[2]) if len(sys.argv) > 2 else 3
+EVERY = float(sys.argv[3]) if len(sys.argv) > 3 else 30.0
+LENGTH = float(sys.argv[4]) if len(sys.argv) > 4 else 20.0
+MODE = sys.argv[5] if len(sys.argv) > 5 else "close"
+LATENCY = float(sys.argv[6]) / 1000 if len(sys.argv) > 6 else 0.025
+SEALED_HEIGHT = 268154930
+STARTED = time.monotonic()
+
+lock = threading.Lock()
+failed_until = [0.0] * NODES  # time.monotonic() until which each node fails
+script_node = 0  # the node that executed the latest script
+
+
+def failing(node):
+    with lock:
+        return time.monotonic() < failed_until[node]
+
+
+class MockAccessNode(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive, like the Access Node
+    timeout = 60  # frees the threads of connections the client abandoned
+
+    def log_message(self, format, *args):
+        pass
+
+    def fail(self):
+        if MODE == "hang":
+            while failing(self.server.node):
+                time.sleep(0.1)
+        self.close_connection = True
+
+    def respond(self, body):
+        time.sleep(self.server.node * LATENCY)
+        payload = json.dumps(body).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(payload)))
+        self.end_headers()
+        self.wfile.write(payload)
+
+    def do_GET(self):
+        if failing(self.server.node):
+            self.fail()
+            return
+        if not self.path.startswith("/v1/blocks?height=sealed"):
+            self.send_error(404)
+            return
+        height = SEALED_HEIGHT + int(time.monotonic() - STARTED)
+        self.respond([{"header": {"id": "7a5c" * 16, "height": str(height)}, "block_status": "BLOCK_SEALED"}])
+
+    def do_POST(self):
+        global script_node
+        self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        if failing(self.server.node):
+            self.fail()
+            return
+        if not self.path.startswith("/v1/scripts"):
+            self.send_error(404)
+            return
+        with lock:
+            script_node = self.server.node
+        self.respond("eyJ2YWx1ZSI6IjQyIiwidHlwZSI6IkludDY0In0K")
+
+
+def fail_nodes():
+    while True:
+        time.sleep(EVERY)
+        with lock:
+            node = script_node
+            failed_until[node] = time.monotonic() + LENGTH
+        print(f"💥 {time.monotonic() - STARTED:7.1f} s: node {node} (port {FIRST_PORT + node}) fails ({MODE}) for {LENGTH:g} s")
+
+
+if __name__ == "__main__":
+    for node in range(NODES):
+        server = ThreadingHTTPServer(("", FIRST_PORT + node), MockAccessNode)
+        server.daemon_threads = True
+        server.node = node
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        print(f"mock access node {node} on port {FIRST_PORT + node}, answering after {node * LATENCY * 1000:g} ms")
+    print(f"every {EVERY:g} s, the node in use fails ({MODE}) for {LENGTH:g} s")
+    fail_nodes()
@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <algorithm>
+
+#include "AccessNodeSelector.h"
+#include "OnChainStateWorker.h"
+#include "PinnedTask.h"
+#include "WiFiCredentials.h"
+
+// -----------------------------------------------------------------------------
+// NEEDS HUMAN CONFIGURATION: address of the computer running `mock_access_nodes.py`, which serves three nodes on
+// consecutive ports and, every 30 seconds, lets the node in use fail for 20 seconds
+// (`python3 mock_access_nodes.py 8081 3 30 20 close`, or `hang` instead of `close`).
+// -----------------------------------------------------------------------------
+const AccessNode MOCK_NODES[] = {
+    // host, SSL, WebSocket port (unused), REST port
+    {"192.168.1.10", false, 0, 8081},
+    {"192.168.1.10", false, 0, 8082},
+    {"192.168.1.10", false, 0, 8083},
+};
+const unsigned long readIntervalMS = 500;    // the client reads the state from the current node this often
+const unsigned long probeIntervalMS = 2000;  // probes one node (round robin) this often
+const unsigned long probeTimeoutMS = 2000;   // as in the controller
+const unsigned long sealedBlockHeight = 268154930; // known, as the controller knows the sealed head from the block
+                                                   // digests; so a state read is a single request
+const int failoversToMeasure = 8;
+
+// The loop stands in for the network task of Project Hummingbird. It reads the on-chain state from the current
+// node every `readIntervalMS`, and has the other nodes probed in between -- both via OnChainStateWorker on a task
+// of its own, as the controller does (see `../src`). A failed read counts as a failure of the node, as a lost
+// connection does in the controller, and the AccessNodeSelector switches to the best healthy node. For each
+// outage, the time from starting the first failed read (which may take until the HTTP timeout to fail) to the
+// first successful one (on whichever node), and the time since the last successful read before the outage, are
+// recorded.
+AccessNodeSelector *selector = nullptr;
+OnChainStateWorker *worker = nullptr;
+bool readPending = false;
+uint32_t probeTicket = 0;
+size_t probedNode = 0;
+unsigned long lastReadMS = 0;
+unsigned long lastSuccessMS = 0;
+unsigned long firstFailureMS = 0; // when the first failed read of the ongoing outage started; 0 if there is none
+unsigned long failedReads = 0;
+size_t failedNode = 0;
+unsigned long fromFailureMS[failoversToMeasure];
+unsigned long unavailableMS[failoversToMeasure];
+int failovers = 0;
+
+String restBaseURL(const AccessNode &node) {
+  return String(node.useSsl ? "https://" : "http://") + node.host + ":" + String(node.restPort) + "/v1/";
+}
+
+bool workerIteration() {
+  return worker->work();
+}
+
+void onStateRead(const OnChainStateWorker::Result &result) {
+  readPending = false;
+  const unsigned long nowMS = millis();
+  if (!result.success) {
+    if (firstFailureMS == 0) {
+      firstFailureMS = nowMS - result.elapsedMS;
+      failedNode = selector->currentIndex();
+    }
+    ++failedReads;
+    selector->reportFailure();
+    selector->selectBest();
+    return;
+  }
+  selector->reportSuccess();
+  if (firstFailureMS != 0 && failovers < failoversToMeasure) {
+    fromFailureMS[failovers] = nowMS - firstFailureMS;
+    unavailableMS[failovers] = nowMS - lastSuccessMS;
+    Serial.printf("⏱️ failover %d from node %zu to node %zu: %lu ms from the first failed read (%lu failed reads), "
+                  "%lu ms without a successful read\n",
+                  failovers + 1, failedNode, selector->currentIndex(), fromFailureMS[failovers], failedReads,
+                  unavailableMS[failovers]);
+    ++failovers;
+  }
+  firstFailureMS = 0;
+  failedReads = 0;
+  lastSuccessMS = nowMS;
+}
+
+void onProbe(const OnChainStateWorker::Result &result) {
+  if (result.ticket != probeTicket) return;
+  probeTicket = 0;
+  selector->recordProbe(probedNode, result.success ? (long)result.roundTripMS : -1);
+}
+
+void onCompletion(const OnChainStateWorker::Result &result) {
+  switch (result.request) {
+    case OnChainStateWorker::Request::ReadControllerState:
+      onStateRead(result);
+      break;
+    case OnChainStateWorker::Request::ProbeLatency:
+      onProbe(result);
+      break;
+  }
+}
+
+// FUNCTION report: fastest, median and slowest of `values`
+void report(const char *name, unsigned long *values) {
+  std::sort(values, values + failoversToMeasure);
+  Serial.printf("%-38s: %6lu / %6lu / %6lu ms (fastest / median / slowest)\n", name, values[0],
+                values[failoversToMeasure / 2], values[failoversToMeasure - 1]);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(100);
+  }
+  Serial.printf("📡 connected to Wi‑Fi '%s'; %zu mock access nodes at %s\n", WiFi.SSID().c_str(),
+                sizeof(MOCK_NODES) / sizeof(MOCK_NODES[0]), MOCK_NODES[0].host);
+
+  selector = new AccessNodeSelector(MOCK_NODES, sizeof(MOCK_NODES) / sizeof(MOCK_NODES[0]), probeIntervalMS);
+  worker = new OnChainStateWorker(onCompletion, probeTimeoutMS);
+  startPinnedTask("stateReader", workerIteration, 0, 8192, 1);
+  lastSuccessMS = millis();
+}
+
+void loop() {
+  delay(1);
+  if (failovers == failoversToMeasure) return;
+  worker->poll();
+
+  if (!readPending && millis() - lastReadMS >= readIntervalMS) {
+    lastReadMS = millis();
+    readPending = worker->submit(OnChainStateWorker::Request::ReadControllerState, restBaseURL(selector->current()),
+                                 sealedBlockHeight) != 0;
+  }
+  size_t index;
+  if (selector->probeDue(index)) {
+    probeTicket = worker->submit(OnChainStateWorker::Request::ProbeLatency, restBaseURL(selector->node(index)));
+    if (probeTicket == 0) {
+      selector->cancelProbe();
+    } else {
+      probedNode = index;
+    }
+  }
+
+  if (failovers < failoversToMeasure) return;
+  Serial.printf("\n%d failovers, %lu switches between nodes\n", failovers, selector->switches());
+  report("from the first failed read", fromFailureMS);
+  report("from the last successful read", unavailableMS);
+}
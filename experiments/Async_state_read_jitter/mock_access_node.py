@@ -0,0 +1,48 @@
+"""Minimal stand-in for the REST API of a Flow Access Node, with a slow script execution.
+
+Serves the two requests of a state read:
+  GET  /v1/blocks?height=sealed   -> immediately, the latest sealed block (header only)
+  POST /v1/scripts?block_height=N -> after DELAY seconds, the script result {"value":"42","type":"Int64"}
+
+Usage: python3 mock_access_node.py [port] [delay in seconds]     (defaults: 8070, 3)
+"""
+
+import json
+import sys
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 8070
+DELAY = float(sys.argv[2]) if len(sys.argv) > 2 else 3.0
+SEALED_HEIGHT = 268154930
+
+
+class MockAccessNode(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive, like the Access Node
+
+    def respond(self, body):
+        payload = json.dumps(body).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(payload)))
+        self.end_headers()
+        self.wfile.write(payload)
+
+    def do_GET(self):
+        if not self.path.startswith("/v1/blocks"):
+            self.send_error(404)
+            return
+        self.respond([{"header": {"id": "7a5c" * 16, "height": str(SEALED_HEIGHT)}, "block_status": "BLOCK_SEALED"}])
+
+    def do_POST(self):
+        self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        if not self.path.startswith("/v1/scripts"):
+            self.send_error(404)
+            return
+        time.sleep(DELAY)
+        self.respond("eyJ2YWx1ZSI6IjQyIiwidHlwZSI6IkludDY0In0K")
+
+
+if __name__ == "__main__":
+    print(f"mock access node on port {PORT}, script execution takes {DELAY} s")
+    ThreadingHTTPServer(("", PORT), MockAccessNode).serve_forever()
@@ -0,0 +1,110 @@
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "OnChainState.h"
+#include "OnChainStateWorker.h"
+#include "PinnedTask.h"
+#include "WiFiCredentials.h"
+
+// -----------------------------------------------------------------------------
+// NEEDS HUMAN CONFIGURATION: address of the computer running `mock_access_node.py`, which delays script
+// execution by a few seconds (like a slow or overloaded Access Node)
+// -----------------------------------------------------------------------------
+static const char *mock_rest_url = "http://192.168.1.10:8070/v1/";
+const unsigned long readIntervalMS = 10000; // a state read every 10 seconds ...
+const int readsPerApproach = 3;             // ... three times per approach
+const unsigned long slowIterationUS = 10000;
+
+// The loop stands in for the network task of Project Hummingbird: an iteration takes about a millisecond when
+// idle. Every `readIntervalMS`, the on-chain state is read -- first by calling OnChainState right in the loop
+// (as the project used to), then via OnChainStateWorker on a task of its own -- and the gaps between
+// consecutive iterations are recorded.
+enum class Approach { Blocking, Worker, Finished } approach = Approach::Blocking;
+OnChainState *blockingState = nullptr;
+OnChainStateWorker *worker = nullptr;
+bool readPending = false;
+int readsDone = 0;
+unsigned long lastReadMS = 0;
+unsigned long lastIterationUS = 0;
+unsigned long iterations = 0;
+unsigned long worstGapUS = 0;
+unsigned long slowIterations = 0;
+
+void onStateRead(const OnChainStateWorker::Result &result) {
+  readPending = false;
+  ++readsDone;
+  Serial.printf("   %s state %lld at block %lu after %lu ms\n", result.success ? "✅" : "❌", result.controllerState,
+                result.blockHeight, result.elapsedMS);
+}
+
+bool workerIteration() {
+  return worker->work();
+}
+
+void readBlocking() {
+  const unsigned long startMS = millis();
+  const std::tuple<unsigned long, bool> block = blockingState->get_latest_sealed_block();
+  const std::tuple<int64_t, bool> state = std::get<1>(block) ? blockingState->get_led_state_at_block(std::get<0>(block))
+                                                             : std::make_tuple((int64_t)0, false);
+  ++readsDone;
+  Serial.printf("   %s state %lld at block %lu after %lu ms\n", std::get<1>(state) ? "✅" : "❌", std::get<0>(state),
+                std::get<0>(block), millis() - startMS);
+}
+
+void report(const char *name) {
+  Serial.printf("%-8s: %lu iterations; worst gap between iterations %lu µs; %lu gaps over %lu µs\n\n", name, iterations,
+                worstGapUS, slowIterations, slowIterationUS);
+  iterations = worstGapUS = slowIterations = lastIterationUS = 0;
+  readsDone = 0;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(100);
+  }
+  Serial.printf("📡 connected to Wi‑Fi '%s'; mock access node at %s\n", WiFi.SSID().c_str(), mock_rest_url);
+
+  blockingState = new OnChainState(mock_rest_url);
+  worker = new OnChainStateWorker(onStateRead);
+  startPinnedTask("stateReader", workerIteration, 0, 8192, 1);
+  Serial.println(F("📞 blocking: OnChainState called in the loop"));
+}
+
+void loop() {
+  const unsigned long nowUS = micros();
+  if (lastIterationUS != 0) {
+    const unsigned long gapUS = nowUS - lastIterationUS;
+    ++iterations;
+    if (gapUS > worstGapUS) worstGapUS = gapUS;
+    if (gapUS > slowIterationUS) ++slowIterations;
+  }
+  lastIterationUS = nowUS;
+  delay(1); // an idle iteration
+
+  if (approach == Approach::Finished) return;
+  if (approach == Approach::Worker) worker->poll();
+  if (!readPending && millis() - lastReadMS >= readIntervalMS) {
+    lastReadMS = millis();
+    if (approach == Approach::Blocking) {
+      readBlocking();
+    } else {
+      readPending = worker->submit(OnChainStateWorker::Request::ReadControllerState, mock_rest_url) != 0;
+    }
+  }
+
+  if (readsDone < readsPerApproach) return;
+  if (approach == Approach::Blocking) {
+    report("blocking");
+    approach = Approach::Worker;
+    Serial.println(F("📞 worker: OnChainStateWorker on a task of its own"));
+  } else {
+    report("worker");
+    approach = Approach::Finished;
+  }
+}
@@ -0,0 +1,185 @@
+#include <Arduino.h>
+
+#include "EventOrderingStage.h"
+
+// -----------------------------------------------------------------------------
+// A bursty stream of `ControlValueChanged` events is generated once (deterministically) and replayed from memory:
+//  • every `burstEveryBlocks`-th block on average carries a burst of 1 to 3 transactions with 1 to 3 events each,
+//    alternately switching the load on and off (someone toggling the on-chain value in quick succession)
+//  • within a block with several events, two of them arrive swapped now and then
+//  • every `reconnectEveryBlocks` blocks, a reconnect replays the last `replayedBlocks` blocks
+// It is processed twice, counting how often the relay switches:
+//  • right away:      as Project Hummingbird did originally; each event with a new eventSequence is applied as it
+//                     arrives, a gap in the eventSequence is backfilled first
+//  • ordering stage:  via the `EventOrderingStage` (see `../src`); deduplicated by transaction ID and event index,
+//                     ordered by (block height, eventSequence), and only the final value of each block is applied
+// Backfilling takes the missing events from the generator's record, as the REST API would provide them.
+// -----------------------------------------------------------------------------
+const unsigned long blocks = 2000;
+const unsigned long burstEveryBlocks = 4;
+const unsigned long swapEveryBursts = 5;
+const unsigned long reconnectEveryBlocks = 250;
+const unsigned long replayedBlocks = 3;
+
+struct Delivery {
+  bool blockEnd; // marks the end of `blockHeight`; the other fields are unused then
+  unsigned long blockHeight;
+  char transactionId[17];
+  uint32_t eventIndex;
+  uint64_t eventSequence;
+  int64_t value;
+};
+
+Delivery *stream = nullptr;
+size_t deliveries = 0;
+int64_t *valueOfSequence = nullptr;      // as emitted, indexed by eventSequence
+unsigned long *blockOfSequence = nullptr;
+uint64_t lastSequence = 0;
+unsigned long outOfOrder = 0, replayed = 0;
+
+uint32_t lcg = 12345;
+uint32_t nextRandom(uint32_t bound) {
+  lcg = lcg * 1664525u + 1013904223u;
+  return (lcg >> 8) % bound;
+}
+
+// FUNCTION generateStream: the stream as the node delivers it, including replays after reconnects
+void generateStream() {
+  const size_t maxDeliveries = blocks * 20;
+  stream = new Delivery[maxDeliveries];
+  valueOfSequence = new int64_t[blocks * 9 + 1];
+  blockOfSequence = new unsigned long[blocks * 9 + 1];
+  size_t blockStart[replayedBlocks + 1] = {};
+  int64_t magnitude = 1;
+  for (unsigned long block = 1; block <= blocks; ++block) {
+    memmove(blockStart, blockStart + 1, replayedBlocks * sizeof(size_t));
+    blockStart[replayedBlocks] = deliveries;
+    if (nextRandom(burstEveryBlocks) == 0) {
+      const uint32_t transactions = 1 + nextRandom(3);
+      for (uint32_t t = 0; t < transactions; ++t) {
+        char transactionId[17];
+        snprintf(transactionId, sizeof(transactionId), "%08lx%08lx", (unsigned long)nextRandom(UINT32_MAX), block);
+        const uint32_t events = 1 + nextRandom(3);
+        for (uint32_t i = 0; i < events; ++i) {
+          Delivery &d = stream[deliveries++];
+          d = {false, block, "", i, ++lastSequence, (lastSequence % 2 ? -1 : 1) * (magnitude++)};
+          strcpy(d.transactionId, transactionId);
+          valueOfSequence[lastSequence] = d.value;
+          blockOfSequence[lastSequence] = block;
+        }
+      }
+      const size_t count = deliveries - blockStart[replayedBlocks];
+      if (count >= 2 && nextRandom(swapEveryBursts) == 0) {
+        const size_t i = blockStart[replayedBlocks] + nextRandom(count - 1);
+        const Delivery swapped = stream[i];
+        stream[i] = stream[i + 1];
+        stream[i + 1] = swapped;
+        ++outOfOrder;
+      }
+    }
+    stream[deliveries++] = {true, block, "", 0, 0, 0};
+
+    if (block % reconnectEveryBlocks == 0 && block >= replayedBlocks) { // the node replays the last blocks
+      const size_t end = deliveries;
+      for (size_t i = blockStart[1]; i < end; ++i, ++replayed) stream[deliveries++] = stream[i];
+    }
+  }
+}
+
+/* ── right away: the original approach ─────────────────────────────────────────────────────────── */
+struct Relay {
+  bool on = false;
+  unsigned long switches = 0;
+  unsigned long applied = 0;
+  void apply(int64_t value) {
+    ++applied;
+    if ((value < 0) != on) ++switches;
+    on = value < 0;
+  }
+};
+
+Relay runRightAway() {
+  Relay relay;
+  uint64_t lastApplied = 0;
+  for (size_t i = 0; i < deliveries; ++i) {
+    const Delivery &d = stream[i];
+    if (d.blockEnd || d.eventSequence <= lastApplied) continue;
+    for (uint64_t missed = lastApplied + 1; lastApplied > 0 && missed < d.eventSequence; ++missed) {
+      relay.apply(valueOfSequence[missed]); // backfilled
+    }
+    relay.apply(d.value);
+    lastApplied = d.eventSequence;
+  }
+  return relay;
+}
+
+/* ── via the ordering stage ────────────────────────────────────────────────────────────────────── */
+Relay runOrderingStage(EventOrderingStage &stage) {
+  Relay relay;
+  uint64_t lastApplied = 0;
+  unsigned long lastEventBlock = 0;
+  for (size_t i = 0; i < deliveries; ++i) {
+    const Delivery &d = stream[i];
+    if (!d.blockEnd) {
+      if (stage.seen(d.transactionId, d.eventIndex, d.blockHeight) || d.eventSequence <= lastApplied) continue;
+      if (stage.add(d.blockHeight, d.eventSequence, d.value) == EventOrderingStage::Insert::Full) {
+        Serial.println(F("❌ ordering stage full"));
+      }
+      continue;
+    }
+    if (!stage.contiguous(d.blockHeight, lastApplied)) { // backfill the blocks since the last applied event
+      for (uint64_t s = lastApplied + 1; s <= lastSequence && blockOfSequence[s] <= d.blockHeight; ++s) {
+        if (blockOfSequence[s] > lastEventBlock) stage.add(blockOfSequence[s], s, valueOfSequence[s]);
+      }
+    }
+    EventOrderingStage::Update final;
+    if (stage.take(d.blockHeight, lastApplied, final) == 0) continue;
+    relay.apply(final.value);
+    lastApplied = final.eventSequence;
+    lastEventBlock = final.blockHeight;
+  }
+  return relay;
+}
+
+// FUNCTION minimumSwitches: blocks whose final value switches the load, compared to the block before
+unsigned long minimumSwitches() {
+  unsigned long switches = 0;
+  bool on = false;
+  for (uint64_t s = 1; s <= lastSequence; ++s) {
+    if (s < lastSequence && blockOfSequence[s + 1] == blockOfSequence[s]) continue; // not the block's final value
+    if ((valueOfSequence[s] < 0) != on) ++switches;
+    on = valueOfSequence[s] < 0;
+  }
+  return switches;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  generateStream();
+  Serial.printf("replaying %u deliveries: %llu control events in %lu blocks, %lu swapped pairs, %lu events and block ends replayed after reconnects\n",
+                (unsigned)deliveries, lastSequence, blocks, outOfOrder, replayed);
+
+  unsigned long startUS = micros();
+  const Relay rightAway = runRightAway();
+  const unsigned long rightAwayUS = micros() - startUS;
+
+  EventOrderingStage stage(16, 64);
+  startUS = micros();
+  const Relay ordered = runOrderingStage(stage);
+  const unsigned long orderedUS = micros() - startUS;
+
+  Serial.printf("  right away:     %4lu relay switches, %4lu values applied; %.2f µs per delivery\n", rightAway.switches,
+                rightAway.applied, (float)rightAwayUS / deliveries);
+  Serial.printf("  ordering stage: %4lu relay switches, %4lu values applied; %.2f µs per delivery; %lu events collapsed, %lu duplicates recognised\n",
+                ordered.switches, ordered.applied, (float)orderedUS / deliveries, stage.collapsed(), stage.duplicates());
+  Serial.printf("  fewest possible switches, once per sealed block: %lu; final state %s\n", minimumSwitches(),
+                rightAway.on == ordered.on ? "identical" : "DIFFERS");
+}
+
+void loop() {
+  // Nothing to do here
+}
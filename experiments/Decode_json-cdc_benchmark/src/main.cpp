@@ -0,0 +1,87 @@
+#include "mbedtls/base64.h" // bundled with ESP32‑Arduino core
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "Base64DecodingStream.h"
+#include "JsonCadenceReader.h"
+
+// -----------------------------------------------------------------------------
+// Same hard‑coded Base64 payload from the Flow event as in `Decode_json-cdc_poc`
+// -----------------------------------------------------------------------------
+static const char *encoded_payload =
+    "eyJ2YWx1ZSI6eyJpZCI6IkEuMGQzYzhkMDJiMDJjZWI0Yy5NaWNyb2NvbnRyb2xsZXJUZXN0LkNvbnRyb2xWYWx1ZUNoYW5nZWQiLCJmaWVsZHMiOlt7InZhbHVlIjp7InZhbHVlIjoiMTUiLCJ0eXBlIjoiSW50NjQifSwibmFtZSI6InZhbHVlIn0seyJ2YWx1ZSI6eyJ2YWx1ZSI6IjE2IiwidHlwZSI6IkludDY0In0sIm5hbWUiOiJvbGRWYWx1ZSJ9LHsidmFsdWUiOnsidmFsdWUiOiIzOCIsInR5cGUiOiJVSW50NjQifSwibmFtZSI6ImV2ZW50U2VxdWVuY2UifV19LCJ0eXBlIjoiRXZlbnQifQo=";
+static const char *event_id = "A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged";
+const int iterations = 1000;
+
+// original approach: decode into a malloc'ed buffer, build a JsonDocument, copy the values into Strings
+bool decodeWithMbedtls(int64_t &value, int64_t &oldValue, uint64_t &eventSequence) {
+  const size_t encodedLen = strlen(encoded_payload);
+  size_t decodedLen = 0;
+  mbedtls_base64_decode(nullptr, 0, &decodedLen, reinterpret_cast<const unsigned char *>(encoded_payload), encodedLen);
+  char *decoded = static_cast<char *>(malloc(decodedLen + 1));
+  if (!decoded) return false;
+  mbedtls_base64_decode(reinterpret_cast<unsigned char *>(decoded), decodedLen, &decodedLen, reinterpret_cast<const unsigned char *>(encoded_payload), encodedLen);
+  decoded[decodedLen] = '\0';
+
+  StaticJsonDocument<4096> cadenceEvent;
+  if (deserializeJson(cadenceEvent, decoded)) {
+    free(decoded);
+    return false;
+  }
+  String newValueStr, oldValueStr, eventSequenceStr;
+  for (JsonObject field : cadenceEvent["value"]["fields"].as<JsonArray>()) {
+    const char *name = field["name"];
+    const char *fieldValue = field["value"]["value"];
+    if (strcmp(name, "value") == 0) newValueStr = fieldValue;
+    if (strcmp(name, "oldValue") == 0) oldValueStr = fieldValue;
+    if (strcmp(name, "eventSequence") == 0) eventSequenceStr = fieldValue;
+  }
+  value = strtoll(newValueStr.c_str(), nullptr, 10);
+  oldValue = strtoll(oldValueStr.c_str(), nullptr, 10);
+  eventSequence = strtoull(eventSequenceStr.c_str(), nullptr, 10);
+  free(decoded);
+  return true;
+}
+
+// streaming approach of the main project: single pass, no heap allocations
+bool decodeStreaming(int64_t &value, int64_t &oldValue, uint64_t &eventSequence) {
+  Base64DecodingStream decoded(encoded_payload);
+  JsonCadenceReader reader(decoded);
+  JsonCadenceReader::IntegerField fields[] = {
+      {"value", true, false, 0, 0},
+      {"oldValue", true, false, 0, 0},
+      {"eventSequence", false, false, 0, 0},
+  };
+  if (reader.readEvent(event_id, fields, 3) != JsonCadenceReader::Result::Ok) return false;
+  value = fields[0].int64Value;
+  oldValue = fields[1].int64Value;
+  eventSequence = fields[2].uint64Value;
+  return true;
+}
+
+void benchmark(const char *name, bool (*decode)(int64_t &, int64_t &, uint64_t &)) {
+  int64_t value = 0, oldValue = 0;
+  uint64_t eventSequence = 0;
+  const uint32_t heapBefore = ESP.getMinFreeHeap();
+  const unsigned long startUS = micros();
+  bool ok = true;
+  for (int i = 0; i < iterations; ++i)
+    ok &= decode(value, oldValue, eventSequence);
+  const unsigned long elapsedUS = micros() - startUS;
+  Serial.printf("%-10s %s: %.2f µs per decode; value %lld, oldValue %lld, eventSequence %llu; heap low-water mark dropped by %u bytes\n",
+                name, ok ? "✅" : "❌", (float)elapsedUS / iterations, value, oldValue, eventSequence, heapBefore - ESP.getMinFreeHeap());
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  benchmark("mbedtls", decodeWithMbedtls);
+  benchmark("streaming", decodeStreaming);
+}
+
+void loop() {
+  // Nothing to do here
+}
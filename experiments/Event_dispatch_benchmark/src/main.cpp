@@ -0,0 +1,64 @@
+#include <Arduino.h>
+
+#include "EventRegistry.h"
+
+// -----------------------------------------------------------------------------
+// Registries with 1, 10 and 100 event types. The looked-up type is always the
+// last one registered, mimicking the `ControlValueChanged` event of the main project.
+// -----------------------------------------------------------------------------
+volatile int handled = 0;
+void countEvent(const char *) {
+  handled = handled + 1;
+}
+
+#define EVENT(n) {"A.0d3c8d02b02ceb4c.MicrocontrollerTest.Event" #n, countEvent}
+#define EVENTS_10(d) EVENT(d##0), EVENT(d##1), EVENT(d##2), EVENT(d##3), EVENT(d##4), EVENT(d##5), EVENT(d##6), EVENT(d##7), EVENT(d##8), EVENT(d##9)
+
+constexpr EventType TYPES_1[] = {EVENT(99)};
+constexpr EventType TYPES_10[] = {EVENTS_10(9)};
+constexpr EventType TYPES_100[] = {EVENTS_10(0), EVENTS_10(1), EVENTS_10(2), EVENTS_10(3), EVENTS_10(4),
+                                   EVENTS_10(5), EVENTS_10(6), EVENTS_10(7), EVENTS_10(8), EVENTS_10(9)};
+constexpr EventRegistry REGISTRY_1(TYPES_1);
+constexpr EventRegistry REGISTRY_10(TYPES_10);
+constexpr EventRegistry REGISTRY_100(TYPES_100);
+
+const int iterations = 10000;
+char incomingType[80] = "A.0d3c8d02b02ceb4c.MicrocontrollerTest.Event99"; // in RAM, like a deserialized envelope
+
+// original approach: compare against every subscribed type
+template <size_t N>
+const EventType *linearSearch(const EventType (&types)[N], const char *id) {
+  for (size_t i = 0; i < N; ++i)
+    if (strcmp(types[i].id, id) == 0) return &types[i];
+  return nullptr;
+}
+
+template <size_t N>
+void benchmark(const EventType (&types)[N], const EventRegistry<N> &registry) {
+  unsigned long startUS = micros();
+  for (int i = 0; i < iterations; ++i)
+    registry.find(incomingType)->handler(incomingType);
+  const float registryUS = (float)(micros() - startUS) / iterations;
+
+  startUS = micros();
+  for (int i = 0; i < iterations; ++i)
+    linearSearch(types, incomingType)->handler(incomingType);
+  const float linearUS = (float)(micros() - startUS) / iterations;
+
+  Serial.printf("%3u registered types: %.3f µs per dispatch via registry, %.3f µs via linear strcmp\n", (unsigned)N, registryUS, linearUS);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  benchmark(TYPES_1, REGISTRY_1);
+  benchmark(TYPES_10, REGISTRY_10);
+  benchmark(TYPES_100, REGISTRY_100);
+}
+
+void loop() {
+  // Nothing to do here
+}
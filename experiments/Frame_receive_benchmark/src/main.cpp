@@ -0,0 +1,285 @@
+#include <Arduino.h>
+#include <Client.h>
+
+#include <vector>
+
+#include "RxRingBuffer.h"
+#include "WebSocketFrameParser.h"
+
+// -----------------------------------------------------------------------------
+// Receiving WebSocket messages, as the network task of Project Hummingbird does, from a recorded stream of
+// server-to-client frames that a `ReplayClient` hands out one TCP segment at a time (as lwIP does on the board):
+//  • byte at a time:  the original `readWebSocketFrame()`, one `client->read()` per byte, the payload grown into a
+//                     `String` per byte
+//  • ring buffer:     bulk `client->read(buf, n)` into an `RxRingBuffer`, frames parsed in place by the
+//                     `WebSocketFrameParser`, the message read straight out of the buffer via `readMessage()`
+// The stream mixes heartbeats, messages with events, messages fragmented into several frames, and PINGs, and is
+// replayed until `messagesToReceive` messages were received. For each approach, the payload received per second,
+// the time per message and, on the host, the heap allocations per message are printed.
+// Allocations are counted on the host only, by wrapping glibc's malloc. Note that the host's `String` is a
+// `std::string`, which grows geometrically; the board's grows by exactly the appended byte, so the byte-at-a-time
+// approach reallocates even more often there.
+// -----------------------------------------------------------------------------
+const unsigned long messagesToReceive = 20000;
+const size_t segmentSize = 1436;       // TCP payload per segment
+const size_t rxBufferCapacity = 16384; // as `wsRxBufferCapacity` in `../../src/main.cpp`
+const size_t fragmentSize = 512;       // payload per frame of a fragmented message
+
+#if !defined(ARDUINO_ARCH_ESP32)
+/* ── allocation counting (host only) ─────────────────────────────────────────────────────────────── */
+unsigned long allocations = 0;
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) {
+  ++allocations;
+  return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+  ++allocations;
+  return __libc_calloc(count, size);
+}
+void *realloc(void *pointer, size_t size) {
+  ++allocations;
+  return __libc_realloc(pointer, size);
+}
+}
+#define COUNTS_ALLOCATIONS 1
+#else
+#define COUNTS_ALLOCATIONS 0
+#endif
+
+// CLASS ReplayClient
+// a `Client` handing out `recording` over and over, as fast as it is read; a bulk read ends at the end of a segment
+class ReplayClient : public Client {
+  public:
+  explicit ReplayClient(const std::vector<uint8_t> &recording) : recording(recording), position(0), reads(0) {}
+
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char *, uint16_t) override { return 1; }
+  size_t write(uint8_t) override { return 1; } // PONGs are not the point here
+  size_t write(const uint8_t *, size_t size) override { return size; }
+  int available() override { return segmentSize; } // the sender is always ahead
+  int read() override {
+    ++reads;
+    const uint8_t byte = recording[position % recording.size()];
+    ++position;
+    return byte;
+  }
+  int read(uint8_t *buffer, size_t size) override {
+    ++reads;
+    size = std::min(size, segmentSize - position % segmentSize); // up to the end of the segment
+    for (size_t copied = 0; copied < size;) { // the recording wraps around
+      const size_t offset = (position + copied) % recording.size();
+      const size_t n = std::min(size - copied, recording.size() - offset);
+      memcpy(buffer + copied, recording.data() + offset, n);
+      copied += n;
+    }
+    position += size;
+    return size;
+  }
+  int peek() override { return recording[position % recording.size()]; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+
+  unsigned long readCalls() const { return reads; }
+
+  private:
+  const std::vector<uint8_t> &recording;
+  size_t position;
+  unsigned long reads;
+};
+
+/* ── the recorded stream ───────────────────────────────────────────────────────────────────────── */
+std::vector<uint8_t> recording;
+unsigned long recordedMessages = 0;
+unsigned long recordedPayloadBytes = 0;
+
+// FUNCTION appendFrame: a server-to-client (unmasked) frame
+void appendFrame(uint8_t opcode, bool isFinal, const char *payload, size_t length) {
+  recording.push_back((isFinal ? 0x80 : 0x00) | opcode);
+  if (length < 126) {
+    recording.push_back(length);
+  } else {
+    recording.push_back(126);
+    recording.push_back(length >> 8);
+    recording.push_back(length & 0xFF);
+  }
+  recording.insert(recording.end(), payload, payload + length);
+}
+
+// FUNCTION appendMessage: a text message, in frames of at most `frameSize` bytes
+void appendMessage(const String &message, size_t frameSize) {
+  for (size_t offset = 0; offset < message.length(); offset += frameSize) {
+    const size_t length = std::min(frameSize, (size_t)message.length() - offset);
+    appendFrame(offset == 0 ? 0x1 : 0x0, offset + length == message.length(), message.c_str() + offset, length);
+  }
+  ++recordedMessages;
+  recordedPayloadBytes += message.length();
+}
+
+// FUNCTION eventsMessage: a message of the `events` topic with `events` ControlValueChanged events (0: heartbeat)
+String eventsMessage(unsigned long blockHeight, int events) {
+  String message = "{\"subscription_id\":\"20charIDStreamEvents\",\"topic\":\"events\",\"payload\":{\"block_id\":"
+                   "\"8cba6b0b2fbeb6bb2b0c9a7d0a3f3c8f1d6e5a4b3c2d1e0f9a8b7c6d5e4f3a2b\",\"block_height\":\"" +
+                   String(blockHeight) + "\",\"block_timestamp\":\"2025-06-01T12:00:00.000000000Z\",\"events\":[";
+  for (int i = 0; i < events; ++i) {
+    if (i > 0) message += ",";
+    message += "{\"type\":\"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged\",\"transaction_id\":"
+               "\"4a3b2c1d0e9f8a7b6c5d4e3f2a1b0c9d8e7f6a5b4c3d2e1f0a9b8c7d6e5f4a3b\",\"transaction_index\":\"0\","
+               "\"event_index\":\"" +
+               String(i) +
+               "\",\"payload\":\"eyJ2YWx1ZSI6eyJpZCI6IkEuMGQzYzhkMDJiMDJjZWI0Yy5NaWNyb2NvbnRyb2xsZXJUZXN0LkNvbnRyb2xW"
+               "YWx1ZUNoYW5nZWQiLCJmaWVsZHMiOlt7InZhbHVlIjp7InZhbHVlIjoiMTUiLCJ0eXBlIjoiSW50NjQifSwibmFtZSI6InZhbHVlIn0s"
+               "eyJ2YWx1ZSI6eyJ2YWx1ZSI6IjE2IiwidHlwZSI6IkludDY0In0sIm5hbWUiOiJvbGRWYWx1ZSJ9XX0sInR5cGUiOiJFdmVudCJ9\"}";
+  }
+  return message + "],\"message_index\":" + String(blockHeight % 100000) + "}}";
+}
+
+// FUNCTION record: 100 messages -- mostly heartbeats, some with events, a few fragmented -- and a PING every 25
+void record() {
+  for (unsigned long block = 268154930; recordedMessages < 100; ++block) {
+    if (recordedMessages % 25 == 0) appendFrame(0x9, true, "keepalive", 9);
+    if (block % 10 == 0) {
+      appendMessage(eventsMessage(block, 6), fragmentSize); // about 3.2 KB, in 7 frames
+    } else if (block % 3 == 0) {
+      appendMessage(eventsMessage(block, 1), 65535);
+    } else {
+      appendMessage(eventsMessage(block, 0), 65535);
+    }
+  }
+}
+
+/* ── byte at a time (the original approach) ────────────────────────────────────────────────────── */
+String wsBuffer = "";
+bool wsReceiving = false;
+
+// FUNCTION readFrameByteAtATime:
+// `readWebSocketFrame()` before the receive buffer, reduced to the frames of the recording; true once a complete
+// message is in `wsBuffer`
+bool readFrameByteAtATime(Client *client) {
+  if (client->available() < 2) return false;
+  uint8_t firstByte = client->read();
+  uint8_t secondByte = client->read();
+  bool isFinal = firstByte & 0x80;
+  uint8_t opcode = firstByte & 0x0F;
+  uint64_t payloadLength = secondByte & 0x7F;
+  if (payloadLength == 126) {
+    payloadLength = ((uint64_t)client->read() << 8) | client->read();
+  }
+
+  if (opcode == 0x9) { // PING
+    String pingPayload;
+    while (pingPayload.length() < payloadLength)
+      pingPayload += (char)client->read();
+    return false;
+  }
+
+  String payload;
+  while (payload.length() < payloadLength)
+    payload += (char)client->read();
+  if (opcode == 0x1) {
+    wsBuffer = payload;
+    wsReceiving = !isFinal;
+  } else {
+    wsBuffer += payload;
+    wsReceiving = !isFinal;
+  }
+  return !wsReceiving;
+}
+
+/* ── measurement ───────────────────────────────────────────────────────────────────────────────── */
+// FUNCTION report
+void report(const char *name, unsigned long elapsedUS, unsigned long messages, unsigned long payloadBytes,
+            unsigned long allocationCount, unsigned long readCalls, unsigned long checksum) {
+  Serial.printf("⏱️ %-15s: %7.1f MB/s payload, %6.2f µs per message, %6.2f client reads per message", name,
+                (double)payloadBytes / elapsedUS, (double)elapsedUS / messages, (double)readCalls / messages);
+  if (COUNTS_ALLOCATIONS) Serial.printf(", %6.2f allocations per message", (double)allocationCount / messages);
+  Serial.printf(" (checksum %lx)\n", checksum);
+}
+
+// FUNCTION measureByteAtATime
+void measureByteAtATime() {
+  ReplayClient client(recording);
+  unsigned long messages = 0, payloadBytes = 0, checksum = 0;
+#if COUNTS_ALLOCATIONS
+  const unsigned long allocationsBefore = allocations;
+#endif
+  const unsigned long startUS = micros();
+  while (messages < messagesToReceive) {
+    if (!readFrameByteAtATime(&client)) continue;
+    ++messages;
+    payloadBytes += wsBuffer.length();
+    checksum = checksum * 31 + (uint8_t)wsBuffer[wsBuffer.length() / 2];
+  }
+  const unsigned long elapsedUS = micros() - startUS;
+#if COUNTS_ALLOCATIONS
+  const unsigned long allocationCount = allocations - allocationsBefore;
+#else
+  const unsigned long allocationCount = 0;
+#endif
+  report("byte at a time", elapsedUS, messages, payloadBytes, allocationCount, client.readCalls(), checksum);
+}
+
+// FUNCTION measureRingBuffer
+void measureRingBuffer() {
+  ReplayClient client(recording);
+  RxRingBuffer *rx = new RxRingBuffer(rxBufferCapacity);
+  WebSocketFrameParser *parser = new WebSocketFrameParser(rx);
+  static uint8_t message[rxBufferCapacity]; // the consumer, standing in for `deserializeJson`
+  unsigned long messages = 0, payloadBytes = 0, checksum = 0;
+#if COUNTS_ALLOCATIONS
+  const unsigned long allocationsBefore = allocations;
+#endif
+  const unsigned long startUS = micros();
+  while (messages < messagesToReceive) {
+    switch (parser->poll()) {
+      case WebSocketFrameParser::Event::None:
+        rx->fill(&client);
+        break;
+      case WebSocketFrameParser::Event::MessageReady: {
+        const size_t length = parser->readMessage(message, sizeof(message));
+        parser->finishMessage();
+        ++messages;
+        payloadBytes += length;
+        checksum = checksum * 31 + message[length / 2];
+        break;
+      }
+      default: // PINGs
+        break;
+    }
+  }
+  const unsigned long elapsedUS = micros() - startUS;
+#if COUNTS_ALLOCATIONS
+  const unsigned long allocationCount = allocations - allocationsBefore;
+#else
+  const unsigned long allocationCount = 0;
+#endif
+  delete parser;
+  delete rx;
+  report("ring buffer", elapsedUS, messages, payloadBytes, allocationCount, client.readCalls(), checksum);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  record();
+  Serial.printf("📼 recorded %lu messages, %lu B of payload, %zu B on the wire; receiving %lu messages per approach\n",
+                recordedMessages, recordedPayloadBytes, recording.size(), messagesToReceive);
+  for (int round = 0; round < 3; ++round) {
+    measureByteAtATime();
+    measureRingBuffer();
+  }
+  Serial.println(F("🏁 done"));
+}
+
+void loop() {
+  delay(1000);
+}
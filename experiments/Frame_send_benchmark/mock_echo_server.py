@@ -0,0 +1,142 @@
+"""Minimal WebSocket echo server that counts the TCP segments each client frame arrived in.
+
+Every (masked) frame the client sends is unmasked and echoed back as an unmasked text frame. The payload of the
+benchmark's frames starts with the name of the approach that sent it ("per byte:...", "writer:..."); for
+each run of frames of the same approach and length, the server prints how many TCP segments and recv() calls a
+frame took on average. Segments are read from the kernel (TCP_INFO's tcpi_segs_in, Linux only) and include the
+client's pure ACKs of the echoes, at most one per frame.
+
+Usage: python3 mock_echo_server.py [port]     (default: 8076)
+Standard library only; one client at a time.
+"""
+
+import base64
+import hashlib
+import socket
+import struct
+import sys
+
+PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 8076
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+TCPI_SEGS_IN_OFFSET = 140  # in struct tcp_info, since Linux 4.2
+
+
+def segments_in(conn):
+    """TCP segments received on `conn` so far; None where the kernel doesn't tell"""
+    if not hasattr(socket, "TCP_INFO"):
+        return None
+    info = conn.getsockopt(socket.IPPROTO_TCP, socket.TCP_INFO, 256)
+    if len(info) < TCPI_SEGS_IN_OFFSET + 4:
+        return None
+    return struct.unpack_from("I", info, TCPI_SEGS_IN_OFFSET)[0]
+
+
+class CountingReader:
+    """reads exactly the bytes asked for, counting the recv() calls it takes"""
+
+    def __init__(self, conn):
+        self.conn = conn
+        self.calls = 0
+
+    def exactly(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = self.conn.recv(n - len(data))
+            self.calls += 1
+            if not chunk:
+                raise ConnectionError("client closed the connection")
+            data += chunk
+        return data
+
+
+def recv_frame(reader):
+    first, second = reader.exactly(2)
+    opcode = first & 0x0F
+    length = second & 0x7F
+    if length == 126:
+        length = struct.unpack("!H", reader.exactly(2))[0]
+    elif length == 127:
+        length = struct.unpack("!Q", reader.exactly(8))[0]
+    mask = reader.exactly(4) if second & 0x80 else b"\0\0\0\0"
+    payload = bytes(b ^ mask[i % 4] for i, b in enumerate(reader.exactly(length)))
+    return opcode, payload
+
+
+def send_frame(conn, opcode, payload):
+    if len(payload) < 126:
+        header = struct.pack("!BB", 0x80 | opcode, len(payload))
+    elif len(payload) < 65536:
+        header = struct.pack("!BBH", 0x80 | opcode, 126, len(payload))
+    else:
+        header = struct.pack("!BBQ", 0x80 | opcode, 127, len(payload))
+    conn.sendall(header + payload)
+
+
+def handshake(conn):
+    request = b""
+    while b"\r\n\r\n" not in request:
+        chunk = conn.recv(1024)
+        if not chunk:
+            raise ConnectionError("client closed the connection during the handshake")
+        request += chunk
+    key = ""
+    for line in request.decode(errors="replace").split("\r\n"):
+        if line.lower().startswith("sec-websocket-key:"):
+            key = line.split(":", 1)[1].strip()
+    accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+    conn.sendall(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  f"Sec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+
+
+class Run:
+    """consecutive frames of the same approach and length"""
+
+    def __init__(self, key):
+        self.key = key
+        self.frames = self.segments = self.calls = 0
+
+    def report(self):
+        if self.frames == 0:
+            return
+        approach, length = self.key
+        segments = f"{self.segments / self.frames:8.2f}" if self.segments is not None else "     n/a"
+        print(f"📦 {approach:<15} {length:6} B: {self.frames:4} frames, {segments} segments and "
+              f"{self.calls / self.frames:8.2f} recv() calls per frame")
+
+
+def serve(conn):
+    handshake(conn)
+    reader = CountingReader(conn)
+    run = Run(None)
+    try:
+        while True:
+            before_segments, before_calls = segments_in(conn), reader.calls
+            opcode, payload = recv_frame(reader)
+            if opcode == 0x8:  # close
+                return
+            key = (payload.split(b":", 1)[0].decode(errors="replace"), len(payload))
+            if key != run.key:
+                run.report()
+                run = Run(key)
+            after_segments = segments_in(conn)
+            run.frames += 1
+            run.calls += reader.calls - before_calls
+            if run.segments is not None and after_segments is not None:
+                run.segments += after_segments - before_segments
+            else:
+                run.segments = None
+            send_frame(conn, 0x1, payload)
+    except (ConnectionError, OSError) as error:
+        print(f"connection ended: {error}")
+    finally:
+        run.report()
+        conn.close()
+
+
+if __name__ == "__main__":
+    server = socket.create_server(("", PORT))
+    print(f"mock echo server on port {PORT}")
+    while True:
+        connection, address = server.accept()
+        print(f"client {address[0]} connected")
+        serve(connection)
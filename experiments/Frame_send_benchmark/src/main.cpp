@@ -0,0 +1,217 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <algorithm>
+
+#include "RxRingBuffer.h"
+#include "WebSocketFrameParser.h"
+#include "WebSocketFrameWriter.h"
+#include "WiFiCredentials.h"
+
+// -----------------------------------------------------------------------------
+// NEEDS HUMAN CONFIGURATION: address of the computer running `mock_echo_server.py`
+// (`python3 mock_echo_server.py 8076`); on the host, `127.0.0.1`.
+// -----------------------------------------------------------------------------
+const char *echoHost = "192.168.1.10";
+const uint16_t echoPort = 8076;
+
+// Sending masked client-to-server frames, as Project Hummingbird does for subscription requests and PONG replies:
+//  • per byte:       the original `sendWebSocketFrame()`, writing the header, then one `client->write()` per
+//                     masked payload byte
+//  • writer:          the `WebSocketFrameWriter` (see `../src`), masking 32 bits at a time into a scratch buffer
+//                     that leaves in one `write()`
+// First in memory, into a client that only counts the writes (time and writes per frame), then over the network to
+// the echo server, which counts the TCP segments each frame arrived in; the board waits for each echo before sending
+// the next frame, which gives the round trip time.
+const size_t payloadLengths[] = {9, 180, 1000, 4000}; // a PONG, a subscription request, larger messages
+const size_t scratchCapacity = 1024;                   // as `wsTxScratchCapacity` in `../../src/main.cpp`
+const unsigned long framesInMemory = 20000;            // per approach and length
+const int framesOverNetwork = 50;                      // per approach and length
+
+enum class Approach { PerByte, Writer };
+const char *approachNames[] = {"per byte", "writer"}; // also the prefix of the payload; fits into 9 bytes
+
+WebSocketFrameWriter *writer = nullptr;
+uint8_t payload[4000];
+
+// FUNCTION sendFramePerByte:
+// `sendWebSocketFrame()` before the frame writer, for any payload
+bool sendFramePerByte(Client *client, uint8_t opcode, const uint8_t *payload, size_t payloadLength) {
+  uint8_t header[14];
+  size_t headerSize = 2;
+  uint8_t maskKey[4];
+
+  header[0] = 0x80 | opcode; // FIN + opcode
+  if (payloadLength <= 125) {
+    header[1] = 0x80 | payloadLength;
+  } else {
+    header[1] = 0x80 | 126;
+    header[2] = (payloadLength >> 8) & 0xFF;
+    header[3] = payloadLength & 0xFF;
+    headerSize += 2;
+  }
+  for (int i = 0; i < 4; ++i) {
+    maskKey[i] = random(0, 256);
+    header[headerSize++] = maskKey[i];
+  }
+
+  bool ok = client->write(header, headerSize) == headerSize; // header + mask
+  for (size_t i = 0; ok && i < payloadLength; ++i) {          // mask payload
+    ok = client->write(payload[i] ^ maskKey[i % 4]) == 1;
+  }
+  client->flush();
+  return ok;
+}
+
+bool sendFrame(Approach approach, Client *client, size_t payloadLength) {
+  if (approach == Approach::PerByte) return sendFramePerByte(client, 0x1, payload, payloadLength);
+  return writer->send(client, WebSocketFrameWriter::OPCODE_TEXT, payload, payloadLength);
+}
+
+// FUNCTION fillPayload:
+// `payloadLength` bytes of JSON-like text, starting with the approach's name so the echo server can tell them apart
+void fillPayload(Approach approach, size_t payloadLength) {
+  const int prefixLength = snprintf((char *)payload, sizeof(payload), "%s:", approachNames[static_cast<int>(approach)]);
+  for (size_t i = prefixLength; i < payloadLength; ++i)
+    payload[i] = "{\"subscription_id\":\"20charIDStreamEvents\"}"[i % 42];
+}
+
+/* ── in memory ─────────────────────────────────────────────────────────────────────────────────── */
+// CLASS CountingClient
+// a `Client` that accepts and counts all writes, and has nothing to read
+class CountingClient : public Client {
+  public:
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char *, uint16_t) override { return 1; }
+  size_t write(uint8_t) override {
+    ++writes;
+    ++bytes;
+    return 1;
+  }
+  size_t write(const uint8_t *, size_t size) override {
+    ++writes;
+    bytes += size;
+    return size;
+  }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(uint8_t *, size_t) override { return -1; }
+  int peek() override { return -1; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+
+  unsigned long writes = 0;
+  unsigned long bytes = 0;
+};
+
+// FUNCTION measureInMemory
+void measureInMemory(Approach approach, size_t payloadLength) {
+  CountingClient client;
+  fillPayload(approach, payloadLength);
+  const unsigned long startUS = micros();
+  for (unsigned long i = 0; i < framesInMemory; ++i)
+    sendFrame(approach, &client, payloadLength);
+  const unsigned long elapsedUS = micros() - startUS;
+  Serial.printf("⏱️ %-15s %5zu B: %8.3f µs per frame, %6.1f MB/s, %7.1f writes and %6.1f B per frame\n",
+                approachNames[static_cast<int>(approach)], payloadLength, (double)elapsedUS / framesInMemory,
+                (double)payloadLength * framesInMemory / elapsedUS, (double)client.writes / framesInMemory,
+                (double)client.bytes / framesInMemory);
+}
+
+/* ── over the network ──────────────────────────────────────────────────────────────────────────── */
+WiFiClient echoClient;
+RxRingBuffer *rx = nullptr;
+WebSocketFrameParser *parser = nullptr;
+
+// FUNCTION connectToEchoServer: TCP connection and WebSocket upgrade
+bool connectToEchoServer() {
+  if (!echoClient.connect(echoHost, echoPort)) return false;
+  echoClient.print(String("GET / HTTP/1.1\r\nHost: ") + echoHost +
+                   "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                   "Sec-WebSocket-Version: 13\r\n\r\n");
+  String response;
+  const unsigned long startMS = millis();
+  while (!response.endsWith("\r\n\r\n")) {
+    if (millis() - startMS > 5000 || !echoClient.connected()) return false;
+    const int c = echoClient.read();
+    if (c < 0) {
+      delay(1);
+    } else {
+      response += (char)c;
+    }
+  }
+  return response.startsWith("HTTP/1.1 101");
+}
+
+// FUNCTION awaitEcho: true if the echo of the `payloadLength` bytes just sent arrived intact within 5 s
+bool awaitEcho(size_t payloadLength) {
+  static uint8_t echo[sizeof(payload)];
+  const unsigned long startMS = millis();
+  while (millis() - startMS < 5000) {
+    rx->fill(&echoClient);
+    if (parser->poll() != WebSocketFrameParser::Event::MessageReady) continue;
+    const size_t length = parser->readMessage(echo, sizeof(echo));
+    parser->finishMessage();
+    return length == payloadLength && memcmp(echo, payload, length) == 0;
+  }
+  return false;
+}
+
+// FUNCTION measureOverNetwork
+void measureOverNetwork(Approach approach, size_t payloadLength) {
+  unsigned long roundTripUS[framesOverNetwork];
+  fillPayload(approach, payloadLength);
+  int echoed = 0;
+  for (int i = 0; i < framesOverNetwork; ++i) {
+    const unsigned long startUS = micros();
+    if (!sendFrame(approach, &echoClient, payloadLength) || !awaitEcho(payloadLength)) continue;
+    roundTripUS[echoed++] = micros() - startUS;
+  }
+  if (echoed == 0) {
+    Serial.printf("❌ %-15s %5zu B: no echo\n", approachNames[static_cast<int>(approach)], payloadLength);
+    return;
+  }
+  std::sort(roundTripUS, roundTripUS + echoed);
+  Serial.printf("⏱️ %-15s %5zu B: %d/%d echoed, round trip %7.2f / %7.2f / %7.2f ms (fastest / median / slowest)\n",
+                approachNames[static_cast<int>(approach)], payloadLength, echoed, framesOverNetwork,
+                roundTripUS[0] / 1000.0, roundTripUS[echoed / 2] / 1000.0, roundTripUS[echoed - 1] / 1000.0);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  writer = new WebSocketFrameWriter(scratchCapacity);
+  rx = new RxRingBuffer(2 * sizeof(payload));
+  parser = new WebSocketFrameParser(rx);
+
+  Serial.println(F("🧮 in memory"));
+  for (size_t payloadLength : payloadLengths) {
+    for (Approach approach : {Approach::PerByte, Approach::Writer})
+      measureInMemory(approach, payloadLength);
+  }
+
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(100);
+  }
+  if (!connectToEchoServer()) {
+    Serial.printf("❌ Connecting to the echo server at %s:%u failed\n", echoHost, echoPort);
+    return;
+  }
+  Serial.printf("📡 over the network, to the echo server at %s:%u (it prints the segments per frame)\n", echoHost,
+                echoPort);
+  for (size_t payloadLength : payloadLengths) {
+    for (Approach approach : {Approach::PerByte, Approach::Writer})
+      measureOverNetwork(approach, payloadLength);
+  }
+  echoClient.stop();
+  Serial.println(F("🏁 done"));
+}
+
+void loop() {
+  delay(1000);
+}
@@ -0,0 +1,193 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "Base64DecodingStream.h"
+#include "HttpBodyStream.h"
+#include "JsonCadenceReader.h"
+
+// -----------------------------------------------------------------------------
+// Responses of the Flow REST API, as they arrive on the connection after the headers: in chunked transfer
+// encoding, split into chunks of `chunk_size` bytes. The bodies are shaped after responses of testnet
+// (`/v1/blocks?height=sealed`, with and without `expand=payload`, and `/v1/scripts`); ids and signatures are
+// filler of the same length.
+// -----------------------------------------------------------------------------
+static const size_t chunk_size = 1024;
+static const char *script_result = R"("eyJ2YWx1ZSI6IjQyIiwidHlwZSI6IkludDY0In0K")"; // {"value":"42","type":"Int64"}
+static const char *script_error =
+    R"({"code":400,"message":"Invalid Flow argument: failed to execute the script on the execution node: execution reverted: [Error Code: 1101] error caused by: 1 error occurred:\n\t* transaction execute failed: [Error Code: 1101] cadence runtime error: Execution failed"})";
+const int iterations = 200;
+
+// 64 hex characters, like the ids of blocks and collections
+String hexId(uint32_t seed) {
+  String id;
+  for (int i = 0; i < 8; ++i)
+    id += String(seed * 2654435761u + i * 40503u | 0x10000000u, HEX);
+  return id;
+}
+
+// `/v1/blocks?height=sealed`; with `guarantees` > 0 as for `&expand=payload`, with that many collection
+// guarantees and block seals, which is what makes the response of a busy block long
+String sealedBlockResponse(unsigned int guarantees) {
+  String body = "[{\"header\":{\"id\":\"" + hexId(1) + "\",\"parent_id\":\"" + hexId(2) +
+                "\",\"height\":\"268154930\",\"timestamp\":\"2025-06-14T09:21:07.612409367Z\",\"parent_voter_signature\":\"" +
+                hexId(3) + hexId(4) + "\"},";
+  if (guarantees == 0) {
+    body += "\"_expandable\":{\"payload\":\"/v1/blocks/" + hexId(1) + "/payload\",\"execution_result\":\"/v1/execution_results/" +
+            hexId(5) + "\"},";
+  } else {
+    body += "\"payload\":{\"collection_guarantees\":[";
+    for (unsigned int i = 0; i < guarantees; ++i) {
+      if (i > 0) body += ",";
+      body += "{\"collection_id\":\"" + hexId(100 + i) + "\",\"signer_indices\":\"" + hexId(200 + i).substring(0, 16) +
+              "\",\"signature\":\"" + hexId(300 + i) + "\"}";
+    }
+    body += "],\"block_seals\":[";
+    for (unsigned int i = 0; i < guarantees; ++i) {
+      if (i > 0) body += ",";
+      body += "{\"block_id\":\"" + hexId(400 + i) + "\",\"result_id\":\"" + hexId(500 + i) + "\",\"final_state\":\"" +
+              hexId(600 + i) + "\",\"aggregated_approval_signatures\":[]}";
+    }
+    body += "]},\"_expandable\":{\"execution_result\":\"/v1/execution_results/" + hexId(5) + "\"},";
+  }
+  body += "\"_links\":{\"_self\":\"/v1/blocks/" + hexId(1) + "\"},\"block_status\":\"BLOCK_SEALED\"}]";
+  return body;
+}
+
+String chunked(const String &body) {
+  String wire;
+  for (size_t offset = 0; offset < body.length(); offset += chunk_size) {
+    const String chunk = body.substring(offset, offset + chunk_size);
+    wire += String(chunk.length(), HEX) + "\r\n" + chunk + "\r\n";
+  }
+  return wire + "0\r\n\r\n";
+}
+
+// plays back a response, in place of the connection to the Access Node
+class RecordedConnection : public Stream {
+  public:
+  RecordedConnection(const String &wire) : wire(wire), position(0) {}
+  void rewind() { position = 0; }
+  int available() override { return wire.length() - position; }
+  int read() override { return position < wire.length() ? (uint8_t)wire[position++] : -1; }
+  int peek() override { return position < wire.length() ? (uint8_t)wire[position] : -1; }
+  size_t write(uint8_t) override { return 0; }
+
+  private:
+  const String &wire;
+  size_t position;
+};
+
+bool parseIntegerResult(const char *base64Payload, int64_t &result) {
+  Base64DecodingStream decoded(base64Payload);
+  JsonCadenceReader reader(decoded);
+  return reader.readIntegerValue(result) == JsonCadenceReader::Result::Ok;
+}
+
+// original approach: `http.getString()` (which removes the chunked encoding into a String), then parse it all
+String getString(Stream &connection) {
+  HttpBodyStream body(connection, true, -1);
+  String rawResponse;
+  char buffer[128];
+  size_t length;
+  while ((length = body.readBytes(buffer, sizeof(buffer))) > 0)
+    rawResponse.concat(buffer, length);
+  return rawResponse;
+}
+
+bool sealedHeightBuffered(Stream &connection, int64_t &result) {
+  String rawResponse = getString(connection);
+  DynamicJsonDocument response(4096);
+  if (deserializeJson(response, rawResponse)) return false;
+  result = strtoll(response[0]["header"]["height"] | "0", nullptr, 10);
+  return result > 0;
+}
+
+bool scriptResultBuffered(Stream &connection, int64_t &result) {
+  String rawResponse = getString(connection);
+  rawResponse.trim();
+  if (rawResponse.startsWith("{")) {
+    StaticJsonDocument<1024> errorDoc;
+    deserializeJson(errorDoc, rawResponse);
+    return false;
+  }
+  if (!rawResponse.startsWith("\"") || !rawResponse.endsWith("\"")) return false;
+  return parseIntegerResult(rawResponse.substring(1, rawResponse.length() - 1).c_str(), result);
+}
+
+// streamed approach of the main project (see `OnChainState`): parse from the connection, keep only what is needed
+bool sealedHeightStreamed(Stream &connection, int64_t &result) {
+  HttpBodyStream body(connection, true, -1);
+  JsonDocument filter;
+  filter[0]["header"]["height"] = true;
+  JsonDocument response;
+  const bool parsed = !deserializeJson(response, body, DeserializationOption::Filter(filter));
+  if (!body.drain() || !parsed) return false;
+  result = strtoll(response[0]["header"]["height"] | "0", nullptr, 10);
+  return result > 0;
+}
+
+bool scriptResultStreamed(Stream &connection, int64_t &result) {
+  HttpBodyStream body(connection, true, -1);
+  bool success = false;
+  if (body.peek() == '{') {
+    JsonDocument filter;
+    filter["code"] = true;
+    filter["message"] = true;
+    JsonDocument errorDoc;
+    deserializeJson(errorDoc, body, DeserializationOption::Filter(filter));
+  } else if (body.read() == '"') {
+    Base64DecodingStream decoded(body, '"'); // straight from the response, up to the string's closing quote
+    JsonCadenceReader reader(decoded);
+    success = reader.readIntegerValue(result) == JsonCadenceReader::Result::Ok;
+  }
+  return body.drain() && success;
+}
+
+void benchmark(const char *name, const char *approach, const String &wire, bool (*parse)(Stream &, int64_t &)) {
+  RecordedConnection connection(wire);
+  int64_t result = 0;
+  const uint32_t heapBefore = ESP.getMinFreeHeap();
+  const unsigned long startUS = micros();
+  bool ok = true;
+  for (int i = 0; i < iterations; ++i) {
+    connection.rewind();
+    ok &= parse(connection, result);
+  }
+  const unsigned long elapsedUS = micros() - startUS;
+  Serial.printf("%-22s %-9s %s: %8.2f µs per response of %5u bytes; result %lld; heap low-water mark dropped by %u bytes\n",
+                name, approach, ok ? "✅" : "❌", (float)elapsedUS / iterations, wire.length(), result,
+                heapBefore - ESP.getMinFreeHeap());
+}
+
+struct Response {
+  const char *name;
+  String wire;
+  bool (*buffered)(Stream &, int64_t &);
+  bool (*streamed)(Stream &, int64_t &);
+};
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  Response responses[] = {
+      {"sealed block", chunked(sealedBlockResponse(0)), sealedHeightBuffered, sealedHeightStreamed},
+      {"sealed block, payload", chunked(sealedBlockResponse(8)), sealedHeightBuffered, sealedHeightStreamed},
+      {"busy block, payload", chunked(sealedBlockResponse(48)), sealedHeightBuffered, sealedHeightStreamed},
+      {"script result", chunked(script_result), scriptResultBuffered, scriptResultStreamed},
+      {"script error (❌ expected)", chunked(script_error), scriptResultBuffered, scriptResultStreamed},
+  };
+
+  // The heap's low-water mark only ever drops. Hence, the streamed approach runs first; the drop of the buffered
+  // approach is what it needs on top.
+  for (const Response &response : responses)
+    benchmark(response.name, "streamed", response.wire, response.streamed);
+  for (const Response &response : responses)
+    benchmark(response.name, "buffered", response.wire, response.buffered);
+}
+
+void loop() {
+  // Nothing to do here
+}
@@ -0,0 +1,192 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Client.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "MessageArena.h"
+#include "RxRingBuffer.h"
+#include "WebSocketFrameParser.h"
+#include "WebSocketMessageStream.h"
+
+// -----------------------------------------------------------------------------
+// Deserializing WebSocket messages of the `events` topic, as the network task of Project Hummingbird does, once the
+// frame parser reported a complete message in the receive buffer:
+//  • copied:    the message is first copied into a `String` (`wsBuffer`, reserved to the message's length), which is
+//               then deserialized -- as before messages were deserialized in place
+//  • in place:  `deserializeJson()` reads the message straight out of the receive buffer via the
+//               `WebSocketMessageStream` (see `../src`), skipping the headers of continuation frames
+// Both deserialize with the controller's filter into a `JsonDocument` placed in a `MessageArena`, so the memory the
+// document takes is the arena's high-water mark. The peak RAM of a message is that plus, for the copied approach,
+// the copy; the receive buffer (`rxBufferCapacity`) is the same for both and not included. The parse latency runs
+// from the message being reported ready until it is deserialized and released, the copy included.
+// -----------------------------------------------------------------------------
+const int eventCounts[] = {0, 1, 6, 12}; // a heartbeat, a control event, busy blocks; 12 events are about 6 KB
+const unsigned long messagesPerSize = 2000;
+const size_t segmentSize = 1436;       // TCP payload per segment
+const size_t rxBufferCapacity = 16384; // as `wsRxBufferCapacity` in `../../src/main.cpp`
+const size_t frameSize = 4096;         // larger messages arrive fragmented
+const size_t arenaCapacity = 16384;    // twice `wsMessageArenaCapacity`, so that the largest message fits
+
+enum class Approach { Copied, InPlace };
+const char *approachNames[] = {"copied", "in place"};
+
+// CLASS ReplayClient
+// a `Client` handing out `recording` over and over, as fast as it is read; a bulk read ends at the end of a segment
+class ReplayClient : public Client {
+  public:
+  explicit ReplayClient(const std::vector<uint8_t> &recording) : recording(recording), position(0) {}
+
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char *, uint16_t) override { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t *, size_t size) override { return size; }
+  int available() override { return segmentSize; } // the sender is always ahead
+  int read() override { return recording[position++ % recording.size()]; }
+  int read(uint8_t *buffer, size_t size) override {
+    size = std::min(size, segmentSize - position % segmentSize); // up to the end of the segment
+    for (size_t copied = 0; copied < size;) { // the recording wraps around
+      const size_t offset = (position + copied) % recording.size();
+      const size_t n = std::min(size - copied, recording.size() - offset);
+      memcpy(buffer + copied, recording.data() + offset, n);
+      copied += n;
+    }
+    position += size;
+    return size;
+  }
+  int peek() override { return recording[position % recording.size()]; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+
+  private:
+  const std::vector<uint8_t> &recording;
+  size_t position;
+};
+
+// FUNCTION eventsMessage: a message of the `events` topic with `events` ControlValueChanged events (0: heartbeat)
+String eventsMessage(unsigned long blockHeight, int events) {
+  String message = "{\"subscription_id\":\"20charIDStreamEvents\",\"topic\":\"events\",\"payload\":{\"block_id\":"
+                   "\"8cba6b0b2fbeb6bb2b0c9a7d0a3f3c8f1d6e5a4b3c2d1e0f9a8b7c6d5e4f3a2b\",\"block_height\":\"" +
+                   String(blockHeight) + "\",\"block_timestamp\":\"2025-06-01T12:00:00.000000000Z\",\"events\":[";
+  for (int i = 0; i < events; ++i) {
+    if (i > 0) message += ",";
+    message += "{\"type\":\"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged\",\"transaction_id\":"
+               "\"4a3b2c1d0e9f8a7b6c5d4e3f2a1b0c9d8e7f6a5b4c3d2e1f0a9b8c7d6e5f4a3b\",\"transaction_index\":\"0\","
+               "\"event_index\":\"" +
+               String(i) +
+               "\",\"payload\":\"eyJ2YWx1ZSI6eyJpZCI6IkEuMGQzYzhkMDJiMDJjZWI0Yy5NaWNyb2NvbnRyb2xsZXJUZXN0LkNvbnRyb2xW"
+               "YWx1ZUNoYW5nZWQiLCJmaWVsZHMiOlt7InZhbHVlIjp7InZhbHVlIjoiMTUiLCJ0eXBlIjoiSW50NjQifSwibmFtZSI6InZhbHVlIn0s"
+               "eyJ2YWx1ZSI6eyJ2YWx1ZSI6IjE2IiwidHlwZSI6IkludDY0In0sIm5hbWUiOiJvbGRWYWx1ZSJ9XX0sInR5cGUiOiJFdmVudCJ9\"}";
+  }
+  return message + "],\"message_index\":" + String(blockHeight % 100000) + "}}";
+}
+
+// FUNCTION record: `message` as server-to-client text frames of at most `frameSize` bytes
+std::vector<uint8_t> record(const String &message) {
+  std::vector<uint8_t> recording;
+  for (size_t offset = 0; offset < message.length(); offset += frameSize) {
+    const size_t length = std::min(frameSize, (size_t)message.length() - offset);
+    recording.push_back((offset + length == message.length() ? 0x80 : 0x00) | (offset == 0 ? 0x1 : 0x0));
+    if (length < 126) {
+      recording.push_back(length);
+    } else {
+      recording.push_back(126);
+      recording.push_back(length >> 8);
+      recording.push_back(length & 0xFF);
+    }
+    recording.insert(recording.end(), message.c_str() + offset, message.c_str() + offset + length);
+  }
+  return recording;
+}
+
+// FUNCTION buildFilter: as `buildWebSocketMessageFilter()` in `../../src/main.cpp`
+void buildFilter(JsonDocument &filter) {
+  filter["topic"] = true;
+  filter["subscription_id"] = true;
+  filter["action"] = true;
+  filter["error"] = true;
+  filter["payload"]["height"] = true;
+  filter["payload"]["block_id"] = true;
+  filter["payload"]["block_height"] = true;
+  filter["payload"]["block_timestamp"] = true;
+  filter["payload"]["message_index"] = true;
+  filter["payload"]["events"][0]["type"] = true;
+  filter["payload"]["events"][0]["payload"] = true;
+  filter["payload"]["events"][0]["transaction_id"] = true;
+  filter["payload"]["events"][0]["event_index"] = true;
+}
+
+JsonDocument filter;
+
+// FUNCTION measure
+void measure(Approach approach, int events) {
+  const String message = eventsMessage(268154930, events);
+  const std::vector<uint8_t> recording = record(message);
+  ReplayClient client(recording);
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  WebSocketMessageStream stream(&parser);
+  MessageArena arena(arenaCapacity);
+  ArenaJsonAllocator allocator(&arena);
+
+  static unsigned long latencyUS[messagesPerSize];
+  size_t copyBytes = 0;
+  unsigned long failed = 0, eventsRead = 0;
+  for (unsigned long i = 0; i < messagesPerSize;) {
+    if (parser.poll() != WebSocketFrameParser::Event::MessageReady) {
+      rx.fill(&client);
+      continue;
+    }
+    const unsigned long startUS = micros();
+    {
+      JsonDocument doc(&allocator);
+      DeserializationError err;
+      if (approach == Approach::Copied) {
+        String wsBuffer;
+        wsBuffer.reserve(message.length());
+        char chunk[256];
+        for (size_t n; (n = stream.readBytes(chunk, sizeof(chunk))) > 0;)
+          wsBuffer.concat(chunk, n);
+        parser.finishMessage();
+        copyBytes = std::max(copyBytes, (size_t)wsBuffer.length() + 1); // with the terminator
+        err = deserializeJson(doc, wsBuffer, DeserializationOption::Filter(filter));
+      } else {
+        err = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+        parser.finishMessage();
+      }
+      if (err) ++failed;
+      eventsRead += doc["payload"]["events"].size();
+    }
+    arena.reset();
+    latencyUS[i++] = micros() - startUS;
+  }
+
+  std::sort(latencyUS, latencyUS + messagesPerSize);
+  Serial.printf("⏱️ %-8s %2d events, %5u B: %8.1f / %8.1f µs (median / slowest), peak RAM %5zu B (document %5zu B + "
+                "copy %5zu B); %lu events read, %lu failed\n",
+                approachNames[static_cast<int>(approach)], events, message.length(),
+                (double)latencyUS[messagesPerSize / 2], (double)latencyUS[messagesPerSize - 1],
+                arena.highWaterMark() + copyBytes, arena.highWaterMark(), copyBytes, eventsRead, failed);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  buildFilter(filter);
+  Serial.printf("📥 deserializing %lu messages per size and approach\n", messagesPerSize);
+  for (int events : eventCounts) {
+    for (Approach approach : {Approach::Copied, Approach::InPlace})
+      measure(approach, events);
+  }
+  Serial.println(F("🏁 done"));
+}
+
+void loop() {
+  delay(1000);
+}
@@ -0,0 +1,187 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "Base64DecodingStream.h"
+#include "EventRegistry.h"
+#include "IngestQueue.h"
+#include "JsonCadenceReader.h"
+
+// -----------------------------------------------------------------------------
+// A synthetic feed of `events` messages, shaped like those of the WebSocket API: every block carries one
+// `EVM.BlockExecuted` and `feesPerBlock` `FlowFees.FeesDeducted` events (telemetry), and every
+// `controlEveryBlocks`-th block additionally a `ControlValueChanged` event (control). The messages are generated
+// in memory at an offered rate and processed in passes like those of the network task of Project Hummingbird:
+//  • direct:   each pass reads one message and processes all its events right away (the original approach)
+//  • queued:   each pass processes up to `itemsPerPass` items of the `IngestQueue`, then reads one message into
+//              it, unless the queue is congested (the node then has to wait: backpressure)
+// A rate counts as sustained if the backlog of messages not yet read stays below `sustainedBacklogMS` worth.
+// Logging an event is simulated by formatting its line into a buffer, so the serial port doesn't dominate.
+// -----------------------------------------------------------------------------
+const unsigned long measurementMS = 3000; // per rate and approach
+const unsigned long offeredRates[] = {500, 1000, 2000, 5000, 10000, 20000, 50000}; // events/s
+const size_t feesPerBlock = 8;
+const unsigned long controlEveryBlocks = 10;
+const unsigned long sustainedBacklogMS = 100;
+const size_t itemsPerPass = 4;
+
+const char *BLOCK_EXECUTED = "A.8c5303eaa26202d6.EVM.BlockExecuted";
+const char *FEES_DEDUCTED = "A.912d5440f7e3769e.FlowFees.FeesDeducted";
+const char *CONTROL_VALUE_CHANGED = "A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged";
+
+// base64 of a `ControlValueChanged` event's JSON-CDC; telemetry payloads are filler of a typical length
+const char *CONTROL_PAYLOAD =
+    "eyJ2YWx1ZSI6eyJpZCI6IkEuMGQzYzhkMDJiMDJjZWI0Yy5NaWNyb2NvbnRyb2xsZXJUZXN0LkNvbnRyb2xWYWx1ZUNoYW5nZWQiLCJmaWVsZHMiOlt7InZhbHVl"
+    "Ijp7InZhbHVlIjoiMTUiLCJ0eXBlIjoiSW50NjQifSwibmFtZSI6InZhbHVlIn0seyJ2YWx1ZSI6eyJ2YWx1ZSI6IjE2IiwidHlwZSI6IkludDY0In0sIm5hbWUi"
+    "OiJvbGRWYWx1ZSJ9LHsidmFsdWUiOnsidmFsdWUiOiIzOCIsInR5cGUiOiJVSW50NjQifSwibmFtZSI6ImV2ZW50U2VxdWVuY2UifV19LCJ0eXBlIjoiRXZlbnQifQ==";
+char telemetryPayload[257];
+
+unsigned long controlEventsApplied = 0;
+char logLine[160];
+
+void applyControlEvent(const char *encodedPayload) {
+  Base64DecodingStream decoded(encodedPayload);
+  JsonCadenceReader cadenceEvent(decoded);
+  JsonCadenceReader::IntegerField fields[] = {
+      {"value", true, false, 0, 0},
+      {"oldValue", true, false, 0, 0},
+      {"eventSequence", false, false, 0, 0},
+  };
+  if (cadenceEvent.readEvent(CONTROL_VALUE_CHANGED, fields, 3) == JsonCadenceReader::Result::Ok) ++controlEventsApplied;
+}
+
+constexpr EventType EVENT_TYPES[] = {
+    {"A.8c5303eaa26202d6.EVM.BlockExecuted", nullptr, EventPriority::Telemetry},
+    {"A.912d5440f7e3769e.FlowFees.FeesDeducted", nullptr, EventPriority::Telemetry},
+    {"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged", applyControlEvent},
+};
+constexpr EventRegistry EVENT_REGISTRY(EVENT_TYPES);
+
+char messageBuffer[4096];
+JsonDocument filter;
+unsigned long blocksSent = 0, eventsSent = 0, controlEventsSent = 0;
+
+// FUNCTION nextMessage: the `events` message of the next block, as text
+const char *nextMessage() {
+  const unsigned long blockHeight = 268154930 + blocksSent;
+  size_t length = snprintf(messageBuffer, sizeof(messageBuffer),
+                           "{\"subscription_id\":\"20charIDStreamEvents\",\"topic\":\"events\",\"payload\":{\"block_id\":\"%064lx\","
+                           "\"block_height\":\"%lu\",\"block_timestamp\":\"2025-06-01T12:00:00Z\",\"events\":[",
+                           blockHeight, blockHeight);
+  for (size_t i = 0; i <= feesPerBlock; ++i) {
+    length += snprintf(messageBuffer + length, sizeof(messageBuffer) - length, "%s{\"type\":\"%s\",\"payload\":\"%s\"}",
+                       i > 0 ? "," : "", i == 0 ? BLOCK_EXECUTED : FEES_DEDUCTED, telemetryPayload);
+  }
+  eventsSent += feesPerBlock + 1;
+  if (blocksSent % controlEveryBlocks == 0) {
+    length += snprintf(messageBuffer + length, sizeof(messageBuffer) - length, ",{\"type\":\"%s\",\"payload\":\"%s\"}",
+                       CONTROL_VALUE_CHANGED, CONTROL_PAYLOAD);
+    ++eventsSent;
+    ++controlEventsSent;
+  }
+  snprintf(messageBuffer + length, sizeof(messageBuffer) - length, "],\"message_index\":%lu}}", blocksSent);
+  ++blocksSent;
+  return messageBuffer;
+}
+
+void logEvent(const EventType *type, unsigned long blockHeight, unsigned count) {
+  snprintf(logLine, sizeof(logLine), "  • %s ×%u [block %lu]\n", type->id, count, blockHeight);
+}
+
+// FUNCTION readMessage:
+// deserializes the next message and hands each registered event to `accept`
+template <typename Accept>
+void readMessage(Accept accept) {
+  JsonDocument doc;
+  if (deserializeJson(doc, nextMessage(), DeserializationOption::Filter(filter))) return;
+  const unsigned long blockHeight = strtoul(doc["payload"]["block_height"] | "0", nullptr, 10);
+  for (JsonObject e : doc["payload"]["events"].as<JsonArray>()) {
+    const EventType *registered = EVENT_REGISTRY.find(e["type"] | "");
+    if (registered) accept(registered, blockHeight, (const char *)e["payload"]);
+  }
+}
+
+void report(const char *approach, unsigned long offered, unsigned long backlogBlocks) {
+  const unsigned long sustainedBlocks = offered / (feesPerBlock + 1) * sustainedBacklogMS / 1000;
+  Serial.printf("  %-6s offered %5lu events/s: ingested %5lu events/s, backlog %4lu blocks %s; control events %lu of %lu applied\n",
+                approach, offered, eventsSent * 1000 / measurementMS, backlogBlocks,
+                backlogBlocks <= sustainedBlocks + 1 ? "(sustained)" : "(falling behind)", controlEventsApplied, controlEventsSent);
+}
+
+// FUNCTION blocksDue: messages the node would have sent by now, at the offered rate
+unsigned long blocksDue(unsigned long startUS, unsigned long offered) {
+  return (unsigned long)((uint64_t)(micros() - startUS) * offered / (feesPerBlock + 1) / 1000000);
+}
+
+void runDirect(unsigned long offered) {
+  blocksSent = eventsSent = controlEventsSent = controlEventsApplied = 0;
+  const unsigned long startUS = micros();
+  while (micros() - startUS < measurementMS * 1000) {
+    if (blocksSent >= blocksDue(startUS, offered)) continue;
+    readMessage([](const EventType *type, unsigned long blockHeight, const char *payload) {
+      logEvent(type, blockHeight, 1);
+      if (type->handler) type->handler(payload);
+    });
+  }
+  report("direct", offered, blocksDue(startUS, offered) - blocksSent);
+}
+
+void runQueued(unsigned long offered) {
+  blocksSent = eventsSent = controlEventsSent = controlEventsApplied = 0;
+  IngestQueue queue(32, 768, 24);
+  unsigned long inlineControlEvents = 0;
+  auto process = [&](size_t budget) {
+    for (const IngestQueue::Item *item; budget > 0 && (item = queue.front()); --budget) {
+      if (item->type) {
+        logEvent(item->type, item->blockHeight, item->count);
+        if (item->type->handler) item->type->handler(item->payload);
+      }
+      queue.pop();
+    }
+  };
+
+  const unsigned long startUS = micros();
+  while (micros() - startUS < measurementMS * 1000) {
+    process(itemsPerPass);
+    if (queue.congested() || blocksSent >= blocksDue(startUS, offered)) continue;
+    unsigned long blockHeight = 0;
+    readMessage([&](const EventType *type, unsigned long height, const char *payload) {
+      blockHeight = height;
+      if (queue.pushEvent(type, height, payload) != IngestQueue::Outcome::Full) return;
+      process(queue.getCapacity());
+      ++inlineControlEvents;
+      type->handler(payload);
+    });
+    queue.pushBlockEnd(blockHeight, false);
+  }
+  const unsigned long backlogBlocks = blocksDue(startUS, offered) - blocksSent;
+  process(queue.getCapacity());
+  report("queued", offered, backlogBlocks);
+  Serial.printf("         queue peak %u of %u; %lu events coalesced; dropped %lu heartbeats, %lu telemetry events, %lu block ends; %lu control events processed right away\n",
+                queue.highWaterMark(), queue.getCapacity(), queue.coalesced(), queue.dropped(IngestQueue::Kind::Heartbeat),
+                queue.dropped(IngestQueue::Kind::Telemetry), queue.dropped(IngestQueue::Kind::BlockEnd), inlineControlEvents);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  memset(telemetryPayload, 'A', sizeof(telemetryPayload) - 1);
+  telemetryPayload[sizeof(telemetryPayload) - 1] = '\0';
+  filter["payload"]["block_height"] = true;
+  filter["payload"]["message_index"] = true;
+  filter["payload"]["events"][0]["type"] = true;
+  filter["payload"]["events"][0]["payload"] = true;
+
+  Serial.printf("%u telemetry events per block, a control event every %lu blocks; %lu s per rate\n",
+                (unsigned)feesPerBlock + 1, controlEveryBlocks, measurementMS / 1000);
+  for (unsigned long offered : offeredRates) {
+    runDirect(offered);
+    runQueued(offered);
+  }
+}
+
+void loop() {
+  // Nothing to do here
+}
@@ -0,0 +1,241 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Client.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "MessageArena.h"
+#include "RxRingBuffer.h"
+#include "WebSocketFrameParser.h"
+#include "WebSocketMessageStream.h"
+
+// -----------------------------------------------------------------------------
+// Deserializing `events` messages of busy blocks in place from the receive buffer, as the network task of Project
+// Hummingbird does, once without a filter and once with the controller's filter (`buildWebSocketMessageFilter()`).
+// The messages are synthetic: every block has an `EVM.BlockExecuted` event, with the hashes of the block's EVM
+// transactions, and a `FlowFees.FeesDeducted` event per transaction. The filter keeps the type and payload of every
+// event (the type is only known after parsing) and the union of the fields all topics read, so of these messages it
+// only drops `transaction_index` (`block_id` is read in the `block_digests` topic). The document is placed in a
+// `MessageArena`, so its size is the arena's high-water mark; the latency runs from the message being reported ready
+// until it is deserialized and released.
+//
+// ArduinoJson 7 sizes every document to its content, whatever the declared capacity: `StaticJsonDocument<N>` is a
+// deprecated alias of `JsonDocument` that ignores N. What the filter saves is hence what it measures here, not the
+// difference between two declared capacities.
+// -----------------------------------------------------------------------------
+const int transactionCounts[] = {0, 1, 4, 8}; // EVM transactions per block; 8 make about 7 KB
+const unsigned long messagesPerSize = 2000;
+const size_t segmentSize = 1436;       // TCP payload per segment
+const size_t rxBufferCapacity = 16384; // as `wsRxBufferCapacity` in `../../src/main.cpp`
+const size_t frameSize = 4096;         // larger messages arrive fragmented
+const size_t arenaCapacity = 32768;    // four times `wsMessageArenaCapacity`, so that unfiltered messages fit
+
+const char *blockExecutedType = "A.8c5303eaa26202d6.EVM.BlockExecuted";
+const char *feesDeductedType = "A.912d5440f7e3769e.FlowFees.FeesDeducted";
+
+// CLASS ReplayClient
+// a `Client` handing out `recording` over and over, as fast as it is read; a bulk read ends at the end of a segment
+class ReplayClient : public Client {
+  public:
+  explicit ReplayClient(const std::vector<uint8_t> &recording) : recording(recording), position(0) {}
+
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char *, uint16_t) override { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t *, size_t size) override { return size; }
+  int available() override { return segmentSize; } // the sender is always ahead
+  int read() override { return recording[position++ % recording.size()]; }
+  int read(uint8_t *buffer, size_t size) override {
+    size = std::min(size, segmentSize - position % segmentSize); // up to the end of the segment
+    for (size_t copied = 0; copied < size;) { // the recording wraps around
+      const size_t offset = (position + copied) % recording.size();
+      const size_t n = std::min(size - copied, recording.size() - offset);
+      memcpy(buffer + copied, recording.data() + offset, n);
+      copied += n;
+    }
+    position += size;
+    return size;
+  }
+  int peek() override { return recording[position % recording.size()]; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+
+  private:
+  const std::vector<uint8_t> &recording;
+  size_t position;
+};
+
+// FUNCTION base64: encodes a payload as the Access API does
+String base64(const String &text) {
+  static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  String encoded;
+  encoded.reserve((text.length() + 2) / 3 * 4);
+  for (size_t i = 0; i < text.length(); i += 3) {
+    uint32_t group = (uint8_t)text[i] << 16;
+    if (i + 1 < text.length()) group |= (uint8_t)text[i + 1] << 8;
+    if (i + 2 < text.length()) group |= (uint8_t)text[i + 2];
+    encoded += digits[group >> 18];
+    encoded += digits[(group >> 12) & 0x3F];
+    encoded += i + 1 < text.length() ? digits[(group >> 6) & 0x3F] : '=';
+    encoded += i + 2 < text.length() ? digits[group & 0x3F] : '=';
+  }
+  return encoded;
+}
+
+// FUNCTION hash: 32 bytes, hex-encoded, different for each `seed`
+String hash(unsigned long seed) {
+  char hex[65];
+  for (int i = 0; i < 64; ++i) {
+    seed = seed * 1103515245 + 12345;
+    hex[i] = "0123456789abcdef"[(seed >> 16) & 0xF];
+  }
+  hex[64] = '\0';
+  return String(hex);
+}
+
+String cadenceField(const char *name, const char *type, const String &value) {
+  return String("{\"name\":\"") + name + "\",\"value\":{\"type\":\"" + type + "\",\"value\":" + value + "}}";
+}
+
+String quoted(const String &text) {
+  return "\"" + text + "\"";
+}
+
+// FUNCTION event: an event of the `events` topic, with its JSON-Cadence payload encoded
+String event(const char *type, unsigned long blockHeight, int transactionIndex, const String &fields) {
+  const String cadence = String("{\"type\":\"Event\",\"value\":{\"id\":\"") + type + "\",\"fields\":[" + fields + "]}}";
+  return String("{\"type\":\"") + type + "\",\"transaction_id\":\"" + hash(blockHeight * 100 + transactionIndex) +
+         "\",\"transaction_index\":\"" + String(transactionIndex) + "\",\"event_index\":\"0\",\"payload\":\"" +
+         base64(cadence) + "\"}";
+}
+
+// FUNCTION eventsMessage: a block with `transactions` EVM transactions (0: only the block's `EVM.BlockExecuted`)
+String eventsMessage(unsigned long blockHeight, int transactions) {
+  String transactionHashes = "[";
+  for (int i = 0; i < transactions; ++i)
+    transactionHashes += String(i > 0 ? "," : "") + "{\"type\":\"String\",\"value\":\"" + hash(blockHeight * 1000 + i) + "\"}";
+  transactionHashes += "]";
+  const String blockExecuted =
+      cadenceField("height", "UInt64", quoted(String(blockHeight))) + "," +
+      cadenceField("hash", "String", quoted(hash(blockHeight))) + "," +
+      cadenceField("timestamp", "UInt64", quoted("1748779200")) + "," +
+      cadenceField("totalSupply", "Int", quoted("1234567890000000000000000")) + "," +
+      cadenceField("totalGasUsed", "UInt64", quoted(String(21000 * transactions))) + "," +
+      cadenceField("parentHash", "String", quoted(hash(blockHeight - 1))) + "," +
+      cadenceField("receiptRoot", "String", quoted(hash(blockHeight + 7))) + "," +
+      cadenceField("transactionHashes", "Array", transactionHashes);
+
+  String message = "{\"subscription_id\":\"20charIDStreamEvents\",\"topic\":\"events\",\"payload\":{\"block_id\":\"" +
+                   hash(blockHeight * 7) + "\",\"block_height\":\"" + String(blockHeight) +
+                   "\",\"block_timestamp\":\"2025-06-01T12:00:00.000000000Z\",\"events\":[" +
+                   event(blockExecutedType, blockHeight, 0, blockExecuted);
+  for (int i = 0; i < transactions; ++i) {
+    const String fees = cadenceField("amount", "UFix64", quoted("0.00000179")) + "," +
+                        cadenceField("inclusionEffort", "UFix64", quoted("1.00000000")) + "," +
+                        cadenceField("executionEffort", "UFix64", quoted("0.00000411"));
+    message += "," + event(feesDeductedType, blockHeight, i + 1, fees);
+  }
+  return message + "],\"message_index\":" + String(blockHeight % 100000) + "}}";
+}
+
+// FUNCTION record: `message` as server-to-client text frames of at most `frameSize` bytes
+std::vector<uint8_t> record(const String &message) {
+  std::vector<uint8_t> recording;
+  for (size_t offset = 0; offset < message.length(); offset += frameSize) {
+    const size_t length = std::min(frameSize, (size_t)message.length() - offset);
+    recording.push_back((offset + length == message.length() ? 0x80 : 0x00) | (offset == 0 ? 0x1 : 0x0));
+    if (length < 126) {
+      recording.push_back(length);
+    } else {
+      recording.push_back(126);
+      recording.push_back(length >> 8);
+      recording.push_back(length & 0xFF);
+    }
+    recording.insert(recording.end(), message.c_str() + offset, message.c_str() + offset + length);
+  }
+  return recording;
+}
+
+// FUNCTION buildFilter: as `buildWebSocketMessageFilter()` in `../../src/main.cpp`
+void buildFilter(JsonDocument &filter) {
+  filter["topic"] = true;
+  filter["subscription_id"] = true;
+  filter["action"] = true;
+  filter["error"] = true;
+  filter["payload"]["height"] = true;
+  filter["payload"]["block_id"] = true;
+  filter["payload"]["block_height"] = true;
+  filter["payload"]["block_timestamp"] = true;
+  filter["payload"]["message_index"] = true;
+  filter["payload"]["events"][0]["type"] = true;
+  filter["payload"]["events"][0]["payload"] = true;
+  filter["payload"]["events"][0]["transaction_id"] = true;
+  filter["payload"]["events"][0]["event_index"] = true;
+}
+
+JsonDocument filter;
+
+// FUNCTION measure
+void measure(bool filtered, int transactions) {
+  const String message = eventsMessage(268154930, transactions);
+  if (message.length() > rxBufferCapacity) {
+    Serial.printf("❌ %u B don't fit the receive buffer\n", message.length());
+    return;
+  }
+  const std::vector<uint8_t> recording = record(message);
+  ReplayClient client(recording);
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  WebSocketMessageStream stream(&parser);
+  MessageArena arena(arenaCapacity);
+  ArenaJsonAllocator allocator(&arena);
+
+  static unsigned long latencyUS[messagesPerSize];
+  unsigned long failed = 0, eventsRead = 0;
+  for (unsigned long i = 0; i < messagesPerSize;) {
+    if (parser.poll() != WebSocketFrameParser::Event::MessageReady) {
+      rx.fill(&client);
+      continue;
+    }
+    const unsigned long startUS = micros();
+    {
+      JsonDocument doc(&allocator);
+      const DeserializationError err = filtered ? deserializeJson(doc, stream, DeserializationOption::Filter(filter))
+                                                : deserializeJson(doc, stream);
+      parser.finishMessage();
+      if (err) ++failed;
+      eventsRead += doc["payload"]["events"].size();
+    }
+    arena.reset();
+    latencyUS[i++] = micros() - startUS;
+  }
+
+  std::sort(latencyUS, latencyUS + messagesPerSize);
+  Serial.printf("⏱️ %-9s %d+%d events, %5u B: %8.1f / %8.1f µs (median / slowest), document %5zu B; %lu events read, "
+                "%lu failed, %lu arena overflows\n",
+                filtered ? "filtered" : "unfiltered", 1, transactions, message.length(),
+                (double)latencyUS[messagesPerSize / 2], (double)latencyUS[messagesPerSize - 1], arena.highWaterMark(),
+                eventsRead, failed, arena.failures());
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  buildFilter(filter);
+  Serial.printf("📥 deserializing %lu messages per size, with and without the filter\n", messagesPerSize);
+  for (int transactions : transactionCounts) {
+    for (bool filtered : {false, true})
+      measure(filtered, transactions);
+  }
+  Serial.println(F("🏁 done"));
+}
+
+void loop() {
+  delay(1000);
+}
@@ -0,0 +1,117 @@
+"""Minimal stand-in for the REST API of a Flow Access Node, keeping connections alive until they idle.
+
+Serves the two requests of a state recovery, over plain HTTP and, given a certificate, over TLS as well:
+  GET  /v1/blocks?height=sealed   -> the latest sealed block (header only); the height grows by one per second
+  POST /v1/scripts?block_height=N -> the script result {"value":"42","type":"Int64"}
+Like the Access Node, it answers with HTTP/1.1 and keeps the connection open for further requests, until the
+connection has been idle for IDLE seconds; then it closes it, without telling the client.
+
+Usage: python3 mock_rest_node.py [port] [idle seconds] [tls port] [certificate] [key]    (defaults: 8071, 5)
+
+A certificate for the TLS port, valid for `localhost`:
+  openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 365 -subj /CN=localhost \
+      -addext subjectAltName=DNS:localhost -keyout key.pem -out cert.pem
+"""
+
+import json
+import ssl
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 8071
+IDLE = float(sys.argv[2]) if len(sys.argv) > 2 else 5.0
+TLS_PORT = int(sys.argv[3]) if len(sys.argv) > 3 else None
+CERTIFICATE = sys.argv[4] if len(sys.argv) > 4 else "cert.pem"
+KEY = sys.argv[5] if len(sys.argv) > 5 else "key.pem"
+SEALED_HEIGHT = 268154930
+STARTED = time.monotonic()
+
+connections = 0
+connections_lock = threading.Lock()
+
+
+class MockRestNode(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive, like the Access Node
+    timeout = IDLE  # a connection without a request for this long is closed
+    disable_nagle_algorithm = True  # as the Access Node; else a body written after its headers waits for the ACK
+
+    def setup(self):
+        global connections
+        super().setup()
+        with connections_lock:
+            connections += 1
+            self.connection_number = connections
+        self.requests = 0
+        print(f"🔌 connection {self.connection_number} from {self.client_address[0]} ({self.server.name})")
+
+    def finish(self):
+        super().finish()
+        print(f"   connection {self.connection_number} closed after {self.requests} requests")
+
+    def log_message(self, format, *args):
+        pass  # one line per connection is enough
+
+    def log_error(self, format, *args):
+        if format.startswith("Request timed out"):  # BaseHTTPRequestHandler closes the connection then
+            print(f"   connection {self.connection_number} idle for {IDLE:g} s, closing it")
+        else:
+            print(f"   connection {self.connection_number}: " + format % args)
+
+    def respond(self, body):
+        self.requests += 1
+        payload = json.dumps(body).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(payload)))
+        self.end_headers()
+        self.wfile.write(payload)
+
+    def do_GET(self):
+        if not self.path.startswith("/v1/blocks?height=sealed"):
+            self.send_error(404)
+            return
+        height = SEALED_HEIGHT + int(time.monotonic() - STARTED)
+        self.respond([{"header": {"id": "7a5c" * 16, "height": str(height)}, "block_status": "BLOCK_SEALED"}])
+
+    def do_POST(self):
+        self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        if not self.path.startswith("/v1/scripts"):
+            self.send_error(404)
+            return
+        self.respond("eyJ2YWx1ZSI6IjQyIiwidHlwZSI6IkludDY0In0K")
+
+
+class TlsMockRestNode(MockRestNode):
+    def setup(self):
+        # the handshake happens in the connection's thread, so a slow client doesn't hold up the others
+        self.request.settimeout(IDLE)
+        self.request.do_handshake()
+        super().setup()
+
+
+class MockServer(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def handle_error(self, request, client_address):
+        print(f"❌ connection from {client_address[0]} failed: {sys.exc_info()[1]}")
+
+
+def serve(port, context=None):
+    server = MockServer(("", port), TlsMockRestNode if context else MockRestNode)
+    server.name = "TLS" if context else "plain"
+    if context:
+        server.socket = context.wrap_socket(server.socket, server_side=True, do_handshake_on_connect=False)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+
+
+if __name__ == "__main__":
+    serve(PORT)
+    print(f"mock access node on port {PORT}, closing connections idle for {IDLE:g} s")
+    if TLS_PORT:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(CERTIFICATE, KEY)
+        serve(TLS_PORT, context)
+        print(f"... and over TLS on port {TLS_PORT}")
+    threading.Event().wait()
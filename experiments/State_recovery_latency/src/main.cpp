@@ -0,0 +1,114 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <algorithm>
+
+#include "OnChainState.h"
+#include "WiFiCredentials.h"
+
+// -----------------------------------------------------------------------------
+// NEEDS HUMAN CONFIGURATION: address of the computer running `mock_rest_node.py`, which closes connections idle for
+// `idleCloseMS` (`python3 mock_rest_node.py 8071 2 8443 cert.pem key.pem`). The TLS port's certificate is not
+// verified on the board; on the host, where the mock runs on the same computer, point OpenSSL at it:
+// `SSL_CERT_FILE=cert.pem .pio/build/native/program` (the script describes how to create one for `localhost`).
+// -----------------------------------------------------------------------------
+#if defined(ARDUINO_ARCH_ESP32)
+static const char *mock_rest_urls[] = {"http://192.168.1.10:8071/v1/", "https://192.168.1.10:8443/v1/"};
+#else
+static const char *mock_rest_urls[] = {"http://localhost:8071/v1/", "https://localhost:8443/v1/"};
+#endif
+const unsigned long idleCloseMS = 2000;
+const int recoveries = 8; // per transport and approach
+const unsigned long warmSpacingMS = 200;
+
+// A state recovery -- reading the latest sealed block, then executing the script at that block -- is timed four
+// ways, over plain HTTP and over TLS:
+//  • per request:     a new connection for each of the two requests, as OnChainState used to
+//  • per recovery:    a new OnChainState, so the two requests share one new connection
+//  • warm:            the same OnChainState throughout; the connection is still open from the previous recovery
+//  • after idle:      the same, but the mock has closed the idle connection in the meantime, so the first request
+//                     fails without a response and is retried on a new connection
+enum class Approach { PerRequest, PerRecovery, Warm, AfterIdle };
+const char *approachNames[] = {"per request", "per recovery", "warm", "after idle"};
+
+// FUNCTION recover:
+// one state recovery via `forBlock` and `forScript` (the same object, unless a connection per request is wanted);
+// returns how long it took, in microseconds, or 0 if it failed
+unsigned long recover(OnChainState &forBlock, OnChainState &forScript) {
+  const unsigned long startUS = micros();
+  const std::tuple<unsigned long, bool> block = forBlock.get_latest_sealed_block();
+  if (!std::get<1>(block)) return 0;
+  const std::tuple<int64_t, bool> state = forScript.get_led_state_at_block(std::get<0>(block));
+  if (!std::get<1>(state)) return 0;
+  return micros() - startUS;
+}
+
+// FUNCTION measure:
+// times `recoveries` recoveries of `approach` against `url` and prints the fastest, median and slowest
+void measure(const char *url, Approach approach) {
+  unsigned long latencyUS[recoveries];
+  int succeeded = 0;
+  unsigned long requests = 0, reusedRequests = 0;
+  OnChainState *kept = new OnChainState(url);
+  if (approach == Approach::Warm || approach == Approach::AfterIdle) recover(*kept, *kept); // opens the connection
+  const unsigned long keptRequestsBefore = kept->requests(), keptReusedBefore = kept->reusedRequests();
+
+  for (int i = 0; i < recoveries; ++i) {
+    delay(approach == Approach::AfterIdle ? idleCloseMS + 500 : warmSpacingMS);
+    unsigned long elapsedUS;
+    if (approach == Approach::PerRequest) {
+      OnChainState forBlock(url), forScript(url);
+      elapsedUS = recover(forBlock, forScript);
+      requests += forBlock.requests() + forScript.requests();
+      reusedRequests += forBlock.reusedRequests() + forScript.reusedRequests();
+    } else if (approach == Approach::PerRecovery) {
+      OnChainState state(url);
+      elapsedUS = recover(state, state);
+      requests += state.requests();
+      reusedRequests += state.reusedRequests();
+    } else {
+      elapsedUS = recover(*kept, *kept);
+    }
+    if (elapsedUS != 0) latencyUS[succeeded++] = elapsedUS;
+  }
+  if (approach == Approach::Warm || approach == Approach::AfterIdle) { // without the recovery opening the connection
+    requests = kept->requests() - keptRequestsBefore;
+    reusedRequests = kept->reusedRequests() - keptReusedBefore;
+  }
+  delete kept;
+
+  if (succeeded == 0) {
+    Serial.printf("❌ %-5s %-12s: all %d recoveries failed\n", strncmp(url, "https", 5) == 0 ? "TLS" : "plain",
+                  approachNames[static_cast<int>(approach)], recoveries);
+    return;
+  }
+  std::sort(latencyUS, latencyUS + succeeded);
+  Serial.printf("⏱️ %-5s %-12s: %d/%d recoveries, %7.1f / %7.1f / %7.1f ms (fastest / median / slowest); %lu of %lu "
+                "requests on a kept-alive connection\n",
+                strncmp(url, "https", 5) == 0 ? "TLS" : "plain", approachNames[static_cast<int>(approach)], succeeded,
+                recoveries, latencyUS[0] / 1000.0, latencyUS[succeeded / 2] / 1000.0, latencyUS[succeeded - 1] / 1000.0,
+                reusedRequests, requests);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(100);
+  }
+  Serial.printf("📡 connected to Wi‑Fi '%s'; mock access node at %s and %s\n", WiFi.SSID().c_str(), mock_rest_urls[0],
+                mock_rest_urls[1]);
+
+  for (const char *url : mock_rest_urls) {
+    for (Approach approach : {Approach::PerRequest, Approach::PerRecovery, Approach::Warm, Approach::AfterIdle})
+      measure(url, approach);
+  }
+  Serial.println(F("🏁 done"));
+}
+
+void loop() {
+  delay(1000);
+}
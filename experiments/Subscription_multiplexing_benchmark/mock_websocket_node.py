@@ -0,0 +1,335 @@
+"""Minimal stand-in for the WebSocket API of a Flow Access Node, streaming as fast as the client reads.
+
+Understands the two actions of the Access API's WebSocket protocol that the benchmark uses:
+  {"subscription_id": ..., "action": "subscribe", "topic": ..., "arguments": {...}} -> acknowledged
+  {"subscription_id": ..., "action": "unsubscribe"}                                 -> acknowledged
+While subscriptions are active, messages shaped like those of the `block_digests` topic are sent round robin
+over all of them, as fast as the client consumes them (TCP backpressure paces the stream).
+
+If the client offers `permessage-deflate` (RFC 7692), the mock accepts it with the client's `server_max_window_bits`
+and compresses every message it sends, keeping the compression context from one message to the next, as the Access
+Node's WebSocket library does by default. Bytes on the wire, message bytes and the time spent compressing are
+reported along with the message counts.
+
+Given a block interval, the mock runs a chain instead, which seals a block every BLOCK_INTERVAL seconds, and
+streams to Project Hummingbird itself (set its ACCESS_NODES to the computer running the mock):
+  • `block_digests` follows the sealed head; `events` carries a `ControlValueChanged` event every 7th block, and a
+    heartbeat after `heartbeat_interval` blocks without one
+  • `events` starts at `start_block_height`, if given, and replays the blocks since then as fast as the client
+    reads them; up to REPLAY_LIMIT blocks back, like an Access Node, older start heights are rejected
+  • every DROP seconds, the connection is dropped without a close frame, as by a flaky network
+For each reconnect, it reports how long the client took to be consistent again (from the drop until the replay of
+the resumed `events` subscription caught up with the sealed head), the control events it missed (never sent,
+as the subscription resumed after them) and the blocks it was sent twice (the replay overlapping what was sent
+before the drop). A client that subscribes from the latest block, after re-reading the on-chain state, doesn't
+miss events by doing so; the events it skipped are reported separately.
+
+Usage: python3 mock_websocket_node.py [port] [block interval s] [drop every s]     (defaults: 8075, 0, 0)
+       e.g. python3 mock_websocket_node.py 8075 0.8 45
+Standard library only; one client at a time.
+"""
+
+import base64
+import hashlib
+import itertools
+import json
+import socket
+import struct
+import sys
+import threading
+import time
+import zlib
+
+PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 8075
+BLOCK_INTERVAL = float(sys.argv[2]) if len(sys.argv) > 2 else 0.0  # 0: as fast as the client reads
+DROP = float(sys.argv[3]) if len(sys.argv) > 3 else 0.0  # 0: never
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+FIRST_HEIGHT = 268154930
+CONTROL_EVERY = 7  # blocks
+REPLAY_LIMIT = 300  # blocks
+CONTROL_EVENT = "A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged"
+STARTED = time.monotonic()
+
+
+def sealed_head():
+    if BLOCK_INTERVAL <= 0:
+        return float("inf")
+    return FIRST_HEIGHT + int((time.monotonic() - STARTED) / BLOCK_INTERVAL)
+
+
+def control_sequence(height):
+    """eventSequence of the block's ControlValueChanged event; 0 if it has none"""
+    offset = height - FIRST_HEIGHT
+    return offset // CONTROL_EVERY + 1 if offset > 0 and offset % CONTROL_EVERY == 0 else 0
+
+
+def control_event(height, sequence):
+    def integer(name, value, type):
+        return {"value": {"value": str(value), "type": type}, "name": name}
+
+    value = sequence % 2  # switches the load on and off
+    cadence = {"value": {"id": CONTROL_EVENT, "fields": [integer("value", value, "Int64"), integer("oldValue", 1 - value, "Int64"),
+                                                         integer("eventSequence", sequence, "UInt64")]}, "type": "Event"}
+    return {"type": CONTROL_EVENT, "transaction_id": f"{height:064x}", "transaction_index": "0", "event_index": "0",
+            "payload": base64.b64encode(json.dumps(cadence).encode()).decode()}
+
+
+class Reconnects:
+    """what the client was sent of the `events` topic, across connections"""
+
+    def __init__(self):
+        self.sent_through = 0  # the last block sent (events or heartbeat) on an `events` subscription
+        self.dropped_at = None  # time.monotonic() of the latest drop, until the client is consistent again
+        self.count = self.resumed = self.missed = self.skipped = self.replayed = 0
+        self.consistent_after = []
+
+    def subscribed(self, start):
+        if self.sent_through == 0:
+            return
+        self.count += 1
+        if start is None:  # from the latest block: the client re-read the state instead of resuming
+            skipped = [h for h in range(self.sent_through + 1, sealed_head() + 1) if control_sequence(h)]
+            self.skipped += len(skipped)
+            print(f"   reconnect {self.count}: not resumed, {len(skipped)} control events skipped (the client re-read the state)")
+            return
+        self.resumed += 1
+        missed = [control_sequence(h) for h in range(self.sent_through + 1, start) if control_sequence(h)]
+        replayed = max(0, self.sent_through - start + 1)
+        self.missed += len(missed)
+        self.replayed += replayed
+        print(f"   reconnect {self.count}: resumed from block {start}, {self.sent_through} was sent last: "
+              f"{len(missed)} control events missed{f' (eventSequence {missed})' if missed else ''}, {replayed} blocks sent again")
+
+    def caught_up(self):
+        if self.dropped_at is None:
+            return
+        self.consistent_after.append(time.monotonic() - self.dropped_at)
+        self.dropped_at = None
+        times = sorted(self.consistent_after)
+        print(f"✅ consistent again {self.consistent_after[-1]:.2f} s after the drop; "
+              f"over {len(times)} reconnects: median {times[len(times) // 2]:.2f} s, slowest {times[-1]:.2f} s; "
+              f"{self.resumed} resumed, {self.missed} control events missed, {self.skipped} skipped, "
+              f"{self.replayed} blocks sent again")
+
+
+reconnects = Reconnects()
+
+
+class Deflater:
+    """permessage-deflate of one connection: raw deflate with a 2^bits window, the context carried over between messages"""
+
+    def __init__(self, bits):
+        self.bits = bits
+        self.compressor = zlib.compressobj(wbits=-bits)
+        self.messages = self.message_bytes = self.wire_bytes = 0
+        self.seconds = 0.0
+
+    def compress(self, payload):
+        started = time.perf_counter()
+        compressed = self.compressor.compress(payload) + self.compressor.flush(zlib.Z_SYNC_FLUSH)
+        self.seconds += time.perf_counter() - started
+        assert compressed.endswith(b"\x00\x00\xff\xff")
+        compressed = compressed[:-4]  # RFC 7692: the receiver appends the empty block's tail again
+        self.messages += 1
+        self.message_bytes += len(payload)
+        self.wire_bytes += len(compressed)
+        return compressed
+
+    def report(self):
+        if not self.messages:
+            return ""
+        return (f"; deflate ({self.bits} bits): {self.wire_bytes} B on the wire for {self.message_bytes} B of messages "
+                f"({self.wire_bytes / self.message_bytes:.0%}), {self.seconds / self.messages * 1e6:.1f} µs per message to compress")
+
+
+def send_frame(conn, lock, text, deflater=None):
+    payload = text.encode()
+    first = 0x81  # FIN, text
+    with lock:  # compressed in the order sent, as each message may refer to the previous ones
+        if deflater is not None:
+            payload = deflater.compress(payload)
+            first |= 0x40  # RSV1: the message is compressed
+        if len(payload) < 126:
+            header = struct.pack("!BB", first, len(payload))
+        elif len(payload) < 65536:
+            header = struct.pack("!BBH", first, 126, len(payload))
+        else:
+            header = struct.pack("!BBQ", first, 127, len(payload))
+        conn.sendall(header + payload)
+
+
+def recv_exactly(conn, n):
+    data = b""
+    while len(data) < n:
+        chunk = conn.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("client closed the connection")
+        data += chunk
+    return data
+
+
+def recv_frame(conn):
+    first, second = recv_exactly(conn, 2)
+    opcode = first & 0x0F
+    length = second & 0x7F
+    if length == 126:
+        length = struct.unpack("!H", recv_exactly(conn, 2))[0]
+    elif length == 127:
+        length = struct.unpack("!Q", recv_exactly(conn, 8))[0]
+    mask = recv_exactly(conn, 4) if second & 0x80 else b"\0\0\0\0"
+    payload = bytes(b ^ mask[i % 4] for i, b in enumerate(recv_exactly(conn, length)))
+    return opcode, payload
+
+
+def handshake(conn):
+    """completes the handshake; returns the connection's Deflater if permessage-deflate was agreed on, else None"""
+    request = b""
+    while b"\r\n\r\n" not in request:
+        chunk = conn.recv(1024)
+        if not chunk:
+            raise ConnectionError("client closed the connection during the handshake")
+        request += chunk
+    key = ""
+    deflater = None
+    for line in request.decode(errors="replace").split("\r\n"):
+        name, _, value = line.partition(":")
+        if name.strip().lower() == "sec-websocket-key":
+            key = value.strip()
+        if name.strip().lower() == "sec-websocket-extensions" and deflater is None:
+            for offer in value.split(","):
+                parameters = [p.strip().lower() for p in offer.split(";")]
+                if parameters[0] != "permessage-deflate":
+                    continue
+                bits = 15
+                for parameter in parameters[1:]:
+                    if parameter.startswith("server_max_window_bits="):
+                        bits = int(parameter.split("=", 1)[1])
+                if 9 <= bits <= 15:  # zlib's raw deflate can't do a 256 B window
+                    deflater = Deflater(bits)
+    accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+    extension = f"Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits={deflater.bits}\r\n" if deflater else ""
+    conn.sendall(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  f"Sec-WebSocket-Accept: {accept}\r\n{extension}\r\n").encode())
+    return deflater
+
+
+def message(subscription, height):
+    """the subscription's message about block `height`; None if there is nothing to send about it"""
+    if subscription["topic"] != "events":
+        return {"subscription_id": subscription["id"], "topic": subscription["topic"],
+                "payload": {"block_id": f"{height:064x}", "height": str(height), "timestamp": "2025-06-01T12:00:00Z"}}
+    sequence = control_sequence(height)
+    if not sequence and height - subscription["last_message"] < subscription["heartbeat_interval"]:
+        return None
+    subscription["last_message"] = height
+    payload = {"block_id": f"{height:064x}", "block_height": str(height), "block_timestamp": "2025-06-01T12:00:00Z",
+               "events": [control_event(height, sequence)] if sequence else [], "message_index": next(subscription["index"])}
+    return {"subscription_id": subscription["id"], "topic": "events", "payload": payload}
+
+
+def stream(conn, lock, active, stop, deflater):
+    sent = 0
+    while not stop.is_set():
+        with lock:
+            subscriptions = list(active)
+        head = sealed_head()
+        progress = False
+        for subscription in subscriptions:
+            height = subscription["next"]
+            if height > head:
+                continue
+            subscription["next"] += 1
+            progress = True
+            outgoing = message(subscription, height)
+            if outgoing is None:
+                continue
+            try:
+                send_frame(conn, lock, json.dumps(outgoing), deflater)
+            except OSError:  # the client is gone; serve() reports it
+                return
+            sent += 1
+            if subscription["topic"] == "events" and BLOCK_INTERVAL > 0:
+                reconnects.sent_through = max(reconnects.sent_through, height)
+                if height == head:  # caught up with the sealed head
+                    reconnects.caught_up()
+            if sent % 10000 == 0:
+                print(f"   {sent} messages sent, {len(subscriptions)} subscription(s) active{deflater.report() if deflater else ''}")
+        if not progress:
+            time.sleep(0.01)
+
+
+def drop(conn, stop):
+    """drops the connection after DROP seconds, without a close frame"""
+    if DROP > 0 and not stop.wait(DROP):
+        print("💥 dropping the connection")
+        reconnects.dropped_at = time.monotonic()
+        try:
+            conn.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+
+
+def subscribe(request):
+    """the new subscription; None if its start height can't be served"""
+    arguments = request.get("arguments") or {}
+    head = sealed_head()
+    start = int(arguments["start_block_height"]) if "start_block_height" in arguments else None
+    if start is not None and head != float("inf") and start < head - REPLAY_LIMIT:
+        return None
+    if request.get("topic") == "events" and BLOCK_INTERVAL > 0:
+        reconnects.subscribed(start)
+    first = start if start is not None else (FIRST_HEIGHT if head == float("inf") else head)
+    return {"id": request.get("subscription_id"), "topic": request.get("topic"), "next": first, "last_message": first - 1,
+            "heartbeat_interval": int(arguments.get("heartbeat_interval", 10)), "index": itertools.count()}
+
+
+def serve(conn):
+    lock = threading.RLock()
+    active = []
+    stop = threading.Event()
+    deflater = handshake(conn)
+    if deflater:
+        print(f"permessage-deflate agreed on, {deflater.bits} window bits")
+    streamer = threading.Thread(target=stream, args=(conn, lock, active, stop, deflater), daemon=True)
+    streamer.start()
+    threading.Thread(target=drop, args=(conn, stop), daemon=True).start()
+    try:
+        while True:
+            opcode, payload = recv_frame(conn)
+            if opcode == 0x8:  # close
+                return
+            if opcode != 0x1:
+                continue
+            request = json.loads(payload)
+            subscription_id, action = request.get("subscription_id"), request.get("action")
+            with lock:
+                known = [s for s in active if s["id"] == subscription_id]
+                if action == "subscribe" and not known:
+                    subscription = subscribe(request)
+                    if subscription is None:
+                        error = {"code": 400, "message": f"start height is more than {REPLAY_LIMIT} blocks in the past"}
+                        send_frame(conn, lock, json.dumps({"subscription_id": subscription_id, "error": error}), deflater)
+                        print(f"{action} '{subscription_id}' rejected: {error['message']}")
+                        continue
+                    active.append(subscription)
+                elif action == "unsubscribe" and known:
+                    active.remove(known[0])
+                send_frame(conn, lock, json.dumps({"subscription_id": subscription_id, "action": action}), deflater)
+            print(f"{action} '{subscription_id}' ({request.get('topic', '')}); {len(active)} active")
+    except (ConnectionError, OSError) as error:
+        print(f"connection ended: {error}")
+    finally:
+        stop.set()
+        if deflater and deflater.messages:
+            print(f"   {deflater.messages} messages sent{deflater.report()}")
+        conn.close()
+
+
+if __name__ == "__main__":
+    server = socket.create_server(("", PORT))
+    print(f"mock websocket node on port {PORT}" + (f", sealing a block every {BLOCK_INTERVAL:g} s" if BLOCK_INTERVAL > 0 else "") +
+          (f", dropping connections after {DROP:g} s" if DROP > 0 else ""))
+    while True:
+        connection, address = server.accept()
+        print(f"client {address[0]} connected")
+        serve(connection)
@@ -0,0 +1,235 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+
+#include "MessageArena.h"
+#include "RxRingBuffer.h"
+#include "SubscriptionManager.h"
+#include "WebSocketFrameParser.h"
+#include "WebSocketFrameWriter.h"
+#include "WebSocketInflater.h"
+#include "WebSocketMessageStream.h"
+#include "WiFiCredentials.h"
+
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <malloc.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// NEEDS HUMAN CONFIGURATION: address of the computer running `mock_websocket_node.py`, which streams messages
+// round robin over all active subscriptions, as fast as we read them; on the host, it runs on the same computer
+// -----------------------------------------------------------------------------
+#if defined(ARDUINO_ARCH_ESP32)
+static const char *mock_host = "192.168.1.10";
+#else
+static const char *mock_host = "127.0.0.1";
+#endif
+const uint16_t mock_port = 8075;
+const unsigned long measurementMS = 10000; // per round
+const size_t rounds[] = {1, 16};           // concurrent subscriptions per round
+const int deflateWindowBits = 11;          // as `wsDeflateWindowBits` in `../../src/main.cpp`
+
+// The receive path is the one of Project Hummingbird: bulk reads into the ring buffer, a resumable frame parser,
+// messages deserialized straight from the buffer with a filter, all transient memory in the message arena. Each
+// round registers its subscriptions with a fresh SubscriptionManager, subscribes them all on the one connection,
+// measures for `measurementMS`, and unsubscribes them again. All rounds run twice, on a connection without and then
+// on one with permessage-deflate, where the mock compresses each message and the parser inflates it while it is
+// deserialized; bytes on the wire are compared to the bytes of the messages, as read by the JSON parser.
+WiFiClient client;
+RxRingBuffer *rxBuffer = nullptr;
+WebSocketFrameParser *parser = nullptr;
+WebSocketMessageStream *message = nullptr;
+WebSocketFrameWriter *writer = nullptr;
+WebSocketInflater *inflater = nullptr;
+JsonDocument filter;
+unsigned long lastHeight = 0;
+unsigned long wireBytes = 0; // received from the socket
+
+// CLASS CountingStream
+// the message stream, counting the bytes the JSON parser reads from it: the message text, inflated if compressed
+class CountingStream : public Stream {
+  public:
+  int available() override { return message->available(); }
+  int read() override {
+    const int c = message->read();
+    if (c >= 0) ++count;
+    return c;
+  }
+  int peek() override { return message->peek(); }
+  size_t readBytes(char *buffer, size_t length) override {
+    const size_t n = message->readBytes(buffer, length);
+    count += n;
+    return n;
+  }
+  size_t write(uint8_t) override { return 0; }
+
+  unsigned long count = 0;
+};
+CountingStream messageText;
+
+// FUNCTION heapInUseBytes: the heap taken, as the free heap's complement; the host's `ESP.getFreeHeap()` is 0
+uint32_t heapInUseBytes() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return ESP.getHeapSize() - ESP.getFreeHeap();
+#else
+  return mallinfo2().uordblks;
+#endif
+}
+
+bool sendText(const char *payload, size_t length) {
+  return writer->send(&client, WebSocketFrameWriter::OPCODE_TEXT, reinterpret_cast<const uint8_t *>(payload), length);
+}
+
+void buildDigestArguments(JsonObject arguments) {
+  arguments["block_status"] = "sealed";
+}
+
+void countDigest(JsonDocument &doc) {
+  lastHeight = strtoul(doc["payload"]["height"] | "0", nullptr, 10);
+}
+
+// FUNCTION connectWebSocket: offers permessage-deflate if `deflate`; true once connected as offered
+bool connectWebSocket(bool deflate) {
+  if (!client.connect(mock_host, mock_port)) return false;
+  client.print(String("GET /v1/ws HTTP/1.1\r\nHost: ") + mock_host + "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n" +
+               "Sec-WebSocket-Key: x3JJHMbDL1EzLkh9GBhXDw==\r\nSec-WebSocket-Version: 13\r\n" +
+               (deflate ? String("Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=") + deflateWindowBits + "\r\n" : String()) +
+               "\r\n");
+  client.setTimeout(5000);
+  const String status = client.readStringUntil('\n');
+  bool deflateNegotiated = false;
+  while (true) { // the remaining headers, up to the empty line
+    String line = client.readStringUntil('\n');
+    if (line.length() <= 1) break;
+    line.toLowerCase();
+    if (!line.startsWith("sec-websocket-extensions:") || line.indexOf("permessage-deflate") < 0) continue;
+    const int paramPos = line.indexOf("server_max_window_bits=");
+    const int windowBits = paramPos >= 0 ? line.substring(paramPos + strlen("server_max_window_bits=")).toInt() : WebSocketInflater::MAX_WINDOW_BITS;
+    deflateNegotiated = inflater->configure(windowBits, line.indexOf("server_no_context_takeover") >= 0);
+  }
+  rxBuffer->clear();
+  parser->reset();
+  parser->setInflater(deflateNegotiated ? inflater : nullptr);
+  return status.startsWith("HTTP/1.1 101") && deflateNegotiated == deflate;
+}
+
+// processes all complete messages that have arrived; returns the time spent in deserializing and routing them
+unsigned long processMessages(SubscriptionManager &subscriptions, MessageArena &arena, ArenaJsonAllocator &allocator,
+                              unsigned long &worstUS) {
+  unsigned long spentUS = 0;
+  wireBytes += rxBuffer->fill(&client);
+  while (true) {
+    const WebSocketFrameParser::Event event = parser->poll();
+    if (event == WebSocketFrameParser::Event::None) return spentUS;
+    if (event != WebSocketFrameParser::Event::MessageReady) continue; // the mock sends no control frames
+    const unsigned long startUS = micros();
+    {
+      JsonDocument doc(&allocator);
+      const DeserializationError err = deserializeJson(doc, messageText, DeserializationOption::Filter(filter));
+      parser->finishMessage();
+      if (!err) subscriptions.dispatch(doc);
+    }
+    arena.reset();
+    const unsigned long messageUS = micros() - startUS;
+    spentUS += messageUS;
+    if (messageUS > worstUS) worstUS = messageUS;
+    wireBytes += rxBuffer->fill(&client);
+  }
+}
+
+void runRound(size_t subscriptionCount) {
+  MessageArena *arena = new MessageArena(8192);
+  ArenaJsonAllocator *allocator = new ArenaJsonAllocator(arena);
+  const uint32_t heapBeforeBytes = heapInUseBytes();
+  SubscriptionManager *subscriptions = new SubscriptionManager(arena, allocator, sendText);
+  for (size_t i = 0; i < subscriptionCount; ++i) {
+    char id[SubscriptionManager::MAX_ID_LENGTH + 1];
+    snprintf(id, sizeof(id), "benchDigests%02u", (unsigned)i);
+    subscriptions->add(id, "block_digests", buildDigestArguments, countDigest);
+  }
+  subscriptions->subscribeAll();
+
+  unsigned long worstUS = 0;
+  unsigned long startMS = millis();
+  while (subscriptions->active() < subscriptionCount && millis() - startMS < 5000) {
+    processMessages(*subscriptions, *arena, *allocator, worstUS);
+  }
+  const uint32_t heapSubscribedBytes = heapInUseBytes();
+
+  worstUS = 0;
+  unsigned long spentUS = 0;
+  const unsigned long routedBefore = subscriptions->routed();
+  const unsigned long wireBytesBefore = wireBytes, messageBytesBefore = messageText.count;
+  startMS = millis();
+  while (millis() - startMS < measurementMS) {
+    spentUS += processMessages(*subscriptions, *arena, *allocator, worstUS);
+  }
+  const unsigned long routed = subscriptions->routed() - routedBefore;
+  const unsigned long roundWireBytes = wireBytes - wireBytesBefore, roundMessageBytes = messageText.count - messageBytesBefore;
+
+  unsigned long fewest = ULONG_MAX, most = 0;
+  for (size_t i = 0; i < subscriptionCount; ++i) {
+    fewest = min(fewest, subscriptions->messages(i));
+    most = max(most, subscriptions->messages(i));
+    subscriptions->unsubscribe(i);
+  }
+  startMS = millis();
+  while (subscriptions->active() > 0 && millis() - startMS < 5000) {
+    processMessages(*subscriptions, *arena, *allocator, worstUS);
+  }
+
+  Serial.printf("%2u subscription(s): %lu messages/s routed, %.1f µs per message (worst %lu µs); per subscription %lu to %lu messages\n",
+                (unsigned)subscriptionCount, routed * 1000 / measurementMS, routed ? (float)spentUS / routed : 0.0f, worstUS, fewest, most);
+  Serial.printf("    memory: %u B for the manager (static, any number up to %u subscriptions), heap %u B more in use once subscribed (manager incl.), arena peak %u B; %lu messages unrouted, last height %lu\n",
+                (unsigned)sizeof(SubscriptionManager), (unsigned)SubscriptionManager::MAX_SUBSCRIPTIONS,
+                heapSubscribedBytes - heapBeforeBytes, arena->highWaterMark(), subscriptions->unrouted(), lastHeight);
+  Serial.printf("    wire: %lu B received for %lu B of messages (%.0f%%), %.1f B per message on the wire\n", roundWireBytes, roundMessageBytes,
+                roundMessageBytes ? 100.0 * roundWireBytes / roundMessageBytes : 0.0, routed ? (float)roundWireBytes / routed : 0.0f);
+  delete subscriptions;
+  delete allocator;
+  delete arena;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(100);
+  } // Wait for Serial Monitor to open
+
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(100);
+  }
+  Serial.printf("📡 connected to Wi‑Fi '%s'; mock websocket node at %s:%u\n", WiFi.SSID().c_str(), mock_host, mock_port);
+
+  rxBuffer = new RxRingBuffer(16384);
+  parser = new WebSocketFrameParser(rxBuffer);
+  message = new WebSocketMessageStream(parser);
+  writer = new WebSocketFrameWriter(1024);
+  inflater = new WebSocketInflater();
+  filter["subscription_id"] = true;
+  filter["action"] = true;
+  filter["error"] = true;
+  filter["payload"]["height"] = true;
+  filter["payload"]["block_id"] = true;
+  for (bool deflate : {false, true}) {
+    if (!connectWebSocket(deflate)) {
+      Serial.printf("❌ WebSocket connection to the mock node failed%s\n", deflate ? " (or permessage-deflate was declined)" : "");
+      return;
+    }
+    Serial.printf("🗜️ permessage-deflate %s\n", deflate ? "on" : "off");
+    for (size_t subscriptionCount : rounds) {
+      runRound(subscriptionCount);
+    }
+    if (deflate) {
+      Serial.printf("    inflating: %lu B in, %lu B out, %lu µs in total\n", inflater->compressedBytes(), inflater->inflatedBytes(),
+                    inflater->inflateMicros());
+    }
+    client.stop();
+    delay(500); // the mock serves one client at a time; let it notice
+  }
+}
+
+void loop() {
+  // Nothing to do here
+}
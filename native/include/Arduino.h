@@ -0,0 +1,87 @@
+#pragma once
+
+// Arduino core shim for the `native` environment (Linux). It provides the part of the Arduino-ESP32 core's API
+// that Project Hummingbird uses, so the sources in `src/` compile and run unchanged on the host. Time is measured
+// by the host's monotonic clock, GPIO levels are only recorded, and `Serial` writes to stdout.
+// See `native/README.md`.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "HardwareSerial.h"
+#include "Print.h"
+#include "Printable.h"
+#include "Stream.h"
+#include "WString.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+// GPIO numbers as on the Arduino Nano ESP32
+static const uint8_t LED_RED = 46;
+static const uint8_t LED_GREEN = 45;
+static const uint8_t LED_BLUE = 0;
+static const uint8_t D6 = 9;
+
+/* ── time ──────────────────────────────────────────────────────────────────────────────────────── */
+unsigned long millis(); // since the start of the process
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Host only, for tests: once started, the simulated clock replaces the process clock. millis() and micros() then
+// advance only by `advanceSimulatedClock` and by delay(), which returns right away.
+void startSimulatedClock(unsigned long startMS = 0);
+void advanceSimulatedClock(unsigned long ms);
+
+/* ── GPIO ──────────────────────────────────────────────────────────────────────────────────────── */
+// There is no hardware to drive: the levels written are recorded, and read back by `digitalRead`.
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+/* ── random numbers ────────────────────────────────────────────────────────────────────────────── */
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+/* ── chip ──────────────────────────────────────────────────────────────────────────────────────── */
+class EspClass {
+  public:
+  // The host has no fixed heap to report on; both are 0.
+  uint32_t getFreeHeap();
+  uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+// glibc provides strlcpy only since version 2.38
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
+#endif
+
+// implemented by the sketch
+void setup();
+void loop();
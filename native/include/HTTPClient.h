@@ -0,0 +1,92 @@
+#pragma once
+#include <Arduino.h>
+
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_MOVED_PERMANENTLY = 301,
+  HTTP_CODE_FOUND = 302,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+  HTTP_CODE_SERVICE_UNAVAILABLE = 503,
+} t_http_codes;
+
+class HTTPClient {
+
+  // HTTP/1.1 client with the ESP32 core's HTTPClient API, for `http://` and `https://` URLs. As there, the
+  // request methods return once the response headers are read (the status code, or a negative HTTPC_ERROR_*),
+  // and the body is left on the connection, see `getStream()`. With `setReuse(true)`, the connection is kept
+  // open by `end()` unless the server asked to close it, and the next request to the same host reuses it.
+
+  public:
+  HTTPClient();
+  ~HTTPClient();
+
+  bool begin(String url); // false if the URL is malformed
+  void end();
+  bool connected();
+
+  void setReuse(bool reuse);
+  void setConnectTimeout(int32_t connectTimeout);
+  void setTimeout(uint16_t timeout);
+
+  void addHeader(const String &name, const String &value);
+  void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+  String header(const char *name); // value of a collected header, empty if absent
+  bool hasHeader(const char *name);
+
+  int GET();
+  int POST(uint8_t *payload, size_t size);
+  int POST(const String &payload);
+  int sendRequest(const char *type, uint8_t *payload = nullptr, size_t size = 0);
+
+  int getSize();                 // Content-Length of the response, -1 if unknown
+  WiFiClient &getStream();       // the connection, positioned at the response body
+  String getString();            // reads the body (of known length, or up to the end of the connection)
+  static String errorToString(int error);
+
+  private:
+  struct CollectedHeader {
+    String key;
+    String value;
+  };
+
+  bool connect();
+  int handleHeaderResponse();
+  void disconnect();
+
+  // behavioral parameters
+  bool reuse;
+  int32_t connectTimeoutMS;
+  uint16_t timeoutMS;
+
+  // dynamic state parameters
+  WiFiClient *client; // plain or secure, as the URL's scheme asks for
+  bool secure;
+  String host;
+  uint16_t port;
+  String uri;
+  String requestHeaders;
+  CollectedHeader *collectedHeaders;
+  size_t collectedHeaderCount;
+  int returnCode;
+  int size;
+  bool canReuse;
+};
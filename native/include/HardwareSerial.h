@@ -0,0 +1,24 @@
+#pragma once
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+
+  // The serial port, written to stdout. Nothing is ever received.
+
+  public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  void setDebugOutput(bool) {}
+
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  void flush() override;
+
+  operator bool() const { return true; } // the "Serial Monitor" is always there
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+#include "WString.h"
+
+// IPv4 address
+class IPAddress {
+  public:
+  IPAddress() : IPAddress(0, 0, 0, 0) {}
+  IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) : octets{first, second, third, fourth} {}
+
+  uint8_t operator[](int index) const { return octets[index]; }
+  String toString() const;
+
+  private:
+  uint8_t octets[4];
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+
+class Preferences {
+
+  // Key-value storage in namespaces, with the API of the ESP32's NVS-backed Preferences. On the host, the values
+  // are kept in memory; they survive `end()` and re-opening the namespace, but not the process. The memory is
+  // laid out as NVS lays out flash, to tell what writes cost: a partition of 4 KB pages, each holding 126 entries of
+  // 32 bytes, written as a log. See `SimulatedNvsStatistics` below.
+
+  public:
+  bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+  size_t putBytes(const char *key, const void *value, size_t length);
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *buffer, size_t maxLength);
+
+  private:
+  String keyPath(const char *key) const;
+
+  String openedNamespace;
+  bool opened = false;
+  bool readOnly = false;
+};
+
+// Host only, for tests: the simulated NVS partition, 5 pages of 126 entries as the default 20 KB partition. Each
+// write appends entries to the active page -- a blob takes an index entry, a data header and one entry per 32 bytes of
+// data -- and marks the entries of the value it replaces as erased; a namespace takes an entry when first opened for
+// writing. When the active page is full, the next empty page becomes active; one page is always kept empty, so once
+// only that one is left, the full page with the most erased entries is reclaimed: its live entries are copied to the
+// empty page, and it is erased.
+struct SimulatedNvsStatistics {
+  unsigned long entriesWritten;    // including those copied while reclaiming pages
+  unsigned long pageErases;
+  unsigned long mostErasesOfAPage;
+};
+SimulatedNvsStatistics simulatedNvsStatistics();
+void eraseSimulatedNvs(); // all namespaces and the statistics, as a freshly erased partition
+
+// Host only, for tests: power is lost while the next `putBytes` writes its entries, after `entriesWritten` of
+// them. As NVS would find on the next boot, entries of an incomplete value are erased and the previous value stays;
+// if all of them were written, the new value replaces the previous one. The write returns 0.
+void tearNextSimulatedNvsWrite(size_t entriesWritten);
@@ -0,0 +1,11 @@
+#pragma once
+#include <stddef.h>
+
+class Print;
+
+// interface of objects that know how to print themselves, e.g. via `Serial.print(object)`
+class Printable {
+  public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "Print.h"
+
+class Stream : public Print {
+
+  // Base of everything that bytes can be read from. Subclasses implement `available`, `read` and `peek`, which
+  // never block; the timed reads below wait up to `getTimeout()` ms for a byte to arrive.
+
+  public:
+  Stream() : _timeout(1000), _startMillis(0) {}
+
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() const { return _timeout; }
+
+  // true once `target` was read, false on timeout; consumes the stream up to the end of `target`
+  bool find(const char *target) { return findUntil(target, strlen(target), nullptr, 0); }
+  bool find(const char *target, size_t length) { return findUntil(target, length, nullptr, 0); }
+  bool find(char target) { return find(&target, 1); }
+  bool findUntil(const char *target, const char *terminator) { return findUntil(target, strlen(target), terminator, strlen(terminator)); }
+  bool findUntil(const char *target, size_t targetLength, const char *terminator, size_t terminatorLength);
+
+  virtual size_t readBytes(char *buffer, size_t length); // stops early on timeout
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes(reinterpret_cast<char *>(buffer), length); }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+  String readString();
+  String readStringUntil(char terminator);
+
+  protected:
+  int timedRead(); // -1 on timeout
+  int timedPeek();
+
+  unsigned long _timeout;
+  unsigned long _startMillis;
+};
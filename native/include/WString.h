@@ -0,0 +1,139 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+// On the ESP32, string literals wrapped in F() stay in flash. The host has no such distinction; the type only
+// selects the matching overloads.
+class __FlashStringHelper;
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
+#define F(string_literal) (FPSTR(string_literal))
+
+class String {
+
+  // Arduino's dynamic string, held in a std::string. Numbers are formatted like the Arduino core does.
+
+  public:
+  String() {}
+  String(const char *cstr) : buffer(cstr ? cstr : "") {}
+  String(const char *cstr, unsigned int length) : buffer(cstr ? cstr : "", cstr ? length : 0) {}
+  String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+  String(const String &str) = default;
+  String(String &&str) = default;
+  explicit String(char c) : buffer(1, c) {}
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+
+  String &operator=(const String &rhs) = default;
+  String &operator=(String &&rhs) = default;
+  String &operator=(const char *cstr);
+  String &operator=(const __FlashStringHelper *str) { return *this = reinterpret_cast<const char *>(str); }
+
+  bool reserve(unsigned int size);
+  unsigned int length() const { return buffer.size(); }
+  bool isEmpty() const { return buffer.empty(); }
+  void clear() { buffer.clear(); }
+
+  bool concat(const String &str);
+  bool concat(const char *cstr);
+  bool concat(const char *cstr, unsigned int length);
+  bool concat(const __FlashStringHelper *str) { return concat(reinterpret_cast<const char *>(str)); }
+  bool concat(char c);
+  bool concat(unsigned char value) { return concat(String(value)); }
+  bool concat(int value) { return concat(String(value)); }
+  bool concat(unsigned int value) { return concat(String(value)); }
+  bool concat(long value) { return concat(String(value)); }
+  bool concat(unsigned long value) { return concat(String(value)); }
+  bool concat(long long value) { return concat(String(value)); }
+  bool concat(unsigned long long value) { return concat(String(value)); }
+  bool concat(float value) { return concat(String(value)); }
+  bool concat(double value) { return concat(String(value)); }
+
+  template <typename T>
+  String &operator+=(const T &rhs) {
+    concat(rhs);
+    return *this;
+  }
+
+  int compareTo(const String &s) const { return buffer.compare(s.buffer); }
+  bool equals(const String &s) const { return buffer == s.buffer; }
+  bool equals(const char *cstr) const { return buffer == (cstr ? cstr : ""); }
+  bool equalsIgnoreCase(const String &s) const;
+  bool operator==(const String &rhs) const { return equals(rhs); }
+  bool operator==(const char *cstr) const { return equals(cstr); }
+  bool operator!=(const String &rhs) const { return !equals(rhs); }
+  bool operator!=(const char *cstr) const { return !equals(cstr); }
+  bool operator<(const String &rhs) const { return compareTo(rhs) < 0; }
+  bool startsWith(const String &prefix) const { return buffer.compare(0, prefix.length(), prefix.buffer) == 0; }
+  bool endsWith(const String &suffix) const;
+
+  char charAt(unsigned int index) const { return index < buffer.size() ? buffer[index] : 0; }
+  void setCharAt(unsigned int index, char c) {
+    if (index < buffer.size()) buffer[index] = c;
+  }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char &operator[](unsigned int index) { return buffer[index]; }
+  const char *c_str() const { return buffer.c_str(); }
+  char *begin() { return &buffer[0]; }
+  char *end() { return &buffer[0] + buffer.size(); }
+  void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+
+  // -1 if not found
+  int indexOf(char c, unsigned int fromIndex = 0) const;
+  int indexOf(const String &str, unsigned int fromIndex = 0) const;
+  int lastIndexOf(char c) const;
+  int lastIndexOf(const String &str) const;
+  String substring(unsigned int beginIndex) const;
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replace);
+  void replace(const String &find, const String &replace);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+  private:
+  std::string buffer;
+};
+
+// the type of intermediate results of `+`; ArduinoJson recognises it as a String
+class StringSumHelper : public String {
+  public:
+  using String::String;
+  StringSumHelper(const String &s) : String(s) {}
+};
+
+template <typename T>
+StringSumHelper operator+(const String &lhs, const T &rhs) {
+  StringSumHelper result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+inline StringSumHelper operator+(const char *lhs, const String &rhs) {
+  StringSumHelper result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+inline bool operator==(const char *lhs, const String &rhs) {
+  return rhs.equals(lhs);
+}
+
+inline bool operator!=(const char *lhs, const String &rhs) {
+  return !rhs.equals(lhs);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+class WiFiClass {
+
+  // The host's network is used as it is. Joining a Wi-Fi succeeds right away; the credentials are ignored.
+
+  public:
+  wl_status_t begin(const char *ssid, const char *passphrase = nullptr);
+  bool disconnect(bool wifiOff = false);
+  wl_status_t status();
+  String SSID() const;
+  IPAddress localIP() const; // the first IPv4 address of a network interface other than loopback
+
+  private:
+  wl_status_t currentStatus = WL_IDLE_STATUS;
+  String joinedSsid;
+};
+
+extern WiFiClass WiFi;
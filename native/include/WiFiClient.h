@@ -0,0 +1,56 @@
+#pragma once
+#include "Client.h"
+
+class WiFiClient : public Client {
+
+  // A TCP connection over a POSIX socket. Like the ESP32's WiFiClient, reads never block (`read` returns -1 if
+  // no byte is available) and single-byte reads are served from a receive buffer of one TCP segment's size, so
+  // parsers pulling a byte at a time don't cost a system call each. Writes block for up to `getTimeout()` ms.
+  //
+  // Subclasses add a protocol on top of the socket (see WiFiClientSecure) by overriding the transport hooks.
+
+  public:
+  WiFiClient();
+  ~WiFiClient() override;
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char *host, uint16_t port) override;
+  virtual int connect(const char *host, uint16_t port, int32_t timeoutMS); // 1 if connected, 0 otherwise
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size) override;
+  int peek() override;
+  void flush() override; // sends are not buffered; nothing to do
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override;
+
+  protected:
+  // transport hooks; all of them return without waiting
+  virtual bool openSession(const char *host, unsigned long deadlineMS); // after the TCP connection is established
+  virtual void closeSession();
+  virtual int pendingBytes();                            // bytes that can be received right away
+  virtual int receive(uint8_t *buffer, size_t size);     // bytes received, 0 if none, -1 if closed
+  virtual int send(const uint8_t *buffer, size_t size);  // bytes sent, 0 if it would block, -1 on error
+  bool waitForSocket(short events, unsigned long deadlineMS); // false on timeout
+
+  static const unsigned long DEFAULT_CONNECT_TIMEOUT_MS;
+  static const size_t RX_BUFFER_SIZE;
+
+  int socketFd; // -1: not connected
+
+  private:
+  bool fillRxBuffer();
+
+  // dynamic state parameters
+  uint8_t *rxBuffer;
+  size_t rxPos;
+  size_t rxLength;
+  bool peerClosed;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include "WiFiClient.h"
+
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_st SSL;
+
+class WiFiClientSecure : public WiFiClient {
+
+  // A TLS connection, via OpenSSL. The server's certificate is verified against the host's trusted CAs,
+  // unless `setInsecure()` was called.
+
+  public:
+  WiFiClientSecure();
+  ~WiFiClientSecure() override;
+
+  void setInsecure();
+
+  protected:
+  bool openSession(const char *host, unsigned long deadlineMS) override;
+  void closeSession() override;
+  int pendingBytes() override;
+  int receive(uint8_t *buffer, size_t size) override;
+  int send(const uint8_t *buffer, size_t size) override;
+
+  private:
+  bool insecure;
+  SSL_CTX *context;
+  SSL *session;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zlib.h>
+
+// The ESP32's ROM provides miniz' inflater, tinfl. On the host, its API is implemented on top of zlib's
+// inflate. Unlike tinfl, zlib keeps its own history window, so the output buffer merely receives the output;
+// the window wrapping that WebSocketInflater relies on works the same.
+
+typedef unsigned char mz_uint8;
+typedef uint32_t mz_uint32;
+
+enum {
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32 = 8,
+};
+
+typedef enum {
+  TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct {
+  mz_uint32 m_state;      // 0: (re)start the stream on the next call
+  mz_uint32 m_zlibHeader; // the stream was started with a zlib header
+  mz_uint32 m_magic;      // TINFL_ZSTREAM_MAGIC once `m_stream` was initialised; the struct may come from malloc()
+  z_stream m_stream;
+} tinfl_decompressor;
+
+#define TINFL_ZSTREAM_MAGIC 0x7A6C6962u
+
+#define tinfl_init(r)   \
+  do {                  \
+    (r)->m_state = 0;   \
+  } while (0)
+
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start,
+                              mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags);
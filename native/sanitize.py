@@ -0,0 +1,10 @@
+# Adds sanitizers to the `native_sanitize` and `native_tsan` environments: AddressSanitizer and
+# UndefinedBehaviorSanitizer unless `custom_sanitizers` names others (ThreadSanitizer can't be combined with
+# AddressSanitizer). The flags have to reach the linker as well, which `build_flags` doesn't do for them.
+Import("env")
+
+sanitizers = env.GetProjectOption("custom_sanitizers", "address,undefined")
+SANITIZERS = ["-fsanitize=" + sanitizers]
+if "undefined" in sanitizers:
+    SANITIZERS.append("-fno-sanitize-recover=undefined")
+env.Append(CCFLAGS=SANITIZERS, LINKFLAGS=SANITIZERS)
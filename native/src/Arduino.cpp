@@ -0,0 +1,144 @@
+#include <Arduino.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+// Core functions of the Arduino shim, and the program's entry point.
+
+static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+static std::atomic<bool> simulatedClock(false);
+static std::atomic<unsigned long> simulatedUS(0);
+
+unsigned long millis() {
+  if (simulatedClock.load(std::memory_order_relaxed)) return simulatedUS.load(std::memory_order_relaxed) / 1000;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - processStart).count();
+}
+
+unsigned long micros() {
+  if (simulatedClock.load(std::memory_order_relaxed)) return simulatedUS.load(std::memory_order_relaxed);
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - processStart).count();
+}
+
+void delay(unsigned long ms) {
+  if (simulatedClock.load(std::memory_order_relaxed)) return advanceSimulatedClock(ms);
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (simulatedClock.load(std::memory_order_relaxed)) {
+    simulatedUS.fetch_add(us, std::memory_order_relaxed);
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void startSimulatedClock(unsigned long startMS) {
+  simulatedUS.store(startMS * 1000, std::memory_order_relaxed);
+  simulatedClock.store(true, std::memory_order_relaxed);
+}
+
+void advanceSimulatedClock(unsigned long ms) {
+  simulatedUS.fetch_add(ms * 1000, std::memory_order_relaxed);
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+/* ── GPIO ──────────────────────────────────────────────────────────────────────────────────────── */
+static uint8_t pinLevels[256];
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  pinLevels[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return pinLevels[pin];
+}
+
+/* ── random numbers ────────────────────────────────────────────────────────────────────────────── */
+// Not synchronised: as on the device, only the network task draws random numbers.
+static std::mt19937 generator{std::random_device{}()};
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return std::uniform_int_distribution<long>(0, howbig - 1)(generator);
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) generator.seed(seed);
+}
+
+/* ── chip ──────────────────────────────────────────────────────────────────────────────────────── */
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap() {
+  return 0;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return 0;
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size) {
+  const size_t length = strlen(src);
+  if (size > 0) {
+    const size_t copied = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, copied);
+    dst[copied] = '\0';
+  }
+  return length;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size) {
+  const size_t existing = strnlen(dst, size);
+  if (existing == size) return size + strlen(src);
+  return existing + strlcpy(dst + existing, src, size - existing);
+}
+#endif
+
+/* ── Serial ────────────────────────────────────────────────────────────────────────────────────── */
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+#ifndef PIO_UNIT_TESTING // tests under `test/` bring their own main()
+// FUNCTION main:
+// runs `setup()` once and `loop()` forever, as the Arduino core does. With an argument, the program exits after
+// that many seconds, so profilers and sanitizers get to write their reports.
+int main(int argc, char **argv) {
+  setvbuf(stdout, nullptr, _IOLBF, 0); // log lines appear as they are written, also when piped
+  signal(SIGPIPE, SIG_IGN);            // a connection closed by the peer is reported by write() instead
+  const unsigned long runForMS = argc > 1 ? strtoul(argv[1], nullptr, 10) * 1000 : 0;
+
+  setup();
+  while (runForMS == 0 || millis() < runForMS) {
+    loop();
+  }
+  fflush(stdout);
+  _exit(0); // the pinned tasks are still running: skip the static destructors of objects they use
+}
+#endif
@@ -0,0 +1,257 @@
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+
+// CLASS HTTPClient
+
+// HTTP/1.1 requests over a WiFiClient, with the ESP32 core's HTTPClient API and behaviour.
+
+HTTPClient::HTTPClient()
+    : reuse(true), connectTimeoutMS(HTTPCLIENT_DEFAULT_TCP_TIMEOUT), timeoutMS(HTTPCLIENT_DEFAULT_TCP_TIMEOUT), client(nullptr),
+      secure(false), port(0), collectedHeaders(nullptr), collectedHeaderCount(0), returnCode(0), size(-1), canReuse(false) {
+}
+
+HTTPClient::~HTTPClient() {
+  delete client;
+  delete[] collectedHeaders;
+}
+
+// FUNCTION begin:
+// parses `url` into scheme, host, port and path. A kept-alive connection to a different host is closed.
+bool HTTPClient::begin(String url) {
+  returnCode = 0;
+  size = -1;
+  requestHeaders = "";
+
+  const int schemeEnd = url.indexOf("://");
+  if (schemeEnd < 0) return false;
+  const String scheme = url.substring(0, schemeEnd);
+  if (scheme != "http" && scheme != "https") {
+    Serial.printf("❌ HTTPClient: unsupported scheme '%s'\n", scheme.c_str());
+    return false;
+  }
+  const bool useSsl = scheme == "https";
+  String rest = url.substring(schemeEnd + 3);
+  const int pathStart = rest.indexOf('/');
+  String authority = pathStart >= 0 ? rest.substring(0, pathStart) : rest;
+  const String path = pathStart >= 0 ? rest.substring(pathStart) : String("/");
+  const int at = authority.indexOf('@'); // credentials are not supported; skip them
+  if (at >= 0) authority = authority.substring(at + 1);
+  const int colon = authority.indexOf(':');
+  const String newHost = colon >= 0 ? authority.substring(0, colon) : authority;
+  const uint16_t newPort = colon >= 0 ? authority.substring(colon + 1).toInt() : (useSsl ? 443 : 80);
+
+  if (client && (useSsl != secure || newHost != host || newPort != port)) {
+    delete client;
+    client = nullptr;
+  }
+  secure = useSsl;
+  host = newHost;
+  port = newPort;
+  uri = path;
+  return true;
+}
+
+void HTTPClient::end() {
+  disconnect();
+}
+
+bool HTTPClient::connected() {
+  return client && (client->available() > 0 || client->connected());
+}
+
+void HTTPClient::setReuse(bool reuse) {
+  this->reuse = reuse;
+}
+
+void HTTPClient::setConnectTimeout(int32_t connectTimeout) {
+  connectTimeoutMS = connectTimeout;
+}
+
+void HTTPClient::setTimeout(uint16_t timeout) {
+  timeoutMS = timeout;
+  if (client) client->setTimeout(timeout);
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+  requestHeaders += name + ": " + value + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+  delete[] collectedHeaders;
+  collectedHeaders = new CollectedHeader[headerKeysCount];
+  collectedHeaderCount = headerKeysCount;
+  for (size_t i = 0; i < headerKeysCount; ++i) {
+    collectedHeaders[i].key = headerKeys[i];
+  }
+}
+
+String HTTPClient::header(const char *name) {
+  for (size_t i = 0; i < collectedHeaderCount; ++i) {
+    if (collectedHeaders[i].key.equalsIgnoreCase(name)) return collectedHeaders[i].value;
+  }
+  return String();
+}
+
+bool HTTPClient::hasHeader(const char *name) {
+  return header(name).length() > 0;
+}
+
+int HTTPClient::GET() {
+  return sendRequest("GET");
+}
+
+int HTTPClient::POST(uint8_t *payload, size_t size) {
+  return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::POST(const String &payload) {
+  return POST(reinterpret_cast<uint8_t *>(const_cast<char *>(payload.c_str())), payload.length());
+}
+
+// FUNCTION sendRequest:
+// sends the request line, the headers and the payload, and reads the response headers
+int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
+  if (!connect()) return returnCode = HTTPC_ERROR_CONNECTION_REFUSED;
+
+  String request = String(type) + " " + uri + " HTTP/1.1\r\nHost: " + host;
+  if (port != (secure ? 443 : 80)) request += String(":") + String((unsigned)port);
+  request += "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: ";
+  request += reuse ? "keep-alive" : "close";
+  request += "\r\nAccept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+  if (payload || strcmp(type, "POST") == 0) request += String("Content-Length: ") + String((unsigned long)size) + "\r\n";
+  request += requestHeaders + "\r\n";
+
+  if (client->write(reinterpret_cast<const uint8_t *>(request.c_str()), request.length()) != request.length()) {
+    disconnect();
+    return returnCode = HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  if (payload && size > 0 && client->write(payload, size) != size) {
+    disconnect();
+    return returnCode = HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+  return returnCode = handleHeaderResponse();
+}
+
+int HTTPClient::getSize() {
+  return size;
+}
+
+WiFiClient &HTTPClient::getStream() {
+  if (!client) client = secure ? new WiFiClientSecure() : new WiFiClient();
+  return *client;
+}
+
+String HTTPClient::getString() {
+  if (!client || returnCode <= 0) return String();
+  String body;
+  if (size > 0) body.reserve(size);
+  client->setTimeout(timeoutMS);
+  for (long remaining = size; remaining != 0 && (connected() || client->available() > 0);) {
+    char buffer[512];
+    const size_t wanted = remaining > 0 && remaining < (long)sizeof(buffer) ? remaining : sizeof(buffer);
+    const size_t n = client->readBytes(buffer, wanted);
+    if (n == 0) break;
+    body.concat(buffer, n);
+    if (remaining > 0) remaining -= n;
+  }
+  return body;
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return F("connection refused");
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return F("send header failed");
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return F("send payload failed");
+    case HTTPC_ERROR_NOT_CONNECTED: return F("not connected");
+    case HTTPC_ERROR_CONNECTION_LOST: return F("connection lost");
+    case HTTPC_ERROR_NO_STREAM: return F("no stream");
+    case HTTPC_ERROR_NO_HTTP_SERVER: return F("no HTTP server");
+    case HTTPC_ERROR_TOO_LESS_RAM: return F("too less ram");
+    case HTTPC_ERROR_ENCODING: return F("Transfer-Encoding not supported");
+    case HTTPC_ERROR_STREAM_WRITE: return F("Stream write error");
+    case HTTPC_ERROR_READ_TIMEOUT: return F("read Timeout");
+    default: return String();
+  }
+}
+
+// FUNCTION connect:
+// reuses the kept-alive connection if it is still open (discarding any leftovers of the previous response),
+// otherwise connects anew
+bool HTTPClient::connect() {
+  if (connected()) {
+    while (client->available() > 0) client->read();
+    return true;
+  }
+  WiFiClient &connection = getStream();
+  connection.setTimeout(timeoutMS);
+  return connection.connect(host.c_str(), port, connectTimeoutMS);
+}
+
+// FUNCTION handleHeaderResponse:
+// reads the status line and the headers, up to the empty line before the body. Like the ESP32's HTTPClient,
+// it polls the connection while waiting for the response.
+int HTTPClient::handleHeaderResponse() {
+  for (size_t i = 0; i < collectedHeaderCount; ++i) {
+    collectedHeaders[i].value = "";
+  }
+  size = -1;
+  canReuse = reuse;
+  int code = 0;
+  bool http10 = false;
+  unsigned long lastDataMS = millis();
+  while (connected()) {
+    if (client->available() <= 0) {
+      if (millis() - lastDataMS > timeoutMS) return HTTPC_ERROR_READ_TIMEOUT;
+      delay(1);
+      continue;
+    }
+    String line = client->readStringUntil('\n');
+    line.trim();
+    lastDataMS = millis();
+
+    if (code == 0) { // status line, e.g. "HTTP/1.1 200 OK"
+      if (!line.startsWith("HTTP/1.")) return HTTPC_ERROR_NO_HTTP_SERVER;
+      http10 = line.startsWith("HTTP/1.0");
+      code = line.substring(line.indexOf(' ') + 1).toInt();
+      if (http10) canReuse = false;
+      continue;
+    }
+    if (line.isEmpty()) {
+      if (code == 100) { // "Continue": the actual response follows
+        code = 0;
+        continue;
+      }
+      return code > 0 ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+    }
+
+    const int colon = line.indexOf(':');
+    if (colon < 0) continue;
+    String name = line.substring(0, colon);
+    String value = line.substring(colon + 1);
+    value.trim();
+    if (name.equalsIgnoreCase("Content-Length")) size = value.toInt();
+    if (name.equalsIgnoreCase("Connection")) {
+      value.toLowerCase();
+      if (value.indexOf("close") >= 0) canReuse = false;
+      if (http10 && value.indexOf("keep-alive") >= 0) canReuse = reuse;
+    }
+    for (size_t i = 0; i < collectedHeaderCount; ++i) {
+      if (collectedHeaders[i].key.equalsIgnoreCase(name)) collectedHeaders[i].value = value;
+    }
+  }
+  return code > 0 ? HTTPC_ERROR_CONNECTION_LOST : HTTPC_ERROR_NOT_CONNECTED;
+}
+
+// FUNCTION disconnect:
+// keeps the connection open for the next request if reuse was asked for and the server agreed; discards what
+// is left of the response in the receive buffer
+void HTTPClient::disconnect() {
+  if (!client) return;
+  if (connected()) {
+    while (client->available() > 0) client->read();
+    if (reuse && canReuse) return;
+    client->stop();
+  }
+  delete client;
+  client = nullptr;
+}
@@ -0,0 +1,221 @@
+#include <Preferences.h>
+
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// CLASS Preferences
+
+// In-memory stand-in for the NVS: one map for all namespaces, keyed by "namespace/key", and the pages of a
+// simulated partition, which only track where each value's entries are and how many of a page's entries are erased.
+
+/* ── simulated partition ───────────────────────────────────────────────────────────────────────── */
+static const size_t PAGES = 5;
+static const size_t ENTRIES_PER_PAGE = 126; // 4 KB, less the page header and the entry state bitmap
+static const size_t ENTRY_SIZE = 32;
+
+struct Page {
+  bool empty = true;
+  size_t written = 0; // entries appended since the page was last erased
+  size_t erased = 0;  // of those, the ones belonging to no live value any more
+  unsigned long sequence = 0; // when the page was last made active; NVS reclaims the oldest of equal candidates
+  unsigned long erases = 0;
+};
+
+struct Item {
+  size_t page;
+  size_t entries;
+};
+
+static std::map<std::string, std::vector<uint8_t>> storage;
+static std::map<std::string, Item> items;      // where the entries of each value are, keyed as `storage`
+static std::map<std::string, Item> namespaces; // namespaces opened for writing; each has an entry of its own
+static Page pages[PAGES];
+static size_t activePage = PAGES; // none until the first write
+static unsigned long pageSequence = 0;
+static SimulatedNvsStatistics statistics = {0, 0, 0};
+static size_t tornWriteEntries = SIZE_MAX; // SIZE_MAX: the next write completes
+static std::mutex storageMutex;
+
+static size_t blobEntries(size_t length) { // index, data header, data
+  return 2 + (length + ENTRY_SIZE - 1) / ENTRY_SIZE;
+}
+
+static void erasePage(size_t page) {
+  pages[page] = Page{true, 0, 0, 0, pages[page].erases + 1};
+  ++statistics.pageErases;
+  if (pages[page].erases > statistics.mostErasesOfAPage) statistics.mostErasesOfAPage = pages[page].erases;
+}
+
+// FUNCTION activateNextPage: makes an empty page active, reclaiming a full one if only the spare one is left
+static bool activateNextPage() {
+  size_t emptyPages = 0, next = PAGES;
+  for (size_t i = 1; i <= PAGES; ++i) { // round robin, starting after the active page
+    const size_t page = (activePage + i) % PAGES;
+    if (!pages[page].empty) continue;
+    ++emptyPages;
+    if (next == PAGES) next = page;
+  }
+  if (next == PAGES) return false;
+
+  size_t victim = PAGES;
+  if (emptyPages == 1) { // the spare page; reclaim the full page with the most erased entries into it
+    for (size_t page = 0; page < PAGES; ++page) {
+      if (pages[page].empty) continue;
+      if (victim == PAGES || pages[page].erased > pages[victim].erased ||
+          (pages[page].erased == pages[victim].erased && pages[page].sequence < pages[victim].sequence))
+        victim = page;
+    }
+    if (victim == PAGES || pages[victim].erased == 0) return false; // the partition is full
+  }
+  activePage = next;
+  pages[next].empty = false;
+  pages[next].sequence = ++pageSequence;
+  if (victim == PAGES) return true;
+
+  for (std::map<std::string, Item> *map : {&items, &namespaces}) {
+    for (auto &entry : *map) {
+      Item &item = entry.second;
+      if (item.page != victim) continue;
+      item.page = next;
+      pages[next].written += item.entries;
+      statistics.entriesWritten += item.entries;
+    }
+  }
+  erasePage(victim);
+  return true;
+}
+
+// FUNCTION appendEntries: the page the `count` entries were appended to, or PAGES if there is no room
+static size_t appendEntries(size_t count) {
+  if (count > ENTRIES_PER_PAGE) return PAGES;
+  while (activePage == PAGES || pages[activePage].written + count > ENTRIES_PER_PAGE) {
+    if (!activateNextPage()) return PAGES;
+  }
+  pages[activePage].written += count;
+  statistics.entriesWritten += count;
+  return activePage;
+}
+
+static void eraseEntries(const Item &item) {
+  pages[item.page].erased += item.entries;
+}
+
+SimulatedNvsStatistics simulatedNvsStatistics() {
+  std::lock_guard<std::mutex> lock(storageMutex);
+  return statistics;
+}
+
+void eraseSimulatedNvs() {
+  std::lock_guard<std::mutex> lock(storageMutex);
+  storage.clear();
+  items.clear();
+  namespaces.clear();
+  for (Page &page : pages)
+    page = Page();
+  activePage = PAGES;
+  pageSequence = 0;
+  statistics = {0, 0, 0};
+  tornWriteEntries = SIZE_MAX;
+}
+
+void tearNextSimulatedNvsWrite(size_t entriesWritten) {
+  std::lock_guard<std::mutex> lock(storageMutex);
+  tornWriteEntries = entriesWritten;
+}
+
+/* ── Preferences ───────────────────────────────────────────────────────────────────────────────── */
+bool Preferences::begin(const char *name, bool readOnly, const char *) {
+  if (!name || !*name) return false;
+  openedNamespace = name;
+  this->readOnly = readOnly;
+  if (!readOnly) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    if (namespaces.count(name) == 0) {
+      const size_t page = appendEntries(1);
+      if (page == PAGES) return false;
+      namespaces[name] = Item{page, 1};
+    }
+  }
+  opened = true;
+  return true;
+}
+
+void Preferences::end() {
+  opened = false;
+}
+
+bool Preferences::clear() {
+  if (!opened || readOnly) return false;
+  std::lock_guard<std::mutex> lock(storageMutex);
+  const std::string prefix = keyPath("").c_str();
+  for (auto entry = storage.lower_bound(prefix); entry != storage.end() && entry->first.compare(0, prefix.size(), prefix) == 0;) {
+    eraseEntries(items[entry->first]);
+    items.erase(entry->first);
+    entry = storage.erase(entry);
+  }
+  return true;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!opened || readOnly) return false;
+  std::lock_guard<std::mutex> lock(storageMutex);
+  const std::string path = keyPath(key).c_str();
+  if (storage.erase(path) == 0) return false;
+  eraseEntries(items[path]);
+  items.erase(path);
+  return true;
+}
+
+bool Preferences::isKey(const char *key) {
+  if (!opened) return false;
+  std::lock_guard<std::mutex> lock(storageMutex);
+  return storage.count(keyPath(key).c_str()) > 0;
+}
+
+// FUNCTION putBytes: the new entries are appended before those of the previous value are erased, as NVS does
+size_t Preferences::putBytes(const char *key, const void *value, size_t length) {
+  if (!opened || readOnly || !key || !value) return 0;
+  std::lock_guard<std::mutex> lock(storageMutex);
+  const std::string path = keyPath(key).c_str();
+  const size_t entries = blobEntries(length);
+  const size_t entriesBeforePowerLoss = tornWriteEntries;
+  tornWriteEntries = SIZE_MAX;
+  if (entriesBeforePowerLoss < entries) { // the incomplete value's entries are erased on the next boot
+    const size_t page = appendEntries(entriesBeforePowerLoss);
+    if (page != PAGES) pages[page].erased += entriesBeforePowerLoss;
+    return 0;
+  }
+
+  const size_t page = appendEntries(entries);
+  if (page == PAGES) return 0;
+  const auto previous = items.find(path);
+  if (previous != items.end()) eraseEntries(previous->second);
+  const uint8_t *bytes = static_cast<const uint8_t *>(value);
+  storage[path].assign(bytes, bytes + length);
+  items[path] = Item{page, entries};
+  return entriesBeforePowerLoss == SIZE_MAX ? length : 0;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  if (!opened || !key) return 0;
+  std::lock_guard<std::mutex> lock(storageMutex);
+  const auto entry = storage.find(keyPath(key).c_str());
+  return entry != storage.end() ? entry->second.size() : 0;
+}
+
+// FUNCTION getBytes: 0 (and nothing copied) if the value is larger than `maxLength`, as on the ESP32
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength) {
+  if (!opened || !key || !buffer) return 0;
+  std::lock_guard<std::mutex> lock(storageMutex);
+  const auto entry = storage.find(keyPath(key).c_str());
+  if (entry == storage.end() || entry->second.size() > maxLength) return 0;
+  memcpy(buffer, entry->second.data(), entry->second.size());
+  return entry->second.size();
+}
+
+String Preferences::keyPath(const char *key) const {
+  return openedNamespace + "/" + key;
+}
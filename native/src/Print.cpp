@@ -0,0 +1,180 @@
+#include <Arduino.h>
+
+// CLASS Print
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (!write(*buffer++)) break;
+    ++n;
+  }
+  return n;
+}
+
+size_t Print::printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  const size_t n = vprintf(format, args);
+  va_end(args);
+  return n;
+}
+
+size_t Print::printf(const __FlashStringHelper *format, ...) {
+  va_list args;
+  va_start(args, format);
+  const size_t n = vprintf(reinterpret_cast<const char *>(format), args);
+  va_end(args);
+  return n;
+}
+
+// FUNCTION vprintf:
+// formats into a buffer on the stack, or on the heap if the text doesn't fit, and writes it in one go
+size_t Print::vprintf(const char *format, va_list args) {
+  char stackBuffer[128];
+  va_list copy;
+  va_copy(copy, args);
+  const int length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, copy);
+  va_end(copy);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(stackBuffer)) return write(reinterpret_cast<const uint8_t *>(stackBuffer), length);
+
+  char *heapBuffer = static_cast<char *>(malloc(length + 1));
+  if (!heapBuffer) return 0;
+  vsnprintf(heapBuffer, length + 1, format, args);
+  const size_t n = write(reinterpret_cast<const uint8_t *>(heapBuffer), length);
+  free(heapBuffer);
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper *s) {
+  return write(reinterpret_cast<const char *>(s));
+}
+
+size_t Print::print(const String &s) {
+  return write(s.c_str(), s.length());
+}
+
+size_t Print::print(const char s[]) {
+  return write(s);
+}
+
+size_t Print::print(char c) {
+  return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return print(static_cast<unsigned long long>(n), base);
+}
+
+size_t Print::print(int n, int base) {
+  return print(static_cast<long long>(n), base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print(static_cast<unsigned long long>(n), base);
+}
+
+size_t Print::print(long n, int base) {
+  return print(static_cast<long long>(n), base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return print(static_cast<unsigned long long>(n), base);
+}
+
+size_t Print::print(long long n, int base) {
+  if (base == 0) return write(static_cast<uint8_t>(n));
+  if (base == DEC && n < 0) return print('-') + printNumber(0ull - static_cast<unsigned long long>(n), DEC);
+  return printNumber(static_cast<unsigned long long>(n), base);
+}
+
+size_t Print::print(unsigned long long n, int base) {
+  if (base == 0) return write(static_cast<uint8_t>(n));
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  return printFloat(n, digits);
+}
+
+size_t Print::print(const Printable &x) {
+  return x.printTo(*this);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper *s) {
+  return print(s) + println();
+}
+
+size_t Print::println(const String &s) {
+  return print(s) + println();
+}
+
+size_t Print::println(const char s[]) {
+  return print(s) + println();
+}
+
+size_t Print::println(char c) {
+  return print(c) + println();
+}
+
+size_t Print::println(unsigned char n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(long long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits) {
+  return print(n, digits) + println();
+}
+
+size_t Print::println(const Printable &x) {
+  return print(x) + println();
+}
+
+size_t Print::printNumber(unsigned long long n, uint8_t base) {
+  char buffer[8 * sizeof(n) + 1];
+  char *str = &buffer[sizeof(buffer) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    const char digit = n % base;
+    n /= base;
+    *--str = digit < 10 ? digit + '0' : digit + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+size_t Print::printFloat(double number, uint8_t digits) {
+  if (isnan(number)) return print("nan");
+  if (isinf(number)) return print("inf");
+  char buffer[64];
+  const int length = snprintf(buffer, sizeof(buffer), "%.*f", digits, number);
+  if (length < 0 || (size_t)length >= sizeof(buffer)) return print("ovf");
+  return write(buffer, length);
+}
@@ -0,0 +1,74 @@
+#include <Arduino.h>
+
+// CLASS Stream
+
+int Stream::timedRead() {
+  _startMillis = millis();
+  do {
+    const int c = read();
+    if (c >= 0) return c;
+    yield();
+  } while (millis() - _startMillis < _timeout);
+  return -1;
+}
+
+int Stream::timedPeek() {
+  _startMillis = millis();
+  do {
+    const int c = peek();
+    if (c >= 0) return c;
+    yield();
+  } while (millis() - _startMillis < _timeout);
+  return -1;
+}
+
+// FUNCTION findUntil:
+// reads until `target` was matched (true), or `terminator` was matched or the stream timed out (false)
+bool Stream::findUntil(const char *target, size_t targetLength, const char *terminator, size_t terminatorLength) {
+  if (targetLength == 0) return true;
+  size_t targetMatched = 0, terminatorMatched = 0;
+  for (int c = timedRead(); c >= 0; c = timedRead()) {
+    targetMatched = c == target[targetMatched] ? targetMatched + 1 : (c == target[0] ? 1 : 0);
+    if (targetMatched == targetLength) return true;
+    if (terminatorLength == 0) continue;
+    terminatorMatched = c == terminator[terminatorMatched] ? terminatorMatched + 1 : (c == terminator[0] ? 1 : 0);
+    if (terminatorMatched == terminatorLength) return false;
+  }
+  return false;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    const int c = timedRead();
+    if (c < 0) break;
+    buffer[count++] = static_cast<char>(c);
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    const int c = timedRead();
+    if (c < 0 || c == terminator) break;
+    buffer[count++] = static_cast<char>(c);
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String result;
+  for (int c = timedRead(); c >= 0; c = timedRead()) {
+    result += static_cast<char>(c);
+  }
+  return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String result;
+  for (int c = timedRead(); c >= 0 && c != terminator; c = timedRead()) {
+    result += static_cast<char>(c);
+  }
+  return result;
+}
@@ -0,0 +1,194 @@
+#include <Arduino.h>
+#include <ctype.h>
+
+// CLASS String
+
+// FUNCTION formatInteger: `value` in `base` (2 to 36), as the Arduino core's itoa family formats it
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char buffer[8 * sizeof(value) + 2];
+  char *str = &buffer[sizeof(buffer) - 1];
+  *str = '\0';
+  do {
+    const char digit = value % base;
+    value /= base;
+    *--str = digit < 10 ? digit + '0' : digit + 'a' - 10;
+  } while (value);
+  if (negative) *--str = '-';
+  return str;
+}
+
+// FUNCTION formatSigned: negative numbers carry a sign in base 10 only; other bases show the two's complement
+template <typename T>
+static std::string formatSigned(T value, unsigned char base) {
+  typedef typename std::make_unsigned<T>::type Unsigned;
+  if (base == 10 && value < 0) return formatInteger(0ull - static_cast<unsigned long long>(value), true, base);
+  return formatInteger(static_cast<Unsigned>(value), false, base);
+}
+
+String::String(unsigned char value, unsigned char base) : buffer(formatInteger(value, false, base)) {
+}
+
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {
+}
+
+String::String(unsigned int value, unsigned char base) : buffer(formatInteger(value, false, base)) {
+}
+
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(formatInteger(value, false, base)) {
+}
+
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {
+}
+
+String::String(unsigned long long value, unsigned char base) : buffer(formatInteger(value, false, base)) {
+}
+
+String::String(float value, unsigned int decimalPlaces) : String(static_cast<double>(value), decimalPlaces) {
+}
+
+String::String(double value, unsigned int decimalPlaces) {
+  char formatted[64];
+  snprintf(formatted, sizeof(formatted), "%.*f", decimalPlaces, value);
+  buffer = formatted;
+}
+
+String &String::operator=(const char *cstr) {
+  buffer = cstr ? cstr : "";
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  buffer.reserve(size);
+  return true;
+}
+
+bool String::concat(const String &str) {
+  buffer += str.buffer;
+  return true;
+}
+
+bool String::concat(const char *cstr) {
+  if (!cstr) return false;
+  buffer += cstr;
+  return true;
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+  if (!cstr) return false;
+  buffer.append(cstr, length);
+  return true;
+}
+
+bool String::concat(char c) {
+  buffer += c;
+  return true;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  if (length() != s.length()) return false;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)s.buffer[i])) return false;
+  }
+  return true;
+}
+
+bool String::endsWith(const String &suffix) const {
+  return buffer.size() >= suffix.length() && buffer.compare(buffer.size() - suffix.length(), suffix.length(), suffix.buffer) == 0;
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const {
+  if (bufsize == 0 || !buf) return;
+  if (index >= buffer.size()) {
+    buf[0] = '\0';
+    return;
+  }
+  const size_t n = std::min<size_t>(bufsize - 1, buffer.size() - index);
+  memcpy(buf, buffer.data() + index, n);
+  buf[n] = '\0';
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const {
+  const size_t position = buffer.find(c, fromIndex);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const {
+  const size_t position = buffer.find(str.buffer, fromIndex);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c) const {
+  const size_t position = buffer.rfind(c);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(const String &str) const {
+  const size_t position = buffer.rfind(str.buffer);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, buffer.size());
+}
+
+// FUNCTION substring: as in Arduino, the indices are swapped if given in reverse, and clipped to the length
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+  if (beginIndex >= buffer.size()) return String();
+  if (endIndex > buffer.size()) endIndex = buffer.size();
+  return String(buffer.data() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replace) {
+  std::replace(buffer.begin(), buffer.end(), find, replace);
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (find.isEmpty()) return;
+  for (size_t position = buffer.find(find.buffer); position != std::string::npos;
+       position = buffer.find(find.buffer, position + replace.length())) {
+    buffer.replace(position, find.length(), replace.buffer);
+  }
+}
+
+void String::remove(unsigned int index) {
+  if (index < buffer.size()) buffer.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < buffer.size()) buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (char &c : buffer) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char &c : buffer) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+  const size_t first = buffer.find_first_not_of(" \t\r\n\f\v");
+  if (first == std::string::npos) {
+    buffer.clear();
+    return;
+  }
+  buffer.erase(buffer.find_last_not_of(" \t\r\n\f\v") + 1);
+  buffer.erase(0, first);
+}
+
+long String::toInt() const {
+  return atol(buffer.c_str());
+}
+
+float String::toFloat() const {
+  return static_cast<float>(toDouble());
+}
+
+double String::toDouble() const {
+  return atof(buffer.c_str());
+}
@@ -0,0 +1,240 @@
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// CLASS WiFiClient
+
+// TCP connection over a non-blocking POSIX socket.
+
+const unsigned long WiFiClient::DEFAULT_CONNECT_TIMEOUT_MS = 3000; // as on the ESP32
+const size_t WiFiClient::RX_BUFFER_SIZE = 1436;                    // one TCP segment, as on the ESP32
+
+WiFiClient::WiFiClient() : socketFd(-1), rxBuffer(new uint8_t[RX_BUFFER_SIZE]), rxPos(0), rxLength(0), peerClosed(false) {
+  _timeout = DEFAULT_CONNECT_TIMEOUT_MS;
+}
+
+WiFiClient::~WiFiClient() {
+  if (socketFd >= 0) ::close(socketFd); // not stop(): the subclass' session is gone already
+  delete[] rxBuffer;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  return connect(host, port, DEFAULT_CONNECT_TIMEOUT_MS);
+}
+
+// FUNCTION connect:
+// resolves `host` (blocking, like the ESP32's lwIP does) and tries its addresses in turn until one accepts the
+// connection; then the subclass opens its session. All of it within `timeoutMS`.
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeoutMS) {
+  stop();
+  const unsigned long deadlineMS = millis() + (timeoutMS > 0 ? timeoutMS : DEFAULT_CONNECT_TIMEOUT_MS);
+
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  char service[6];
+  snprintf(service, sizeof(service), "%u", port);
+  addrinfo *addresses = nullptr;
+  if (getaddrinfo(host, service, &hints, &addresses) != 0) return 0;
+
+  for (addrinfo *address = addresses; address && socketFd < 0; address = address->ai_next) {
+    const int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+    if (fd < 0) continue;
+    socketFd = fd;
+    if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0 || (errno == EINPROGRESS && waitForSocket(POLLOUT, deadlineMS))) {
+      int error = 0;
+      socklen_t length = sizeof(error);
+      if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) break;
+    }
+    ::close(fd);
+    socketFd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (socketFd < 0) return 0;
+
+  const int noDelay = 1; // frames are written in one go; don't hold back their last segment
+  setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+  if (!openSession(host, deadlineMS)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+  if (socketFd < 0) return 0;
+  const unsigned long deadlineMS = millis() + _timeout;
+  size_t written = 0;
+  while (written < size) {
+    const int n = send(buffer + written, size - written);
+    if (n < 0) break;
+    if (n == 0 && !waitForSocket(POLLOUT, deadlineMS)) break;
+    written += n;
+  }
+  return written;
+}
+
+int WiFiClient::available() {
+  if (socketFd < 0) return rxLength - rxPos;
+  const int pending = pendingBytes();
+  if (rxPos == rxLength && pending <= 0 && fillRxBuffer()) return rxLength; // e.g. a TLS record was completed
+  return rxLength - rxPos + (pending > 0 ? pending : 0);
+}
+
+int WiFiClient::read() {
+  if (rxPos == rxLength && !fillRxBuffer()) return -1;
+  return rxBuffer[rxPos++];
+}
+
+// FUNCTION read:
+// takes the buffered bytes first; beyond those, receives straight into `buffer`
+int WiFiClient::read(uint8_t *buffer, size_t size) {
+  size_t n = std::min(size, rxLength - rxPos);
+  memcpy(buffer, rxBuffer + rxPos, n);
+  rxPos += n;
+  if (n < size && socketFd >= 0 && !peerClosed) {
+    const int received = receive(buffer + n, size - n);
+    if (received > 0) n += received;
+    if (received < 0) peerClosed = true;
+  }
+  return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+  if (rxPos == rxLength && !fillRxBuffer()) return -1;
+  return rxBuffer[rxPos];
+}
+
+void WiFiClient::flush() {
+}
+
+void WiFiClient::stop() {
+  if (socketFd >= 0) {
+    closeSession();
+    ::close(socketFd);
+  }
+  socketFd = -1;
+  rxPos = rxLength = 0;
+  peerClosed = false;
+}
+
+// FUNCTION connected:
+// true while there are bytes to read, or the peer has not closed the connection
+uint8_t WiFiClient::connected() {
+  if (rxPos < rxLength) return 1;
+  if (socketFd < 0 || peerClosed) return 0;
+  uint8_t probe;
+  const ssize_t n = recv(socketFd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))) return 1;
+  peerClosed = true;
+  return 0;
+}
+
+WiFiClient::operator bool() {
+  return connected();
+}
+
+bool WiFiClient::openSession(const char *, unsigned long) {
+  return true;
+}
+
+void WiFiClient::closeSession() {
+}
+
+int WiFiClient::pendingBytes() {
+  int pending = 0;
+  return ioctl(socketFd, FIONREAD, &pending) == 0 ? pending : 0;
+}
+
+int WiFiClient::receive(uint8_t *buffer, size_t size) {
+  const ssize_t n = recv(socketFd, buffer, size, MSG_DONTWAIT);
+  if (n > 0) return n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+  return -1; // closed by the peer, or failed
+}
+
+int WiFiClient::send(const uint8_t *buffer, size_t size) {
+  const ssize_t n = ::send(socketFd, buffer, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (n >= 0) return n;
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+}
+
+bool WiFiClient::waitForSocket(short events, unsigned long deadlineMS) {
+  const long remainingMS = (long)(deadlineMS - millis());
+  if (remainingMS <= 0) return false;
+  pollfd descriptor = {socketFd, events, 0};
+  return poll(&descriptor, 1, remainingMS) > 0;
+}
+
+bool WiFiClient::fillRxBuffer() {
+  if (socketFd < 0 || peerClosed) return false;
+  const int n = receive(rxBuffer, RX_BUFFER_SIZE);
+  if (n < 0) peerClosed = true;
+  if (n <= 0) return false;
+  rxPos = 0;
+  rxLength = n;
+  return true;
+}
+
+// CLASS IPAddress
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+  return String(text);
+}
+
+// CLASS WiFiClass
+
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *) {
+  joinedSsid = ssid;
+  currentStatus = WL_CONNECTED;
+  return currentStatus;
+}
+
+bool WiFiClass::disconnect(bool) {
+  currentStatus = WL_DISCONNECTED;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  return currentStatus;
+}
+
+String WiFiClass::SSID() const {
+  return joinedSsid;
+}
+
+IPAddress WiFiClass::localIP() const {
+  ifaddrs *interfaces = nullptr;
+  if (getifaddrs(&interfaces) != 0) return IPAddress();
+  IPAddress result;
+  for (ifaddrs *i = interfaces; i; i = i->ifa_next) {
+    if (!i->ifa_addr || i->ifa_addr->sa_family != AF_INET) continue;
+    const uint32_t address = ntohl(reinterpret_cast<sockaddr_in *>(i->ifa_addr)->sin_addr.s_addr);
+    if ((address >> 24) == 127) continue; // loopback
+    result = IPAddress(address >> 24, address >> 16, address >> 8, address);
+    break;
+  }
+  freeifaddrs(interfaces);
+  return result;
+}
@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <poll.h>
+
+// CLASS WiFiClientSecure
+
+// TLS via OpenSSL, on top of WiFiClient's non-blocking socket.
+
+WiFiClientSecure::WiFiClientSecure() : insecure(false), context(nullptr), session(nullptr) {
+}
+
+WiFiClientSecure::~WiFiClientSecure() {
+  closeSession();
+  SSL_CTX_free(context);
+}
+
+void WiFiClientSecure::setInsecure() {
+  insecure = true;
+}
+
+// FUNCTION openSession:
+// TLS handshake with `host` (also sent as SNI); fails if it doesn't complete before `deadlineMS`
+bool WiFiClientSecure::openSession(const char *host, unsigned long deadlineMS) {
+  if (!context) {
+    context = SSL_CTX_new(TLS_client_method());
+    if (!context) return false;
+    SSL_CTX_set_default_verify_paths(context);
+  }
+  session = SSL_new(context);
+  if (!session) return false;
+  SSL_set_mode(session, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+  SSL_set_fd(session, socketFd);
+  SSL_set_tlsext_host_name(session, host);
+  if (insecure) {
+    SSL_set_verify(session, SSL_VERIFY_NONE, nullptr);
+  } else {
+    SSL_set_verify(session, SSL_VERIFY_PEER, nullptr);
+    SSL_set1_host(session, host);
+  }
+
+  while (true) {
+    const int rc = SSL_connect(session);
+    if (rc == 1) return true;
+    const int error = SSL_get_error(session, rc);
+    if (error == SSL_ERROR_WANT_READ && waitForSocket(POLLIN, deadlineMS)) continue;
+    if (error == SSL_ERROR_WANT_WRITE && waitForSocket(POLLOUT, deadlineMS)) continue;
+    Serial.printf("❌ TLS handshake with %s failed: %s\n", host, ERR_reason_error_string(ERR_get_error()) ?: "timeout");
+    ERR_clear_error();
+    return false;
+  }
+}
+
+void WiFiClientSecure::closeSession() {
+  if (!session) return;
+  SSL_shutdown(session); // sends close_notify; doesn't wait for the peer's
+  SSL_free(session);
+  session = nullptr;
+}
+
+int WiFiClientSecure::pendingBytes() {
+  return session ? SSL_pending(session) : 0;
+}
+
+int WiFiClientSecure::receive(uint8_t *buffer, size_t size) {
+  if (!session) return -1;
+  const int n = SSL_read(session, buffer, size);
+  if (n > 0) return n;
+  const int error = SSL_get_error(session, n);
+  if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) return 0;
+  ERR_clear_error();
+  return -1; // closed by the peer, or failed
+}
+
+int WiFiClientSecure::send(const uint8_t *buffer, size_t size) {
+  if (!session) return -1;
+  const int n = SSL_write(session, buffer, size);
+  if (n > 0) return n;
+  const int error = SSL_get_error(session, n);
+  if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) return 0;
+  ERR_clear_error();
+  return -1;
+}
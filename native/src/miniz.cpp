@@ -0,0 +1,47 @@
+#include "rom/miniz.h"
+
+// tinfl's API on top of zlib's inflate.
+
+// FUNCTION tinfl_decompress:
+// inflates from `pIn_buf_next` into `pOut_buf_next`; on return, the sizes hold the bytes consumed and produced.
+// The stream is (re)started after tinfl_init().
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *,
+                              mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags) {
+  if (!r || !pIn_buf_size || !pOut_buf_size) return TINFL_STATUS_BAD_PARAM;
+  z_stream &stream = r->m_stream;
+
+  if (r->m_state == 0) {
+    const bool zlibHeader = (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) != 0;
+    if (r->m_magic == TINFL_ZSTREAM_MAGIC && r->m_zlibHeader == zlibHeader) {
+      if (inflateReset(&stream) != Z_OK) return TINFL_STATUS_FAILED;
+    } else {
+      if (r->m_magic == TINFL_ZSTREAM_MAGIC) inflateEnd(&stream);
+      stream = {};
+      if (inflateInit2(&stream, zlibHeader ? MAX_WBITS : -MAX_WBITS) != Z_OK) {
+        r->m_magic = 0;
+        return TINFL_STATUS_FAILED;
+      }
+      r->m_magic = TINFL_ZSTREAM_MAGIC;
+      r->m_zlibHeader = zlibHeader;
+    }
+    r->m_state = 1;
+  }
+
+  stream.next_in = const_cast<mz_uint8 *>(pIn_buf_next);
+  stream.avail_in = *pIn_buf_size;
+  stream.next_out = pOut_buf_next;
+  stream.avail_out = *pOut_buf_size;
+  const int rc = inflate(&stream, Z_NO_FLUSH);
+  *pIn_buf_size -= stream.avail_in;
+  *pOut_buf_size -= stream.avail_out;
+
+  switch (rc) {
+    case Z_STREAM_END:
+      return TINFL_STATUS_DONE;
+    case Z_OK:
+    case Z_BUF_ERROR: // no progress possible: out of input, or of output space
+      return stream.avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+    default:
+      return TINFL_STATUS_FAILED;
+  }
+}
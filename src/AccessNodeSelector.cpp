@@ -0,0 +1,107 @@
+#include "AccessNodeSelector.h"
+
+// CLASS AccessNodeSelector
+
+// Latency-ranked failover between equivalent Access Nodes.
+
+AccessNodeSelector::AccessNodeSelector(const AccessNode *nodes, size_t count, unsigned long probeIntervalMS)
+    : nodes(nodes), count(count < MAX_NODES ? count : MAX_NODES), probeIntervalMS(probeIntervalMS), currentNode(0),
+      nextProbe(0), probeOutstanding(false), lastProbeMS(millis()), switchCount(0) {
+  for (size_t i = 0; i < MAX_NODES; ++i)
+    health[i] = {-1, false, 0};
+}
+
+const AccessNode &AccessNodeSelector::current() const {
+  return nodes[currentNode];
+}
+
+size_t AccessNodeSelector::currentIndex() const {
+  return currentNode;
+}
+
+const AccessNode &AccessNodeSelector::node(size_t index) const {
+  return nodes[index];
+}
+
+size_t AccessNodeSelector::size() const {
+  return count;
+}
+
+bool AccessNodeSelector::probeDue(size_t &index) {
+  if (count < 2 || probeOutstanding) return false; // nothing to choose from, or still waiting for the previous probe
+  if (millis() - lastProbeMS < probeIntervalMS) return false;
+  index = nextProbe;
+  nextProbe = (nextProbe + 1) % count;
+  probeOutstanding = true;
+  return true;
+}
+
+void AccessNodeSelector::recordProbe(size_t index, long sampleMS) {
+  probeOutstanding = false;
+  lastProbeMS = millis(); // the interval starts once the probe is done, however long it took
+  if (index >= count) return;
+  Health &h = health[index];
+  if (sampleMS < 0) {
+    h.probeFailed = true;
+    Serial.printf("🩺 Access node %s did not respond to the probe\n", nodes[index].host);
+    return;
+  }
+  h.probeFailed = false;
+  h.roundTripMS = h.roundTripMS < 0 ? sampleMS : (3 * h.roundTripMS + sampleMS) / 4; // EWMA, α = 1/4
+  if (index != currentNode) h.consecutiveFailures = 0;
+  Serial.printf("🩺 Access node %s: round trip %ld ms (smoothed %ld ms)\n", nodes[index].host, sampleMS, h.roundTripMS);
+}
+
+void AccessNodeSelector::cancelProbe() {
+  probeOutstanding = false;
+  lastProbeMS = millis();
+}
+
+void AccessNodeSelector::reportSuccess() {
+  health[currentNode].consecutiveFailures = 0;
+}
+
+void AccessNodeSelector::reportFailure() {
+  ++health[currentNode].consecutiveFailures;
+}
+
+bool AccessNodeSelector::selectBest() {
+  size_t best = currentNode;
+  for (size_t i = 0; i < count; ++i) {
+    if (ranksBefore(i, best)) best = i;
+  }
+  if (best == currentNode) return false;
+  Serial.printf("🔀 Switching access node from %s to %s\n", nodes[currentNode].host, nodes[best].host);
+  currentNode = best;
+  ++switchCount;
+  return true;
+}
+
+long AccessNodeSelector::roundTripMS(size_t index) const {
+  if (index >= count || health[index].probeFailed) return -1;
+  return health[index].roundTripMS;
+}
+
+unsigned long AccessNodeSelector::switches() const {
+  return switchCount;
+}
+
+bool AccessNodeSelector::isHealthy(size_t index) const {
+  return !health[index].probeFailed && health[index].consecutiveFailures == 0;
+}
+
+// number of recent failures of the node, counting a failed probe as one
+unsigned int AccessNodeSelector::penalty(size_t index) const {
+  return health[index].consecutiveFailures + (health[index].probeFailed ? 1 : 0);
+}
+
+// true if node `a` is strictly preferable to node `b`
+bool AccessNodeSelector::ranksBefore(size_t a, size_t b) const {
+  const bool aHealthy = isHealthy(a), bHealthy = isHealthy(b);
+  if (aHealthy != bHealthy) return aHealthy;
+  if (!aHealthy) return penalty(a) < penalty(b);
+
+  const long aMS = health[a].roundTripMS, bMS = health[b].roundTripMS;
+  if ((aMS < 0) != (bMS < 0)) return aMS >= 0; // measured before unknown
+  return aMS < bMS;
+}
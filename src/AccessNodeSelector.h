@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+
+// An Access Node serving both the WebSocket and the REST API.
+struct AccessNode {
+  const char *host;
+  bool useSsl;       // for both APIs
+  uint16_t wsPort;   // WebSocket API, at `/v1/ws`
+  uint16_t restPort; // REST API, at `/v1/`
+};
+
+class AccessNodeSelector {
+
+  // This class chooses the Access Node to connect to from a list of equivalent nodes. It has one node at a time
+  // probed periodically (round robin) and keeps a smoothed round-trip time per node. The probe itself is up to
+  // the caller, so it can be made on another task than the one using the selector (see `probeDue()`). The current
+  // node is kept as long as it works; once a connection to it fails, `selectBest()` switches to the
+  // healthy node with the lowest round-trip time:
+  //  • healthy: the latest probe succeeded (or the node hasn't been probed yet) and the node hasn't
+  //    failed since. Nodes that were never probed rank after all nodes with a measured round-trip time.
+  //  • A node's failures are forgotten when connecting to it succeeds, or -- unless it is the current node,
+  //    whose failures are what we are trying to get away from -- when a probe of it succeeds.
+  //  • If no node is healthy, the one with the fewest recent failures (counting a failed probe as one) is chosen.
+  // All nodes must serve the same network, so that block heights (and hence the resume point of the event
+  // stream) carry over from one node to the next.
+
+  public:
+  AccessNodeSelector(const AccessNode *nodes, size_t count, unsigned long probeIntervalMS);
+
+  const AccessNode &current() const;
+  size_t currentIndex() const;
+  const AccessNode &node(size_t index) const;
+  size_t size() const;
+
+  // true if the interval elapsed, with the node to probe next in `index`. The caller measures the node's
+  // round-trip time and reports it via `recordProbe()`, or `cancelProbe()` if it can't; until then, no probe is due.
+  bool probeDue(size_t &index);
+  void recordProbe(size_t index, long roundTripMS); // in milliseconds; negative if the node did not respond properly
+  void cancelProbe();
+  void reportSuccess(); // connecting to the current node succeeded
+  void reportFailure(); // connecting to the current node failed, or the connection was lost
+  bool selectBest();    // true if it switched to a different node
+  long roundTripMS(size_t index) const; // smoothed; negative if unknown or the latest probe failed
+  unsigned long switches() const;
+
+  private:
+  struct Health {
+    long roundTripMS;    // smoothed; -1 if not measured yet
+    bool probeFailed;    // the latest probe failed
+    unsigned int consecutiveFailures;
+  };
+  static const size_t MAX_NODES = 8;
+
+  bool isHealthy(size_t index) const;
+  unsigned int penalty(size_t index) const;
+  bool ranksBefore(size_t a, size_t b) const;
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const AccessNode *const nodes;
+  const size_t count;
+  const unsigned long probeIntervalMS;
+
+  // dynamic state parameters
+  Health health[MAX_NODES];
+  size_t currentNode;
+  size_t nextProbe;
+  bool probeOutstanding;
+  unsigned long lastProbeMS;
+  unsigned long switchCount;
+};
@@ -0,0 +1,104 @@
+#include "Base64DecodingStream.h"
+
+// CLASS Base64DecodingStream
+
+// Streaming base64 decoder (RFC 4648, standard alphabet) exposed as an Arduino `Stream`.
+
+// maps an ASCII character to its 6-bit value; -1 for characters outside the alphabet
+static int8_t sextetOf(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+Base64DecodingStream::Base64DecodingStream(const char *encoded)
+    : source(nullptr), terminator('\0'), input(encoded ? encoded : ""), decodedLength(0), decodedPos(0), error(false) {
+}
+
+Base64DecodingStream::Base64DecodingStream(Stream &encoded, char terminator)
+    : source(&encoded), terminator(terminator), input(""), decodedLength(0), decodedPos(0), error(false) {
+}
+
+int Base64DecodingStream::available() {
+  if (decodedPos < decodedLength) return 1;
+  return decodeQuantum() ? 1 : 0;
+}
+
+int Base64DecodingStream::read() {
+  if (decodedPos >= decodedLength && !decodeQuantum()) return -1;
+  return decoded[decodedPos++];
+}
+
+int Base64DecodingStream::peek() {
+  if (decodedPos >= decodedLength && !decodeQuantum()) return -1;
+  return decoded[decodedPos];
+}
+
+size_t Base64DecodingStream::readBytes(char *buffer, size_t length) {
+  size_t copied = 0;
+  while (copied < length) {
+    if (decodedPos >= decodedLength && !decodeQuantum()) break;
+    buffer[copied++] = decoded[decodedPos++];
+  }
+  return copied;
+}
+
+size_t Base64DecodingStream::write(uint8_t) {
+  return 0;
+}
+
+bool Base64DecodingStream::failed() const {
+  return error;
+}
+
+// FUNCTION decodeQuantum:
+// Decodes the next (up to) 4 encoded characters into `decoded`. Returns false at the end of the input,
+// at padding, or on an invalid character.
+bool Base64DecodingStream::decodeQuantum() {
+  decodedPos = 0;
+  decodedLength = 0;
+  if (error) return false;
+
+  uint32_t bits = 0;
+  uint8_t sextets = 0;
+  int c;
+  while (sextets < 4 && (c = peekEncoded()) >= 0 && c != '=') {
+    const int8_t value = sextetOf(c);
+    if (value < 0) {
+      error = true;
+      return false;
+    }
+    bits = (bits << 6) | value;
+    ++sextets;
+    consumeEncoded();
+  }
+  if (sextets == 1) error = true; // a single sextet can't encode a full byte
+  if (sextets < 2) return false;
+
+  // a partial quantum (2 or 3 sextets) at the end of the input encodes 1 or 2 bytes
+  bits <<= 6 * (4 - sextets);
+  decoded[0] = bits >> 16;
+  decoded[1] = bits >> 8;
+  decoded[2] = bits;
+  decodedLength = sextets - 1;
+  return true;
+}
+
+// next encoded character, without consuming it; -1 at the end of the input
+int Base64DecodingStream::peekEncoded() {
+  if (!source) return *input != '\0' ? (uint8_t)*input : -1;
+  int c = source->peek();
+  if (c == '\\') { // JSON escape; the only one that can occur in base64 is `\/`
+    source->read();
+    c = source->peek();
+  }
+  return c == terminator ? -1 : c;
+}
+
+void Base64DecodingStream::consumeEncoded() {
+  if (source) source->read();
+  else ++input;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+
+class Base64DecodingStream : public Stream {
+
+  // This class is a read-only `Stream` over the decoded bytes of a base64-encoded, null-terminated
+  // string. Decoding happens on the fly, one 4-character quantum at a time, as the consumer reads.
+  // Hence, no buffer for the decoded data has to be sized and allocated up front; the state is a
+  // pointer into the encoded string plus at most 3 decoded bytes.
+  //
+  // Alternatively, the encoded characters are read from another `Stream` up to a `terminator` (e.g. the
+  // closing quote of a JSON string, read straight from an HTTP response), so the encoded string doesn't
+  // have to be buffered either. JSON escapes (`\/`) are resolved on the way.
+  //
+  // Padding (`=`) is optional. If the input contains a character outside the base64 alphabet, the
+  // stream ends prematurely and `failed()` returns true.
+
+  public:
+  Base64DecodingStream(const char *encoded);
+  Base64DecodingStream(Stream &encoded, char terminator);
+
+  int available() override; // lower bound: 1 if at least one more byte can be decoded, 0 otherwise
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t write(uint8_t) override; // read-only, always returns 0
+  bool failed() const;
+
+  private:
+  bool decodeQuantum();
+  int peekEncoded();
+  void consumeEncoded();
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  Stream *const source; // nullptr if decoding `input`
+  const char terminator;
+
+  // dynamic state parameters
+  const char *input;   // next encoded character not decoded yet
+  uint8_t decoded[3];  // bytes decoded from the current quantum
+  uint8_t decodedLength;
+  uint8_t decodedPos;  // next byte in `decoded` to hand out
+  bool error;
+};
@@ -0,0 +1,109 @@
+#include "ConnectionManager.h"
+
+// CLASS ConnectionManager
+
+// Non-blocking connection state machine with per-stage timeouts and jittered exponential backoff.
+
+ConnectionManager::ConnectionManager(StepFunction step, AbortFunction abort, unsigned long baseBackoffMS, unsigned long maxBackoffMS,
+                                     Clock clock, RandomSource random)
+    : stepFunction(step), abortFunction(abort), baseBackoffMS(baseBackoffMS), maxBackoffMS(maxBackoffMS), clock(clock), randomSource(random),
+      current(Stage::Backoff), stepped(false), stageEnteredMS(clock()), backoffMS(0), consecutiveFailures(0),
+      establishedCount(0), failureCount(0) {
+  for (size_t i = 0; i < STAGE_COUNT; ++i)
+    stageTimeoutMS[i] = 0;
+}
+
+void ConnectionManager::setStageTimeout(Stage stage, unsigned long timeoutMS) {
+  stageTimeoutMS[static_cast<size_t>(stage)] = timeoutMS;
+}
+
+void ConnectionManager::poll() {
+  if (current == Stage::Backoff) {
+    const unsigned long currentMS = clock();
+    if (currentMS - stageEnteredMS < backoffMS) return;
+    enter(Stage::WifiJoining, currentMS);
+  }
+
+  const bool entering = !stepped;
+  stepped = true;
+  Progress progress = stepFunction(current, entering);
+
+  const unsigned long currentMS = clock(); // read after the step, which may have taken a while
+  const unsigned long timeoutMS = stageTimeoutMS[static_cast<size_t>(current)];
+  if (progress == Progress::Pending && timeoutMS > 0 && currentMS - stageEnteredMS >= timeoutMS) {
+    Serial.printf("⌛ Connection stage '%s' timed out after %lu ms\n", stageName(current), currentMS - stageEnteredMS);
+    progress = Progress::Failed;
+  }
+
+  if (progress == Progress::Failed) {
+    fail(currentMS);
+  } else if (progress == Progress::Done && current != Stage::Connected) {
+    const Stage next = static_cast<Stage>(static_cast<uint8_t>(current) + 1);
+    if (next == Stage::Connected) {
+      consecutiveFailures = 0;
+      ++establishedCount;
+    }
+    enter(next, currentMS);
+  }
+}
+
+ConnectionManager::Stage ConnectionManager::stage() const {
+  return current;
+}
+
+bool ConnectionManager::isConnected() const {
+  return current == Stage::Connected;
+}
+
+unsigned long ConnectionManager::currentBackoffMS() const {
+  return current == Stage::Backoff ? backoffMS : 0;
+}
+
+unsigned long ConnectionManager::established() const {
+  return establishedCount;
+}
+
+unsigned long ConnectionManager::failures() const {
+  return failureCount;
+}
+
+const char *ConnectionManager::stageName(Stage stage) {
+  switch (stage) {
+    case Stage::Backoff: return "backoff";
+    case Stage::WifiJoining: return "Wi-Fi";
+    case Stage::Transport: return "TCP/TLS";
+    case Stage::Upgrade: return "WebSocket upgrade";
+    case Stage::Subscribing: return "subscribe";
+    case Stage::Connected: return "connected";
+  }
+  return "?";
+}
+
+uint32_t ConnectionManager::defaultRandom(uint32_t bound) {
+  return bound > 0 ? static_cast<uint32_t>(::random(static_cast<long>(bound))) : 0; // hardware RNG on the ESP32
+}
+
+void ConnectionManager::enter(Stage next, unsigned long currentMS) {
+  current = next;
+  stepped = false;
+  stageEnteredMS = currentMS;
+}
+
+void ConnectionManager::fail(unsigned long currentMS) {
+  const Stage failedStage = current;
+  abortFunction(failedStage);
+  ++failureCount;
+
+  // d = min(maxBackoffMS, baseBackoffMS * 2^n), doubled step by step to avoid overflowing
+  unsigned long ceilingMS = baseBackoffMS;
+  for (unsigned int i = 0; i < consecutiveFailures && ceilingMS < maxBackoffMS; ++i)
+    ceilingMS *= 2;
+  if (ceilingMS > maxBackoffMS) ceilingMS = maxBackoffMS;
+  const unsigned long floorMS = ceilingMS / 2;
+  backoffMS = floorMS + randomSource(static_cast<uint32_t>(ceilingMS - floorMS + 1));
+  ++consecutiveFailures;
+
+  Serial.printf("⚠️ Connection %s in stage '%s' (%u consecutive), next attempt in %lu ms\n",
+                failedStage == Stage::Connected ? "lost" : "failed", stageName(failedStage), consecutiveFailures, backoffMS);
+  enter(Stage::Backoff, currentMS);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <Arduino.h>
+
+class ConnectionManager {
+
+  // This class (re)establishes the connection to the Access Node as a state machine that never blocks:
+  // each call of `poll()` advances the current stage by at most one step. The stages themselves (joining
+  // Wi-Fi, connecting TCP/TLS, upgrading to WebSocket, subscribing) are implemented by the application in a
+  // `StepFunction`, which reports whether its stage is still pending, done or failed. ConnectionManager
+  // bounds each stage by a timeout and, after a failure or a lost connection, waits for a randomised,
+  // exponentially growing backoff before starting over with Wi-Fi.
+  //
+  // Backoff: after the n-th consecutive failure (n = 0 for a connection that was lost after being
+  // established), the delay is drawn uniformly from [d/2, d] with d = min(maxBackoffMS, baseBackoffMS * 2^n).
+  // When an Access Node restarts, all devices connected to it lose their connection at the same time; the
+  // jitter spreads their reconnects over the backoff window instead of having them hit the node in lockstep.
+  //
+  // The clock and the source of randomness are injectable, so the timing can be exercised against a
+  // simulated clock on a host.
+
+  public:
+  enum class Stage : uint8_t {
+    Backoff,     // waiting before the next attempt
+    WifiJoining, // associating with the access point
+    Transport,   // TCP connect, including the TLS handshake when using SSL
+    Upgrade,     // WebSocket upgrade: request sent, awaiting the response headers
+    Subscribing, // subscription sent, awaiting its confirmation
+    Connected,   // polled to detect a lost connection
+  };
+
+  enum class Progress : uint8_t {
+    Pending,
+    Done,
+    Failed,
+  };
+
+  // performs one non-blocking step of `stage`; `entering` is true for the first call after entering it
+  typedef Progress (*StepFunction)(Stage stage, bool entering);
+  // releases whatever a failed attempt or lost connection holds, e.g. closes the socket
+  typedef void (*AbortFunction)(Stage failedStage);
+  typedef unsigned long (*Clock)();
+  typedef uint32_t (*RandomSource)(uint32_t bound); // uniformly distributed in [0, bound)
+
+  ConnectionManager(StepFunction step, AbortFunction abort, unsigned long baseBackoffMS, unsigned long maxBackoffMS,
+                    Clock clock = millis, RandomSource random = defaultRandom);
+
+  void setStageTimeout(Stage stage, unsigned long timeoutMS); // 0 (default): the stage never times out
+  void poll();
+  Stage stage() const;
+  bool isConnected() const;
+  unsigned long currentBackoffMS() const; // delay before the pending attempt; 0 if none is pending
+  unsigned long established() const;      // how often `Connected` was reached
+  unsigned long failures() const;         // failed attempts and lost connections
+
+  static const char *stageName(Stage stage);
+
+  private:
+  static const size_t STAGE_COUNT = 6;
+
+  static uint32_t defaultRandom(uint32_t bound);
+  void enter(Stage next, unsigned long currentMS);
+  void fail(unsigned long currentMS);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const StepFunction stepFunction;
+  const AbortFunction abortFunction;
+  const unsigned long baseBackoffMS;
+  const unsigned long maxBackoffMS;
+  const Clock clock;
+  const RandomSource randomSource;
+  unsigned long stageTimeoutMS[STAGE_COUNT];
+
+  // dynamic state parameters
+  Stage current;
+  bool stepped;                     // the step function was called since entering `current`
+  unsigned long stageEnteredMS;
+  unsigned long backoffMS;
+  unsigned int consecutiveFailures; // since `Connected` was last reached
+  unsigned long establishedCount;
+  unsigned long failureCount;
+};
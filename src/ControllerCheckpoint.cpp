@@ -0,0 +1,84 @@
+#include "ControllerCheckpoint.h"
+
+// CLASS ControllerCheckpoint
+
+// Rate-bounded, CRC-protected checkpoint of the controller's progress in NVS.
+
+const uint16_t ControllerCheckpoint::FORMAT_VERSION = 1;
+
+static const char *const NVS_NAMESPACE = "checkpoint";
+static const char *const NVS_KEY = "record";
+
+ControllerCheckpoint::ControllerCheckpoint(unsigned long minWriteIntervalMS)
+    : minWriteIntervalMS(minWriteIntervalMS), opened(false), latest{0, 0, 0}, dirty(false), writtenOnce(false),
+      lastWriteMS(0), writeCount(0) {
+}
+
+bool ControllerCheckpoint::begin() {
+  opened = preferences.begin(NVS_NAMESPACE, false);
+  if (!opened) Serial.println(F("❌ Opening NVS for the checkpoint failed"));
+  return opened;
+}
+
+bool ControllerCheckpoint::load(Record &record) {
+  if (!opened) return false;
+  Stored stored;
+  if (preferences.getBytesLength(NVS_KEY) != sizeof(stored)) return false; // nothing stored yet, or a different format
+  preferences.getBytes(NVS_KEY, &stored, sizeof(stored));
+  if (stored.version != FORMAT_VERSION) return false;
+  if (stored.crc != crc32(reinterpret_cast<const uint8_t *>(&stored.record), sizeof(stored.record))) {
+    Serial.println(F("⚠️ Checkpoint in NVS is corrupt, ignored"));
+    return false;
+  }
+  record = stored.record;
+  latest = stored.record;
+  dirty = false;
+  return true;
+}
+
+void ControllerCheckpoint::update(const Record &record) {
+  if (record.blockHeight == latest.blockHeight && record.eventSequence == latest.eventSequence &&
+      record.controllerState == latest.controllerState) return;
+  latest = record;
+  dirty = true;
+}
+
+const ControllerCheckpoint::Record &ControllerCheckpoint::current() const {
+  return latest;
+}
+
+bool ControllerCheckpoint::persistIfDue() {
+  if (!opened || !dirty) return false;
+  const unsigned long currentMS = millis();
+  if (writtenOnce && currentMS - lastWriteMS < minWriteIntervalMS) return false;
+
+  Stored stored;
+  stored.version = FORMAT_VERSION;
+  stored.reserved = 0;
+  stored.record = latest;
+  stored.crc = crc32(reinterpret_cast<const uint8_t *>(&stored.record), sizeof(stored.record));
+  lastWriteMS = currentMS; // also rate-bounds retries if writing fails
+  writtenOnce = true;
+  if (preferences.putBytes(NVS_KEY, &stored, sizeof(stored)) != sizeof(stored)) {
+    Serial.println(F("❌ Writing the checkpoint to NVS failed"));
+    return false;
+  }
+  dirty = false;
+  ++writeCount;
+  return true;
+}
+
+unsigned long ControllerCheckpoint::writes() const {
+  return writeCount;
+}
+
+// CRC-32 (IEEE 802.3, reflected), bitwise: the record is tiny and written at most once per interval
+uint32_t ControllerCheckpoint::crc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <Arduino.h>
+#include <Preferences.h>
+
+class ControllerCheckpoint {
+
+  // This class persists the controller's progress in the ESP32's non-volatile storage (NVS), so that
+  // after a reboot the external load can be restored right away and the event stream resumed from
+  // where we left off, instead of re-reading the on-chain state before anything else.
+  //
+  // A checkpoint is a single 32-byte blob: last processed block height, last `eventSequence`, controller
+  // state, a format version and a CRC32. NVS writes a blob as a new entry before invalidating the old one,
+  // so a power loss in the middle of a write leaves the previous checkpoint intact; the CRC additionally
+  // rejects records that are corrupt for any other reason. As all values are written together, a restored
+  // state always belongs to the restored block height -- replaying events from there is consistent.
+  //
+  // Flash wear budget: NVS is log-structured and wear-levels across the pages of its partition by itself.
+  // Each write appends 3 entries of 32 bytes (blob index, data header, data) to the active page; a 4 KB page
+  // holds 126 entries, so a page is erased every 42 writes. Writes are rate-bounded by `minWriteIntervalMS`
+  // and skipped if nothing changed. With the 60 s interval configured in main.cpp, that is at most 1440 writes, ≈34
+  // page erases per day. Spread over the 4 usable pages of the default 20 KB NVS partition, each page is
+  // erased ≈9 times a day; at the flash's rated 100k erase cycles, that lasts for more than 30 years
+  // (ignoring other NVS users, such as the WiFi driver, which write rarely).
+
+  public:
+  struct Record {
+    uint64_t blockHeight;   // all events up to and including this block have been applied
+    uint64_t eventSequence; // `eventSequence` of the last applied control event; 0 if unknown (state read via script)
+    int64_t controllerState;
+  };
+
+  ControllerCheckpoint(unsigned long minWriteIntervalMS);
+
+  bool begin();              // opens the NVS namespace; call once at startup
+  bool load(Record &record); // false if there is no valid checkpoint
+  void update(const Record &record);
+  const Record &current() const; // latest record passed to update() or load()
+  bool persistIfDue();       // writes the latest record, if it changed and the write interval elapsed
+  unsigned long writes() const;
+
+  static const uint16_t FORMAT_VERSION;
+
+  private:
+  struct Stored {
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t crc; // CRC32 over `record`
+    Record record;
+  };
+
+  static uint32_t crc32(const uint8_t *data, size_t length);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const unsigned long minWriteIntervalMS;
+
+  // dynamic state parameters
+  Preferences preferences;
+  bool opened;
+  Record latest;
+  bool dirty;           // `latest` differs from what is in flash
+  bool writtenOnce;     // at least one write since boot; the first write is not rate-bounded
+  unsigned long lastWriteMS;
+  unsigned long writeCount;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+class DesiredState {
+
+  // This class hands the latest controller state from one writer to one reader, which may run concurrently
+  // (e.g. on different cores). Unlike a queue, it can't overflow: publishing overwrites the value the reader
+  // hasn't taken yet, which is superseded anyway. The reader compares the sequence number on every pass and
+  // takes the value once it changed, so it always ends up with the latest state.
+  //
+  // Writing and reading follow the sequence lock pattern: the sequence is odd while `publish` updates the
+  // fields, and `take` retries if the sequence was odd or changed while it read them. All fields are 32-bit
+  // atomics, which are lock-free on the ESP32, so neither side ever blocks on the other.
+
+  public:
+  DesiredState() : sequence(0), valueLow(0), valueHigh(0), publishedUS(0), takenSequence(0) {
+  }
+
+  // writer side
+  void publish(int64_t value, uint32_t nowUS) {
+    const uint32_t s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed); // odd: update in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    valueLow.store(static_cast<uint32_t>(static_cast<uint64_t>(value)), std::memory_order_relaxed);
+    valueHigh.store(static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32), std::memory_order_relaxed);
+    publishedUS.store(nowUS, std::memory_order_relaxed);
+    sequence.store(s + 2, std::memory_order_release);
+  }
+
+  // reader side: true if a value was published since the last call that returned true
+  bool take(int64_t &value, uint32_t &publishedAtUS) {
+    while (true) {
+      const uint32_t s = sequence.load(std::memory_order_acquire);
+      if (s == takenSequence) return false;
+      if (s & 1) continue; // the writer is updating the fields right now; it doesn't block, so this is brief
+      const uint32_t low = valueLow.load(std::memory_order_relaxed);
+      const uint32_t high = valueHigh.load(std::memory_order_relaxed);
+      const uint32_t us = publishedUS.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) != s) continue; // overwritten while reading
+      value = static_cast<int64_t>((static_cast<uint64_t>(high) << 32) | low);
+      publishedAtUS = us;
+      takenSequence = s;
+      return true;
+    }
+  }
+
+  // approximate if called concurrently with publish; the number of values published so far
+  uint32_t published() const {
+    return sequence.load(std::memory_order_acquire) / 2;
+  }
+
+  private:
+  std::atomic<uint32_t> sequence; // twice the number of values published; written by the writer only
+  std::atomic<uint32_t> valueLow;
+  std::atomic<uint32_t> valueHigh;
+  std::atomic<uint32_t> publishedUS; // micros() when the value was published, for the latency statistics
+  uint32_t takenSequence;            // sequence of the value taken last; the reader's only
+};
@@ -0,0 +1,127 @@
+#include "EventOrderingStage.h"
+
+// CLASS EventOrderingStage
+
+// Control events deduplicated, ordered by (block height, eventSequence), and collapsed per block.
+
+EventOrderingStage::EventOrderingStage(size_t capacity, size_t recentKeyCapacity)
+    : capacity(capacity), recentKeyCapacity(recentKeyCapacity), updates(new Update[capacity]),
+      keys(new DeliveredKey[recentKeyCapacity]()), updateCount(0), nextKey(0), duplicateCount(0), collapsedCount(0) {
+}
+
+EventOrderingStage::~EventOrderingStage() {
+  delete[] updates;
+  delete[] keys;
+}
+
+bool EventOrderingStage::seen(const char *transactionId, uint32_t eventIndex, unsigned long blockHeight) {
+  if (!transactionId || *transactionId == '\0') return false;
+  const uint64_t hash = keyHash(transactionId, eventIndex);
+  for (size_t i = 0; i < recentKeyCapacity; ++i) {
+    if (keys[i].hash == hash) {
+      ++duplicateCount;
+      return true;
+    }
+  }
+  keys[nextKey] = {hash, blockHeight};
+  nextKey = (nextKey + 1) % recentKeyCapacity;
+  return false;
+}
+
+// FUNCTION add:
+// inserts the update at its place in (blockHeight, eventSequence) order, collapsing it with the neighbouring
+// updates of the same block if their sequence numbers are adjacent
+EventOrderingStage::Insert EventOrderingStage::add(unsigned long blockHeight, uint64_t eventSequence, int64_t value) {
+  size_t position = 0;
+  while (position < updateCount && (updates[position].blockHeight < blockHeight ||
+                                    (updates[position].blockHeight == blockHeight && updates[position].eventSequence < eventSequence))) {
+    ++position;
+  }
+  if (position < updateCount && updates[position].blockHeight == blockHeight && updates[position].firstSequence <= eventSequence) {
+    ++duplicateCount; // within the collapsed range of this update
+    return Insert::Duplicate;
+  }
+
+  Update *previous = position > 0 && updates[position - 1].blockHeight == blockHeight ? &updates[position - 1] : nullptr;
+  Update *next = position < updateCount && updates[position].blockHeight == blockHeight ? &updates[position] : nullptr;
+  if (previous && previous->eventSequence + 1 == eventSequence) {
+    previous->eventSequence = eventSequence;
+    previous->value = value;
+    if (next && next->firstSequence == eventSequence + 1) { // the gap between the two is closed
+      previous->eventSequence = next->eventSequence;
+      previous->value = next->value;
+      memmove(next, next + 1, (updateCount - position - 1) * sizeof(Update));
+      --updateCount;
+    }
+    return Insert::Buffered;
+  }
+  if (next && next->firstSequence == eventSequence + 1) {
+    next->firstSequence = eventSequence; // the later update's value stays final
+    return Insert::Buffered;
+  }
+
+  if (updateCount == capacity) return Insert::Full;
+  memmove(&updates[position + 1], &updates[position], (updateCount - position) * sizeof(Update));
+  updates[position] = {blockHeight, eventSequence, eventSequence, value};
+  ++updateCount;
+  return Insert::Buffered;
+}
+
+bool EventOrderingStage::contiguous(unsigned long blockHeight, uint64_t lastSequence) const {
+  uint64_t expected = lastSequence + 1;
+  for (size_t i = 0; i < updateCount && updates[i].blockHeight <= blockHeight; ++i) {
+    if (updates[i].eventSequence <= lastSequence) continue; // stale
+    if (lastSequence == 0) expected = updates[i].firstSequence; // unknown: the first update starts the sequence
+    if (updates[i].firstSequence > expected) return false;
+    lastSequence = updates[i].eventSequence;
+    expected = updates[i].eventSequence + 1;
+  }
+  return true;
+}
+
+size_t EventOrderingStage::take(unsigned long blockHeight, uint64_t lastSequence, Update &final) {
+  size_t taken = 0;
+  size_t events = 0;
+  for (; taken < updateCount && updates[taken].blockHeight <= blockHeight; ++taken) {
+    const Update &update = updates[taken];
+    if (update.eventSequence <= lastSequence) continue; // stale
+    const uint64_t first = update.firstSequence > lastSequence ? update.firstSequence : lastSequence + 1;
+    events += update.eventSequence - first + 1;
+    final = update;
+    lastSequence = update.eventSequence;
+  }
+  memmove(updates, &updates[taken], (updateCount - taken) * sizeof(Update));
+  updateCount -= taken;
+  if (events > 1) collapsedCount += events - 1;
+  return events;
+}
+
+void EventOrderingStage::rewind(unsigned long blockHeight) {
+  updateCount = 0;
+  for (size_t i = 0; i < recentKeyCapacity; ++i) {
+    if (keys[i].blockHeight > blockHeight) keys[i] = {0, 0};
+  }
+}
+
+size_t EventOrderingStage::pending() const {
+  return updateCount;
+}
+
+unsigned long EventOrderingStage::duplicates() const {
+  return duplicateCount;
+}
+
+unsigned long EventOrderingStage::collapsed() const {
+  return collapsedCount;
+}
+
+// FUNCTION keyHash:
+// 64-bit FNV-1a hash of the transaction ID, followed by the event's index; never 0, which marks an empty key
+uint64_t EventOrderingStage::keyHash(const char *transactionId, uint32_t eventIndex) {
+  uint64_t hash = 14695981039346656037ull;
+  for (; *transactionId != '\0'; ++transactionId)
+    hash = (hash ^ (uint8_t)*transactionId) * 1099511628211ull;
+  for (int shift = 0; shift < 32; shift += 8)
+    hash = (hash ^ (uint8_t)(eventIndex >> shift)) * 1099511628211ull;
+  return hash != 0 ? hash : 1;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+
+class EventOrderingStage {
+
+  // This class sits between decoding control events and applying them. Control events are not applied one by
+  // one as they arrive; they are buffered until their block is complete, and only the final value of the
+  // complete blocks is applied. Hence, the external load switches at most once per sealed block.
+  //
+  //  • Deduplication: an event is identified by its transaction ID and its index within the transaction.
+  //    `seen` recognises events delivered before, e.g. by the overlapping replay after reconnecting.
+  //  • Order: updates are kept sorted by (block height, eventSequence), regardless of the order they arrive
+  //    in. Adjacent updates of the same block are collapsed as they arrive, so a burst of updates within one
+  //    block takes a single entry.
+  //  • Completion: once the blocks up to some height are complete, `contiguous` tells whether their updates
+  //    continue the applied eventSequence without gaps (otherwise, events were lost and must be backfilled
+  //    first), and `take` removes them, yielding the update that sets the final value.
+  //
+  // The stage is not thread-safe: it is used by the network task only. All memory is allocated at construction.
+
+  public:
+  struct Update {
+    unsigned long blockHeight;
+    uint64_t firstSequence; // eventSequence of the first of the updates collapsed into this one
+    uint64_t eventSequence; // eventSequence of the last one, which set `value`
+    int64_t value;
+  };
+
+  enum class Insert : uint8_t {
+    Buffered,
+    Duplicate, // its eventSequence is buffered already
+    Full,      // too many fragments of non-adjacent updates; complete some blocks first
+  };
+
+  EventOrderingStage(size_t capacity, size_t recentKeyCapacity);
+  ~EventOrderingStage();
+
+  // true if the event was seen before (and is not to be delivered again); records it otherwise. Events without a
+  // transaction ID are never considered seen.
+  bool seen(const char *transactionId, uint32_t eventIndex, unsigned long blockHeight);
+  Insert add(unsigned long blockHeight, uint64_t eventSequence, int64_t value);
+
+  // true if the buffered updates up to `blockHeight` continue `lastSequence` without gaps (if `lastSequence` is
+  // 0, i.e. unknown, the first update starts the sequence). Updates up to `lastSequence` are stale and ignored.
+  bool contiguous(unsigned long blockHeight, uint64_t lastSequence) const;
+  // removes the updates up to `blockHeight`; `final` is the last one that isn't stale. Returns the number of events
+  // collapsed into `final`, 0 if there is none.
+  size_t take(unsigned long blockHeight, uint64_t lastSequence, Update &final);
+  // the event stream continues after `blockHeight`: buffered updates are discarded, and events of later blocks are
+  // forgotten, as they will be delivered again
+  void rewind(unsigned long blockHeight);
+
+  size_t pending() const;          // buffered fragments
+  unsigned long duplicates() const; // events recognised by `seen` or `add`, since construction
+  unsigned long collapsed() const;  // events superseded by a later one of their batch, since construction
+
+  private:
+  struct DeliveredKey {
+    uint64_t hash;             // 0: empty
+    unsigned long blockHeight;
+  };
+
+  static uint64_t keyHash(const char *transactionId, uint32_t eventIndex);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const size_t capacity;
+  const size_t recentKeyCapacity;
+  Update *const updates;     // sorted by (blockHeight, eventSequence)
+  DeliveredKey *const keys; // ring of the most recently delivered events
+
+  // dynamic state parameters
+  size_t updateCount;
+  size_t nextKey; // ring position to record the next key at
+  unsigned long duplicateCount;
+  unsigned long collapsedCount;
+};
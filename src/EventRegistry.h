@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+
+// handles the base64-encoded JSON-Cadence payload of one event
+typedef void (*EventHandler)(const char *encodedPayload);
+
+// FUNCTION eventTypeHash:
+// 32-bit FNV-1a hash of an event type string; constexpr, so registry entries are hashed at compile time.
+constexpr uint32_t eventTypeHash(const char *type) {
+  uint32_t hash = 2166136261u;
+  for (; *type != '\0'; ++type)
+    hash = (hash ^ (uint8_t)*type) * 16777619u;
+  return hash;
+}
+
+// how events of a type are treated when they arrive faster than they are processed (see IngestQueue.h)
+enum class EventPriority : uint8_t {
+  Control,   // changes the controller's state: never dropped
+  Telemetry, // informational: coalesced per block, shed under load
+};
+
+struct EventType {
+  const char *id;       // fully qualified event type, e.g. `A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged`
+  EventHandler handler; // nullptr if events of this type are only logged
+  EventPriority priority;
+  uint32_t hash;
+
+  constexpr EventType(const char *id, EventHandler handler, EventPriority priority = EventPriority::Control)
+      : id(id), handler(handler), priority(priority), hash(eventTypeHash(id)) {
+  }
+};
+
+template <size_t N>
+class EventRegistry {
+
+  // This class maps event type strings to their handlers. It is built at compile time from an array
+  // of `EventType`s: the entries' hashes are computed by the compiler and placed into an open-addressing
+  // hash table with at least twice as many slots as entries. Looking up the type of an incoming event
+  // therefore costs hashing the string once, typically a single probe, and one `strcmp` to rule out
+  // hash collisions -- independent of the number of registered types.
+  //
+  // The same array of `EventType`s is iterated to build the subscription's `event_types` argument, so
+  // the set of subscribed events and the set of handled events can't diverge.
+
+  public:
+  constexpr EventRegistry(const EventType (&types)[N]) : types(types), slots{} {
+    static_assert(N < EMPTY, "too many event types");
+    for (size_t i = 0; i < SLOTS; ++i)
+      slots[i] = EMPTY;
+    for (size_t i = 0; i < N; ++i) {
+      size_t slot = types[i].hash & (SLOTS - 1);
+      while (slots[slot] != EMPTY)
+        slot = (slot + 1) & (SLOTS - 1);
+      slots[slot] = i;
+    }
+  }
+
+  // returns the registered event type, or nullptr if `id` is not registered
+  const EventType *find(const char *id) const {
+    if (!id) return nullptr;
+    const uint32_t hash = eventTypeHash(id);
+    for (size_t slot = hash & (SLOTS - 1); slots[slot] != EMPTY; slot = (slot + 1) & (SLOTS - 1)) {
+      const EventType &type = types[slots[slot]];
+      if (type.hash == hash && strcmp(type.id, id) == 0) return &type;
+    }
+    return nullptr;
+  }
+
+  constexpr size_t size() const {
+    return N;
+  }
+
+  constexpr const EventType &operator[](size_t i) const {
+    return types[i];
+  }
+
+  private:
+  static constexpr size_t slotCount(size_t minimum, size_t slots = 1) {
+    return slots >= minimum ? slots : slotCount(minimum, slots << 1);
+  }
+
+  static constexpr size_t SLOTS = slotCount(2 * N); // power of two, load factor ≤ 0.5
+  static constexpr uint16_t EMPTY = 0xFFFF;
+
+  const EventType (&types)[N];
+  uint16_t slots[SLOTS]; // index into `types`, or EMPTY
+};
@@ -0,0 +1,156 @@
+#include "HttpBodyStream.h"
+
+// CLASS HttpBodyStream
+
+// Body of an HTTP/1.1 response, read from the connection with the chunked transfer encoding removed.
+
+HttpBodyStream::HttpBodyStream(Stream &connection, bool chunked, long contentLength)
+    : connection(connection), chunked(chunked), lengthKnown(!chunked && contentLength >= 0),
+      state(chunked ? State::ChunkHeader : (contentLength == 0 ? State::Done : State::Data)),
+      remaining(contentLength > 0 ? (unsigned long)contentLength : 0), consumed(0) {
+  setTimeout(connection.getTimeout());
+}
+
+int HttpBodyStream::available() {
+  if (!advance()) return 0;
+  const int buffered = connection.available();
+  if (!chunked && !lengthKnown) return buffered;
+  return (unsigned long)buffered < remaining ? buffered : (int)remaining;
+}
+
+int HttpBodyStream::read() {
+  if (!advance()) return -1;
+  const int c = timedReadConnection();
+  if (c < 0) {
+    // end of a body delimited by closing the connection; anything else ends prematurely
+    state = (!chunked && !lengthKnown) ? State::Done : State::Failed;
+    return -1;
+  }
+  ++consumed;
+  if ((chunked || lengthKnown) && --remaining == 0) state = chunked ? State::ChunkEnd : State::Done;
+  return c;
+}
+
+int HttpBodyStream::peek() {
+  if (!advance()) return -1;
+  const int c = timedPeekConnection();
+  if (c < 0) state = (!chunked && !lengthKnown) ? State::Done : State::Failed;
+  return c;
+}
+
+size_t HttpBodyStream::readBytes(char *buffer, size_t length) {
+  size_t copied = 0;
+  while (copied < length) {
+    const int c = read();
+    if (c < 0) break;
+    buffer[copied++] = (char)c;
+  }
+  return copied;
+}
+
+size_t HttpBodyStream::write(uint8_t) {
+  return 0;
+}
+
+bool HttpBodyStream::drain() {
+  while (read() >= 0) {
+  }
+  return state == State::Done;
+}
+
+bool HttpBodyStream::failed() const {
+  return state == State::Failed;
+}
+
+size_t HttpBodyStream::bodyBytes() const {
+  return consumed;
+}
+
+bool HttpBodyStream::advance() {
+  while (true) {
+    switch (state) {
+    case State::Data:
+      return true;
+    case State::ChunkEnd:
+      if (!readLine()) return false;
+      state = State::ChunkHeader;
+      break;
+    case State::ChunkHeader:
+      if (!readChunkHeader()) return false;
+      break;
+    case State::Done:
+    case State::Failed:
+      return false;
+    }
+  }
+}
+
+// FUNCTION readChunkHeader
+// Parses a chunk's size line: the size in hex, optionally followed by extensions (`;name=value`), which
+// are ignored. The last chunk has size 0 and is followed by optional trailers and an empty line.
+bool HttpBodyStream::readChunkHeader() {
+  unsigned long size = 0;
+  unsigned int digits = 0;
+  while (true) {
+    const int c = timedPeekConnection();
+    int digit;
+    if (c >= '0' && c <= '9') digit = c - '0';
+    else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+    else break;
+    if (++digits > 2 * sizeof(size)) { // would overflow
+      state = State::Failed;
+      return false;
+    }
+    size = (size << 4) | (unsigned long)digit;
+    connection.read();
+  }
+  if (digits == 0 || !readLine()) { // timeout, or not a chunk header at all
+    state = State::Failed;
+    return false;
+  }
+  if (size > 0) {
+    remaining = size;
+    state = State::Data;
+    return true;
+  }
+
+  // last chunk: skip the trailers up to the terminating empty line
+  while (true) {
+    const int c = timedPeekConnection();
+    if (c == '\r' || c == '\n') break;
+    if (c < 0 || !readLine()) {
+      state = State::Failed;
+      return false;
+    }
+  }
+  state = readLine() ? State::Done : State::Failed;
+  return false;
+}
+
+// FUNCTION readLine
+// Consumes the connection up to and including the next line feed.
+bool HttpBodyStream::readLine() {
+  while (true) {
+    const int c = timedReadConnection();
+    if (c < 0) {
+      state = State::Failed;
+      return false;
+    }
+    if (c == '\n') return true;
+  }
+}
+
+int HttpBodyStream::timedPeekConnection() {
+  const unsigned long startMS = millis();
+  do {
+    const int c = connection.peek();
+    if (c >= 0) return c;
+    yield();
+  } while (millis() - startMS < getTimeout());
+  return -1;
+}
+
+int HttpBodyStream::timedReadConnection() {
+  return timedPeekConnection() < 0 ? -1 : connection.read();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+
+class HttpBodyStream : public Stream {
+
+  // This class reads the body of an HTTP/1.1 response straight from the connection, after the headers were
+  // consumed (e.g. by HTTPClient), and removes the chunked transfer encoding if the server applied it. Hence a
+  // parser can consume the response as it arrives, without buffering it as a whole.
+  //
+  // The stream ends (read() returns -1) at the end of the body, so a parser can't read into the next response
+  // on a kept-alive connection. Before the connection is reused, the rest of the body has to be consumed via
+  // `drain()`, regardless of how much of it the parser needed.
+  //
+  // Like Stream's own timed reads, read() and peek() wait up to the connection's timeout for bytes to arrive.
+
+  public:
+  // `contentLength` < 0: the length is unknown, the body ends when the connection is closed (unless chunked)
+  HttpBodyStream(Stream &connection, bool chunked, long contentLength);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override; // returns early at the end of the body
+  size_t write(uint8_t) override; // read-only, always returns 0
+
+  bool drain();         // consumes the rest of the body; false if it did not end properly
+  bool failed() const;  // malformed chunk framing or the connection timed out mid-body
+  size_t bodyBytes() const; // decoded bytes read so far
+
+  private:
+  enum class State : uint8_t {
+    ChunkHeader, // expecting the size line of the next chunk
+    Data,        // `remaining` bytes of body (or of the current chunk) left
+    ChunkEnd,    // expecting the CRLF after a chunk's data
+    Done,
+    Failed,
+  };
+
+  bool advance(); // moves past chunk framing until body bytes are due; false at the end of the body
+  int timedPeekConnection();
+  int timedReadConnection();
+  bool readChunkHeader();
+  bool readLine(); // skips a line (e.g. a trailer); false on timeout
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  Stream &connection;
+  const bool chunked;
+  const bool lengthKnown;
+
+  // dynamic state parameters
+  State state;
+  unsigned long remaining; // in the body (not chunked) or in the current chunk
+  size_t consumed;
+};
@@ -0,0 +1,134 @@
+#include "IngestQueue.h"
+
+// CLASS IngestQueue
+
+// Bounded queue of received events, shedding load by the rank of its items when full.
+
+IngestQueue::IngestQueue(size_t capacity, size_t payloadCapacity, size_t highWatermark)
+    : capacity(capacity), payloadCapacity(payloadCapacity), highWatermark(highWatermark), slots(new Slot[capacity]),
+      head(0), count(0), peak(0), coalescedCount(0), droppedCount{}, fullCount(0) {
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].payloadBuffer = new char[payloadCapacity];
+  }
+}
+
+IngestQueue::~IngestQueue() {
+  for (size_t i = 0; i < capacity; ++i) {
+    delete[] slots[i].payloadBuffer;
+  }
+  delete[] slots;
+}
+
+IngestQueue::Outcome IngestQueue::pushEvent(const EventType *type, unsigned long blockHeight, const char *payload) {
+  return push(type->priority == EventPriority::Control ? Kind::Control : Kind::Telemetry, type, blockHeight, payload);
+}
+
+IngestQueue::Outcome IngestQueue::pushBlockEnd(unsigned long blockHeight, bool heartbeat) {
+  return push(heartbeat ? Kind::Heartbeat : Kind::BlockEnd, nullptr, blockHeight, nullptr);
+}
+
+const IngestQueue::Item *IngestQueue::front() const {
+  return count > 0 ? &slotAt(0).item : nullptr;
+}
+
+void IngestQueue::pop() {
+  if (count == 0) return;
+  head = (head + 1) % capacity;
+  --count;
+}
+
+void IngestQueue::clear() {
+  count = 0;
+}
+
+bool IngestQueue::congested() const {
+  return count >= highWatermark;
+}
+
+size_t IngestQueue::depth() const {
+  return count;
+}
+
+size_t IngestQueue::getCapacity() const {
+  return capacity;
+}
+
+size_t IngestQueue::highWaterMark() const {
+  return peak;
+}
+
+unsigned long IngestQueue::coalesced() const {
+  return coalescedCount;
+}
+
+unsigned long IngestQueue::dropped(Kind kind) const {
+  return droppedCount[(size_t)kind];
+}
+
+unsigned long IngestQueue::full() const {
+  return fullCount;
+}
+
+IngestQueue::Slot &IngestQueue::slotAt(size_t position) const {
+  return slots[(head + position) % capacity];
+}
+
+// FUNCTION push:
+// applies the queue's policies to an incoming item: coalesce, queue, evict a lower-ranked item, or drop
+IngestQueue::Outcome IngestQueue::push(Kind kind, const EventType *type, unsigned long blockHeight, const char *payload) {
+  if (kind == Kind::Telemetry) { // the block's events are queued back to back, newest last
+    for (size_t position = count; position > 0 && slotAt(position - 1).item.blockHeight == blockHeight; --position) {
+      Item &queued = slotAt(position - 1).item;
+      if (queued.kind != Kind::Telemetry || queued.type != type) continue;
+      if (queued.count < UINT16_MAX) ++queued.count;
+      ++coalescedCount;
+      return Outcome::Coalesced;
+    }
+  }
+
+  const bool retainPayload = type && type->handler && payload;
+  const size_t payloadLength = retainPayload ? strlen(payload) : 0;
+  if (payloadLength >= payloadCapacity || (count == capacity && !evictBelow(kind))) {
+    if (kind == Kind::Control) {
+      ++fullCount;
+      return Outcome::Full;
+    }
+    recordDrop(kind);
+    return Outcome::Dropped;
+  }
+
+  Slot &slot = slotAt(count);
+  slot.item.kind = kind;
+  slot.item.type = type;
+  slot.item.blockHeight = blockHeight;
+  slot.item.count = 1;
+  memcpy(slot.payloadBuffer, retainPayload ? payload : "", payloadLength + 1);
+  slot.item.payload = slot.payloadBuffer;
+  ++count;
+  if (count > peak) peak = count;
+  return Outcome::Queued;
+}
+
+// FUNCTION evictBelow:
+// removes the oldest item of the lowest rank below `kind`; the items after it move up, taking their payload
+// buffers along, so the freed slot ends up at the tail. False if all queued items rank at least as high as `kind`.
+bool IngestQueue::evictBelow(Kind kind) {
+  for (size_t rank = 0; rank < (size_t)kind; ++rank) {
+    for (size_t position = 0; position < count; ++position) {
+      if ((size_t)slotAt(position).item.kind != rank) continue;
+      recordDrop((Kind)rank);
+      for (; position + 1 < count; ++position) {
+        const Slot evicted = slotAt(position);
+        slotAt(position) = slotAt(position + 1);
+        slotAt(position + 1) = evicted;
+      }
+      --count;
+      return true;
+    }
+  }
+  return false;
+}
+
+void IngestQueue::recordDrop(Kind kind) {
+  ++droppedCount[(size_t)kind];
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <Arduino.h>
+
+#include "EventRegistry.h"
+
+class IngestQueue {
+
+  // This class is the bounded queue between receiving events and processing them. Receiving a message only
+  // queues its events (and a marker for the end of its block); they are processed in order, a few per pass of
+  // the network task. When events arrive faster than they are processed, the queue fills up and sheds load by
+  // explicit policies, ranked by the kind of item:
+  //
+  //   Heartbeat < Telemetry < BlockEnd < Control
+  //
+  //  • Telemetry events (see `EventPriority`) of the same type and block are coalesced into one item, which
+  //    carries the number of events and the payload of the first one.
+  //  • If the queue is full, an incoming item evicts the oldest queued item of the lowest rank below its own;
+  //    if there is none, the incoming item is dropped. Dropping heartbeats and block ends is harmless: a later
+  //    block's end marks all blocks up to it as processed.
+  //  • Control events are never dropped. If one can't be queued (the queue is full of control events, or its
+  //    payload exceeds the payload capacity), push reports `Full`: the caller processes the queue and then the
+  //    event right away.
+  //
+  // `congested()` tells the receiving side to leave further messages in the socket until the queue has drained
+  // below its high watermark; TCP's flow control then slows down the sender.
+  //
+  // The queue is not thread-safe: it is filled and drained by the same task. All memory, including a payload
+  // buffer per slot, is allocated once at construction.
+
+  public:
+  enum class Kind : uint8_t {
+    Heartbeat, // end of a block without events
+    Telemetry, // event of a type registered with `EventPriority::Telemetry`
+    BlockEnd,  // end of a block with events
+    Control,   // event of a type registered with `EventPriority::Control`
+  };
+  static const size_t KIND_COUNT = 4;
+
+  enum class Outcome : uint8_t {
+    Queued,
+    Coalesced, // counted into a queued item of the same type and block
+    Dropped,   // shed, as the queue is full
+    Full,      // a control event that can't be queued; the caller must process it
+  };
+
+  struct Item {
+    Kind kind;
+    const EventType *type;     // nullptr for heartbeats and block ends
+    unsigned long blockHeight;
+    uint16_t count;            // events coalesced into this item; 1 for events
+    const char *payload;       // base64-encoded payload if the type has a handler, otherwise empty
+  };
+
+  IngestQueue(size_t capacity, size_t payloadCapacity, size_t highWatermark);
+  ~IngestQueue();
+
+  Outcome pushEvent(const EventType *type, unsigned long blockHeight, const char *payload);
+  Outcome pushBlockEnd(unsigned long blockHeight, bool heartbeat);
+  const Item *front() const; // oldest item, or nullptr if empty; valid until the next pop() or push
+  void pop();
+  void clear();
+
+  bool congested() const; // at or above the high watermark
+  size_t depth() const;
+  size_t getCapacity() const;
+  size_t highWaterMark() const;                     // largest depth since construction
+  unsigned long coalesced() const;                  // events counted into a queued item
+  unsigned long dropped(Kind kind) const;           // items of `kind` shed, incl. evicted ones
+  unsigned long full() const;                       // control events the caller had to process right away
+
+  private:
+  struct Slot {
+    Item item;
+    char *payloadBuffer; // owned by the slot; moves with the item when items are shifted
+  };
+
+  Slot &slotAt(size_t position) const; // position 0 is the oldest item
+  Outcome push(Kind kind, const EventType *type, unsigned long blockHeight, const char *payload);
+  bool evictBelow(Kind kind);
+  void recordDrop(Kind kind);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const size_t capacity;
+  const size_t payloadCapacity; // incl. the null terminator
+  const size_t highWatermark;
+  Slot *const slots;
+
+  // dynamic state parameters
+  size_t head;  // index of the oldest item
+  size_t count; // number of queued items
+  size_t peak;
+  unsigned long coalescedCount;
+  unsigned long droppedCount[KIND_COUNT];
+  unsigned long fullCount;
+};
@@ -0,0 +1,390 @@
+#include "JsonCadenceReader.h"
+
+// CLASS JsonCadenceReader
+
+// Heap-free pull parser extracting integer values from JSON-Cadence, read from a `Stream`.
+
+JsonCadenceReader::JsonCadenceReader(Stream &input)
+    : in(input), textLength(0), textTruncated(false), textInteger{false, false, 0} {
+  text[0] = '\0';
+}
+
+/* ── Events ───────────────────────────────────────────────────────────────────────────────── */
+
+// FUNCTION readEvent:
+// Example input (key order is not guaranteed):
+//   {"value": {"id": "A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged",
+//              "fields": [{"value": {"value": "15", "type": "Int64"}, "name": "value"}, ...]},
+//    "type": "Event"}
+JsonCadenceReader::Result JsonCadenceReader::readEvent(const char *expectedId, IntegerField *fields, size_t fieldCount) {
+  for (size_t i = 0; i < fieldCount; ++i)
+    fields[i].found = false;
+
+  if (nextToken() != Token::ObjectStart) return Result::MalformedJson;
+  bool isEvent = false;
+  bool idMatches = false;
+  while (true) {
+    Token token = nextToken();
+    if (token == Token::ObjectEnd) break;
+    if (token != Token::String) return Result::MalformedJson;
+
+    if (textEquals("type")) {
+      token = nextToken();
+      if (token == Token::String) isEvent = textEquals("Event");
+      else if (!skipValue(token)) return Result::MalformedJson;
+    } else if (textEquals("value")) {
+      if (nextToken() != Token::ObjectStart) return Result::NotAnEvent;
+      const Result result = readCompositeValue(expectedId, fields, fieldCount, idMatches);
+      if (result != Result::Ok) return result;
+    } else if (!skipValue(nextToken())) {
+      return Result::MalformedJson;
+    }
+  }
+
+  if (!isEvent) return Result::NotAnEvent;
+  if (!idMatches) return Result::UnexpectedEventId;
+  for (size_t i = 0; i < fieldCount; ++i)
+    if (!fields[i].found) return Result::MissingFields;
+  return Result::Ok;
+}
+
+// reads the remainder of the object `{"id": ..., "fields": [...]}`, whose opening brace was consumed already;
+// any id matches if `expectedId` is nullptr
+JsonCadenceReader::Result JsonCadenceReader::readCompositeValue(const char *expectedId, IntegerField *fields, size_t fieldCount, bool &idMatches) {
+  if (!expectedId) idMatches = true;
+  while (true) {
+    Token token = nextToken();
+    if (token == Token::ObjectEnd) return Result::Ok;
+    if (token != Token::String) return Result::MalformedJson;
+
+    if (textEquals("id")) {
+      token = nextToken();
+      if (token == Token::String) idMatches = !expectedId || textEquals(expectedId);
+      else if (!skipValue(token)) return Result::MalformedJson;
+    } else if (textEquals("fields")) {
+      token = nextToken();
+      if (token != Token::ArrayStart) {
+        if (!skipValue(token)) return Result::MalformedJson;
+        continue;
+      }
+      while ((token = nextToken()) != Token::ArrayEnd) {
+        if (token == Token::ObjectStart) {
+          if (!readField(fields, fieldCount)) return Result::MalformedJson;
+        } else if (!skipValue(token)) {
+          return Result::MalformedJson;
+        }
+      }
+    } else if (!skipValue(nextToken())) {
+      return Result::MalformedJson;
+    }
+  }
+}
+
+// reads the remainder of a field object `{"value": {"value": "15", "type": "Int64"}, "name": "value"}`,
+// whose opening brace was consumed already. As `value` may precede `name`, the value is parsed first
+// and only assigned once the object is complete.
+bool JsonCadenceReader::readField(IntegerField *fields, size_t fieldCount) {
+  IntegerField *field = nullptr;
+  Integer value = {false, false, 0};
+  while (true) {
+    Token token = nextToken();
+    if (token == Token::ObjectEnd) break;
+    if (token != Token::String) return false;
+
+    if (textEquals("name")) {
+      token = nextToken();
+      if (token != Token::String) {
+        if (!skipValue(token)) return false;
+        continue;
+      }
+      for (size_t i = 0; i < fieldCount && !field; ++i)
+        if (textEquals(fields[i].name)) field = &fields[i];
+    } else if (textEquals("value")) {
+      if (!readTypedValue(value)) return false;
+    } else if (!skipValue(nextToken())) {
+      return false;
+    }
+  }
+
+  assign(field, value);
+  return true;
+}
+
+void JsonCadenceReader::assign(IntegerField *field, const Integer &value) {
+  if (field && value.valid) {
+    field->found = field->isSigned ? toInt64(value, field->int64Value) : toUInt64(value, field->uint64Value);
+  }
+}
+
+/* ── Composites and dictionaries ──────────────────────────────────────────────────────────── */
+
+// FUNCTION readFields:
+// The kind of value is told apart by the shape of `value` (an object for composites, an array for dictionaries),
+// as `type` may come after it.
+JsonCadenceReader::Result JsonCadenceReader::readFields(IntegerField *fields, size_t fieldCount) {
+  for (size_t i = 0; i < fieldCount; ++i)
+    fields[i].found = false;
+
+  if (nextToken() != Token::ObjectStart) return Result::MalformedJson;
+  bool hasFields = false;
+  while (true) {
+    Token token = nextToken();
+    if (token == Token::ObjectEnd) break;
+    if (token != Token::String) return Result::MalformedJson;
+
+    if (textEquals("value")) {
+      token = nextToken();
+      if (token == Token::ObjectStart) {
+        bool idMatches = false;
+        const Result result = readCompositeValue(nullptr, fields, fieldCount, idMatches);
+        if (result != Result::Ok) return result;
+        hasFields = true;
+      } else if (token == Token::ArrayStart) {
+        if (!readDictionaryEntries(fields, fieldCount)) return Result::MalformedJson;
+        hasFields = true;
+      } else if (!skipValue(token)) {
+        return Result::MalformedJson;
+      }
+    } else if (!skipValue(nextToken())) {
+      return Result::MalformedJson;
+    }
+  }
+
+  if (!hasFields) return Result::NotAComposite;
+  for (size_t i = 0; i < fieldCount; ++i)
+    if (!fields[i].found) return Result::MissingFields;
+  return Result::Ok;
+}
+
+// reads the remainder of the array of entries `[{"key": {...}, "value": {...}}, ...]`, whose opening bracket
+// was consumed already
+bool JsonCadenceReader::readDictionaryEntries(IntegerField *fields, size_t fieldCount) {
+  Token token;
+  while ((token = nextToken()) != Token::ArrayEnd) {
+    if (token == Token::ObjectStart) {
+      if (!readDictionaryEntry(fields, fieldCount)) return false;
+    } else if (!skipValue(token)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// reads the remainder of an entry `{"key": {"value": "load1", "type": "String"}, "value": {"value": "5", ...}}`,
+// whose opening brace was consumed already. Like for fields, the value may precede the key.
+bool JsonCadenceReader::readDictionaryEntry(IntegerField *fields, size_t fieldCount) {
+  IntegerField *field = nullptr;
+  Integer value = {false, false, 0};
+  while (true) {
+    Token token = nextToken();
+    if (token == Token::ObjectEnd) break;
+    if (token != Token::String) return false;
+
+    if (textEquals("key")) {
+      if (!readKey(fields, fieldCount, field)) return false;
+    } else if (textEquals("value")) {
+      if (!readTypedValue(value)) return false;
+    } else if (!skipValue(nextToken())) {
+      return false;
+    }
+  }
+  assign(field, value);
+  return true;
+}
+
+// reads a typed key `{"value": "load1", "type": "String"}` and looks it up among `fields`
+bool JsonCadenceReader::readKey(IntegerField *fields, size_t fieldCount, IntegerField *&field) {
+  Token token = nextToken();
+  if (token != Token::ObjectStart) return skipValue(token);
+  while (true) {
+    token = nextToken();
+    if (token == Token::ObjectEnd) return true;
+    if (token != Token::String) return false;
+
+    if (textEquals("value")) {
+      token = nextToken();
+      if (token != Token::String) {
+        if (!skipValue(token)) return false;
+        continue;
+      }
+      for (size_t i = 0; i < fieldCount && !field; ++i)
+        if (textEquals(fields[i].name)) field = &fields[i];
+    } else if (!skipValue(nextToken())) {
+      return false;
+    }
+  }
+}
+
+/* ── Simple values ────────────────────────────────────────────────────────────────────────── */
+
+JsonCadenceReader::Result JsonCadenceReader::readIntegerValue(int64_t &value) {
+  Integer integer = {false, false, 0};
+  if (!readTypedValue(integer)) return Result::MalformedJson;
+  return toInt64(integer, value) ? Result::Ok : Result::NotAnInteger;
+}
+
+// reads a typed value `{"value": "<integer>", "type": ...}`; `integer.valid` is false for any other value
+bool JsonCadenceReader::readTypedValue(Integer &integer) {
+  integer.valid = false;
+  Token token = nextToken();
+  if (token != Token::ObjectStart) return skipValue(token);
+  while (true) {
+    token = nextToken();
+    if (token == Token::ObjectEnd) return true;
+    if (token != Token::String) return false;
+
+    if (textEquals("value")) {
+      token = nextToken();
+      if (token == Token::String) integer = textInteger;
+      else if (!skipValue(token)) return false;
+    } else if (!skipValue(nextToken())) {
+      return false;
+    }
+  }
+}
+
+/* ── Tokenizer ────────────────────────────────────────────────────────────────────────────── */
+
+JsonCadenceReader::Token JsonCadenceReader::nextToken() {
+  while (true) {
+    const int c = in.read();
+    switch (c) {
+      case -1:
+        return Token::End;
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+      case ':':
+      case ',':
+        continue;
+      case '{':
+        return Token::ObjectStart;
+      case '}':
+        return Token::ObjectEnd;
+      case '[':
+        return Token::ArrayStart;
+      case ']':
+        return Token::ArrayEnd;
+      case '"':
+        readText(true);
+        return Token::String;
+      default: // number, true, false, null
+        textLength = 0;
+        textTruncated = false;
+        textInteger = {true, false, 0};
+        appendText(c);
+        readText(false);
+        return Token::Primitive;
+    }
+  }
+}
+
+// Reads the characters of a string (after its opening quote) or of a primitive (after its first character)
+// into `text`, accumulating them into `textInteger` on the way.
+void JsonCadenceReader::readText(bool quoted) {
+  if (quoted) {
+    textLength = 0;
+    textTruncated = false;
+    textInteger = {true, false, 0};
+  }
+  while (true) {
+    int c = quoted ? in.read() : in.peek();
+    if (c < 0) break;
+    if (!quoted) {
+      if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') break;
+      in.read();
+    } else if (c == '"') {
+      break;
+    } else if (c == '\\') {
+      c = in.read();
+      switch (c) {
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': { // we only need ASCII; other code points are replaced by '?'
+          uint16_t codePoint = 0;
+          for (int i = 0; i < 4; ++i) {
+            const int h = in.read();
+            codePoint = (codePoint << 4) | (h >= 'a' ? h - 'a' + 10 : h >= 'A' ? h - 'A' + 10 : h - '0');
+          }
+          c = codePoint < 0x80 ? codePoint : '?';
+          break;
+        }
+        default: // '"', '\\', '/' stand for themselves
+          break;
+      }
+      if (c < 0) break;
+    }
+    appendText(c);
+  }
+  text[textLength] = '\0';
+  if (textLength == 0 || (textInteger.negative && textLength == 1)) textInteger.valid = false;
+}
+
+void JsonCadenceReader::appendText(char c) {
+  if (textLength + 1 < TEXT_CAPACITY) {
+    text[textLength++] = c;
+  } else {
+    textTruncated = true;
+  }
+
+  if (!textInteger.valid) return;
+  if (c == '-' && textLength == 1 && !textTruncated) {
+    textInteger.negative = true;
+  } else if (c >= '0' && c <= '9') {
+    const uint8_t digit = c - '0';
+    if (textInteger.magnitude > (UINT64_MAX - digit) / 10) textInteger.valid = false; // overflow
+    textInteger.magnitude = textInteger.magnitude * 10 + digit;
+  } else {
+    textInteger.valid = false;
+  }
+}
+
+// skips the value that starts with `token`, including all nested objects and arrays
+bool JsonCadenceReader::skipValue(Token token) {
+  if (token == Token::String || token == Token::Primitive) return true;
+  if (token != Token::ObjectStart && token != Token::ArrayStart) return false;
+  size_t depth = 1;
+  while (depth > 0) {
+    switch (nextToken()) {
+      case Token::ObjectStart:
+      case Token::ArrayStart:
+        ++depth;
+        break;
+      case Token::ObjectEnd:
+      case Token::ArrayEnd:
+        --depth;
+        break;
+      case Token::End:
+        return false;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+bool JsonCadenceReader::textEquals(const char *expected) const {
+  return !textTruncated && strcmp(text, expected) == 0;
+}
+
+bool JsonCadenceReader::toInt64(const Integer &integer, int64_t &value) {
+  if (!integer.valid) return false;
+  if (integer.negative) {
+    if (integer.magnitude > (uint64_t)INT64_MAX + 1) return false;
+    value = (int64_t)(0 - integer.magnitude); // well-defined for INT64_MIN as well
+    return true;
+  }
+  if (integer.magnitude > (uint64_t)INT64_MAX) return false;
+  value = (int64_t)integer.magnitude;
+  return true;
+}
+
+bool JsonCadenceReader::toUInt64(const Integer &integer, uint64_t &value) {
+  if (!integer.valid || integer.negative) return false;
+  value = integer.magnitude;
+  return true;
+}
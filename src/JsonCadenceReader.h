@@ -0,0 +1,90 @@
+#pragma once
+#include <Arduino.h>
+
+class JsonCadenceReader {
+
+  // This class is a small pull parser for JSON-Cadence values, the encoding in which Flow's Access API
+  // returns event payloads and script results. It reads the JSON text from a `Stream` (typically a
+  // `Base64DecodingStream`) character by character and extracts exactly the values we need, skipping
+  // everything else without materializing it.
+  //
+  // In JSON-Cadence, integers are encoded as decimal strings (e.g. `{"value": "15", "type": "Int64"}`).
+  // The digits are accumulated into a 64-bit integer while the string is being read, so neither an
+  // intermediate `String` nor `strtoll` is needed. Other strings (keys, type names, event ids) are
+  // copied into a fixed-size buffer for comparison; longer strings are truncated and never match.
+  //
+  // The reader uses no heap memory. It is lenient regarding JSON syntax: `:` and `,` are treated as
+  // whitespace. This is fine as the input is produced by the Access Node and not by humans.
+
+  public:
+  enum class Result {
+    Ok,
+    MalformedJson,     // unexpected token or premature end of input
+    NotAnEvent,        // event: value's type is not `Event`
+    UnexpectedEventId, // event: id differs from the expected one
+    MissingFields,     // event, fields: at least one requested field is absent or not an integer in range
+    NotAnInteger,      // value: not an integer, or out of range for int64_t
+    NotAComposite,     // fields: value is neither a composite (e.g. a struct) nor a dictionary
+  };
+
+  struct IntegerField {
+    const char *name; // field name as declared in the Cadence event or struct, or key of a dictionary
+    bool isSigned;    // Int* (true) or UInt* (false) Cadence type
+    bool found;       // set by readEvent() or readFields() if the field is present and its value fits the type
+    int64_t int64Value;   // valid if `found && isSigned`
+    uint64_t uint64Value; // valid if `found && !isSigned`
+  };
+
+  JsonCadenceReader(Stream &input);
+
+  // reads a Cadence event `{"value": {"id": ..., "fields": [...]}, "type": "Event"}` and extracts the
+  // requested integer fields
+  Result readEvent(const char *expectedId, IntegerField *fields, size_t fieldCount);
+
+  // reads a simple integer value, e.g. a script result `{"value": "0", "type": "Int64"}`
+  Result readIntegerValue(int64_t &value);
+
+  // reads a composite (struct, resource, event, ...) and extracts the requested integer fields, or a dictionary
+  // with `String` keys and extracts the values of the requested keys; e.g. a script result carrying several
+  // values at once: `{"value": {"id": "s.….Outputs", "fields": [...]}, "type": "Struct"}` or
+  // `{"value": [{"key": {"value": "load1", "type": "String"}, "value": {"value": "5", "type": "Int64"}}, ...],
+  //   "type": "Dictionary"}`
+  Result readFields(IntegerField *fields, size_t fieldCount);
+
+  static const size_t TEXT_CAPACITY = 96; // longest string (incl. null terminator) we compare against
+
+  private:
+  enum class Token { ObjectStart, ObjectEnd, ArrayStart, ArrayEnd, String, Primitive, End };
+
+  // decimal integer, accumulated while a string or primitive is being read
+  struct Integer {
+    bool valid;
+    bool negative;
+    uint64_t magnitude;
+  };
+
+  Token nextToken();
+  void readText(bool quoted);
+  void appendText(char c);
+  bool skipValue(Token token);
+  bool textEquals(const char *expected) const;
+  Result readCompositeValue(const char *expectedId, IntegerField *fields, size_t fieldCount, bool &idMatches);
+  bool readField(IntegerField *fields, size_t fieldCount);
+  bool readDictionaryEntries(IntegerField *fields, size_t fieldCount);
+  bool readDictionaryEntry(IntegerField *fields, size_t fieldCount);
+  bool readKey(IntegerField *fields, size_t fieldCount, IntegerField *&field);
+  void assign(IntegerField *field, const Integer &value);
+  bool readTypedValue(Integer &value);
+
+  static bool toInt64(const Integer &integer, int64_t &value);
+  static bool toUInt64(const Integer &integer, uint64_t &value);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  Stream &in;
+
+  // dynamic state parameters: most recent String or Primitive token
+  char text[TEXT_CAPACITY];
+  size_t textLength;
+  bool textTruncated;
+  Integer textInteger;
+};
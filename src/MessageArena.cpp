@@ -0,0 +1,146 @@
+#include "MessageArena.h"
+
+// CLASS MessageArena
+
+// Bump-pointer arena for per-message memory; reset as a whole after each message.
+
+MessageArena::MessageArena(size_t capacity)
+    : capacity(alignUp(capacity)), buffer(new uint8_t[alignUp(capacity)]), top(0), last(NONE), peak(0), failed(0) {
+}
+
+void *MessageArena::allocate(size_t size) {
+  const size_t required = HEADER + alignUp(size);
+  if (required > capacity - top) {
+    ++failed;
+    return nullptr;
+  }
+  last = top;
+  memcpy(buffer + last, &size, sizeof(size));
+  top += required;
+  if (top > peak) peak = top;
+  return buffer + last + HEADER;
+}
+
+// FUNCTION reallocate:
+// Resizes the most recent allocation in place; any other allocation is kept if it shrinks, and moved to
+// the top of the arena if it grows.
+void *MessageArena::reallocate(void *ptr, size_t size) {
+  if (!ptr) return allocate(size);
+
+  const size_t offset = (size_t)(static_cast<uint8_t *>(ptr) - buffer) - HEADER;
+  if (offset == last) {
+    const size_t required = HEADER + alignUp(size);
+    if (required > capacity - last) {
+      ++failed;
+      return nullptr;
+    }
+    memcpy(buffer + last, &size, sizeof(size));
+    top = last + required;
+    if (top > peak) peak = top;
+    return ptr;
+  }
+
+  const size_t oldSize = sizeOf(ptr);
+  if (size <= oldSize) return ptr;
+  void *moved = allocate(size);
+  if (moved) memcpy(moved, ptr, oldSize);
+  return moved;
+}
+
+// only the most recent allocation is actually released; everything else is reclaimed by reset()
+void MessageArena::deallocate(void *ptr) {
+  if (!ptr || last == NONE) return;
+  if ((size_t)(static_cast<uint8_t *>(ptr) - buffer) - HEADER == last) {
+    top = last;
+    last = NONE;
+  }
+}
+
+void MessageArena::reset() {
+  top = 0;
+  last = NONE;
+}
+
+size_t MessageArena::getCapacity() const {
+  return capacity;
+}
+
+size_t MessageArena::used() const {
+  return top;
+}
+
+size_t MessageArena::highWaterMark() const {
+  return peak;
+}
+
+unsigned long MessageArena::failures() const {
+  return failed;
+}
+
+size_t MessageArena::alignUp(size_t size) {
+  return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+size_t MessageArena::sizeOf(const void *ptr) const {
+  size_t size;
+  memcpy(&size, static_cast<const uint8_t *>(ptr) - HEADER, sizeof(size));
+  return size;
+}
+
+// CLASS ArenaJsonAllocator
+
+ArenaJsonAllocator::ArenaJsonAllocator(MessageArena *arena) : arena(arena) {
+}
+
+void *ArenaJsonAllocator::allocate(size_t size) {
+  return arena->allocate(size);
+}
+
+void ArenaJsonAllocator::deallocate(void *ptr) {
+  arena->deallocate(ptr);
+}
+
+void *ArenaJsonAllocator::reallocate(void *ptr, size_t newSize) {
+  return arena->reallocate(ptr, newSize);
+}
+
+// CLASS ArenaStringBuilder
+
+ArenaStringBuilder::ArenaStringBuilder(MessageArena *arena)
+    : arena(arena), text(nullptr), textLength(0), textCapacity(0), overflow(false) {
+}
+
+size_t ArenaStringBuilder::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t ArenaStringBuilder::write(const uint8_t *data, size_t length) {
+  if (textLength + length > textCapacity) {
+    size_t newCapacity = textCapacity < 32 ? 32 : textCapacity;
+    while (newCapacity < textLength + length)
+      newCapacity *= 2;
+    char *grown = static_cast<char *>(arena->reallocate(text, newCapacity + 1)); // +1 for null terminator
+    if (!grown) {
+      overflow = true;
+      return 0;
+    }
+    text = grown;
+    textCapacity = newCapacity;
+  }
+  memcpy(text + textLength, data, length);
+  textLength += length;
+  text[textLength] = '\0';
+  return length;
+}
+
+const char *ArenaStringBuilder::c_str() const {
+  return text ? text : "";
+}
+
+size_t ArenaStringBuilder::length() const {
+  return textLength;
+}
+
+bool ArenaStringBuilder::overflowed() const {
+  return overflow;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class MessageArena {
+
+  // This class is a bump-pointer arena for the transient memory needed while processing one WebSocket
+  // message (JSON document, strings). Allocating is just advancing an offset into a buffer that is
+  // allocated once at construction; individual allocations are not freed. Instead, the whole arena
+  // is `reset()` once the message has been processed. Hence, processing messages in steady state
+  // does not touch the general heap at all and can't fragment it, no matter how long the device runs.
+  //
+  // To support ArduinoJson's growing strings and pools, the most recent allocation can be resized
+  // (and freed) in place. Resizing any other allocation moves it to the top of the arena.
+  //
+  // When the arena is exhausted, allocations return nullptr; ArduinoJson reports this as `NoMemory`.
+
+  public:
+  MessageArena(size_t capacity);
+
+  void *allocate(size_t size);
+  void *reallocate(void *ptr, size_t size);
+  void deallocate(void *ptr);
+  void reset(); // CAUTION: invalidates all memory handed out by the arena
+
+  size_t getCapacity() const;
+  size_t used() const;
+  size_t highWaterMark() const;  // largest `used()` since construction
+  unsigned long failures() const; // number of allocations that did not fit
+
+  private:
+  static size_t alignUp(size_t size);
+  size_t sizeOf(const void *ptr) const;
+
+  static const size_t ALIGNMENT = 8; // satisfies 64-bit values
+  static const size_t HEADER = 8;    // each allocation is preceded by its size, keeping it aligned
+  static const size_t NONE = (size_t)-1;
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const size_t capacity;
+  uint8_t *const buffer;
+
+  // dynamic state parameters
+  size_t top;  // offset of the first free byte
+  size_t last; // offset of the most recent allocation's header, or NONE
+  size_t peak;
+  unsigned long failed;
+};
+
+class ArenaJsonAllocator : public ArduinoJson::Allocator {
+
+  // ArduinoJson allocator placing a JsonDocument's pools and strings into a `MessageArena`.
+
+  public:
+  ArenaJsonAllocator(MessageArena *arena);
+
+  void *allocate(size_t size) override;
+  void deallocate(void *ptr) override;
+  void *reallocate(void *ptr, size_t newSize) override;
+
+  private:
+  MessageArena *const arena;
+};
+
+class ArenaStringBuilder : public Print {
+
+  // Null-terminated string assembled in a `MessageArena`, e.g. by `serializeJson(doc, builder)`.
+  // As long as nothing else is allocated from the arena while building, appending grows the string
+  // in place. If the arena is exhausted, further characters are dropped and `overflowed()` is true.
+
+  public:
+  ArenaStringBuilder(MessageArena *arena);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t length) override;
+  const char *c_str() const;
+  size_t length() const;
+  bool overflowed() const;
+
+  private:
+  MessageArena *const arena;
+  char *text;
+  size_t textLength;
+  size_t textCapacity; // bytes available for characters, excluding the null terminator
+  bool overflow;
+};
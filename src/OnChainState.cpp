@@ -1,23 +1,33 @@
-#include "mbedtls/base64.h" // bundled with ESP32‑Arduino core
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
+#include <inttypes.h>
 #include <tuple>
 
+#include "Base64DecodingStream.h"
+#include "JsonCadenceReader.h"
 #include "OnChainState.h"
 
 const String OnChainState::Cadence_Script_Retrieving_Led_State = R"({"script": "aW1wb3J0IE1pY3JvY29udHJvbGxlclRlc3QgZnJvbSAweDBkM2M4ZDAyYjAyY2ViNGMKCmFjY2VzcyhhbGwpIGZ1biBtYWluKCk6IEludDY0IHsKICByZXR1cm4gTWljcm9jb250cm9sbGVyVGVzdC5Db250cm9sVmFsdWUKfQ==", "arguments": []})";
 
-OnChainState::OnChainState(String flowRestAccess) : url(flowRestAccess), postBody(Cadence_Script_Retrieving_Led_State) {
+// the REST API serves the events of at most this many blocks per request
+static const unsigned long EVENTS_PAGE_BLOCKS = 250;
+
+// response headers HTTPClient has to keep for us, to read the body from the connection
+static const char *RESPONSE_HEADERS[] = {"Transfer-Encoding"};
+
+OnChainState::OnChainState(String flowRestAccess)
+    : url(flowRestAccess), postBody(Cadence_Script_Retrieving_Led_State), requestCount(0), reusedCount(0) {
+  // Keep the TCP (and TLS) connection open after a response, so a state recovery -- reading the sealed block,
+  // then executing the script at that block -- pays for the handshakes at most once.
+  http.setReuse(true);
 }
 
+// FUNCTION get_latest_sealed_block:
+// The response is an array with the sealed block, which carries its payload (collection guarantees, seals) along with
+// the header. The filter keeps only the height, so the rest is skipped as it streams by rather than stored.
 std::tuple<unsigned long, bool> OnChainState::get_latest_sealed_block() {
-  unsigned long latestSealedHeight = 0;
-  bool success = false;
-
-  HTTPClient http;
-  http.begin(url + "blocks?height=sealed");
-  const int httpResponseCode = http.GET();
+  const int httpResponseCode = request("blocks?height=sealed", nullptr);
   if (httpResponseCode <= 0) {
     Serial.print(F("   ❌ Get sealed block error code: "));
     Serial.println(httpResponseCode);
@@ -25,177 +35,316 @@ std::tuple<unsigned long, bool> OnChainState::get_latest_sealed_block() {
     return std::make_tuple(0, false);
   }
 
-  String rawResponse = http.getString();
-  DynamicJsonDocument response(4096); // Adjust size as needed
-  DeserializationError err = deserializeJson(response, rawResponse);
+  JsonDocument filter;
+  filter[0]["header"]["height"] = true;
+
+  HttpBodyStream body = responseBody();
+  JsonDocument response;
+  const DeserializationError err = deserializeJson(response, body, DeserializationOption::Filter(filter));
+  endResponse(body);
   if (err) {
-    Serial.print("Parsing response for script execution request failed! Error: ");
+    Serial.print(F("   ❌ Parsing response for latest sealed block failed! Error: "));
     Serial.println(err.c_str());
-    http.end();
     return std::make_tuple(0, false);
   }
 
-  // uncomment for debugging:
-  // Serial.println("Result for script execution request:");
-  // serializeJsonPretty(response, Serial);
-  // Serial.println("\n");
-
   // check that response contains at least one element:
-  if (response.size() == 0) {
-    Serial.println(F("   ❌ Response for latest sealed block is empty"));
-    http.end();
+  if (!response.is<JsonArray>() || response.size() == 0) {
+    Serial.print(F("   ❌ Response for latest sealed block is empty, status code: "));
+    Serial.println(httpResponseCode);
     return std::make_tuple(0, false);
   }
-  JsonVariant latestStealedBlock = response[0];
 
-  if (!latestStealedBlock.containsKey("header")) {
-    Serial.println(F("   ❌ Response for latest sealed block does not contain header"));
-    http.end();
-    return std::make_tuple(0, false);
-  }
-  latestStealedBlock = latestStealedBlock["header"];
+  // the REST API encodes 64-bit integers as strings
+  JsonVariant height = response[0]["header"]["height"];
+  if (height.is<const char *>()) return std::make_tuple(strtoul(height.as<const char *>(), nullptr, 10), true);
+  if (height.is<unsigned long>()) return std::make_tuple(height.as<unsigned long>(), true);
+  Serial.println(F("   ❌ Response for latest sealed block does not contain header.height"));
+  return std::make_tuple(0, false);
+}
 
-  if (!latestStealedBlock.containsKey("height")) {
-    Serial.println(F("   ❌ Response for latest sealed block does not contain height"));
-    http.end();
-    return std::make_tuple(0, false);
+String OnChainState::getURL() {
+  return url;
+}
+
+unsigned long OnChainState::requests() const {
+  return requestCount;
+}
+
+unsigned long OnChainState::reusedRequests() const {
+  return reusedCount;
+}
+
+// FUNCTION request:
+// Sends a GET request for `target` (relative to `url`), or a POST request if there is a `body`, on the kept-alive
+// connection. The server may have closed that connection since the previous request (idle timeout); then the
+// request fails without a response and is retried once, on a new connection. A request that timed out is not
+// retried: the connection was alive, but the node did not answer in time, and waiting again would only double the
+// time until the caller can fail over to another node. The caller reads the response via
+// `responseBody()` and finishes it with `endResponse()`, which keeps the connection open for the next request.
+int OnChainState::request(const String &target, const char *body) {
+  ++requestCount;
+  for (int attempt = 0; true; ++attempt) {
+    const bool reusing = http.connected();
+    http.begin(url + target);
+    http.collectHeaders(RESPONSE_HEADERS, 1);
+    if (body) http.addHeader(F("Content-Type"), F("application/json"));
+    const int httpResponseCode = body ? http.POST(reinterpret_cast<uint8_t *>(const_cast<char *>(body)), strlen(body)) : http.GET();
+    if (httpResponseCode > 0) {
+      if (reusing) ++reusedCount;
+      return httpResponseCode;
+    }
+    if (!reusing || attempt > 0 || httpResponseCode == HTTPC_ERROR_READ_TIMEOUT) return httpResponseCode;
+    http.end(); // HTTPClient closed the stale connection already; the next attempt opens a new one
+    Serial.println(F("   ↪️ kept-alive connection was closed by the server, reconnecting"));
   }
-  latestSealedHeight = latestStealedBlock["height"];
-  success = true;
+}
+
+// FUNCTION responseBody:
+// The body of the response to the latest request, read straight from the connection. HTTPClient has consumed the
+// headers, but leaves the transfer encoding to us.
+HttpBodyStream OnChainState::responseBody() {
+  String transferEncoding = http.header(RESPONSE_HEADERS[0]);
+  transferEncoding.toLowerCase();
+  return HttpBodyStream(http.getStream(), transferEncoding.indexOf("chunked") >= 0, http.getSize());
+}
 
-  // Free resources
+// FUNCTION endResponse:
+// Consumes what the parser left of the body, so the next response on the kept-alive connection starts at its
+// status line. If the body did not end properly, the connection is in an unknown state and closed instead.
+void OnChainState::endResponse(HttpBodyStream &body) {
+  if (!body.drain()) {
+    Serial.println(F("   ⚠️ response body ended prematurely, closing the connection"));
+    http.getStream().stop();
+  }
   http.end();
-  return std::make_tuple(latestSealedHeight, success);
 }
 
-String OnChainState::getURL() {
-  return url;
+// FUNCTION forEachEvent:
+// Queries the events of type `eventType` in blocks `startHeight` to `endHeight` (inclusive) and passes each of
+// them to `visitor`, in the order of the chain. Ranges longer than the REST API permits are queried in pages.
+// Returns false if a request or parsing its response failed; events visited until then remain visited.
+bool OnChainState::forEachEvent(const char *eventType, unsigned long startHeight, unsigned long endHeight, EventVisitor visitor) {
+  for (unsigned long pageStart = startHeight; pageStart <= endHeight; pageStart += EVENTS_PAGE_BLOCKS) {
+    const unsigned long pageEnd = endHeight - pageStart < EVENTS_PAGE_BLOCKS ? endHeight : pageStart + EVENTS_PAGE_BLOCKS - 1;
+    if (!visitEventsPage(eventType, pageStart, pageEnd, visitor)) return false;
+    if (pageEnd == endHeight) break; // avoids overflowing `pageStart`
+  }
+  return true;
 }
 
-std::tuple<int64_t, bool> OnChainState::get_led_state_at_block(unsigned long blockHeight) {
-  Serial.println(F("➡️ Sending script execution request to rerieve on-chain state:"));
-  HTTPClient http;
-  http.begin(url + "scripts?block_height=" + String(blockHeight));
-  http.addHeader(F("Content-Type"), F("application/json"));
-  int httpResponseCode = http.POST(postBody);
+// skips whitespace in `body` and returns the next character without consuming it; -1 at the end of the body
+static int peekNonWhitespace(HttpBodyStream &body) {
+  int c = body.peek();
+  while (c >= 0 && isspace(c)) {
+    body.read();
+    c = body.peek();
+  }
+  return c;
+}
 
+// FUNCTION visitEventsPage:
+// One request of forEachEvent. The response is an array with one element per block:
+//   [ { "block_id": "…", "block_height": "1234", "block_timestamp": "…",
+//       "events": [ { "type": "A.….ControlValueChanged", "transaction_id": "…", "transaction_index": "0",
+//                     "event_index": "0", "payload": "<base64-encoded JSON-Cadence>" } ] }, … ]
+// Instead of buffering the whole response, the blocks are parsed one by one straight from the connection, so
+// memory is bounded by a single block's events rather than by the length of the range.
+bool OnChainState::visitEventsPage(const char *eventType, unsigned long startHeight, unsigned long endHeight, EventVisitor visitor) {
+  const int httpResponseCode = request("events?type=" + String(eventType) + "&start_height=" + String(startHeight) + "&end_height=" + String(endHeight), nullptr);
   if (httpResponseCode <= 0) {
-    Serial.print(F("   ❌ Request error code: "));
+    Serial.print(F("   ❌ Events query error code: "));
     Serial.println(httpResponseCode);
     http.end();
-    return std::make_tuple(0, false);
+    return false;
+  }
+  HttpBodyStream body = responseBody();
+  if (httpResponseCode != 200) {
+    Serial.print(F("   ❌ Events query error code: "));
+    Serial.println(httpResponseCode);
+    endResponse(body);
+    return false;
   }
 
-  String rawResponse = http.getString();
-  Serial.println(F("   ⬅️ received script execution response:"));
-  // uncomment for debugging:
-  // Serial.println(rawResponse);
-  // Serial.println("\n");
+  JsonDocument filter;
+  filter["block_height"] = true;
+  filter["events"][0]["type"] = true;
+  filter["events"][0]["payload"] = true;
 
-  std::tuple<String, bool> payload = extractPayloadFromResponse(rawResponse);
-  if (!std::get<1>(payload)) {
-    Serial.println(rawResponse);
-    http.end();
-    return std::make_tuple(0, false);
+  bool success = body.find("[");
+  if (!success) Serial.println(F("   ❌ Events query response is not an array"));
+  int next = success ? peekNonWhitespace(body) : -1;
+  while (success && next != ']') {
+    JsonDocument block;
+    const DeserializationError err = deserializeJson(block, body, DeserializationOption::Filter(filter));
+    if (err) {
+      Serial.print(F("   ❌ Parsing events query response failed: "));
+      Serial.println(err.c_str());
+      success = false;
+      break;
+    }
+    const unsigned long blockHeight = strtoul(block["block_height"] | "0", nullptr, 10);
+    for (JsonObject event : block["events"].as<JsonArray>()) {
+      visitor(blockHeight, event["type"] | "", event["payload"] | "");
+    }
+
+    next = peekNonWhitespace(body); // ',' before the next block or ']' at the end
+    if (next == ',') {
+      body.read();
+      next = peekNonWhitespace(body);
+    }
+    if (next < 0) {
+      Serial.println(F("   ❌ Events query response ended prematurely"));
+      success = false;
+    }
   }
 
-  std::tuple<int64_t, bool> controlValue = parsePayload(std::get<0>(payload));
-  if (!std::get<1>(controlValue)) {
-    Serial.println(rawResponse);
-    Serial.println();
-    http.end();
-    return std::make_tuple(0, false);
+  endResponse(body);
+  return success;
+}
+
+// appends the base64 encoding (RFC 4648, with padding) of `length` bytes at `data` to `out`
+static void appendBase64(String &out, const char *data, size_t length) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (size_t i = 0; i < length; i += 3) {
+    const size_t n = length - i < 3 ? length - i : 3;
+    uint32_t bits = (uint32_t)(uint8_t)data[i] << 16;
+    if (n > 1) bits |= (uint32_t)(uint8_t)data[i + 1] << 8;
+    if (n > 2) bits |= (uint8_t)data[i + 2];
+    out += ALPHABET[(bits >> 18) & 63];
+    out += ALPHABET[(bits >> 12) & 63];
+    out += n > 1 ? ALPHABET[(bits >> 6) & 63] : '=';
+    out += n > 2 ? ALPHABET[bits & 63] : '=';
   }
+}
 
-  http.end();
-  return std::make_tuple(std::get<0>(controlValue), true);
+// FUNCTION scriptRequestBody:
+// `{"script": "<base64>", "arguments": ["<base64>", ...]}`, where each argument is its JSON-Cadence encoding
+// (`{"type": "UInt8", "value": "3"}`), base64-encoded on its own
+static String scriptRequestBody(const char *base64Script, const OnChainState::ScriptArgument *arguments, size_t argumentCount) {
+  String body = String("{\"script\": \"") + base64Script + "\", \"arguments\": [";
+  for (size_t i = 0; i < argumentCount; ++i) {
+    const String argument = String("{\"type\":\"") + arguments[i].type + "\",\"value\":\"" + arguments[i].value + "\"}";
+    if (i > 0) body += ", ";
+    body += '"';
+    appendBase64(body, argument.c_str(), argument.length());
+    body += '"';
+  }
+  body += "]}";
+  return body;
 }
 
-// FUNCTION extractPayloadFromResponse:
-// Takes the raw HTTP-Get response and differentiates happy path from error case. There are two expected responses cases:
+// FUNCTION openScriptResult:
+// Reads the beginning of a script execution response from `body` and differentiates happy path from error case.
+// There are two expected responses cases:
 //
 // Case 1. In case of an error, the response is a JSON object with the following structure:
 //   {
 //   "code" : 404,
 //   "message" : "Flow resource not found: not found: block height 0 is less than the spork root block height 218215349. Try to use a historic node: failed to retrieve block ID for height 0: could not retrieve resource: key not found"
 //   }
-//   Here, we want to detect the error and return false.
+//   Here, we want to detect the error, log it and return false.
 //
 // Case 2. In case of a successful request, the response is a JSON containing soleley the base64-encoded payload:
 //   "eyJ2YWx1ZSI6IjAiLCJ0eXBlIjoiSW50NjQifQo="
-//   Then, we want to continue just the string without the qote signs.
-std::tuple<String, bool> OnChainState::extractPayloadFromResponse(String rawResponse) {
+//   Then, the opening quote is consumed, so the payload can be decoded straight from `body`.
+static bool openScriptResult(HttpBodyStream &body) {
+  const int first = peekNonWhitespace(body);
+
   // Case 1. Detect error response (JSON object)
-  rawResponse.trim();
-  bool isError = false;
-  if (rawResponse.startsWith("{")) {
-    // Error case: parse JSON and check for "code"
-    StaticJsonDocument<1024> errorDoc;
-    DeserializationError err = deserializeJson(errorDoc, rawResponse);
-    if (!err && errorDoc.containsKey("code")) {
-      Serial.println(F("   ❌ Error response:"));
+  if (first == '{') {
+    JsonDocument filter;
+    filter["code"] = true;
+    filter["message"] = true;
+    JsonDocument errorDoc;
+    const DeserializationError err = deserializeJson(errorDoc, body, DeserializationOption::Filter(filter));
+    if (!err && errorDoc["code"].is<int>()) {
+      Serial.printf("   ❌ Error response: %d %s\n", errorDoc["code"].as<int>(), errorDoc["message"] | "");
     } else {
-      Serial.println(F("   ❌ Unexpected response structure:"));
+      Serial.println(F("   ❌ Unexpected response structure"));
     }
-    return std::make_tuple("", false);
-  }
-
-  // Case 2. treat as base64-encoded string and attempt to decode it
-  // Success case: base64 string, expected in quotation chars
-  String base64Payload = rawResponse;
-  if (!base64Payload.startsWith("\"") || !base64Payload.endsWith("\"")) {
-    Serial.println(F("   ❌ Unexpected response structure:"));
-    return std::make_tuple("", false);
-  }
-  base64Payload = base64Payload.substring(1, base64Payload.length() - 1);
-  return std::make_tuple(base64Payload, true);
-}
-
-// FUNCTION parsePayload:
-// 1. extract the controller state from a Base64 string.
-std::tuple<int64_t, bool> OnChainState::parsePayload(String rawResponse) {
-  // Allocate a buffer big enough for decoded data and decode Base64 into it.
-  // mbedTLS provides a two-step approach (safe and recommended) for dynamic buffer allocation.
-  const size_t encpayloadLen = strlen(rawResponse.c_str());
-  size_t decodedLen = 0; // calling mbedtls_base64_decode first input *dst = NULL or second input dlen = 0 writes the required buffer size in `decodedLen` (third input)
-  mbedtls_base64_decode(nullptr, 0, &decodedLen, reinterpret_cast<const unsigned char *>(rawResponse.c_str()), encpayloadLen);
-  char *decoded = static_cast<char *>(malloc(decodedLen + 1)); // +1 for null terminator
-  if (!decoded) {
-    Serial.println(F("   ❌ malloc failed"));
-    return std::make_tuple(0, false);
+    return false;
   }
-  int rc = mbedtls_base64_decode(reinterpret_cast<unsigned char *>(decoded), decodedLen, &decodedLen,
-                                 reinterpret_cast<const unsigned char *>(rawResponse.c_str()), encpayloadLen);
-  if (rc != 0) { // `mbedtls_base64_decode` returning 0 indicates successful decoding
-    Serial.printf("   ❌ Base64 decode error (code %d)\n", rc);
-    free(decoded);
-    return std::make_tuple(0, false);
-  }
-  decoded[decodedLen] = '\0'; // Ensure null‑terminated string
 
-  // 3. Parse JSON and extract fields
-  StaticJsonDocument<2048> scriptResult;
-  DeserializationError err = deserializeJson(scriptResult, decoded);
-  if (err) {
-    Serial.print(F("   ❌ JSON parse failed:"));
-    Serial.println(err.c_str());
-    free(decoded);
-    return std::make_tuple(0, false);
+  // Case 2. Base64-encoded string, expected in quotation chars
+  if (first != '"') {
+    Serial.println(F("   ❌ Unexpected response structure"));
+    return false;
   }
+  body.read();
+  Serial.println(F("   ⬅️ received script execution response:"));
+  return true;
+}
 
-  if (!scriptResult.containsKey("value")) {
-    Serial.print(F("   ❌ Missing 'value' key in JSON response:"));
-    serializeJsonPretty(scriptResult, Serial);
-    Serial.println("\n");
-    free(decoded);
-    return std::make_tuple(0, false);
+// FUNCTION checkScriptResult:
+// logs why decoding a script result failed, if it did
+static bool checkScriptResult(const Base64DecodingStream &decoded, JsonCadenceReader::Result result) {
+  if (decoded.failed()) {
+    Serial.println(F("   ❌ Base64 decode error"));
+    return false;
+  }
+  if (result == JsonCadenceReader::Result::MalformedJson) {
+    Serial.println(F("   ❌ JSON parse failed"));
+    return false;
+  }
+  if (result != JsonCadenceReader::Result::Ok) {
+    Serial.println(F("   ❌ Missing or non-integer values in the script result"));
+    return false;
   }
+  return true;
+}
 
-  String valueStr = scriptResult["value"];
-  int64_t value = strtoll(valueStr.c_str(), nullptr, 10);
-  Serial.printf("    current led sate: %s\n", valueStr);
+std::tuple<int64_t, bool> OnChainState::get_led_state_at_block(unsigned long blockHeight) {
+  Serial.println(F("➡️ Sending script execution request to rerieve on-chain state:"));
+  if (!requestScript(blockHeight, postBody.c_str())) return std::make_tuple(0, false);
+
+  HttpBodyStream body = responseBody();
+  int64_t value = 0;
+  bool success = openScriptResult(body);
+  if (success) {
+    Base64DecodingStream decoded(body, '"'); // straight from the response, up to the string's closing quote
+    JsonCadenceReader scriptResult(decoded);
+    success = checkScriptResult(decoded, scriptResult.readIntegerValue(value));
+  }
+  endResponse(body);
+  if (!success) return std::make_tuple(0, false);
 
-  // Free resources
-  free(decoded);
+  Serial.printf("    current led sate: %" PRId64 "\n", value);
   return std::make_tuple(value, true);
-}
\ No newline at end of file
+}
+
+// FUNCTION executeScript:
+// Example: a script returning `{String: Int64}`, with the keys `"load1"` and `"load2"`, is read via
+//   JsonCadenceReader::IntegerField outputs[] = {{"load1", true, false, 0, 0}, {"load2", true, false, 0, 0}};
+//   executeScript(script, nullptr, 0, blockHeight, outputs, 2);
+bool OnChainState::executeScript(const char *base64Script, const ScriptArgument *arguments, size_t argumentCount,
+                                 unsigned long blockHeight, JsonCadenceReader::IntegerField *outputs, size_t outputCount) {
+  Serial.printf("➡️ Sending script execution request for %u values:\n", (unsigned)outputCount);
+  if (!requestScript(blockHeight, scriptRequestBody(base64Script, arguments, argumentCount).c_str())) return false;
+
+  HttpBodyStream body = responseBody();
+  bool success = openScriptResult(body);
+  if (success) {
+    Base64DecodingStream decoded(body, '"');
+    JsonCadenceReader scriptResult(decoded);
+    const JsonCadenceReader::Result result = scriptResult.readFields(outputs, outputCount);
+    if (result == JsonCadenceReader::Result::MissingFields) {
+      for (size_t i = 0; i < outputCount; ++i)
+        if (!outputs[i].found) Serial.printf("   ❌ '%s' is missing in the script result or not an integer in range\n", outputs[i].name);
+    }
+    success = checkScriptResult(decoded, result);
+  }
+  endResponse(body);
+  return success;
+}
+
+// FUNCTION requestScript:
+// sends the script execution request; if it fails without a response, logs the error and ends the request
+bool OnChainState::requestScript(unsigned long blockHeight, const char *requestBody) {
+  const int httpResponseCode = request("scripts?block_height=" + String(blockHeight), requestBody);
+  if (httpResponseCode > 0) return true;
+  Serial.print(F("   ❌ Request error code: "));
+  Serial.println(httpResponseCode);
+  http.end();
+  return false;
+}
@@ -1,7 +1,11 @@
 #pragma once
 #include <Arduino.h>
+#include <HTTPClient.h>
 #include <tuple>
 
+#include "HttpBodyStream.h"
+#include "JsonCadenceReader.h"
+
 class OnChainState {
   public:
   OnChainState(String flowRestAccess);
@@ -9,16 +13,41 @@ class OnChainState {
   std::tuple<int64_t, bool> get_led_state_at_block(unsigned long block); // explicit on/off logic
   String getURL();
 
+  // typed script argument, as in JSON-Cadence; for types whose value is encoded as a string, e.g.
+  // {"Address", "0x0d3c8d02b02ceb4c"}, {"UInt8", "3"} or {"String", "load1"}
+  struct ScriptArgument {
+    const char *type;
+    const char *value; // must not contain characters that need escaping in JSON
+  };
+
+  // executes `base64Script` with `arguments` at block `blockHeight` and extracts `outputs` from its result: the
+  // fields of a returned struct, or the values of a returned dictionary with String keys. Hence, a script
+  // returning all values a controller needs restores them with a single request.
+  bool executeScript(const char *base64Script, const ScriptArgument *arguments, size_t argumentCount,
+                     unsigned long blockHeight, JsonCadenceReader::IntegerField *outputs, size_t outputCount);
+
+  // visits one event obtained via the REST API
+  typedef void (*EventVisitor)(unsigned long blockHeight, const char *type, const char *payload);
+  bool forEachEvent(const char *eventType, unsigned long startHeight, unsigned long endHeight, EventVisitor visitor);
+
+  unsigned long requests() const;       // via the kept-alive connection
+  unsigned long reusedRequests() const; // of those, the ones that didn't need to open a new connection
+
   static const String Cadence_Script_Retrieving_Led_State;
 
   private:
-  std::tuple<String, bool> extractPayloadFromResponse(String rawResponse);
-  std::tuple<int64_t, bool> parsePayload(String rawResponse);
+  int request(const String &target, const char *body);
+  HttpBodyStream responseBody();
+  void endResponse(HttpBodyStream &body);
+  bool requestScript(unsigned long blockHeight, const char *requestBody);
+  bool visitEventsPage(const char *eventType, unsigned long startHeight, unsigned long endHeight, EventVisitor visitor);
 
   // behavioral parameters are lifetime-constants (provided at construction)
   const String url;
   const String postBody;
 
-  // behavioral parameters are lifetime-constants (provided at construction) dynamic state parameters
-  // none
+  // dynamic state parameters
+  HTTPClient http; // keeps the connection to the Access Node alive between requests
+  unsigned long requestCount;
+  unsigned long reusedCount;
 };
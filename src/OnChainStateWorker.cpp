@@ -0,0 +1,122 @@
+#include <HTTPClient.h>
+
+#include "OnChainStateWorker.h"
+
+// CLASS OnChainStateWorker
+
+// Executes REST requests to the Access Node on a dedicated task, decoupled from the submitting task by two queues.
+
+OnChainStateWorker::OnChainStateWorker(Completion completion, unsigned long probeTimeoutMS)
+    : completion(completion), probeTimeoutMS(probeTimeoutMS), nextTicket(1), pending(0), state(nullptr), requestCount(0), reusedCount(0) {
+}
+
+uint32_t OnChainStateWorker::submit(Request request, const String &restURL, unsigned long blockHeight) {
+  if (pending >= MAX_IN_FLIGHT) {
+    Serial.println(F("❌ Too many on-chain state requests in flight, request rejected"));
+    return 0;
+  }
+  Job job;
+  if (restURL.length() >= sizeof(job.restURL)) {
+    Serial.println(F("❌ REST URL of the access node is too long, request rejected"));
+    return 0;
+  }
+  job.ticket = nextTicket;
+  job.request = request;
+  job.submittedMS = millis();
+  job.blockHeight = blockHeight;
+  strcpy(job.restURL, restURL.c_str());
+  if (!jobs.push(job)) return 0; // can't happen, as `pending` bounds the queue
+  nextTicket = nextTicket == UINT32_MAX ? 1 : nextTicket + 1;
+  ++pending;
+  return job.ticket;
+}
+
+bool OnChainStateWorker::poll() {
+  bool delivered = false;
+  Result result;
+  while (results.pop(result)) {
+    --pending;
+    delivered = true;
+    completion(result);
+  }
+  return delivered;
+}
+
+size_t OnChainStateWorker::inFlight() const {
+  return pending;
+}
+
+// FUNCTION work:
+// Takes the next request off the queue and executes it, blocking the worker task for as long as the Access Node
+// takes to respond (bounded by the HTTP timeouts).
+bool OnChainStateWorker::work() {
+  Job job;
+  if (!jobs.pop(job)) return false;
+
+  Result result = {job.ticket, job.request, false, 0, 0, 0, 0};
+  switch (job.request) {
+    case Request::ReadControllerState:
+      readControllerState(job, result);
+      requestCount.store(state->requests(), std::memory_order_relaxed);
+      reusedCount.store(state->reusedRequests(), std::memory_order_release);
+      break;
+    case Request::ProbeLatency:
+      probeLatency(job, result);
+      break;
+  }
+  result.elapsedMS = millis() - job.submittedMS;
+  results.push(result); // never full, as `pending` bounds the queue
+  return true;
+}
+
+// FUNCTION requestCounts:
+// Reading `reusedCount` first, with acquire semantics, yields a `requestCount` at least as recent, so the reused
+// requests never exceed the requests. (Both only grow, except when the worker switches to another Access Node.)
+void OnChainStateWorker::requestCounts(unsigned long &requests, unsigned long &reusedRequests) const {
+  reusedRequests = reusedCount.load(std::memory_order_acquire);
+  requests = requestCount.load(std::memory_order_relaxed);
+}
+
+// FUNCTION readControllerState:
+//  1. unless the job names the block, reads the latest sealed block from the Flow access node via a rest call
+//  2. executes the script to read the on-chain state via script execution at that block
+void OnChainStateWorker::readControllerState(const Job &job, Result &result) {
+  if (!state || state->getURL() != job.restURL) { // a different Access Node than the previous state read's
+    delete state;
+    state = new OnChainState(job.restURL);
+  }
+
+  result.blockHeight = job.blockHeight;
+  if (result.blockHeight == 0) {
+    const std::tuple<unsigned long, bool> latestSealedBlock = state->get_latest_sealed_block();
+    if (!std::get<1>(latestSealedBlock)) {
+      Serial.println(F("   ❌ Failed to get latest sealed block"));
+      return;
+    }
+    result.blockHeight = std::get<0>(latestSealedBlock);
+    Serial.printf("   latest sealed block: %lu\n", result.blockHeight);
+  }
+
+  const std::tuple<int64_t, bool> scriptResult = state->get_led_state_at_block(result.blockHeight);
+  if (!std::get<1>(scriptResult)) {
+    Serial.println(F("   ❌ Read of on-chain state failed"));
+    return;
+  }
+  result.controllerState = std::get<0>(scriptResult);
+  result.success = true;
+}
+
+// FUNCTION probeLatency:
+// health and latency probe: round-trip time of requesting the latest sealed block header from the Access Node,
+// on a new connection, so the handshakes count as they would when failing over. The response body is not even read.
+void OnChainStateWorker::probeLatency(const Job &job, Result &result) {
+  HTTPClient http;
+  http.setConnectTimeout(probeTimeoutMS);
+  http.setTimeout(probeTimeoutMS);
+  const unsigned long startMS = millis();
+  http.begin(String(job.restURL) + "blocks?height=sealed");
+  const int httpResponseCode = http.GET();
+  result.roundTripMS = millis() - startMS;
+  http.end();
+  result.success = httpResponseCode == 200;
+}
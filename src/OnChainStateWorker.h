@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+#include "OnChainState.h"
+#include "SpscQueue.h"
+
+class OnChainStateWorker {
+
+  // This class executes requests to an Access Node's REST API (via `OnChainState`) on a task of its own, so a
+  // slow node delays the request, not the task that submitted it. One task submits requests and collects the
+  // results via `poll()`, which calls the completion function on that task; the worker task calls `work()`,
+  // which executes one request at a time:
+  //
+  //   submitting task:  submit() ──► requests ──► work()  :worker task
+  //                     poll()   ◄── results  ◄──┘
+  //
+  // Both queues are lock-free SPSC queues (see SpscQueue.h). At most MAX_IN_FLIGHT requests can be pending,
+  // which bounds the queues; submit() fails beyond that rather than blocking. The worker owns its
+  // `OnChainState` (and hence its kept-alive connection) and re-creates it when a state read names a different
+  // Access Node; probes use a connection of their own, so probing other nodes leaves that connection be.
+
+  public:
+  enum class Request : uint8_t {
+    ReadControllerState, // the controller state as of a sealed block (the latest one, unless specified)
+    ProbeLatency,        // the round-trip time of requesting the latest sealed block, as a health check
+  };
+
+  struct Result {
+    uint32_t ticket; // as returned by submit()
+    Request request;
+    bool success;
+    unsigned long blockHeight; // the state is consistent as of this (sealed) block
+    int64_t controllerState;
+    unsigned long elapsedMS;   // from submitting the request to its completion
+    unsigned long roundTripMS; // ProbeLatency: of the request alone, without the time it waited in the queue
+  };
+
+  // called by poll() for each completed request, on the task calling poll()
+  typedef void (*Completion)(const Result &result);
+
+  static const size_t MAX_IN_FLIGHT = 4;
+
+  // `probeTimeoutMS` bounds how long a probe of an unresponsive node holds up the requests queued behind it
+  OnChainStateWorker(Completion completion, unsigned long probeTimeoutMS = 2000);
+
+  // submitting task
+  // ticket (> 0); 0 if too many requests are in flight. `blockHeight`: a sealed block the request refers to; 0 asks
+  // the Access Node for its latest sealed block first, which costs an extra round trip.
+  uint32_t submit(Request request, const String &restURL, unsigned long blockHeight = 0);
+  bool poll();              // delivers completed requests; true if any
+  size_t inFlight() const;
+
+  // worker task
+  bool work(); // executes the next request, if any; true if one was executed
+
+  // any task: HTTP requests via the current `OnChainState`, and of those, the ones that reused the kept-alive
+  // connection; a consistent pair, although the worker task updates both after every request
+  void requestCounts(unsigned long &requests, unsigned long &reusedRequests) const;
+
+  private:
+  struct Job {
+    uint32_t ticket;
+    Request request;
+    unsigned long submittedMS;
+    unsigned long blockHeight; // 0: the latest sealed block, as reported by the Access Node
+    char restURL[96];
+  };
+
+  void readControllerState(const Job &job, Result &result);
+  void probeLatency(const Job &job, Result &result);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const Completion completion;
+  const unsigned long probeTimeoutMS;
+
+  // dynamic state parameters
+  SpscQueue<Job, MAX_IN_FLIGHT> jobs;       // submitting task -> worker
+  SpscQueue<Result, MAX_IN_FLIGHT> results; // worker -> submitting task
+  uint32_t nextTicket;  // submitting task only
+  size_t pending;       // submitted, but not delivered yet; submitting task only
+  OnChainState *state;  // worker only
+  std::atomic<unsigned long> requestCount; // written by the worker only, before `reusedCount`
+  std::atomic<unsigned long> reusedCount;  // ... which publishes both
+};
@@ -0,0 +1,36 @@
+#include "PinnedTask.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+static void runForever(void *parameter) {
+  TaskIteration iteration = reinterpret_cast<TaskIteration>(parameter);
+  while (true) {
+    if (!iteration()) vTaskDelay(1);
+  }
+}
+
+bool startPinnedTask(const char *name, TaskIteration iteration, int core, uint32_t stackBytes, unsigned priority) {
+  // the ESP-IDF flavour of FreeRTOS specifies the stack depth in bytes
+  BaseType_t rc = xTaskCreatePinnedToCore(runForever, name, stackBytes, reinterpret_cast<void *>(iteration), priority, nullptr, core);
+  if (rc != pdPASS) {
+    Serial.printf("❌ Creating task '%s' failed (code %d)\n", name, (int)rc);
+    return false;
+  }
+  return true;
+}
+
+#else // host build
+
+#include <chrono>
+#include <thread>
+
+bool startPinnedTask(const char *, TaskIteration iteration, int, uint32_t, unsigned) {
+  std::thread([iteration]() {
+    while (true) {
+      if (!iteration()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }).detach();
+  return true;
+}
+
+#endif
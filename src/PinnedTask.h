@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+// iteration of a task's work loop; returns true if there may be more work right away, false if the task
+// can sleep until the next scheduler tick
+typedef bool (*TaskIteration)();
+
+// FUNCTION startPinnedTask:
+// Runs `iteration` in an endless loop on a dedicated FreeRTOS task pinned to `core`. Between idle
+// iterations, the task sleeps for one tick, so it does not starve lower-priority tasks on its core.
+// On hosts without FreeRTOS (native builds), the loop runs on a std::thread and `core` is ignored.
+bool startPinnedTask(const char *name, TaskIteration iteration, int core, uint32_t stackBytes, unsigned priority);
@@ -0,0 +1,89 @@
+#include "RxRingBuffer.h"
+
+// CLASS RxRingBuffer
+
+// Fixed-capacity receive buffer for network bytes, filled via bulk reads from a `Client`.
+// Bytes can be inspected in place (`peek`) and drained in contiguous chunks (`readSpan` + `skip`)
+// so that higher layers can parse protocol frames without copying byte-by-byte.
+
+RxRingBuffer::RxRingBuffer(size_t capacity)
+    : capacity(roundUpToPowerOfTwo(capacity)), mask(roundUpToPowerOfTwo(capacity) - 1),
+      buffer(new uint8_t[roundUpToPowerOfTwo(capacity)]), head(0), tail(0) {
+}
+
+size_t RxRingBuffer::fill(Client *client) {
+  size_t total = 0;
+  while (freeSpace() > 0) {
+    int pending = client->available();
+    if (pending <= 0) break;
+
+    // read into the contiguous free region starting at the write position; if the free space
+    // wraps around the end of the buffer, the next iteration picks up the remainder
+    const size_t writePos = tail & mask;
+    size_t span = capacity - writePos;
+    if (span > freeSpace()) span = freeSpace();
+    if (span > (size_t)pending) span = (size_t)pending;
+
+    int n = client->read(buffer + writePos, span);
+    if (n <= 0) break;
+    tail += n;
+    total += n;
+  }
+  return total;
+}
+
+size_t RxRingBuffer::available() const {
+  return tail - head;
+}
+
+size_t RxRingBuffer::freeSpace() const {
+  return capacity - available();
+}
+
+size_t RxRingBuffer::getCapacity() const {
+  return capacity;
+}
+
+uint8_t RxRingBuffer::peek(size_t offset) const {
+  return buffer[(head + offset) & mask];
+}
+
+size_t RxRingBuffer::read(uint8_t *dst, size_t maxLen) {
+  size_t copied = 0;
+  while (copied < maxLen) {
+    const uint8_t *span;
+    size_t n = readSpan(&span);
+    if (n == 0) break;
+    if (n > maxLen - copied) n = maxLen - copied;
+    memcpy(dst + copied, span, n);
+    head += n;
+    copied += n;
+  }
+  return copied;
+}
+
+size_t RxRingBuffer::readSpan(const uint8_t **span) {
+  const size_t readPos = head & mask;
+  size_t n = capacity - readPos; // bytes until the physical end of the buffer
+  if (n > available()) n = available();
+  *span = buffer + readPos;
+  return n;
+}
+
+size_t RxRingBuffer::skip(size_t len) {
+  if (len > available()) len = available();
+  head += len;
+  return len;
+}
+
+void RxRingBuffer::clear() {
+  head = 0;
+  tail = 0;
+}
+
+size_t RxRingBuffer::roundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
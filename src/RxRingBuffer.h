@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+class RxRingBuffer {
+
+  // This class is a fixed-capacity receive buffer for bytes arriving on a network `Client`.
+  // Instead of pulling one byte at a time via `client->read()` (one virtual call each), the
+  // buffer is topped up with bulk `client->read(buf, n)` calls into its free space. Consumers
+  // can then inspect bytes in place via `peek(offset)` (e.g. to parse a frame header before
+  // committing to it) and drain them in contiguous chunks without any intermediate copies.
+  //
+  // The capacity is rounded up to the next power of two, so that wrapping the read and write
+  // positions is a cheap bitwise AND. Memory is allocated once at construction and never
+  // re-allocated thereafter.
+
+  public:
+  RxRingBuffer(size_t capacity);
+
+  size_t fill(Client *client);                  // bulk-read whatever the client has, up to the free space
+  size_t available() const;                     // number of buffered bytes that are not consumed yet
+  size_t freeSpace() const;                     // number of bytes that can still be buffered
+  size_t getCapacity() const;
+  uint8_t peek(size_t offset) const;            // caution: caller must ensure `offset < available()`
+  size_t read(uint8_t *dst, size_t maxLen);     // copies up to `maxLen` buffered bytes into `dst`
+  size_t readSpan(const uint8_t **span);        // longest contiguous run of buffered bytes, not consumed
+  size_t skip(size_t len);                      // consumes up to `len` bytes without copying them
+  void clear();
+
+  private:
+  static size_t roundUpToPowerOfTwo(size_t value);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const size_t capacity; // always a power of two
+  const size_t mask;     // capacity - 1
+  uint8_t *const buffer;
+
+  // dynamic state parameters
+  // `head` and `tail` are free-running counters; their difference is the number of buffered
+  // bytes. Unsigned overflow is well-defined and harmless since capacity is a power of two.
+  size_t head; // total bytes consumed
+  size_t tail; // total bytes written
+};
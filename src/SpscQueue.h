@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+
+  // This class is a bounded, lock-free queue for exactly one producer and one consumer, which may run
+  // concurrently (e.g. on different cores). The producer only writes `tail`, the consumer only writes
+  // `head`; each publishes its progress with release semantics and observes the other's with acquire
+  // semantics, so an element is completely written before the consumer can see it. Neither side ever
+  // blocks: `push` fails if the queue is full, `pop` fails if it is empty.
+  //
+  // `Capacity` must be a power of two, so that wrapping the free-running positions is a bitwise AND.
+
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+  SpscQueue() : head(0), tail(0) {
+  }
+
+  // producer side
+  bool push(const T &element) {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == Capacity) return false; // full
+    slots[t & (Capacity - 1)] = element;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side
+  bool pop(T &element) {
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (tail.load(std::memory_order_acquire) == h) return false; // empty
+    element = slots[h & (Capacity - 1)];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // approximate if called concurrently with push or pop
+  size_t size() const {
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+  }
+
+  private:
+  T slots[Capacity];
+  std::atomic<size_t> head; // total elements consumed; written by the consumer only
+  std::atomic<size_t> tail; // total elements produced; written by the producer only
+};
@@ -0,0 +1,45 @@
+#include "StreamWatchdog.h"
+
+// CLASS StreamWatchdog
+
+// Liveness watchdog for the event stream, fed by the block heights of heartbeats and events.
+
+StreamWatchdog::StreamWatchdog(unsigned long heartbeatIntervalMS, unsigned int missedIntervals)
+    : deadlineMS(heartbeatIntervalMS * missedIntervals), armed(false), lastProgressMS(0), lastBlockHeight(0),
+      lastMessageIndex(0), stallCount(0) {
+}
+
+void StreamWatchdog::arm() {
+  armed = true;
+  lastProgressMS = millis();
+  lastBlockHeight = 0; // a new subscription may replay from below the heights the previous one reached
+  lastMessageIndex = 0;
+}
+
+void StreamWatchdog::disarm() {
+  armed = false;
+}
+
+void StreamWatchdog::feed(unsigned long messageIndex, unsigned long blockHeight) {
+  lastMessageIndex = messageIndex;
+  if (blockHeight <= lastBlockHeight) return; // a repeated or older block is no sign of life
+  lastBlockHeight = blockHeight;
+  lastProgressMS = millis();
+}
+
+bool StreamWatchdog::isStalled() {
+  if (!armed || silentMS() < deadlineMS) return false;
+  armed = false;
+  ++stallCount;
+  Serial.printf("🐕 Event stream stalled: no progress beyond block %lu (message index %lu) for %lu ms\n",
+                lastBlockHeight, lastMessageIndex, silentMS());
+  return true;
+}
+
+unsigned long StreamWatchdog::silentMS() const {
+  return millis() - lastProgressMS;
+}
+
+unsigned long StreamWatchdog::stalls() const {
+  return stallCount;
+}
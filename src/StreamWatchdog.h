@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+
+class StreamWatchdog {
+
+  // This class detects a stalled event stream. With a `heartbeat_interval`, the Access Node sends a message
+  // at least every few blocks, and every message carries the height of the block it covers. Hence, as long as
+  // the stream is alive, the block height advances at least once per heartbeat interval. If it doesn't for
+  // `missedIntervals` intervals -- no messages at all, or messages that don't make progress -- the stream is
+  // considered stalled.
+  //
+  // A half-open TCP connection (e.g. a silent network partition, or a node that disappeared without closing
+  // the connection) is otherwise only noticed once TCP gives up retransmitting, which takes minutes. The
+  // watchdog notices it after `missedIntervals` heartbeat intervals instead.
+
+  public:
+  StreamWatchdog(unsigned long heartbeatIntervalMS, unsigned int missedIntervals);
+
+  void arm();    // starts watching afresh, e.g. once the subscription is confirmed; forgets the heights seen so far
+  void disarm(); // e.g. when the connection is torn down
+  void feed(unsigned long messageIndex, unsigned long blockHeight); // for every message of the stream
+  bool isStalled();            // true once per detected stall, which also disarms the watchdog
+  unsigned long silentMS() const; // since the block height last advanced
+  unsigned long stalls() const;
+
+  private:
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const unsigned long deadlineMS;
+
+  // dynamic state parameters
+  bool armed;
+  unsigned long lastProgressMS;   // when the block height last advanced (or the watchdog was armed)
+  unsigned long lastBlockHeight;
+  unsigned long lastMessageIndex;
+  unsigned long stallCount;
+};
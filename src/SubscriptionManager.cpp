@@ -0,0 +1,192 @@
+#include "SubscriptionManager.h"
+
+// CLASS SubscriptionManager
+
+// Subscriptions of the WebSocket API multiplexed over one connection, routed by `subscription_id`.
+
+SubscriptionManager::SubscriptionManager(MessageArena *arena, ArduinoJson::Allocator *jsonAllocator, SendFunction send)
+    : arena(arena), jsonAllocator(jsonAllocator), sendFunction(send), subscriptionCount(0), routedCount(0), unroutedCount(0) {
+}
+
+size_t SubscriptionManager::add(const char *id, const char *topic, ArgumentsBuilder build, MessageHandler onMessage, MessageHandler onError) {
+  if (subscriptionCount >= MAX_SUBSCRIPTIONS) {
+    Serial.printf("❌ Too many subscriptions, '%s' not added\n", id);
+    return NONE;
+  }
+  if (strlen(id) > MAX_ID_LENGTH || find(id) != NONE) {
+    Serial.printf("❌ Subscription id '%s' is too long or taken, subscription not added\n", id);
+    return NONE;
+  }
+  Subscription &subscription = subscriptions[subscriptionCount];
+  strcpy(subscription.id, id);
+  subscription.topic = topic;
+  subscription.build = build;
+  subscription.onMessage = onMessage;
+  subscription.onError = onError;
+  subscription.state = State::Idle;
+  subscription.wanted = true;
+  subscription.messageCount = 0;
+  return subscriptionCount++;
+}
+
+bool SubscriptionManager::subscribe(size_t subscription) {
+  if (subscription >= subscriptionCount) return false;
+  Subscription &s = subscriptions[subscription];
+  s.wanted = true;
+  if (!send(s, "subscribe")) return false;
+  s.state = State::Pending;
+  return true;
+}
+
+bool SubscriptionManager::unsubscribe(size_t subscription) {
+  if (subscription >= subscriptionCount) return false;
+  Subscription &s = subscriptions[subscription];
+  s.wanted = false;
+  if (s.state != State::Pending && s.state != State::Active) { // the node doesn't know it
+    s.state = State::Idle;
+    return true;
+  }
+  if (!send(s, "unsubscribe")) return false;
+  s.state = State::Unsubscribing;
+  return true;
+}
+
+size_t SubscriptionManager::subscribeAll() {
+  size_t sent = 0;
+  for (size_t i = 0; i < subscriptionCount; ++i) {
+    if (subscriptions[i].wanted && subscriptions[i].state == State::Idle && subscribe(i)) ++sent;
+  }
+  return sent;
+}
+
+void SubscriptionManager::connectionLost() {
+  for (size_t i = 0; i < subscriptionCount; ++i) {
+    subscriptions[i].state = State::Idle;
+  }
+}
+
+// FUNCTION dispatch:
+// Acknowledgements (`{"subscription_id": ..., "action": "subscribe"}`) and errors (`{..., "error": {...}}`) advance
+// the subscription's state; any other message is data and goes to the subscription's handler, unless the
+// subscription is being (or has been) cancelled.
+bool SubscriptionManager::dispatch(JsonDocument &message) {
+  const size_t index = find(message["subscription_id"] | "");
+  if (index == NONE) {
+    ++unroutedCount;
+    return false;
+  }
+  Subscription &s = subscriptions[index];
+
+  if (message["error"]) {
+    s.state = s.state == State::Unsubscribing ? State::Idle : State::Failed;
+    if (s.onError) {
+      s.onError(message);
+    } else {
+      Serial.printf("❌ Subscription '%s' to '%s' failed:\n", s.id, s.topic);
+      serializeJsonPretty(message, Serial);
+      Serial.println("\n");
+    }
+    return true;
+  }
+
+  const char *action = message["action"];
+  if (action && strcmp(action, "subscribe") == 0) {
+    if (s.state == State::Pending) s.state = State::Active;
+    Serial.printf("⚙️ Subscription '%s' to '%s' confirmed\n", s.id, s.topic);
+    return true;
+  }
+  if (action && strcmp(action, "unsubscribe") == 0) {
+    if (s.state == State::Unsubscribing) s.state = State::Idle;
+    Serial.printf("⚙️ Subscription '%s' to '%s' cancelled\n", s.id, s.topic);
+    return true;
+  }
+
+  if (s.state == State::Pending) s.state = State::Active; // data may overtake the acknowledgement
+  if (s.state != State::Active) { // e.g. in flight while unsubscribing
+    ++unroutedCount;
+    return true;
+  }
+  ++s.messageCount;
+  ++routedCount;
+  s.onMessage(message);
+  return true;
+}
+
+SubscriptionManager::State SubscriptionManager::state(size_t subscription) const {
+  return subscription < subscriptionCount ? subscriptions[subscription].state : State::Idle;
+}
+
+unsigned long SubscriptionManager::messages(size_t subscription) const {
+  return subscription < subscriptionCount ? subscriptions[subscription].messageCount : 0;
+}
+
+size_t SubscriptionManager::count() const {
+  return subscriptionCount;
+}
+
+size_t SubscriptionManager::active() const {
+  size_t activeCount = 0;
+  for (size_t i = 0; i < subscriptionCount; ++i) {
+    if (subscriptions[i].state == State::Active) ++activeCount;
+  }
+  return activeCount;
+}
+
+unsigned long SubscriptionManager::routed() const {
+  return routedCount;
+}
+
+unsigned long SubscriptionManager::unrouted() const {
+  return unroutedCount;
+}
+
+const char *SubscriptionManager::stateName(State state) {
+  switch (state) {
+    case State::Idle:
+      return "idle";
+    case State::Pending:
+      return "pending";
+    case State::Active:
+      return "active";
+    case State::Unsubscribing:
+      return "unsubscribing";
+    case State::Failed:
+      return "failed";
+  }
+  return "unknown";
+}
+
+size_t SubscriptionManager::find(const char *id) const {
+  for (size_t i = 0; i < subscriptionCount; ++i) {
+    if (strcmp(subscriptions[i].id, id) == 0) return i;
+  }
+  return NONE;
+}
+
+// FUNCTION send:
+// assembles a `subscribe` or `unsubscribe` request in the message arena and sends it
+bool SubscriptionManager::send(Subscription &subscription, const char *action) {
+  bool sent = false;
+  {
+    JsonDocument doc(jsonAllocator);
+    doc["subscription_id"] = subscription.id;
+    doc["action"] = action;
+    if (strcmp(action, "subscribe") == 0) {
+      doc["topic"] = subscription.topic;
+      JsonObject arguments = doc.createNestedObject("arguments");
+      if (subscription.build) subscription.build(arguments);
+    }
+
+    ArenaStringBuilder json(arena);
+    serializeJson(doc, json);
+    if (doc.overflowed() || json.overflowed()) {
+      Serial.printf("❌ Request for subscription '%s' does not fit into the message arena\n", subscription.id);
+    } else {
+      Serial.println("📝 JSON payload:");
+      Serial.println(json.c_str());
+      sent = sendFunction(json.c_str(), json.length());
+    }
+  } // `doc` and `json` go out of scope before their memory is reclaimed
+  arena->reset();
+  return sent;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "MessageArena.h"
+
+class SubscriptionManager {
+
+  // This class multiplexes subscriptions of Flow's WebSocket API over a single connection. Each subscription is
+  // registered once with its `subscription_id`, topic and handlers; the manager sends the `subscribe` and
+  // `unsubscribe` requests, tracks each subscription's state from the node's acknowledgements and errors, and
+  // routes every incoming message by its `subscription_id` to the handler of its subscription:
+  //
+  //   Idle ──subscribe()──► Pending ──ack or first message──► Active ──unsubscribe()──► Unsubscribing ──ack──► Idle
+  //                            └──────────error──────────► Failed
+  //
+  // Registered subscriptions are wanted until unsubscribed. A lost connection takes all of them back to `Idle`
+  // (see `connectionLost()`); `subscribeAll()` then re-establishes every wanted subscription on the new one.
+  // Routing is a linear search over at most MAX_SUBSCRIPTIONS ids, each at most 20 characters long (the limit
+  // of the Access API).
+  //
+  // Requests are assembled in the message arena, which is reset after sending. CAUTION: hence, subscribe(),
+  // unsubscribe() and subscribeAll() must not be called while a message is being processed, e.g. from a handler.
+
+  public:
+  enum class State : uint8_t {
+    Idle,          // not subscribed on the current connection
+    Pending,       // `subscribe` sent, awaiting the acknowledgement
+    Active,        // acknowledged, or messages are arriving
+    Unsubscribing, // `unsubscribe` sent, awaiting the acknowledgement
+    Failed,        // the node answered with an error
+  };
+
+  // fills in the subscription's `arguments`; called right before each `subscribe` request is sent
+  typedef void (*ArgumentsBuilder)(JsonObject arguments);
+  // processes a message of the subscription (data or error)
+  typedef void (*MessageHandler)(JsonDocument &message);
+  // sends a text message over the WebSocket connection; false if that failed
+  typedef bool (*SendFunction)(const char *payload, size_t length);
+
+  static const size_t MAX_SUBSCRIPTIONS = 16;
+  static const size_t MAX_ID_LENGTH = 20;
+  static const size_t NONE = (size_t)-1;
+
+  SubscriptionManager(MessageArena *arena, ArduinoJson::Allocator *jsonAllocator, SendFunction send);
+
+  // Registers a subscription (without sending it) and returns its handle, or NONE if the id is too long or taken,
+  // or MAX_SUBSCRIPTIONS are registered already. `topic` must outlive the manager. `onError` may be nullptr:
+  // errors are then only logged.
+  size_t add(const char *id, const char *topic, ArgumentsBuilder build, MessageHandler onMessage, MessageHandler onError = nullptr);
+
+  bool subscribe(size_t subscription);   // sends `subscribe`, also to retry a failed subscription
+  bool unsubscribe(size_t subscription); // sends `unsubscribe` if subscribed; no longer wanted either way
+  size_t subscribeAll();                 // subscribes every wanted subscription that is `Idle`; returns how many
+  void connectionLost();                 // all subscriptions are `Idle` again
+
+  // routes a message by its `subscription_id`; false if it belongs to no registered subscription
+  bool dispatch(JsonDocument &message);
+
+  State state(size_t subscription) const;
+  unsigned long messages(size_t subscription) const; // data messages delivered to the subscription's handler
+  size_t count() const;                              // registered subscriptions
+  size_t active() const;                             // of those, the ones in state `Active`
+  unsigned long routed() const;                      // messages delivered to a handler since construction
+  unsigned long unrouted() const;                    // messages without a registered or current subscription
+
+  static const char *stateName(State state);
+
+  private:
+  struct Subscription {
+    char id[MAX_ID_LENGTH + 1];
+    const char *topic;
+    ArgumentsBuilder build;
+    MessageHandler onMessage;
+    MessageHandler onError;
+    State state;
+    bool wanted; // re-established by subscribeAll()
+    unsigned long messageCount;
+  };
+
+  size_t find(const char *id) const;
+  bool send(Subscription &subscription, const char *action);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  MessageArena *const arena;
+  ArduinoJson::Allocator *const jsonAllocator;
+  const SendFunction sendFunction;
+
+  // dynamic state parameters
+  Subscription subscriptions[MAX_SUBSCRIPTIONS];
+  size_t subscriptionCount;
+  unsigned long routedCount;
+  unsigned long unroutedCount;
+};
@@ -0,0 +1,393 @@
+#include "WebSocketFrameParser.h"
+
+// CLASS WebSocketFrameParser
+
+// Incremental parser for server-to-client WebSocket frames. `poll()` inspects whatever is buffered
+// in the receive buffer and returns as soon as it runs out of bytes, a message is completely buffered,
+// or a control frame was received. It never blocks; partially received frames are resumed on the next
+// call. Message payloads are read in place from the receive buffer, without intermediate copies.
+
+WebSocketFrameParser::WebSocketFrameParser(RxRingBuffer *rxBuffer)
+    : rx(rxBuffer), inflater(nullptr) {
+  reset();
+}
+
+void WebSocketFrameParser::setInflater(WebSocketInflater *inflater) {
+  this->inflater = inflater;
+}
+
+void WebSocketFrameParser::reset() {
+  state = State::Idle;
+  scanOffset = 0;
+  remaining = 0;
+  discardDone = false;
+  messageCompressed = false;
+  frameFinal = false;
+  readFailed = false;
+  peekedByte = -1;
+  inflated = nullptr;
+  inflatedLength = 0;
+  tailFed = 0;
+  inflateResult = WebSocketInflater::Result::NeedsInput;
+  supressRepeatedRSVWarnings = false;
+  scanControlFrames = 0;
+  interleavedCount = 0;
+  interleavedReported = 0;
+  controlLength = 0;
+  if (inflater) inflater->reset();
+}
+
+const uint8_t *WebSocketFrameParser::controlPayload() const {
+  return control;
+}
+
+size_t WebSocketFrameParser::controlPayloadLength() const {
+  return controlLength;
+}
+
+WebSocketFrameParser::Event WebSocketFrameParser::poll() {
+  while (true) {
+    switch (state) {
+      /* ── Frame header at a frame boundary ───────────────────── */
+      case State::Idle: {
+        if (interleavedReported < interleavedCount) { // arrived in between the fragments of the previous message
+          const ControlFrame &frame = interleaved[interleavedReported++];
+          memcpy(control, frame.payload, frame.length);
+          controlLength = frame.length;
+          if (interleavedReported == interleavedCount) interleavedCount = interleavedReported = 0;
+          return reportControlFrame(frame.opcode);
+        }
+
+        FrameHeader header;
+        if (!peekHeader(0, header)) return Event::None;
+        if (!acceptFirstFrame(header)) { // skip the frame, which keeps us in sync with frame boundaries
+          rx->skip(header.headerLength);
+          remaining = header.payloadLength;
+          state = State::DiscardPayload;
+          break;
+        }
+
+        if (header.opcode & 0x08) { // control frame: ≤125 bytes, so it always fits into the buffer
+          if (rx->available() < header.headerLength + header.payloadLength) return Event::None;
+          rx->skip(header.headerLength);
+          controlLength = rx->read(control, header.payloadLength);
+          return reportControlFrame(header.opcode);
+        }
+
+        messageCompressed = header.reservedBits & 0x40;
+        scanOffset = 0;
+        scanControlFrames = 0;
+        state = State::ScanMessage;
+        break;
+      }
+
+      /* ── Verify that all frames of the message are buffered ──── */
+      case State::ScanMessage: {
+        FrameHeader header;
+        bool tooLarge = false;
+        if (!peekHeader(scanOffset, header)) {
+          if (rx->freeSpace() > 0) return Event::None; // resume once more bytes arrived
+          tooLarge = true;
+        } else if (scanOffset + header.headerLength + header.payloadLength > rx->getCapacity()) {
+          tooLarge = true;
+        } else if (rx->available() < scanOffset + header.headerLength + header.payloadLength) {
+          return Event::None; // resume once more bytes arrived
+        }
+
+        if (tooLarge) {
+          Serial.printf("❌ Message exceeds receive buffer of %u bytes, dropped\n", (unsigned)rx->getCapacity());
+          if (messageCompressed) { // skipping it would corrupt the deflate context shared with subsequent messages
+            state = State::Failed;
+            break;
+          }
+          remaining = 0;
+          discardDone = false;
+          state = State::DiscardMessage;
+          break;
+        }
+
+        if (scanOffset > 0) { // frames following the first one
+          if (header.opcode & 0x08) {
+            if (header.payloadLength > sizeof(control) || !header.isFinal) {
+              Serial.println(F("❌ Control frame payload too large or fragmented"));
+              state = State::Failed;
+              break;
+            }
+            if (++scanControlFrames > MAX_INTERLEAVED_CONTROL_FRAMES) {
+              Serial.printf("❌ More than %u control frames within fragmented message\n",
+                            (unsigned)MAX_INTERLEAVED_CONTROL_FRAMES);
+              state = State::Failed;
+              break;
+            }
+            scanOffset += header.headerLength + header.payloadLength;
+            break;
+          }
+          if (header.opcode != 0x0 || header.reservedBits || header.isMasked) {
+            Serial.println(F("❌ Unexpected frame within fragmented message"));
+            state = State::Failed;
+            break;
+          }
+        }
+
+        scanOffset += header.headerLength + header.payloadLength;
+        if (!header.isFinal) break;
+
+        // all frames are buffered; from here on, `scanOffset` counts the message's bytes not consumed yet
+        remaining = 0;
+        frameFinal = false;
+        readFailed = false;
+        peekedByte = -1;
+        inflatedLength = 0;
+        tailFed = 0;
+        inflateResult = WebSocketInflater::Result::NeedsInput;
+        state = State::MessageReady;
+        return Event::MessageReady;
+      }
+
+      case State::MessageReady:
+        return Event::MessageReady;
+
+      /* ── Skipping rejected frames ───────────────────────────── */
+      case State::DiscardPayload: {
+        while (remaining > 0) {
+          size_t n = rx->skip(remaining > rx->available() ? rx->available() : remaining);
+          if (n == 0) return Event::None; // resume on next loop pass
+          remaining -= n;
+        }
+        state = State::Idle;
+        break;
+      }
+
+      case State::DiscardMessage: {
+        while (remaining > 0 || !discardDone) {
+          if (remaining > 0) {
+            size_t n = rx->skip(remaining > rx->available() ? rx->available() : remaining);
+            if (n == 0) return Event::None; // resume on next loop pass
+            remaining -= n;
+            continue;
+          }
+          FrameHeader header;
+          if (!peekHeader(0, header)) return Event::None;
+          rx->skip(header.headerLength);
+          remaining = header.payloadLength;
+          discardDone = header.isFinal && !(header.opcode & 0x08);
+        }
+        state = State::Idle;
+        break;
+      }
+
+      case State::Failed:
+        return Event::ProtocolError;
+    }
+  }
+}
+
+// Parses the frame header starting `offset` bytes after the buffer's head, without consuming it.
+// Returns false if the header is not completely buffered yet.
+bool WebSocketFrameParser::peekHeader(size_t offset, FrameHeader &header) const {
+  if (rx->available() < offset + 2) return false;
+  const uint8_t firstByte = rx->peek(offset);
+  const uint8_t secondByte = rx->peek(offset + 1);
+
+  header.isFinal = firstByte & 0x80;
+  header.reservedBits = firstByte & 0x70;
+  header.opcode = firstByte & 0x0F;
+  header.isMasked = secondByte & 0x80; // should be 0 for server-to-client
+  header.payloadLength = secondByte & 0x7F;
+
+  const size_t extendedLengthBytes = (header.payloadLength == 126) ? 2 : (header.payloadLength == 127) ? 8 : 0;
+  header.headerLength = 2 + extendedLengthBytes + (header.isMasked ? 4 : 0);
+  if (rx->available() < offset + header.headerLength) return false;
+
+  if (extendedLengthBytes > 0) {
+    header.payloadLength = 0;
+    for (size_t i = 0; i < extendedLengthBytes; ++i)
+      header.payloadLength = (header.payloadLength << 8) | rx->peek(offset + 2 + i);
+  }
+  return true;
+}
+
+// Decides whether a frame, starting at a message boundary, is accepted. Rejected frames are skipped.
+bool WebSocketFrameParser::acceptFirstFrame(const FrameHeader &header) {
+  // Check for reserved bits. With permessage-deflate, RSV1 marks the first frame of a compressed message.
+  const uint8_t permittedReservedBits = (inflater && header.opcode == 0x1) ? 0x40 : 0x00;
+  if (header.reservedBits & ~permittedReservedBits) {
+    if (!supressRepeatedRSVWarnings) {
+      Serial.println(F("❌ RSV bits set, unsupported extension"));
+      supressRepeatedRSVWarnings = true;
+    }
+    return false;
+  }
+  supressRepeatedRSVWarnings = false;
+
+  // Check for mask bit (should not be set)
+  if (header.isMasked) {
+    Serial.println(F("❌ Server-to-client frame is masked, protocol error"));
+    return false;
+  }
+
+  if (header.opcode & 0x08) {
+    if (header.payloadLength > sizeof(control) || !header.isFinal) {
+      Serial.println(F("❌ Control frame payload too large or fragmented"));
+      return false;
+    }
+    if (header.opcode != 0x8 && header.opcode != 0x9 && header.opcode != 0xA) {
+      Serial.printf("⚠️ Unsupported opcode 0x%02X\n", header.opcode);
+      return false;
+    }
+    return true;
+  }
+
+  // Data frames: only TEXT can start a message; CONTINUATION frames are verified while scanning
+  if (header.opcode != 0x1) {
+    Serial.printf("⚠️ Unsupported opcode 0x%02X\n", header.opcode);
+    return false;
+  }
+  return true;
+}
+
+WebSocketFrameParser::Event WebSocketFrameParser::reportControlFrame(uint8_t opcode) {
+  switch (opcode) {
+    case 0x9:
+      return Event::Ping;
+    case 0xA:
+      return Event::Pong;
+    default:
+      return Event::Close;
+  }
+}
+
+/* ── Reading the message ──────────────────────────────────────────────────────────────────── */
+
+// FUNCTION readMessage:
+// Copies up to `maxLength` bytes of the (unmasked, decompressed) message payload into `dst`.
+// Returns 0 once the end of the message is reached.
+size_t WebSocketFrameParser::readMessage(uint8_t *dst, size_t maxLength) {
+  if (state != State::MessageReady) return 0;
+  size_t copied = 0;
+  if (peekedByte >= 0 && maxLength > 0) {
+    dst[copied++] = peekedByte;
+    peekedByte = -1;
+  }
+  if (messageCompressed) return copied + readCompressed(dst + copied, maxLength - copied);
+
+  while (copied < maxLength) {
+    if (remaining == 0 && !nextMessageFrame()) break;
+    size_t n = maxLength - copied;
+    if (n > remaining) n = remaining;
+    n = rx->read(dst + copied, n);
+    remaining -= n;
+    scanOffset -= n;
+    copied += n;
+  }
+  return copied;
+}
+
+int WebSocketFrameParser::peekMessage() {
+  if (peekedByte < 0) {
+    uint8_t c;
+    if (readMessage(&c, 1) == 1) peekedByte = c;
+  }
+  return peekedByte;
+}
+
+bool WebSocketFrameParser::messageExhausted() const {
+  if (state != State::MessageReady || readFailed) return true;
+  if (peekedByte >= 0) return false;
+  if (!messageCompressed) return scanOffset == 0;
+  return scanOffset == 0 && tailFed == sizeof(WebSocketInflater::MESSAGE_TAIL) && inflatedLength == 0 &&
+         inflateResult != WebSocketInflater::Result::HasMoreOutput;
+}
+
+// FUNCTION finishMessage:
+// Consumes whatever the reader left of the current message and returns to parsing frames.
+void WebSocketFrameParser::finishMessage() {
+  if (state != State::MessageReady) return;
+  peekedByte = -1;
+
+  if (messageCompressed) {
+    // inflate the unread rest, so that the inflater's window stays in sync for subsequent messages
+    uint8_t sink[64];
+    while (readMessage(sink, sizeof(sink)) > 0) {
+    }
+    if (readFailed) {
+      state = State::Failed;
+      return;
+    }
+    inflater->finishMessage();
+  } else {
+    while (remaining > 0 || nextMessageFrame()) {
+      rx->skip(remaining);
+      scanOffset -= remaining;
+      remaining = 0;
+    }
+  }
+  state = State::Idle;
+}
+
+// Advances to the next data frame of the current message that carries payload, consuming frame headers
+// and control frames on the way (all of them are buffered, as verified by scanning). Returns false at
+// the end of the message.
+bool WebSocketFrameParser::nextMessageFrame() {
+  while (!frameFinal) {
+    FrameHeader header;
+    peekHeader(0, header);
+    rx->skip(header.headerLength);
+    scanOffset -= header.headerLength;
+
+    if (header.opcode & 0x08) { // interleaved control frame; queued until the message is finished
+      ControlFrame &frame = interleaved[interleavedCount++]; // scanning capped their number
+      frame.opcode = header.opcode;
+      frame.length = rx->read(frame.payload, header.payloadLength);
+      scanOffset -= frame.length;
+      continue;
+    }
+    remaining = header.payloadLength;
+    frameFinal = header.isFinal;
+    if (remaining > 0) return true;
+  }
+  return false;
+}
+
+// Reads decompressed bytes of a permessage-deflate message: compressed payload is pulled from the
+// receive buffer (frame by frame) and inflated on the fly, followed by the stripped message tail.
+size_t WebSocketFrameParser::readCompressed(uint8_t *dst, size_t maxLength) {
+  size_t copied = 0;
+  while (copied < maxLength && !readFailed) {
+    if (inflatedLength > 0) { // hand out what the inflater produced so far
+      size_t n = maxLength - copied;
+      if (n > inflatedLength) n = inflatedLength;
+      memcpy(dst + copied, inflated, n);
+      inflated += n;
+      inflatedLength -= n;
+      copied += n;
+      continue;
+    }
+
+    // next input for the inflater: payload of the current frame, or the stripped tail after the last frame
+    const uint8_t *in = nullptr;
+    size_t inLength = 0;
+    const bool fromBuffer = remaining > 0 || nextMessageFrame();
+    if (fromBuffer) {
+      inLength = rx->readSpan(&in);
+      if (inLength > remaining) inLength = remaining;
+    } else if (tailFed < sizeof(WebSocketInflater::MESSAGE_TAIL)) {
+      in = WebSocketInflater::MESSAGE_TAIL + tailFed;
+      inLength = sizeof(WebSocketInflater::MESSAGE_TAIL) - tailFed;
+    } else if (inflateResult != WebSocketInflater::Result::HasMoreOutput) {
+      break; // end of message
+    }
+
+    size_t consumed;
+    inflateResult = inflater->inflate(in, inLength, &consumed, &inflated, &inflatedLength);
+    if (fromBuffer) {
+      rx->skip(consumed);
+      remaining -= consumed;
+      scanOffset -= consumed;
+    } else {
+      tailFed += consumed;
+    }
+    if (inflateResult == WebSocketInflater::Result::Failed) readFailed = true;
+  }
+  return copied;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <Arduino.h>
+
+#include "RxRingBuffer.h"
+#include "WebSocketInflater.h"
+
+class WebSocketFrameParser {
+
+  // This class is an incremental (resumable) parser for server-to-client WebSocket frames.
+  // Each call to `poll()` inspects whatever bytes are currently buffered in the receive buffer
+  // and returns immediately when the buffer runs dry -- it never waits for the network. All
+  // progress (how far the frames of a message have been verified, how many bytes of a rejected
+  // frame still need to be skipped) is kept in the parser's state, so parsing seamlessly resumes
+  // on the next controller loop pass once more bytes have arrived.
+  //
+  // Data frames are never copied: the parser walks the frame headers of a (possibly fragmented)
+  // message in place, without consuming anything, until the final frame is completely buffered.
+  // It then reports `MessageReady`, and the message's payload can be read straight out of the
+  // receive buffer via `readMessage()` (or the `WebSocketMessageStream` adapter) -- frame headers
+  // of continuation frames are skipped transparently. Consequently, a message must fit into the
+  // receive buffer as it arrives on the wire; larger messages are dropped.
+  //
+  // Control frames (≤125 bytes by spec) are collected into a small internal buffer and reported
+  // to the caller, which is responsible for answering PINGs and handling CLOSE. Control frames
+  // interleaved with the fragments of a message are queued (up to `MAX_INTERLEAVED_CONTROL_FRAMES`
+  // per message) and reported one by one, in order of arrival, after that message was finished.
+  //
+  // If `permessage-deflate` was negotiated (see `setInflater`), messages whose first frame has
+  // the RSV1 bit set are compressed; their payload is streamed through the inflater while being
+  // read, so the consumer always sees the decompressed text.
+
+  public:
+  enum class Event {
+    None,          // no complete message or control frame yet; call again once more bytes arrived
+    MessageReady,  // a complete (possibly multi-frame) message is buffered; read it and call finishMessage()
+    Ping,          // PING received; payload available via controlPayload()
+    Pong,          // PONG received; payload available via controlPayload()
+    Close,         // CLOSE received; payload available via controlPayload()
+    ProtocolError, // unrecoverable stream error (e.g. corrupt compressed data); connection should be closed
+  };
+
+  static const size_t MAX_INTERLEAVED_CONTROL_FRAMES = 4; // more within one message is a protocol error
+
+  WebSocketFrameParser(RxRingBuffer *rxBuffer);
+
+  Event poll();
+  void setInflater(WebSocketInflater *inflater); // nullptr if permessage-deflate is not negotiated
+  const uint8_t *controlPayload() const;
+  size_t controlPayloadLength() const;
+  void reset();
+
+  // reading the message, only valid after poll() returned MessageReady
+  size_t readMessage(uint8_t *dst, size_t maxLength);
+  int peekMessage();
+  bool messageExhausted() const;
+  void finishMessage();
+
+  private:
+  enum class State {
+    Idle,           // at a frame boundary; waiting for the next frame header
+    ScanMessage,    // verifying (without consuming) that all frames of the current message are buffered
+    MessageReady,   // complete message is buffered and being read by the consumer
+    DiscardPayload, // skipping payload of a frame we reject
+    DiscardMessage, // skipping all remaining frames of a message we reject
+    Failed,         // unrecoverable; only reset() leaves this state
+  };
+
+  struct ControlFrame {
+    uint8_t opcode;
+    uint8_t payload[125];
+    size_t length;
+  };
+
+  struct FrameHeader {
+    bool isFinal;
+    uint8_t reservedBits; // RSV1-3 as in the first header byte
+    uint8_t opcode;
+    bool isMasked;
+    size_t headerLength; // 2 fixed bytes + extended length + mask key
+    uint64_t payloadLength;
+  };
+
+  bool peekHeader(size_t offset, FrameHeader &header) const;
+  bool acceptFirstFrame(const FrameHeader &header);
+  Event reportControlFrame(uint8_t opcode);
+  bool nextMessageFrame();
+  size_t readCompressed(uint8_t *dst, size_t maxLength);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  RxRingBuffer *const rx;
+
+  // behavioral parameters, set by negotiation
+  WebSocketInflater *inflater;
+
+  // dynamic state parameters: scanning and discarding
+  State state;
+  size_t scanOffset;  // bytes of the current message (from the buffer's head) verified to be complete frames
+  size_t scanControlFrames; // control frames found between the fragments of the current message so far
+  uint64_t remaining; // DiscardPayload/DiscardMessage: bytes still to skip; MessageReady: payload bytes left in the current frame
+  bool discardDone;   // DiscardMessage: final data frame of the message has been reached
+
+  // dynamic state parameters: reading the current message
+  bool messageCompressed;   // current message is permessage-deflate compressed
+  bool frameFinal;          // the frame currently being read is the message's last one
+  bool readFailed;          // inflating the current message failed
+  int peekedByte;           // byte buffered by peekMessage(), or -1
+  const uint8_t *inflated;  // inflated bytes not yet handed to the consumer
+  size_t inflatedLength;
+  size_t tailFed;           // bytes of WebSocketInflater::MESSAGE_TAIL fed into the inflater
+  WebSocketInflater::Result inflateResult;
+
+  // dynamic state parameters: control frames
+  bool supressRepeatedRSVWarnings;
+  ControlFrame interleaved[MAX_INTERLEAVED_CONTROL_FRAMES]; // received while reading a message, not reported yet
+  size_t interleavedCount;
+  size_t interleavedReported; // reported by poll() so far, in order of arrival
+  uint8_t control[125]; // payload of the most recently reported control frame
+  size_t controlLength;
+};
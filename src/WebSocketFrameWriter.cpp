@@ -0,0 +1,94 @@
+#include "WebSocketFrameWriter.h"
+
+// CLASS WebSocketFrameWriter
+
+// Serializes masked client-to-server WebSocket frames into a scratch buffer, so that header,
+// mask key and payload are emitted with as few `Client::write()` calls as possible.
+
+const uint8_t WebSocketFrameWriter::OPCODE_TEXT = 0x1;
+const uint8_t WebSocketFrameWriter::OPCODE_PONG = 0xA;
+
+// longest header: 2 fixed bytes + 8 bytes extended length + 4 bytes mask key
+static const size_t MAX_HEADER_LENGTH = 14;
+
+// Scratch capacity is rounded up to a multiple of 4, so that payload chunks keep their alignment
+// to the mask key, and is at least large enough for a header plus a few payload bytes.
+static size_t scratchSizeFor(size_t requested) {
+  if (requested < 2 * MAX_HEADER_LENGTH) requested = 2 * MAX_HEADER_LENGTH;
+  return (requested + 3) & ~(size_t)3;
+}
+
+WebSocketFrameWriter::WebSocketFrameWriter(size_t scratchCapacity)
+    : scratchCapacity(scratchSizeFor(scratchCapacity)), scratch(new uint8_t[scratchSizeFor(scratchCapacity)]) {
+}
+
+// FUNCTION send:
+// Sends a single (final) frame with the given opcode. Returns true if all bytes were accepted by the client.
+bool WebSocketFrameWriter::send(Client *client, uint8_t opcode, const uint8_t *payload, size_t payloadLength) {
+  // Generate random mask key
+  uint8_t maskKey[4];
+  for (int i = 0; i < 4; ++i)
+    maskKey[i] = random(0, 256);
+
+  // First write: header + mask + as much of the masked payload as fits into the scratch buffer.
+  // The payload part is truncated to a multiple of 4 (unless it is the tail), so that all
+  // subsequent chunks start at mask-key offset 0.
+  size_t headerLength = writeHeader(scratch, opcode, payloadLength, maskKey);
+  size_t chunk = scratchCapacity - headerLength;
+  if (chunk < payloadLength) chunk &= ~(size_t)3;
+  if (chunk > payloadLength) chunk = payloadLength;
+  mask(scratch + headerLength, payload, chunk, maskKey);
+  bool ok = client->write(scratch, headerLength + chunk) == headerLength + chunk;
+
+  // Remaining payload (only for frames larger than the scratch buffer)
+  for (size_t offset = chunk; ok && offset < payloadLength; offset += chunk) {
+    chunk = payloadLength - offset;
+    if (chunk > scratchCapacity) chunk = scratchCapacity;
+    mask(scratch, payload + offset, chunk, maskKey);
+    ok = client->write(scratch, chunk) == chunk;
+  }
+  client->flush();
+  return ok;
+}
+
+// FUNCTION writeHeader:
+// writes FIN + opcode, MASK bit + payload length (7, 7+16 or 7+64 bit form) and the mask key into `dst`;
+// returns the number of header bytes written
+size_t WebSocketFrameWriter::writeHeader(uint8_t *dst, uint8_t opcode, uint64_t payloadLength, const uint8_t maskKey[4]) {
+  size_t headerLength = 2;
+  dst[0] = 0x80 | opcode; // FIN + opcode
+  if (payloadLength <= 125) {
+    dst[1] = 0x80 | payloadLength;
+  } else if (payloadLength <= 65535) {
+    dst[1] = 0x80 | 126;
+    dst[2] = (payloadLength >> 8) & 0xFF;
+    dst[3] = payloadLength & 0xFF;
+    headerLength += 2;
+  } else {
+    dst[1] = 0x80 | 127;
+    for (int i = 0; i < 8; ++i)
+      dst[2 + i] = (payloadLength >> (56 - 8 * i)) & 0xFF;
+    headerLength += 8;
+  }
+  memcpy(dst + headerLength, maskKey, 4);
+  return headerLength + 4;
+}
+
+// FUNCTION mask:
+// XORs `src` with the repeating 4-byte mask key into `dst`, one 32-bit word at a time. The mask key
+// is loaded into a word with the same in-memory byte order as the payload, so the result does not
+// depend on the CPU's endianness. `memcpy` keeps unaligned loads/stores well-defined.
+void WebSocketFrameWriter::mask(uint8_t *dst, const uint8_t *src, size_t length, const uint8_t maskKey[4]) {
+  uint32_t maskWord;
+  memcpy(&maskWord, maskKey, 4);
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4) {
+    uint32_t word;
+    memcpy(&word, src + i, 4);
+    word ^= maskWord;
+    memcpy(dst + i, &word, 4);
+  }
+  for (; i < length; ++i) {
+    dst[i] = src[i] ^ maskKey[i & 3];
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+class WebSocketFrameWriter {
+
+  // This class serializes client-to-server WebSocket frames (RFC 6455, section 5.2). Per spec,
+  // every frame sent by a client must be masked with a random 4-byte key. Header, mask key and
+  // masked payload are assembled in a scratch buffer and handed to the client with a single
+  // `write()`, so that a frame leaves as one TCP segment (or one TLS record on SSL connections)
+  // rather than one per payload byte.
+  //
+  // Masking is done 32 bits at a time. Payloads that exceed the scratch buffer are sent in
+  // multiple writes of at most `scratchCapacity` bytes each; the common case (subscription
+  // messages, PONG replies) fits into a single write.
+
+  public:
+  WebSocketFrameWriter(size_t scratchCapacity);
+
+  bool send(Client *client, uint8_t opcode, const uint8_t *payload, size_t payloadLength);
+
+  static const uint8_t OPCODE_TEXT;
+  static const uint8_t OPCODE_PONG;
+
+  private:
+  static size_t writeHeader(uint8_t *dst, uint8_t opcode, uint64_t payloadLength, const uint8_t maskKey[4]);
+  static void mask(uint8_t *dst, const uint8_t *src, size_t length, const uint8_t maskKey[4]);
+
+  // behavioral parameters are lifetime-constants (provided at construction)
+  const size_t scratchCapacity; // multiple of 4, at least large enough for the longest frame header
+  uint8_t *const scratch;
+};
@@ -0,0 +1,106 @@
+#include "WebSocketInflater.h"
+
+// CLASS WebSocketInflater
+
+// Streaming decompression for the WebSocket `permessage-deflate` extension, built on the tinfl
+// inflater in the ESP32's ROM. Memory use is bounded by the negotiated window size.
+
+const uint8_t WebSocketInflater::MIN_WINDOW_BITS = 8;
+const uint8_t WebSocketInflater::MAX_WINDOW_BITS = 15;
+
+// tail that the sender removes from every compressed message (RFC 7692, section 7.2.2)
+const uint8_t WebSocketInflater::MESSAGE_TAIL[4] = {0x00, 0x00, 0xFF, 0xFF};
+
+WebSocketInflater::WebSocketInflater()
+    : decompressor(nullptr), window(nullptr), windowSize(0), noContextTakeover(false), windowPos(0),
+      statsCompressed(0), statsInflated(0), statsMicros(0) {
+}
+
+bool WebSocketInflater::configure(uint8_t windowBits, bool noContextTakeover) {
+  if (windowBits < MIN_WINDOW_BITS || windowBits > MAX_WINDOW_BITS) {
+    Serial.printf("❌ Unsupported deflate window of %u bits\n", windowBits);
+    return false;
+  }
+  this->noContextTakeover = noContextTakeover;
+
+  if (!decompressor) {
+    decompressor = static_cast<tinfl_decompressor *>(malloc(sizeof(tinfl_decompressor)));
+    if (!decompressor) {
+      Serial.println(F("❌ malloc failed"));
+      return false;
+    }
+  }
+
+  const size_t size = (size_t)1 << windowBits;
+  if (size != windowSize) { // only re-allocate if the negotiated window changed
+    free(window);
+    window = static_cast<uint8_t *>(malloc(size));
+    windowSize = window ? size : 0;
+    if (!window) {
+      Serial.println(F("❌ malloc failed"));
+      return false;
+    }
+  }
+  reset();
+  return true;
+}
+
+void WebSocketInflater::reset() {
+  if (decompressor) tinfl_init(decompressor);
+  windowPos = 0;
+}
+
+// FUNCTION inflate:
+// Decompresses up to `inLength` bytes of a compressed message. On return, `consumed` holds the number
+// of input bytes used and `out`/`produced` the inflated bytes, which remain valid until the next call.
+// If the result is HasMoreOutput, the window filled up before all input was used (or tinfl holds back
+// further output); the caller should consume `out` and call again.
+WebSocketInflater::Result WebSocketInflater::inflate(const uint8_t *in, size_t inLength, size_t *consumed, const uint8_t **out, size_t *produced) {
+  *consumed = 0;
+  *produced = 0;
+  *out = window + windowPos;
+  if (!decompressor || !window) return Result::Failed;
+  const unsigned long startUS = micros();
+
+  size_t inSize = inLength;
+  size_t outSize = windowSize - windowPos;
+  // Not passing TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF makes tinfl treat `window` as a circular
+  // buffer of size `windowSize`; back-references are resolved from the data it wrote previously.
+  tinfl_status status = tinfl_decompress(decompressor, in, &inSize, window, window + windowPos, &outSize, TINFL_FLAG_HAS_MORE_INPUT);
+  *consumed = inSize;
+  *produced = outSize;
+  windowPos = (windowPos + outSize) & (windowSize - 1);
+  statsCompressed += inSize;
+  statsInflated += outSize;
+  statsMicros += micros() - startUS;
+
+  if (status < TINFL_STATUS_DONE) {
+    Serial.printf("❌ Inflate failed (status %d)\n", (int)status);
+    return Result::Failed;
+  }
+  if (status == TINFL_STATUS_DONE) {
+    // sender terminated the deflate stream (BFINAL); anything that follows starts a new stream
+    tinfl_init(decompressor);
+    return inSize < inLength ? Result::HasMoreOutput : Result::NeedsInput;
+  }
+  return status == TINFL_STATUS_HAS_MORE_OUTPUT ? Result::HasMoreOutput : Result::NeedsInput;
+}
+
+// FUNCTION finishMessage:
+// Called once a compressed message (including MESSAGE_TAIL) was fully inflated.
+void WebSocketInflater::finishMessage() {
+  statsCompressed -= sizeof(MESSAGE_TAIL); // not transmitted, so not counted
+  if (noContextTakeover) reset();
+}
+
+unsigned long WebSocketInflater::compressedBytes() const {
+  return statsCompressed;
+}
+
+unsigned long WebSocketInflater::inflatedBytes() const {
+  return statsInflated;
+}
+
+unsigned long WebSocketInflater::inflateMicros() const {
+  return statsMicros;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+
+#include "rom/miniz.h" // tinfl (miniz' inflater) is part of the ESP32's ROM; no additional code size
+
+class WebSocketInflater {
+
+  // This class decompresses messages of the WebSocket `permessage-deflate` extension (RFC 7692).
+  // It works as a pull-based filter: the consumer hands in the next chunk of compressed bytes
+  // (in arbitrary sizes, across frame boundaries) and receives a pointer to the inflated bytes
+  // that this produced. These point into the inflater's window and stay valid until the next call.
+  //
+  // Memory is bounded: the inflater only needs its sliding window, whose size is negotiated
+  // during the handshake via `server_max_window_bits` (2^bits bytes), plus tinfl's state.
+  // Both are allocated once and reused for all subsequent messages. The window doubles as
+  // tinfl's (wrapping) output buffer, so no further buffers are needed.
+  //
+  // Per RFC 7692, the sender strips the trailing 0x00 0x00 0xFF 0xFF of each message's deflate
+  // block, which the consumer has to feed in (see MESSAGE_TAIL) to complete the message.
+  // Unless `server_no_context_takeover` was negotiated, the window is carried over to the next
+  // message, as the server may reference data from previous messages.
+
+  public:
+  enum class Result {
+    NeedsInput,    // all input consumed; feed more compressed bytes (or the message is complete)
+    HasMoreOutput, // output window is full; call again (with or without further input) after consuming `out`
+    Failed,        // corrupt input; inflater must be reset
+  };
+
+  WebSocketInflater();
+
+  bool configure(uint8_t windowBits, bool noContextTakeover); // allocates the window; call on every (re-)negotiation
+  Result inflate(const uint8_t *in, size_t inLength, size_t *consumed, const uint8_t **out, size_t *produced);
+  void finishMessage();
+  void reset();
+
+  // statistics, for measuring the effect of compression
+  unsigned long compressedBytes() const;
+  unsigned long inflatedBytes() const;
+  unsigned long inflateMicros() const;
+
+  static const uint8_t MIN_WINDOW_BITS;
+  static const uint8_t MAX_WINDOW_BITS;
+  static const uint8_t MESSAGE_TAIL[4];
+
+  private:
+  // behavioral parameters, set by negotiation
+  tinfl_decompressor *decompressor;
+  uint8_t *window;
+  size_t windowSize; // power of two
+  bool noContextTakeover;
+
+  // dynamic state parameters
+  size_t windowPos; // position in `window` where tinfl writes its next output
+  unsigned long statsCompressed;
+  unsigned long statsInflated;
+  unsigned long statsMicros;
+};
@@ -0,0 +1,30 @@
+#include "WebSocketMessageStream.h"
+
+// CLASS WebSocketMessageStream
+
+// Read-only `Stream` over the payload of the message that the WebSocket parser has fully buffered.
+
+WebSocketMessageStream::WebSocketMessageStream(WebSocketFrameParser *parser) : parser(parser) {
+}
+
+int WebSocketMessageStream::available() {
+  return parser->messageExhausted() ? 0 : 1; // exact count is unknown for compressed messages, so we report a lower bound
+}
+
+int WebSocketMessageStream::read() {
+  uint8_t c;
+  return parser->readMessage(&c, 1) == 1 ? c : -1;
+}
+
+int WebSocketMessageStream::peek() {
+  return parser->peekMessage();
+}
+
+// bulk read without Stream's per-byte timeout handling, as all bytes of the message are buffered already
+size_t WebSocketMessageStream::readBytes(char *buffer, size_t length) {
+  return parser->readMessage(reinterpret_cast<uint8_t *>(buffer), length);
+}
+
+size_t WebSocketMessageStream::write(uint8_t) {
+  return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+
+#include "WebSocketFrameParser.h"
+
+class WebSocketMessageStream : public Stream {
+
+  // This class exposes the payload of the WebSocket message that the parser reported as ready
+  // (`WebSocketFrameParser::Event::MessageReady`) as an Arduino `Stream`. Frame headers of
+  // continuation frames are skipped and compressed messages are inflated transparently, so that
+  // consumers such as ArduinoJson's `deserializeJson(doc, stream)` read the message text directly
+  // out of the receive buffer -- no intermediate copy of the message is ever assembled.
+  //
+  // All bytes of the message are already buffered when it is reported ready, hence reads never
+  // wait for the network. The stream ends (read() returns -1) at the end of the message.
+  // Caution: once the consumer is done, `WebSocketFrameParser::finishMessage()` must be called.
+
+  public:
+  WebSocketMessageStream(WebSocketFrameParser *parser);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t write(uint8_t) override; // read-only; writes are ignored
+
+  private:
+  WebSocketFrameParser *const parser;
+};
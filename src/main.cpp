@@ -1,11 +1,32 @@
-#include "mbedtls/base64.h" // bundled with ESP32‑Arduino core
 #include <ArduinoJson.h>
+#include <atomic>
+#include <inttypes.h>
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 
 // custom utils
+#include "AccessNodeSelector.h"
+#include "Base64DecodingStream.h"
+#include "ConnectionManager.h"
+#include "JsonCadenceReader.h"
+#include "ControllerCheckpoint.h"
+#include "DesiredState.h"
+#include "EventOrderingStage.h"
+#include "EventRegistry.h"
+#include "IngestQueue.h"
 #include "LedUtils.h"
+#include "MessageArena.h"
 #include "OnChainState.h"
+#include "OnChainStateWorker.h"
+#include "PinnedTask.h"
+#include "RxRingBuffer.h"
+#include "SpscQueue.h"
+#include "StreamWatchdog.h"
+#include "SubscriptionManager.h"
+#include "WebSocketFrameParser.h"
+#include "WebSocketFrameWriter.h"
+#include "WebSocketInflater.h"
+#include "WebSocketMessageStream.h"
 
 /* ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ CONTROLLER INITIALIZATION ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ */
 
@@ -20,15 +41,27 @@
 // The AN's root certificate authority is the ISRG Root X1, wich we can import below.
 // #include "isrg_root_x1.h"
 
-/* Websocket Server configuration
- * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
-// const char *host = "rest-mainnet.onflow.org";              // MAINNET server, only permits SSL connections
-// const char *host = "rest-testnet.onflow.org"; // TESTNET server, only permits SSL connections
-const char *host = "access-001.devnet52.nodes.onflow.org"; // TESTNET server, only permits plaintext connections!
+/* Access Node configuration
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴
+ * The controller connects to the first node and fails over to the others (ranked by their round-trip times,
+ * see AccessNodeSelector.h) when it misbehaves. All nodes must serve the SAME network. Each node's REST API
+ * (for script execution) is used together with its WebSocket API. */
+const AccessNode ACCESS_NODES[] = {
+    // host, SSL, WebSocket port, REST port
+    {"access-001.devnet52.nodes.onflow.org", false, 8075, 8070}, // TESTNET server, only permits plaintext connections!
+    {"rest-testnet.onflow.org", true, 443, 443},                 // TESTNET server, only permits SSL connections
+};
+// const AccessNode ACCESS_NODES[] = {
+//     {"rest-mainnet.onflow.org", true, 443, 443}, // MAINNET server, only permits SSL connections
+// };
 const char *path = "/v1/ws";
+const unsigned long accessNodeProbeIntervalMS = 15000; // probe one node (round robin) every 15 seconds
+const unsigned long accessNodeProbeTimeoutMS = 2000;   // bounds how long a probe holds up a state read queued behind it
 
-// Set to 1 for SSL, 0 for plain text
-#define USE_SSL 0
+// Set to 1 to offer the `permessage-deflate` extension (compressed messages) in the handshake, 0 to disable.
+// The server's sliding window (2^wsDeflateWindowBits bytes) determines the memory needed for decompression.
+#define USE_PERMESSAGE_DEFLATE 1
+const int wsDeflateWindowBits = 11;
 
 /* Flow Events we are interested in:
  * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴
@@ -39,32 +72,58 @@ const char *path = "/v1/ws";
  *   a transaction interacts with the on-chain controller.
  */
 
-const char *const EVENT_TYPES[] = {
-    // "A.8c5303eaa26202d6.EVM.BlockExecuted",
-    "A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged"
+// Each event type is subscribed to and mapped to the handler that processes its payload (nullptr: only log the event).
+// The registry's hash table is built at compile time; routing an incoming event is a single hash lookup of its type.
+// High-rate event types that are merely observed should be registered as `EventPriority::Telemetry`: under load,
+// they are coalesced per block and shed before anything else (see IngestQueue.h).
+void processControlInstruction(const char *encodedPayload);
+
+constexpr EventType EVENT_TYPES[] = {
+    // {"A.8c5303eaa26202d6.EVM.BlockExecuted", nullptr, EventPriority::Telemetry},
+    // {"A.912d5440f7e3769e.FlowFees.FeesDeducted", nullptr, EventPriority::Telemetry},
+    {"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged", processControlInstruction},
     // Add more event types here as needed
 };
+constexpr EventRegistry EVENT_REGISTRY(EVENT_TYPES);
 
 /* CONTROLLER SETUP
  * ━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━ */
 
 /* Websocket client: global variables
  * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
-#if USE_SSL
-WiFiClientSecure sslClient;
-const int port = 443;
-#else
-WiFiClient plainClient;
-const int port = 8075;
-#endif
-Client *client = nullptr;
+WiFiClientSecure sslClient;                 // for Access Nodes with `useSsl`
+WiFiClient plainClient;                     // for all others
+Client *client = nullptr;                   // one of the above, matching the current Access Node
+AccessNodeSelector *accessNodes = nullptr; // only accessed by the network task after setup()
 
 /* Insternal State of the Websocket client */
-String wsBuffer = "";     // holds full message as it arrives
-bool wsReceiving = false; // tracks whether we’re in a multi-frame message
-
-/* Websocket client: global variables ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
-bool supressRepeatedRSVWarnings = false;
+const size_t wsRxBufferCapacity = 16384;     // receive buffer for raw frames; bounds the size of a message as received on the wire
+const size_t wsTxScratchCapacity = 1024;     // outgoing frames up to this size (incl. header) are sent with one write
+RxRingBuffer *wsRxBuffer = nullptr;          // raw bytes from the socket, filled via bulk reads
+WebSocketFrameParser *wsParser = nullptr;    // resumable frame parser, consuming `wsRxBuffer`
+WebSocketMessageStream *wsMessage = nullptr; // payload of a complete message, read directly from `wsRxBuffer`
+WebSocketFrameWriter *wsWriter = nullptr;    // assembles outgoing masked frames for a single write
+WebSocketInflater *wsInflater = nullptr;     // decompresses permessage-deflate messages, if negotiated
+
+/* Deserialization of WebSocket messages
+ * Only the fields listed in `wsMessageFilter` are kept when deserializing a message; everything else the
+ * server sends (transaction ids and indices, subscription metadata, ...) is skipped while parsing. Hence
+ * the document only needs to hold the retained fields: for `ControlValueChanged` events, that is about
+ * 600 bytes per event (dominated by the base64-encoded payload), so 8 KB is ample for a block's events.
+ * All transient memory for processing a message lives in `wsArena`, which is reset after each message.
+ * (ArduinoJson 7 sizes every document to its content; `StaticJsonDocument<N>` merely aliases `JsonDocument`
+ * and ignores N, so declared capacities say nothing about the memory a document takes.) */
+const size_t wsMessageArenaCapacity = 8192;
+JsonDocument wsMessageFilter;                     // on the heap, built once in setup(), see buildWebSocketMessageFilter()
+MessageArena *wsArena = nullptr;                  // per-message memory: JSON documents and strings
+ArenaJsonAllocator *wsJsonAllocator = nullptr;    // places JsonDocuments into `wsArena`
+
+/* Subscriptions, all multiplexed over the one WebSocket connection (see SubscriptionManager.h)
+ * Incoming messages are routed by their `subscription_id`. After a reconnect, every subscription is
+ * re-established; the events subscription only once the on-chain state is known (see subscribeToEvents()). */
+SubscriptionManager *subscriptions = nullptr; // only accessed by the network task after setup()
+size_t eventsSubscription = SubscriptionManager::NONE;
+size_t digestsSubscription = SubscriptionManager::NONE;
 
 /* LED Blinking patterns to indicate current state ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
 LEDToggler *blueToggler = nullptr;  // blinks 5 times turning o1 second
@@ -81,24 +140,214 @@ LEDToggler *redToggler = nullptr;   // blinks 5 times turning o1 second
 #define EXT_LOAD_ON HIGH
 #define EXT_LOAD_OFF LOW
 
+/* Dual-core pipeline
+ * The network task, pinned to core 0 next to the WiFi stack, maintains the connection, reads frames and
+ * parses messages. The actuator -- the Arduino loop() on core 1 -- switches the external load and drives
+ * the LEDs. A large message therefore never delays switching. The network task publishes the desired
+ * controller state, which the actuator compares on every pass -- a state can't get lost, only superseded.
+ * Heartbeat blinks are merely cosmetic; they are handed over through a lock-free queue and dropped if full.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+DesiredState desiredState;                             // network task -> actuator
+SpscQueue<unsigned long, 16> heartbeatQueue;           // network task -> actuator; micros() when each was queued
+const int networkTaskCore = 0;                         // PRO_CPU, where the WiFi stack runs; loop() runs on core 1
+const uint32_t networkTaskStackBytes = 12288;          // HTTP, TLS and JSON processing happen on this task
+unsigned long droppedHeartbeats = 0;                   // heartbeat blinks not queued because the actuator fell behind
+std::atomic<unsigned long> worstCommandLatencyUS(0);   // longest time from publishing a state or heartbeat to applying it
+
 /* Internal representation of the state
  * We are using an 'eventually consistent' approach here.
  * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
-OnChainState *scriptExecuter = nullptr;
+OnChainState *scriptExecuter = nullptr; // REST API of the current Access Node, for backfilling events on the network task
 bool extLoadOn = false; // state of the external load
 
+/* Reading the on-chain state without stalling the network task (see OnChainStateWorker.h)
+ * Script execution takes two round trips to the Access Node and, if the node is slow, up to the HTTP timeouts.
+ * It runs on a task of its own; meanwhile, the network task keeps servicing the WebSocket connection (pings,
+ * timeouts, the red LED) and applies the state once it is delivered. The access node probes run there as well.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const int stateReaderTaskCore = 0;                // next to the network task; the actuator's core stays free
+const uint32_t stateReaderTaskStackBytes = 8192;  // HTTP, TLS and JSON processing
+OnChainStateWorker *stateReader = nullptr;         // submitted to and polled by the network task only
+bool stateReadPending = false;                    // a state read is in flight; subscribing waits for it
+uint32_t accessNodeProbeTicket = 0;               // of the probe in flight, if any
+size_t probedAccessNode = 0;                      // ... and the node it measures
+
+/* Persistent checkpoint of the controller's progress (see ControllerCheckpoint.h for the flash wear budget)
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const unsigned long checkpointIntervalMS = 60000; // write the checkpoint to flash at most once a minute
+ControllerCheckpoint *checkpoint = nullptr;       // only accessed by the network task after setup()
+
+/* (Re-)establishing the connection (see ConnectionManager.h)
+ * Each stage is bounded by a timeout; after a failure or a lost connection, the next attempt is delayed
+ * by a randomised, exponentially growing backoff, so a fleet of devices doesn't reconnect in lockstep.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const unsigned long reconnectBackoffBaseMS = 2000; // first retry after 1–2 s ...
+const unsigned long reconnectBackoffCapMS = 60000; // ... doubling per consecutive failure, up to 30–60 s
+const unsigned long wifiJoinTimeoutMS = 20000;
+const unsigned long transportTimeoutMS = 10000; // TCP connect, incl. the TLS handshake for SSL nodes
+const unsigned long upgradeTimeoutMS = 5000;    // until the handshake response's headers are complete
+const unsigned long subscribeTimeoutMS = 20000; // until the node confirms the subscription, incl. reading the state first
+ConnectionManager *connection = nullptr;        // only accessed by the network task after setup()
+char handshakeLine[256];                        // response header line being received; longer lines are truncated
+size_t handshakeLineLength = 0;
+bool handshakeStatusReceived = false;           // the response's status line has been checked
+bool deflateNegotiated = false;
+bool subscriptionRejected = false;              // the node answered the events subscription with an error
+
+/* Resuming the event stream after a reconnect
+ * Every message in the `events` topic covers one block (heartbeats cover blocks without relevant events).
+ * We remember the last block we have processed and re-subscribe with `start_block_height` right after it,
+ * so the Access Node replays whatever we missed while disconnected. Only if we were disconnected for too
+ * long -- the node only replays from recent blocks -- or the node rejects the start height, the on-chain
+ * state is re-read via script execution (which also yields a new starting point for the subscription).
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const unsigned long maxResumeGapMS = 5UL * 60 * 1000; // ~300 blocks at Flow's ~1 block/s; beyond that, re-read the state
+unsigned long lastProcessedBlockHeight = 0;           // 0 if unknown, then the subscription starts at the latest block
+unsigned long lastProcessedBlockMS = 0;               // when `lastProcessedBlockHeight` was last updated
+unsigned long disconnectedSinceMS = 0;                // when the connection loss was detected; 0 while consistent
+bool subscribedWithStartHeight = false;               // the current subscription asked the node to replay from a start height
+bool resubscribePending = false;                      // the node rejected that; re-read state and re-subscribe
+bool resubscribeAfterStateRead = false;               // ... once the state read requested for that completes
+unsigned long resumedSubscriptions = 0;               // reconnects that continued from `lastProcessedBlockHeight`
+unsigned long stateReReads = 0;                       // reconnects that needed a script execution instead
+
+/* Liveness of the event stream (see StreamWatchdog.h)
+ * The node sends a message at least every `heartbeatIntervalBlocks` blocks. If the block height doesn't advance
+ * for `stallAfterMissedHeartbeats` such intervals, the connection is presumed half-open: it is torn down and the
+ * subscription resumed from the last processed block, instead of waiting minutes for TCP to notice.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const unsigned int heartbeatIntervalBlocks = 5;    // requested as `heartbeat_interval` in the subscription
+const unsigned long maxBlockIntervalMS = 1500;     // Flow seals a block about every 0.8 s; allow for slower periods
+const unsigned int stallAfterMissedHeartbeats = 3; // i.e. a stall is detected after ~22 s of silence
+StreamWatchdog *streamWatchdog = nullptr;          // only accessed by the network task after setup()
+
+/* Tracking the sealed head via a second subscription on the same connection
+ * The `block_digests` topic delivers the ID and height of every block once it is sealed, so the latest sealed
+ * block is always known without asking the REST API. State reads run the script right at that block, and the
+ * lag of the event stream behind the sealed head is measured with every message. Right after connecting, a
+ * state read waits briefly for the first digest; if none arrives in time, the worker looks the block up.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const char *eventsSubscriptionId = "20charIDStreamEvents"; // subscription ids are limited to 20 characters
+const char *digestsSubscriptionId = "20charIDBlockDigests";
+const unsigned long maxSealedHeadAgeMS = 3000; // older digests are not trusted to name the latest sealed block
+const unsigned long sealedHeadWaitMS = 2000;   // how long a state read waits for the first digest after connecting
+unsigned long sealedHeadHeight = 0;            // 0 until the first digest arrives
+char sealedHeadBlockId[65] = "";               // hex-encoded ID of that block
+unsigned long sealedHeadMS = 0;                // when the last digest arrived
+unsigned long subscribingSinceMS = 0;          // when the subscriptions were sent on the current connection
+bool stateReadDeferred = false;                // a state read awaits the first digest
+unsigned long currentEventLagBlocks = 0;       // blocks between the sealed head and the latest events message
+unsigned long worstEventLagBlocks = 0;         // within the current reporting window
+unsigned long stateReadsAtSealedHead = 0;      // state reads that went straight to the script execution
+unsigned long stateReadsWithLookup = 0;        // ... and those that had to look up the latest sealed block
+
+/* Detecting lost messages and backfilling them
+ * Two counters reveal lost messages: the node numbers the messages of a subscription consecutively
+ * (`message_index`), and the contract numbers control events consecutively (`eventSequence`). On a gap, the
+ * events of the affected blocks are fetched from the node's REST API and applied, in order, before the
+ * message that revealed the gap. Events that were applied already are recognised by their `eventSequence`
+ * and skipped. If the backfill fails, the connection is dropped: the subscription then resumes right after
+ * the last block that was processed completely, and the node replays the gap.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const unsigned long maxBackfillBlocks = 1000; // larger gaps are left to the node's replay when resuming
+unsigned long expectedMessageIndex = 0;       // `message_index` of the next message of the current subscription
+uint64_t lastAppliedEventSequence = 0;        // `eventSequence` of the last applied control event; 0 if unknown
+unsigned long lastEventBlockHeight = 0;       // block of that event (or a lower bound, e.g. the checkpoint's block)
+unsigned long currentEventBlockHeight = 0;    // block of the event being processed
+bool backfilling = false;                     // gaps found while backfilling are not backfilled again
+bool eventStreamBroken = false;               // a gap couldn't be closed; the connection was dropped
+unsigned long messageIndexGaps = 0;
+unsigned long eventSequenceGaps = 0;
+unsigned long backfilledEvents = 0;
+unsigned long duplicateEvents = 0;            // events skipped as they were applied already
+
+/* Ingesting events under load
+ * Receiving a message only queues its events; they are processed a few per pass of the network task. When
+ * events arrive faster than that, the queue sheds heartbeats first and coalesces telemetry events of the same
+ * type and block, but never drops control events (see IngestQueue.h). Above the high watermark, no further
+ * messages are read: they stay in the socket, and TCP's flow control slows down the node.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const size_t ingestQueueCapacity = 32;      // items (events and ends of blocks)
+const size_t ingestPayloadCapacity = 768;   // bytes per item, for the base64-encoded payload incl. terminator
+const size_t ingestHighWatermark = 24;      // stop reading messages at this depth
+const size_t ingestItemsPerIteration = 4;   // items processed per pass of the network task
+IngestQueue *ingestQueue = nullptr;
+unsigned long inlineControlEvents = 0;      // control events processed right away, as they couldn't be queued
+
+/* Ordering control events (see EventOrderingStage.h)
+ * Control events are not applied right away, but buffered in (block height, eventSequence) order until their
+ * block is complete. Then only the final value is applied: the external load switches at most once per sealed
+ * block, however many updates the block carries. Events delivered twice, e.g. by the overlapping replay after
+ * a reconnect, are recognised by their transaction ID and index within the transaction.
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const size_t controlUpdateCapacity = 16;      // fragments of non-adjacent updates awaiting the end of their block
+const size_t deliveredEventMemory = 64;       // most recently delivered control events, for deduplication
+EventOrderingStage *controlUpdates = nullptr;
+std::atomic<unsigned long> loadSwitches(0);   // times the actuator actually switched the external load
+
+/* Instrumentation: worst-case duration of a single network task iteration
+ * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
+const unsigned long loopStatsReportIntervalMS = 30000; // report (and reset) the worst-case iteration time every 30 seconds
+unsigned long loopStatsWindowStart = 0;                // timestamp when the current reporting window started
+unsigned long worstLoopIterationUS = 0;                // longest network task iteration within the current window
+
 /* ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ CONTROLLER INITIALIZATION ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ */
 
 /* FUNCTION PROTOTYPES
  * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
-void connectWifi();
-void scriptReadControllerState();
+bool networkTaskIteration();
+bool controllerIteration();
+bool canResumeEventStream();
+void recordProcessedBlock(unsigned long blockHeight);
+void recordControllerState(int64_t state, uint64_t eventSequence);
+bool restoreCheckpoint();
+void publishControllerState(int64_t value);
+void enqueueHeartbeat();
+void recordCommandLatency(unsigned long latencyUS);
+void recordLoopIterationTime(unsigned long iterationUS);
+void reportStatistics(unsigned long windowMS);
+void reportTimingStatistics(unsigned long windowMS);
+void reportConnectionStatistics();
+void reportIngestStatistics();
+void reportOrderingStatistics();
+void reportRestStatistics();
+void reportMemoryStatistics();
+ConnectionManager::Progress connectionStep(ConnectionManager::Stage stage, bool entering);
+void dropConnection(ConnectionManager::Stage failedStage);
+ConnectionManager::Progress joinWifi(bool entering);
+ConnectionManager::Progress connectTransport();
+ConnectionManager::Progress upgradeToWebSocket(bool entering);
+ConnectionManager::Progress subscribeToEvents(bool entering);
+String restBaseURL(const AccessNode &node);
+void useCurrentAccessNode();
+void probeAccessNodeIfDue();
+void recordAccessNodeProbe(const OnChainStateWorker::Result &result);
+void completeStateReaderRequest(const OnChainStateWorker::Result &result);
+bool stateReaderIteration();
+void requestControllerState();
+void applyControllerState(const OnChainStateWorker::Result &result);
 void setControllerState(int64_t newValue);
-void connectAndSubscribeWebsockets();
-void sendWebSocketFrame(const String &payload);
+void buildEventsArguments(JsonObject args);
+void buildBlockDigestArguments(JsonObject args);
+bool sealedHeadIsFresh();
+bool configurePermessageDeflate(String headerLine);
+bool sendWebSocketFrame(const char *payload, size_t length);
 bool readWebSocketFrame();
+void buildWebSocketMessageFilter();
 void processWebSocketMessage();
+void dispatchWebSocketMessage(JsonDocument &doc);
+void processEventsMessage(JsonDocument &doc);
+void processEventsError(JsonDocument &doc);
+void processBlockDigestMessage(JsonDocument &doc);
+void processBlockDigestError(JsonDocument &doc);
 void processControlInstruction(const char *encodedPayload);
+bool backfillEvents(unsigned long startHeight, unsigned long endHeight);
+void applyBackfilledEvent(unsigned long blockHeight, const char *type, const char *payload);
+void abandonEventStream();
+bool processIngestQueue(size_t budget);
+void processIngestItem(const IngestQueue::Item &item);
+bool completeBlock(unsigned long blockHeight);
+void applyControlUpdates(unsigned long blockHeight);
 
 /* FRAMEWORK FUNCTION setup(): called by Arduino framework once at startup
  * ━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━ */
@@ -122,413 +371,899 @@ void setup() {
   digitalWrite(EXT_LOAD_SWITCH, EXT_LOAD_OFF); // off by detault for safety
   delay(1000);                                 // for debugging, wait 1 second for serial monitor to connect
 
-  scriptExecuter = new OnChainState("http://" + String(host) + ":8070/v1/");
+  accessNodes = new AccessNodeSelector(ACCESS_NODES, sizeof(ACCESS_NODES) / sizeof(ACCESS_NODES[0]), accessNodeProbeIntervalMS);
+  useCurrentAccessNode();
+  wsRxBuffer = new RxRingBuffer(wsRxBufferCapacity);
+  wsParser = new WebSocketFrameParser(wsRxBuffer);
+  wsMessage = new WebSocketMessageStream(wsParser);
+  wsWriter = new WebSocketFrameWriter(wsTxScratchCapacity);
+  wsArena = new MessageArena(wsMessageArenaCapacity);
+  wsJsonAllocator = new ArenaJsonAllocator(wsArena);
+  buildWebSocketMessageFilter();
+  ingestQueue = new IngestQueue(ingestQueueCapacity, ingestPayloadCapacity, ingestHighWatermark);
+  controlUpdates = new EventOrderingStage(controlUpdateCapacity, deliveredEventMemory);
+  subscriptions = new SubscriptionManager(wsArena, wsJsonAllocator, sendWebSocketFrame);
+  digestsSubscription = subscriptions->add(digestsSubscriptionId, "block_digests", buildBlockDigestArguments, processBlockDigestMessage, processBlockDigestError);
+  eventsSubscription = subscriptions->add(eventsSubscriptionId, "events", buildEventsArguments, processEventsMessage, processEventsError);
+#if USE_PERMESSAGE_DEFLATE
+  wsInflater = new WebSocketInflater();
+#endif
 
-  connectWifi();
-  scriptReadControllerState();     // initial read the on-chain state via script execution
-  connectAndSubscribeWebsockets(); // keep updates via websockets stream of events
+  checkpoint = new ControllerCheckpoint(checkpointIntervalMS);
+  restoreCheckpoint(); // switches the load right away, before any network activity
+
+  // Wi-Fi, the WebSocket connection and the subscriptions are established by the network task; the initial
+  // on-chain state is read right before subscribing, unless the event stream can be resumed from the checkpoint
+  streamWatchdog = new StreamWatchdog(heartbeatIntervalBlocks * maxBlockIntervalMS, stallAfterMissedHeartbeats);
+  connection = new ConnectionManager(connectionStep, dropConnection, reconnectBackoffBaseMS, reconnectBackoffCapMS);
+  connection->setStageTimeout(ConnectionManager::Stage::WifiJoining, wifiJoinTimeoutMS);
+  connection->setStageTimeout(ConnectionManager::Stage::Transport, transportTimeoutMS);
+  connection->setStageTimeout(ConnectionManager::Stage::Upgrade, upgradeTimeoutMS);
+  connection->setStageTimeout(ConnectionManager::Stage::Subscribing, subscribeTimeoutMS);
+
+  // from here on, all network activity happens on the network task (and the state reader); loop() only actuates
+  stateReader = new OnChainStateWorker(completeStateReaderRequest, accessNodeProbeTimeoutMS);
+  startPinnedTask("stateReader", stateReaderIteration, stateReaderTaskCore, stateReaderTaskStackBytes, 1);
+  startPinnedTask("network", networkTaskIteration, networkTaskCore, networkTaskStackBytes, 1);
 }
 
 /* ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ CONTROLLER LOOP ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ */
 
-/* Frequency bound for controller reconnection attempts in Milliseconds
- * ╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴╴ */
-const unsigned long reconnectionAttemptIntervalMS = 2000; // at most attempt to re-establish connection every 2 seconds
-unsigned long latestReconnectionAttempt = 0;              // timestamp of last reconnection attempt
-
+// FRAMEWORK FUNCTION loop(): the actuator, running on core 1
+// applies the state and heartbeats published by the network task and works through the LEDs' blinking cycles
 void loop() {
-  // If not connected, try to reconnect
-  if (!client || !client->connected()) {
-    unsigned long currentMS = millis();
-    if (currentMS - latestReconnectionAttempt < reconnectionAttemptIntervalMS) {
-      return; // don't attempt to reconnect yet
-    }
-
-    Serial.println(F("⚠️ Lost connection, attempting to reconnect..."));
-    latestReconnectionAttempt = currentMS;
-    client->stop(); // Ensure client is stopped before reconnecting
-    delay(100);
-
-    connectWifi();         // Optional: re-check WiFi connection
-    redToggler->trigger(); // blink red LED to indicate reconnection attempt
-    while (true) {
-      delay(20);
-      redToggler->toggleLED();
-      if (redToggler->isExpired()) break;
-    }
-    scriptReadControllerState();     // initial read the on-chain state via script execution
-    connectAndSubscribeWebsockets(); // keep updates via websockets stream of events
-    return;
+  int64_t state;
+  uint32_t publishedUS;
+  if (desiredState.take(state, publishedUS)) { // only the latest state counts; intermediate ones are skipped
+    setControllerState(state);
+    recordCommandLatency(static_cast<uint32_t>(micros()) - publishedUS);
   }
-
-  // business logic
-  if (readWebSocketFrame()) {
-    processWebSocketMessage();
+  unsigned long enqueuedUS;
+  while (heartbeatQueue.pop(enqueuedUS)) {
+    greenToggler->trigger(); // blink green LED to indicate heartbeat
+    recordCommandLatency(micros() - enqueuedUS);
   }
 
   // work through blinking cycles of LEDs, to make sure they eventually expire
   blueToggler->toggleLED();
   greenToggler->toggleLED();
+  delay(1); // yield to other tasks on this core
+}
+
+// FUNCTION networkTaskIteration:
+// one pass of the network task's work loop, instrumented; returns true if more work may be pending
+bool networkTaskIteration() {
+  const unsigned long iterationStartUS = micros();
+  const bool busy = controllerIteration();
+  recordLoopIterationTime(micros() - iterationStartUS);
+  return busy;
+}
+
+// FUNCTION stateReaderIteration:
+// one pass of the state reader task: executes the next on-chain state request, if any
+bool stateReaderIteration() {
+  return stateReader->work();
+}
+
+// FUNCTION publishControllerState:
+// hands the new controller state from the network task to the actuator; never blocks, never fails
+void publishControllerState(int64_t value) {
+  desiredState.publish(value, static_cast<uint32_t>(micros()));
+}
+
+// FUNCTION enqueueHeartbeat:
+// asks the actuator to blink the heartbeat; never blocks. Dropped if the actuator fell behind, as it's cosmetic.
+void enqueueHeartbeat() {
+  if (!heartbeatQueue.push(micros())) ++droppedHeartbeats;
+}
+
+// FUNCTION recordCommandLatency:
+// on the actuator: tracks the worst-case time from publishing a state or heartbeat to applying it
+void recordCommandLatency(unsigned long latencyUS) {
+  if (latencyUS > worstCommandLatencyUS.load(std::memory_order_relaxed)) worstCommandLatencyUS.store(latencyUS, std::memory_order_relaxed);
+}
+
+// FUNCTION controllerIteration:
+// one pass of the network task; must return quickly. Returns true if a message was processed or queued events
+// await processing, in which case more work is pending already.
+bool controllerIteration() {
+  stateReader->poll(); // applies the on-chain state, once read, and records access node probes
+  connection->poll(); // advances (re-)connecting by one non-blocking step; detects a lost connection
+
+  // the red LED indicates connection problems and hence belongs to the network task
   redToggler->toggleLED();
+  const bool ingestPending = processIngestQueue(ingestItemsPerIteration);
+  const ConnectionManager::Stage stage = connection->stage();
+  if (stage != ConnectionManager::Stage::Subscribing && stage != ConnectionManager::Stage::Connected) {
+    return ingestPending;
+  }
+
+  // business logic, from the moment the subscription is sent; while the ingest queue is congested, messages
+  // are left in the socket (backpressure)
+  const bool messageReady = !ingestQueue->congested() && readWebSocketFrame();
+  if (messageReady) {
+    processWebSocketMessage();
+  }
+  if (resubscribePending) {
+    resubscribePending = false;
+    ++stateReReads;
+    requestControllerState();
+    resubscribeAfterStateRead = true;
+  }
+  if (resubscribeAfterStateRead && !stateReadPending) { // deferred until here, as sending uses the message arena
+    resubscribeAfterStateRead = false;
+    subscriptions->subscribe(eventsSubscription);
+    streamWatchdog->arm(); // the script execution took a while; give the new subscription a full deadline
+  }
+  if (stage == ConnectionManager::Stage::Connected) {
+    probeAccessNodeIfDue(); // measure the alternatives we could fail over to
+  }
+  return messageReady || ingestQueue->depth() > 0;
+}
+
+// FUNCTION recordLoopIterationTime:
+// tracks the worst-case duration of network task iterations; reports the statistics once per reporting window
+void recordLoopIterationTime(unsigned long iterationUS) {
+  if (iterationUS > worstLoopIterationUS) worstLoopIterationUS = iterationUS;
+
+  const unsigned long currentMS = millis();
+  if (currentMS - loopStatsWindowStart < loopStatsReportIntervalMS) return;
+  reportStatistics(currentMS - loopStatsWindowStart);
+  loopStatsWindowStart = currentMS;
+  worstLoopIterationUS = 0;
+  worstEventLagBlocks = 0;
+}
+
+// FUNCTION reportStatistics:
+// reports the statistics of all components via Serial; worst-case values cover the last `windowMS`
+void reportStatistics(unsigned long windowMS) {
+  reportTimingStatistics(windowMS);
+  reportConnectionStatistics();
+  reportIngestStatistics();
+  reportOrderingStatistics();
+  reportRestStatistics();
+  reportMemoryStatistics();
+}
+
+// FUNCTION reportTimingStatistics:
+// the worst-case network task iteration, and the worst-case latency of states and heartbeats to the actuator
+void reportTimingStatistics(unsigned long windowMS) {
+  Serial.printf("⏱️ worst-case network task iteration over the last %lus: %lu µs\n", windowMS / 1000, worstLoopIterationUS);
+  Serial.printf("🔀 worst-case latency to actuator: %lu µs; %lu states published, %lu heartbeat blinks dropped since boot\n",
+                worstCommandLatencyUS.exchange(0), (unsigned long)desiredState.published(), droppedHeartbeats);
+}
+
+// FUNCTION reportConnectionStatistics:
+// the connection, its subscriptions, the sealed head they track and the access nodes
+void reportConnectionStatistics() {
+  Serial.printf("🔌 connection: stage '%s', established %lu times, %lu failed attempts or lost connections since boot\n",
+                ConnectionManager::stageName(connection->stage()), connection->established(), connection->failures());
+  Serial.printf("🔁 reconnects since boot: %lu resumed from the last processed block, %lu re-read the on-chain state\n",
+                resumedSubscriptions, stateReReads);
+  Serial.printf("🐕 event stream stalls detected since boot: %lu\n", streamWatchdog->stalls());
+  Serial.printf("📬 subscriptions: %zu of %zu active; %lu messages routed, %lu without a known or current subscription since boot\n",
+                subscriptions->active(), subscriptions->count(), subscriptions->routed(), subscriptions->unrouted());
+  Serial.printf("📏 sealed head: block %lu (ID %.8s…); event stream lag %lu blocks now, worst %lu\n",
+                sealedHeadHeight, sealedHeadBlockId, currentEventLagBlocks, worstEventLagBlocks);
+  Serial.printf("🛰️ access node %s (round trip %ld ms), %lu fail-overs since boot\n", accessNodes->current().host,
+                accessNodes->roundTripMS(accessNodes->currentIndex()), accessNodes->switches());
+}
+
+// FUNCTION reportIngestStatistics:
+// the ingest queue between parsing and processing messages, and the compression of those messages
+void reportIngestStatistics() {
+  Serial.printf("📥 ingest queue: depth %zu of %zu, peak %zu; since boot %lu events coalesced, dropped %lu heartbeats, %lu telemetry events, %lu block ends; %lu control events processed right away\n",
+                ingestQueue->depth(), ingestQueue->getCapacity(), ingestQueue->highWaterMark(), ingestQueue->coalesced(),
+                ingestQueue->dropped(IngestQueue::Kind::Heartbeat), ingestQueue->dropped(IngestQueue::Kind::Telemetry),
+                ingestQueue->dropped(IngestQueue::Kind::BlockEnd), inlineControlEvents);
+  if (wsInflater && wsInflater->inflatedBytes() > 0) {
+    Serial.printf("🗜️ permessage-deflate since boot: %lu B on the wire → %lu B inflated, %lu µs inflating\n",
+                  wsInflater->compressedBytes(), wsInflater->inflatedBytes(), wsInflater->inflateMicros());
+  }
+}
+
+// FUNCTION reportOrderingStatistics:
+// lost, duplicate and collapsed control events, and what became of the applied ones
+void reportOrderingStatistics() {
+  Serial.printf("🕳️ gaps since boot: %lu in message_index, %lu in eventSequence; %lu events backfilled, %lu duplicates skipped\n",
+                messageIndexGaps, eventSequenceGaps, backfilledEvents, duplicateEvents);
+  Serial.printf("🎚️ control events: %lu collapsed into a later one of their block, %zu updates awaiting the end of their block; external load switched %lu times since boot\n",
+                controlUpdates->collapsed(), controlUpdates->pending(), loadSwitches.load(std::memory_order_relaxed));
+  Serial.printf("💾 checkpoint writes since boot: %lu\n", checkpoint->writes());
+}
+
+// FUNCTION reportRestStatistics:
+// requests to the access node's REST API, by the network task (backfills) and by the state reader task
+void reportRestStatistics() {
+  unsigned long readerRequests, readerReusedRequests;
+  stateReader->requestCounts(readerRequests, readerReusedRequests); // written on the state reader task
+  Serial.printf("🔗 REST requests to the current access node: %lu, of which %lu reused the kept-alive connection\n",
+                scriptExecuter->requests() + readerRequests, scriptExecuter->reusedRequests() + readerReusedRequests);
+  Serial.printf("📜 state reads since boot: %lu at the sealed head, %lu looked it up\n", stateReadsAtSealedHead, stateReadsWithLookup);
+}
+
+// FUNCTION reportMemoryStatistics:
+// heap fragmentation (largest free block) and the message arena's peak usage
+void reportMemoryStatistics() {
+  Serial.printf("🧠 heap: %lu B free, largest free block %lu B; message arena: peak %zu of %zu B, %lu allocations did not fit\n",
+                (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxAllocHeap(), wsArena->highWaterMark(),
+                wsArena->getCapacity(), wsArena->failures());
 }
 
 /* ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ BUSINESS LOGIC FUNCTIONS ▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅▅ */
 
-// FUNCTION connectWifi:
-// connects to the Wifi using credentials specified in `WiFiCredentials.h`
-//  * while connecting Wifi, Led will be on red
-//  * when this function returns, all LED's are off
-// If disconnected, this function turns on the red LED while trying to reconnect to Wifi. It
-// blocks until the connection is established and then turns the red LED off and returns.
-void connectWifi() {
-  if (WiFi.status() == WL_CONNECTED) {
-    digitalWrite(LED_RED, HIGH); // off
-    return;
+// FUNCTION connectionStep:
+// performs one non-blocking step of the connection stage `stage` on behalf of `connection`
+ConnectionManager::Progress connectionStep(ConnectionManager::Stage stage, bool entering) {
+  switch (stage) {
+    case ConnectionManager::Stage::WifiJoining:
+      return joinWifi(entering);
+    case ConnectionManager::Stage::Transport:
+      return connectTransport();
+    case ConnectionManager::Stage::Upgrade:
+      return upgradeToWebSocket(entering);
+    case ConnectionManager::Stage::Subscribing:
+      return subscribeToEvents(entering);
+    case ConnectionManager::Stage::Connected: // the server closing the stream also stops the client, see readWebSocketFrame()
+      if (!client->connected() || streamWatchdog->isStalled()) return ConnectionManager::Progress::Failed;
+      return ConnectionManager::Progress::Pending;
+    default:
+      return ConnectionManager::Progress::Pending;
   }
+}
 
-  digitalWrite(LED_RED, LOW); // on
-  delay(500);
-  Serial.print(F("Connecting Wi‑Fi…"));
-  latestReconnectionAttempt = millis();
-  WiFi.begin(WIFI_SSID, WIFI_PASS);
-  for (int i = 0; true; i++) { // wait for connection
-    delay(750);
-    if (WiFi.status() == WL_CONNECTED) break;
-    if (i == 3) {
-      i = 0;
-    }
-    if (i == 0) {
-      Serial.print(F(".looking."));
-    } else if (i == 1) {
-      Serial.print(F(".for."));
-      delay(200);
-    } else if (i == 2) {
-      Serial.print(F(".Wifi.."));
-      delay(500);
-    }
+// FUNCTION dropConnection:
+// tears down a failed connection attempt or a lost connection, so the next attempt starts from a clean state
+void dropConnection(ConnectionManager::Stage failedStage) {
+  if (client) client->stop();
+  processIngestQueue(ingestQueue->getCapacity()); // events received before the connection was lost still count
+  controlUpdates->rewind(lastProcessedBlockHeight); // the rest of an incomplete block is replayed when resuming
+  wsRxBuffer->clear(); // drop any bytes and partial frames left over from this connection
+  wsParser->reset();
+  subscriptions->connectionLost();
+  resubscribePending = false;
+  resubscribeAfterStateRead = false;
+  stateReadDeferred = false;
+  eventStreamBroken = false;
+  streamWatchdog->disarm();
+  if (failedStage == ConnectionManager::Stage::WifiJoining) {
+    WiFi.disconnect(); // start the next attempt afresh
+  } else {             // the Access Node failed us: fail over to a better one, if there is any
+    accessNodes->reportFailure();
+    if (accessNodes->selectBest()) useCurrentAccessNode();
   }
-  Serial.printf("\n📡 connected to Wi‑Fi '%s' with local IP %s\n\n", WiFi.SSID(), WiFi.localIP().toString().c_str());
-  digitalWrite(LED_RED, HIGH); // off
+  if (failedStage == ConnectionManager::Stage::Connected && disconnectedSinceMS == 0) disconnectedSinceMS = millis();
+  redToggler->trigger(); // blink red LED to indicate the connection problem
+}
+
+// FUNCTION joinWifi:
+// connects to the Wifi using credentials specified in `WiFiCredentials.h`; never blocks
+ConnectionManager::Progress joinWifi(bool entering) {
+  const wl_status_t status = WiFi.status();
+  if (status == WL_CONNECTED) {
+    if (!entering) Serial.printf("📡 connected to Wi‑Fi '%s' with local IP %s\n\n", WiFi.SSID().c_str(), WiFi.localIP().toString().c_str());
+    return ConnectionManager::Progress::Done;
+  }
+  if (entering) {
+    Serial.println(F("Connecting Wi‑Fi…"));
+    WiFi.begin(WIFI_SSID, WIFI_PASS);
+    return ConnectionManager::Progress::Pending;
+  }
+  if (status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL) return ConnectionManager::Progress::Failed;
+  return ConnectionManager::Progress::Pending;
+}
+
+// FUNCTION restBaseURL:
+// base URL of the REST API of `node`, e.g. `http://access-001.devnet52.nodes.onflow.org:8070/v1/`
+String restBaseURL(const AccessNode &node) {
+  return String(node.useSsl ? "https://" : "http://") + node.host + ":" + String(node.restPort) + "/v1/";
+}
+
+// FUNCTION useCurrentAccessNode:
+// pairs the REST API for script execution with the Access Node whose WebSocket API we connect to
+void useCurrentAccessNode() {
+  delete scriptExecuter;
+  scriptExecuter = new OnChainState(restBaseURL(accessNodes->current()));
+}
+
+// FUNCTION probeAccessNodeIfDue:
+// has the state reader probe the next access node, if due: the round-trip time of requesting its latest sealed
+// block header. The network task goes on meanwhile; recordAccessNodeProbe() takes the result.
+void probeAccessNodeIfDue() {
+  size_t index;
+  if (!accessNodes->probeDue(index)) return;
+  accessNodeProbeTicket = stateReader->submit(OnChainStateWorker::Request::ProbeLatency, restBaseURL(accessNodes->node(index)));
+  if (accessNodeProbeTicket == 0) {
+    accessNodes->cancelProbe(); // retried after the probe interval
+    return;
+  }
+  probedAccessNode = index;
+}
+
+// FUNCTION recordAccessNodeProbe:
+// completion of a probe, called on the network task
+void recordAccessNodeProbe(const OnChainStateWorker::Result &result) {
+  if (result.ticket != accessNodeProbeTicket) return;
+  accessNodeProbeTicket = 0;
+  accessNodes->recordProbe(probedAccessNode, result.success ? (long)result.roundTripMS : -1);
 }
 
 /* Initial state recovery via script execution
  * ━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━ */
 
-// FUNCTION setControllerState:
-//  1. reads the latest sealed block from the Flow access node via a rest call
-//  2. executes the script to read the on-chain state via script execution at the latest sealed block
-void scriptReadControllerState() {
-  Serial.print(F("📞 Reading on-chain state via script execution from "));
-  Serial.println("'" + scriptExecuter->getURL() + "'");
-
-  // 1. get latest sealed block
-  const std::tuple<unsigned long, bool> optionalLatestSealedBlock = scriptExecuter->get_latest_sealed_block();
-  if (!std::get<1>(optionalLatestSealedBlock)) {
-    Serial.println(F("   ❌ Failed to get latest sealed block"));
-    return;
+// FUNCTION requestControllerState:
+// has the state reader read the on-chain state via script execution at the latest sealed block; the result is
+// applied by applyControllerState(). The block is the sealed head, if known; otherwise, the state reader looks
+// it up first. If a read is in flight already (e.g. requested by a failed connection attempt), that one is
+// awaited instead.
+void requestControllerState() {
+  lastProcessedBlockHeight = 0; // unless the read succeeds, subscribe from the latest block
+  if (stateReadPending) return;
+  const unsigned long blockHeight = sealedHeadIsFresh() ? sealedHeadHeight : 0;
+  if (blockHeight > 0) {
+    Serial.printf("📞 Reading on-chain state at sealed block %lu via script execution from ", blockHeight);
+  } else {
+    Serial.print(F("📞 Reading on-chain state via script execution from "));
   }
-  unsigned long latestSealedBlock = std::get<0>(optionalLatestSealedBlock);
-  Serial.printf("   latest sealed block: %lu\n", latestSealedBlock);
+  Serial.println("'" + restBaseURL(accessNodes->current()) + "'");
+  stateReadPending = stateReader->submit(OnChainStateWorker::Request::ReadControllerState, restBaseURL(accessNodes->current()), blockHeight) != 0;
+  if (!stateReadPending) return;
+  if (blockHeight > 0) {
+    ++stateReadsAtSealedHead;
+  } else {
+    ++stateReadsWithLookup;
+  }
+}
 
-  // 2. retrieve on-chain state as of the latest sealed block
-  const std::tuple<int64_t, bool> scriptResult = scriptExecuter->get_led_state_at_block(latestSealedBlock);
-  if (!std::get<1>(scriptResult)) {
-    Serial.println(F("   ❌ Read of on-chain state failed"));
-    return;
+// FUNCTION completeStateReaderRequest:
+// completion of the state reader's requests, called on the network task
+void completeStateReaderRequest(const OnChainStateWorker::Result &result) {
+  switch (result.request) {
+    case OnChainStateWorker::Request::ReadControllerState:
+      applyControllerState(result);
+      break;
+    case OnChainStateWorker::Request::ProbeLatency:
+      recordAccessNodeProbe(result);
+      break;
   }
-  const int64_t ledState = std::get<0>(scriptResult);
-  setControllerState(ledState);
+}
+
+// FUNCTION applyControllerState:
+// completion of a state read, called on the network task
+void applyControllerState(const OnChainStateWorker::Result &result) {
+  stateReadPending = false;
+  processIngestQueue(ingestQueue->getCapacity()); // queued events precede the state that was read
+  controlUpdates->rewind(result.blockHeight);     // updates still buffered are superseded by the state, or replayed
+  if (!result.success) return; // the subscription starts from the latest block
+  publishControllerState(result.controllerState);
+  lastAppliedEventSequence = 0; // the script yields the value only, not the sequence number of the event that set it
+  lastEventBlockHeight = result.blockHeight;
+  recordControllerState(result.controllerState, lastAppliedEventSequence);
+  recordProcessedBlock(result.blockHeight); // the state is consistent as of this block; events follow from the next one
+  Serial.printf("   recovered the on-chain state in %lu ms\n", result.elapsedMS);
 }
 
 /* Websockets Prototol Implementation
  * ━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━ */
 
-// FUNCTION connectAndSubscribeWebsockets:
-// connects to the Flow access node and subscribes to the events topic
-void connectAndSubscribeWebsockets() {
-  if (client && client->connected()) {
-    digitalWrite(LED_RED, HIGH); // off
-    return;
+// FUNCTION connectTransport:
+// opens the TCP connection to the current Access Node (and performs the TLS handshake for SSL nodes).
+// The Arduino clients connect synchronously, so this step blocks the network task for up to `transportTimeoutMS`.
+ConnectionManager::Progress connectTransport() {
+  const AccessNode &node = accessNodes->current();
+  Serial.printf("Connecting to websockets API of %s:%d\n", node.host, node.wsPort);
+  bool connected;
+  if (node.useSsl) {
+    sslClient.setInsecure(); // Accept all certs (insecure, but works for dev)
+    client = &sslClient;
+    Serial.println(F("🔐 Using SSL connection"));
+    connected = sslClient.connect(node.host, node.wsPort, transportTimeoutMS);
+  } else {
+    client = &plainClient;
+    Serial.println(F("🔓 Using plain-text connection"));
+    connected = plainClient.connect(node.host, node.wsPort, transportTimeoutMS);
+  }
+  if (!connected) {
+    Serial.println(F("❌ Connection to server failed!"));
+    return ConnectionManager::Progress::Failed;
   }
-  latestReconnectionAttempt = millis();
+  return ConnectionManager::Progress::Done;
+}
 
-#if USE_SSL
-  sslClient.setInsecure(); // Accept all certs (insecure, but works for dev)
-  client = &sslClient;
-  Serial.println(F("🔐 Using SSL connection"));
-#else
-  client = &plainClient;
-  Serial.println(F("🔓 Using plain-text connection"));
+// FUNCTION upgradeToWebSocket:
+// sends the WebSocket handshake (HTTP upgrade request) when entering the stage; afterwards consumes whatever part
+// of the response has arrived, line by line, without ever waiting for more. Done once the headers are complete.
+ConnectionManager::Progress upgradeToWebSocket(bool entering) {
+  if (entering) {
+    wsRxBuffer->clear(); // drop any bytes and partial frames left over from the previous connection
+    wsParser->reset();
+    handshakeLineLength = 0;
+    handshakeStatusReceived = false;
+    deflateNegotiated = false;
+
+    String req = String("GET ") + path + " HTTP/1.1\r\n" +
+                 "Host: " + accessNodes->current().host + "\r\n" +
+                 "Upgrade: websocket\r\n" +
+                 "Connection: Upgrade\r\n" +
+                 "Sec-WebSocket-Key: x3JJHMbDL1EzLkh9GBhXDw==\r\n" +
+                 "Sec-WebSocket-Version: 13\r\n" +
+                 "Origin: https://rest-testnet.onflow.org\r\n";
+#if USE_PERMESSAGE_DEFLATE
+    // offer compression, restricting the server to a small sliding window to bound our memory for decompression
+    req += String("Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=") + String(wsDeflateWindowBits) + "\r\n";
 #endif
-
-  Serial.printf("Connecting to websockets API of s:%d\n", host, port);
-  if (!client->connect(host, port)) {
-    Serial.println(F("❌ Connection to server failed!"));
-    return;
+    req += "\r\n";
+    client->print(req);
+    Serial.println(F("🛰️ Sent WebSocket handshake"));
+    return ConnectionManager::Progress::Pending;
   }
 
-  // handshake and WebSocket HTTP upgrade request
-  String req = String("GET ") + path + " HTTP/1.1\r\n" +
-               "Host: " + host + "\r\n" +
-               "Upgrade: websocket\r\n" +
-               "Connection: Upgrade\r\n" +
-               "Sec-WebSocket-Key: x3JJHMbDL1EzLkh9GBhXDw==\r\n" +
-               "Sec-WebSocket-Version: 13\r\n" +
-               "Origin: https://rest-testnet.onflow.org\r\n" +
-               "\r\n";
-  client->print(req);
-  Serial.println(F("🛰️ Sent WebSocket handshake"));
-
-  // Wait for response
-  while (client->connected() && !client->available())
-    delay(10);
-  Serial.println(F("📩 Handshake response:"));
+  if (!client->connected()) return ConnectionManager::Progress::Failed;
+  // read byte by byte, so that nothing beyond the headers is consumed: frames may follow right away
   while (client->available()) {
-    String line = client->readStringUntil('\n');
-    Serial.print(line);
-    if (line == "\r") break;
-  }
-  Serial.println(F("💡 End of HTTP headers"));
-
-  /* ── send subscription  ───────────────────────────────────────── */
-  StaticJsonDocument<512> doc;
-  doc["subscription_id"] = "20charIDStreamEvents";
-  doc["action"] = "subscribe";
-  doc["topic"] = "events";
-  JsonObject args = doc.createNestedObject("arguments");
-  args["heartbeat_interval"] = "5";
-
-  size_t subscribedEventTypesCount = sizeof(EVENT_TYPES) / sizeof(EVENT_TYPES[0]);
-  // if no events to filter for are specified, so we take all events
-  // this is achieved by setting by omitting the `event_types` in the subscription message
-  if (subscribedEventTypesCount > 0) {
-    JsonArray types = args.createNestedArray("event_types");
-    for (size_t i = 0; i < subscribedEventTypesCount; ++i) {
-      types.add(EVENT_TYPES[i]);
+    const int c = client->read();
+    if (c < 0) break;
+    if (c != '\n') {
+      if (handshakeLineLength < sizeof(handshakeLine) - 1) handshakeLine[handshakeLineLength++] = (char)c;
+      continue;
+    }
+    handshakeLine[handshakeLineLength] = '\0'; // still ends with '\r'
+    const bool endOfHeaders = handshakeLineLength <= 1;
+    handshakeLineLength = 0;
+
+    if (!handshakeStatusReceived) {
+      handshakeStatusReceived = true;
+      Serial.println(F("📩 Handshake response:"));
+      Serial.println(handshakeLine);
+      if (strncmp(handshakeLine, "HTTP/1.1 101", strlen("HTTP/1.1 101")) != 0) {
+        Serial.println(F("❌ Server refused the WebSocket upgrade"));
+        return ConnectionManager::Progress::Failed;
+      }
+      continue;
     }
+    if (endOfHeaders) {
+      Serial.println(F("💡 End of HTTP headers"));
+      wsParser->setInflater(deflateNegotiated ? wsInflater : nullptr);
+      return ConnectionManager::Progress::Done;
+    }
+    Serial.println(handshakeLine);
+#if USE_PERMESSAGE_DEFLATE
+    if (!deflateNegotiated) deflateNegotiated = configurePermessageDeflate(String(handshakeLine));
+#endif
   }
+  return ConnectionManager::Progress::Pending;
+}
 
-  String json;
-  serializeJson(doc, json);
-  Serial.println("📝 JSON payload:");
-  Serial.println(json);
+// FUNCTION subscribeToEvents:
+// When entering the stage, subscribes to the sealed block digests and decides whether the on-chain state needs to
+// be read, i.e. if the event stream can't be resumed from the last processed block. The read is requested once
+// the sealed head is known (or waiting for it took too long); the events subscription is sent once the state is
+// known. Done once the node confirms it (see dispatchWebSocketMessage()).
+ConnectionManager::Progress subscribeToEvents(bool entering) {
+  if (entering) {
+    subscriptionRejected = false;
+    subscribingSinceMS = millis();
+    subscriptions->subscribe(digestsSubscription);
+    const bool reconnecting = disconnectedSinceMS != 0;
+    if (canResumeEventStream()) {
+      if (reconnecting) {
+        ++resumedSubscriptions;
+        Serial.printf("🔁 Resuming event stream after block %lu\n", lastProcessedBlockHeight);
+      }
+    } else {
+      if (reconnecting) ++stateReReads;
+      stateReadDeferred = true; // first connect, or gap too large to replay: read the on-chain state via script execution
+    }
+    return ConnectionManager::Progress::Pending;
+  }
 
-  sendWebSocketFrame(json);
+  if (subscriptionRejected || !client->connected()) return ConnectionManager::Progress::Failed;
+  if (stateReadDeferred) {
+    if (!sealedHeadIsFresh() && millis() - subscribingSinceMS < sealedHeadWaitMS) return ConnectionManager::Progress::Pending;
+    stateReadDeferred = false;
+    requestControllerState();
+  }
+  if (subscriptions->state(eventsSubscription) == SubscriptionManager::State::Idle) {
+    if (stateReadPending) return ConnectionManager::Progress::Pending;
+    subscriptions->subscribeAll(); // the events, and any other subscription not re-established yet
+    return ConnectionManager::Progress::Pending;
+  }
+  if (subscriptions->state(eventsSubscription) != SubscriptionManager::State::Active) return ConnectionManager::Progress::Pending;
+  accessNodes->reportSuccess();
+  streamWatchdog->arm();
+  return ConnectionManager::Progress::Done;
 }
 
-// Send WebSocket frame (typically responses to PING or subscription messages)
-void sendWebSocketFrame(const String &payload) {
-  const uint8_t opcode = 0x1; // text frame
-  uint8_t header[10];
-  size_t payloadLength = payload.length();
-  size_t headerSize = 2;
-  uint8_t maskKey[4];
-
-  // Construct header
-  header[0] = 0x80 | opcode; // FIN + opcode
-  if (payloadLength <= 125) {
-    header[1] = 0x80 | payloadLength;
-  } else if (payloadLength <= 65535) {
-    header[1] = 0x80 | 126;
-    header[2] = (payloadLength >> 8) & 0xFF;
-    header[3] = payloadLength & 0xFF;
-    headerSize += 2;
-  } else {
-    Serial.println(F("❌ Payload too large"));
-    return;
+// FUNCTION buildEventsArguments:
+// arguments of the events subscription; called by `subscriptions` right before the subscription is sent
+void buildEventsArguments(JsonObject args) {
+  char heartbeatInterval[11];
+  snprintf(heartbeatInterval, sizeof(heartbeatInterval), "%u", heartbeatIntervalBlocks);
+  args["heartbeat_interval"] = heartbeatInterval;
+
+  // continue right after the last block we have processed, so the node replays anything we missed
+  if (lastProcessedBlockHeight > 0) {
+    char startHeight[21]; // ArduinoJson copies the (non-literal) string into the document
+    snprintf(startHeight, sizeof(startHeight), "%lu", lastProcessedBlockHeight + 1);
+    args["start_block_height"] = startHeight;
   }
+  subscribedWithStartHeight = lastProcessedBlockHeight > 0;
+  expectedMessageIndex = 0; // numbering starts over with every subscription
 
-  // Generate random mask key
-  for (int i = 0; i < 4; ++i) {
-    maskKey[i] = random(0, 256);
-    header[headerSize++] = maskKey[i];
+  // subscribe to exactly the event types we have registered handlers for
+  JsonArray types = args.createNestedArray("event_types");
+  for (size_t i = 0; i < EVENT_REGISTRY.size(); ++i) {
+    types.add(EVENT_REGISTRY[i].id);
   }
+}
 
-  // Send header + mask + masked payload
-  client->write(header, headerSize);           // header + mask
-  for (size_t i = 0; i < payloadLength; ++i) { // mask payload
-    client->write(payload[i] ^ maskKey[i % 4]);
-  }
-  client->flush();
+// FUNCTION buildBlockDigestArguments:
+// arguments of the subscription to the digests of sealed blocks, which keep the sealed head current
+void buildBlockDigestArguments(JsonObject args) {
+  args["block_status"] = "sealed";
+}
+
+// FUNCTION configurePermessageDeflate:
+// Inspects one line of the handshake response. If it is the server's acceptance of our `permessage-deflate`
+// offer, the inflater is configured with the negotiated parameters and true is returned.
+bool configurePermessageDeflate(String headerLine) {
+  headerLine.toLowerCase();
+  if (!headerLine.startsWith("sec-websocket-extensions:") || headerLine.indexOf("permessage-deflate") < 0) return false;
+
+  int windowBits = WebSocketInflater::MAX_WINDOW_BITS; // if the server did not confirm a window size, assume the largest
+  const int paramPos = headerLine.indexOf("server_max_window_bits=");
+  if (paramPos >= 0) windowBits = headerLine.substring(paramPos + strlen("server_max_window_bits=")).toInt();
+  const bool noContextTakeover = headerLine.indexOf("server_no_context_takeover") >= 0;
+
+  if (!wsInflater->configure(windowBits, noContextTakeover)) return false;
+  Serial.printf("🗜️ permessage-deflate negotiated: window %d bits%s\n", windowBits, noContextTakeover ? ", no context takeover" : "");
+  return true;
+}
 
+// Send WebSocket frame (typically responses to PING or subscription messages)
+// Header, mask and the masked payload leave in a single write (one TCP segment / TLS record).
+bool sendWebSocketFrame(const char *payload, size_t length) {
+  if (!wsWriter->send(client, WebSocketFrameWriter::OPCODE_TEXT, reinterpret_cast<const uint8_t *>(payload), length)) {
+    Serial.println(F("❌ Sending WebSocket text frame failed"));
+    return false;
+  }
   Serial.println(F("📤 Sent WebSocket text frame"));
+  return true;
 }
 
-// Reads from the WebSocket stream, fills wsBuffer, returns true if a complete message is
-// stored in `wsBuffer` and ready to be processed
+// Reads from the WebSocket stream, returns true if a complete message is buffered and ready
+// to be processed; its payload can then be read via `wsMessage`.
+// Never blocks: consumes only the bytes that the socket already received and otherwise returns
+// false right away; a partially received frame is resumed on the next loop pass.
 bool readWebSocketFrame() {
-  // Need at least 2 bytes for the frame header
-  if (client->available() < 2) return false;
-
-  /* ── Frame header ───────────────────────────────────────── */
-  uint8_t firstByte = client->read();
-  uint8_t secondByte = client->read();
-
-  bool isFinal = firstByte & 0x80;
-  uint8_t opcode = firstByte & 0x0F;
-  bool isControl = opcode & 0x08;
-  bool mask = secondByte & 0x80; // should be 0 for server-to-client
-  uint64_t payloadLength = secondByte & 0x7F;
-
-  // Check for reserved bits
-  if (firstByte & 0x70) {
-    if (!supressRepeatedRSVWarnings) {
-      Serial.println(F("❌ RSV bits set, unsupported extension"));
-      supressRepeatedRSVWarnings = true;
+  wsRxBuffer->fill(client); // bulk-read whatever the socket has buffered
+
+  while (true) {
+    switch (wsParser->poll()) {
+      case WebSocketFrameParser::Event::None:
+        return false; // waiting for more bytes
+
+      case WebSocketFrameParser::Event::MessageReady:
+        return true;
+
+      /* ── Handle control frames ──────────────────────────────── */
+      case WebSocketFrameParser::Event::Ping: {
+        const uint8_t *pingPayload = wsParser->controlPayload();
+        const size_t pingLength = wsParser->controlPayloadLength(); // <=125 B by spec
+
+        // Reply with masked PONG frame (header + mask + masked payload), echoing the ping payload
+        wsWriter->send(client, WebSocketFrameWriter::OPCODE_PONG, pingPayload, pingLength);
+        Serial.print(F("📤 Pong sent, payload bytes: "));
+        Serial.println(pingLength);
+        break; // done with this frame
+      }
+
+      case WebSocketFrameParser::Event::Pong:
+        Serial.println(F("📥 PONG received (ignored)"));
+        break;
+
+      case WebSocketFrameParser::Event::Close:
+        client->stop();
+        wsRxBuffer->clear();
+        wsParser->reset();
+        Serial.println(F("📴 Server closed the connection."));
+        return false;
+
+      case WebSocketFrameParser::Event::ProtocolError:
+        client->stop(); // stream can't be resumed; reconnecting re-negotiates from a clean state
+        wsRxBuffer->clear();
+        wsParser->reset();
+        Serial.println(F("❌ Unrecoverable WebSocket stream error, closed the connection."));
+        return false;
     }
-    return false;
   }
-  supressRepeatedRSVWarnings = false;
+}
 
-  // Check for mask bit (should not be set)
-  if (mask) {
-    Serial.println(F("❌ Server-to-client frame is masked, protocol error"));
-    // Optionally, read and discard mask key to resync
-    for (int i = 0; i < 4; ++i)
-      client->read();
-    return false;
-  }
+// FUNCTION buildWebSocketMessageFilter:
+// Assembles the ArduinoJson filter applied to every incoming message. As the topic of a message is only
+// known after parsing it, the filter is the union of the fields we read from each kind of message.
+void buildWebSocketMessageFilter() {
+  wsMessageFilter.clear();
+
+  // all messages: routing information
+  wsMessageFilter["topic"] = true;
+  wsMessageFilter["subscription_id"] = true;
+
+  // subscription acknowledgements (`{"subscription_id": ..., "action": "subscribe"}`) and errors
+  wsMessageFilter["action"] = true;
+  wsMessageFilter["error"] = true;
+
+  // `block_digests` topic
+  wsMessageFilter["payload"]["height"] = true;
+  wsMessageFilter["payload"]["block_id"] = true;
+
+  // `events` topic; heartbeats are messages in the same topic with an empty events list
+  wsMessageFilter["payload"]["block_height"] = true;
+  wsMessageFilter["payload"]["block_timestamp"] = true;
+  wsMessageFilter["payload"]["message_index"] = true;
+  wsMessageFilter["payload"]["events"][0]["type"] = true; // filter of the first array element is applied to all events
+  wsMessageFilter["payload"]["events"][0]["payload"] = true;
+  wsMessageFilter["payload"]["events"][0]["transaction_id"] = true; // identify an event, together with ...
+  wsMessageFilter["payload"]["events"][0]["event_index"] = true;    // ... its index within the transaction
+}
 
-  if (payloadLength == 126) {
-    while (client->available() < 2)
-      delay(1);
-    payloadLength = ((uint64_t)client->read() << 8) | client->read();
-  } else if (payloadLength == 127) {
-    Serial.println(F("❌ 64‑bit payloads not supported"));
-    while (client->available() < 8)
-      delay(1);
-    for (int i = 0; i < 8; ++i)
-      client->read(); // discard
-    return false;
-  }
+// Processes the JSON message, deserializing it straight from the WebSocket receive buffer
+// CAUTION: should only be called if readWebSocketFrame() returned true
+void processWebSocketMessage() {
+  {
+    JsonDocument doc(wsJsonAllocator); // all memory for the message comes from the arena
+    DeserializationError err = deserializeJson(doc, *wsMessage, DeserializationOption::Filter(wsMessageFilter));
+    wsParser->finishMessage(); // release the message's bytes in the receive buffer
+    // uncomment following two lines to print the deserialized Json message (only the fields retained by the filter) for debugging:
+    // Serial.println("📥 Filtered WebSocket message:");
+    // serializeJson(doc, Serial);
+
+    if (err) {
+      Serial.print(F("❌ JSON parse failed:"));
+      Serial.println(err.c_str());
+    } else {
+      dispatchWebSocketMessage(doc);
+    }
+  } // `doc` goes out of scope before its memory is reclaimed
+  wsArena->reset();
+}
 
-  if (isControl && payloadLength > 125) {
-    Serial.println(F("❌ Control frame payload too large"));
-    return false;
+// FUNCTION dispatchWebSocketMessage:
+// hands a deserialized message to the handler of its subscription (see `subscriptions`)
+void dispatchWebSocketMessage(JsonDocument &doc) {
+  if (subscriptions->dispatch(doc)) return;
+  Serial.println(F("⚙️ Message of no known subscription:"));
+  serializeJsonPretty(doc, Serial);
+  Serial.println("\n");
+}
+
+// FUNCTION processEventsMessage:
+// processes a message of the events subscription: the relevant events of one block, or a heartbeat
+void processEventsMessage(JsonDocument &doc) {
+  if (eventStreamBroken) return; // messages still buffered after the gap; resuming the subscription replays them
+  // pull out extra metadata:
+  unsigned long blockHeight = strtoul(doc["payload"]["block_height"] | "0", nullptr, 10);
+  const char *ts = doc["payload"]["block_timestamp"] | "?"; // ISO‑8601
+  int msgIndex = doc["payload"]["message_index"] | 0; // int fallback
+  streamWatchdog->feed(msgIndex, blockHeight);
+  if (sealedHeadIsFresh()) {
+    currentEventLagBlocks = sealedHeadHeight > blockHeight ? sealedHeadHeight - blockHeight : 0;
+    if (currentEventLagBlocks > worstEventLagBlocks) worstEventLagBlocks = currentEventLagBlocks;
   }
-  // Serial.printf("📦 Expecting %llu byte(s) of payload\n", payloadLength);
-
-  /* ── Handle control frames first ────────────────────────── */
-  if (opcode == 0x9) { // PING
-    // read ping payload (<=125 B by spec)
-    String pingPayload;
-    while (pingPayload.length() < payloadLength) {
-      if (client->available())
-        pingPayload += (char)client->read();
-      else
-        delay(1);
-    }
 
-    // Build masked PONG frame (header + mask + masked payload)
-    uint8_t maskKey[4];
-    for (int i = 0; i < 4; ++i)
-      maskKey[i] = random(0, 256);
-
-    uint8_t hdr[6];
-    hdr[0] = 0x8A;                        // FIN=1, opcode=0xA (PONG)
-    hdr[1] = 0x80 | pingPayload.length(); // MASK bit | length (≤125)
-    for (int i = 0; i < 4; ++i)
-      hdr[2 + i] = maskKey[i];
-    client->write(hdr, 6);
-
-    // Send masked payload
-    for (size_t i = 0; i < pingPayload.length(); ++i) {
-      client->write(pingPayload[i] ^ maskKey[i % 4]);
+  // a gap in the numbering means that messages about blocks after the last processed one got lost
+  if ((unsigned long)msgIndex > expectedMessageIndex) {
+    ++messageIndexGaps;
+    Serial.printf("🕳️ Message index %d, expected %lu: messages were lost\n", msgIndex, expectedMessageIndex);
+    processIngestQueue(ingestQueue->getCapacity()); // the gap starts after the last block processed completely
+    if (eventStreamBroken) return;
+    if (lastProcessedBlockHeight > 0 && !backfillEvents(lastProcessedBlockHeight + 1, blockHeight - 1)) {
+      abandonEventStream();
+      return;
     }
-    client->flush();
-    Serial.print(F("📤 Pong sent, payload bytes: "));
-    Serial.println(pingPayload.length());
-    return false; // done with this frame
-  }
-
-  if (opcode == 0xA) { // PONG
-    // Just read and discard payload
-    for (uint64_t i = 0; i < payloadLength; ++i) {
-      while (!client->available())
-        delay(1);
-      client->read();
-    }
-    Serial.println(F("📥 PONG received (ignored)"));
-    return false;
   }
-
-  if (opcode == 0x8) { // CLOSE frame
-    for (uint64_t i = 0; i < payloadLength; ++i) {
-      while (!client->available())
-        delay(1);
-      client->read();
+  expectedMessageIndex = msgIndex + 1;
+
+  // queue the events for processing (see `processIngestItem`), followed by the end of their block
+  JsonArray events = doc["payload"]["events"];
+  if (events.size() > 0) {
+    Serial.printf("\n🔔[msg index %4d] block at height %lu, time stamp %s, has %zu relevant event(s)\n", msgIndex, blockHeight, ts, events.size());
+    for (JsonObject e : events) {
+      const char *type = e["type"];
+      const EventType *registered = EVENT_REGISTRY.find(type); // route before decoding any payload
+      if (!registered) {
+        Serial.printf("  • %s\n    ⚠️ no handler registered for event type, skipped\n", type);
+        continue;
+      }
+      if (registered->priority == EventPriority::Control) {
+        JsonVariant eventIndex = e["event_index"]; // a string in the WebSocket API, like all integers
+        const uint32_t index = eventIndex.is<const char *>() ? strtoul(eventIndex.as<const char *>(), nullptr, 10) : eventIndex.as<uint32_t>();
+        if (controlUpdates->seen(e["transaction_id"] | "", index, blockHeight)) {
+          ++duplicateEvents;
+          Serial.printf("  • %s\n    ↩️ delivered already, skipped\n", type);
+          continue;
+        }
+      }
+      const char *payload = e["payload"];
+      if (ingestQueue->pushEvent(registered, blockHeight, payload) != IngestQueue::Outcome::Full) continue;
+
+      // a control event that can't be queued: process everything before it, then the event itself
+      processIngestQueue(ingestQueue->getCapacity());
+      if (eventStreamBroken) return;
+      ++inlineControlEvents;
+      Serial.printf("  • %s\n", type);
+      currentEventBlockHeight = blockHeight;
+      if (registered->handler) registered->handler(payload); // decode and process payload
+      if (eventStreamBroken) return; // this block is incomplete, resuming the subscription replays it
     }
-    client->stop();
-    Serial.println(F("📴 Server closed the connection."));
-    return false;
+  } else {
+    Serial.printf("⏳[msg index %4d] heartbeat @ block hight %lu, time stamp %s\n", msgIndex, blockHeight, ts);
   }
+  ingestQueue->pushBlockEnd(blockHeight, events.size() == 0);
+}
 
-  /* ── Data frames (text / continuation) ──────────────────── */
-  String payload;
-  while (payload.length() < payloadLength) {
-    if (client->available())
-      payload += (char)client->read();
-    else
-      delay(1);
+// FUNCTION processIngestQueue:
+// processes up to `budget` queued items, in order; returns true if items remain queued
+bool processIngestQueue(size_t budget) {
+  for (; budget > 0 && !eventStreamBroken; --budget) {
+    const IngestQueue::Item *item = ingestQueue->front();
+    if (!item) break;
+    processIngestItem(*item);
+    ingestQueue->pop(); // no-op if the stream was abandoned, which clears the queue
   }
-  // Serial.printf("📦 Received  %u byte(s) of payload\n", payload.length());
+  return ingestQueue->depth() > 0;
+}
 
-  if (opcode == 0x1) { // TEXT – first (or only) frame
-    wsBuffer = payload;
-    wsReceiving = !isFinal;
-  } else if (opcode == 0x0 && wsReceiving) { // CONTINUATION
-    wsBuffer += payload;
-    wsReceiving = !isFinal;
+// FUNCTION processIngestItem:
+// processes a queued event, or the end of a block: the block is complete then (see `completeBlock`)
+void processIngestItem(const IngestQueue::Item &item) {
+  switch (item.kind) {
+    case IngestQueue::Kind::Heartbeat:
+      enqueueHeartbeat();
+      completeBlock(item.blockHeight);
+      return;
+    case IngestQueue::Kind::BlockEnd:
+      completeBlock(item.blockHeight);
+      return;
+    case IngestQueue::Kind::Telemetry:
+    case IngestQueue::Kind::Control:
+      break;
+  }
+  if (item.count > 1) {
+    Serial.printf("  • %s ×%u [block %lu]\n", item.type->id, (unsigned)item.count, item.blockHeight);
   } else {
-    Serial.printf("⚠️ Unsupported opcode 0x%02X\n", opcode);
-    return false;
+    Serial.printf("  • %s [block %lu]\n", item.type->id, item.blockHeight);
   }
-
-  // Return true if message is complete
-  return !wsReceiving;
+  if (!item.type->handler) return;
+  currentEventBlockHeight = item.blockHeight;
+  item.type->handler(item.payload); // decode and process payload
 }
 
-// Processes the JSON message in wsBuffer
-// CAUTION: should only be called if readWebSocketFrame() returned true
-void processWebSocketMessage() {
-  StaticJsonDocument<16384> doc;
-  DeserializationError err = deserializeJson(doc, wsBuffer);
-  // uncomment following two lines to print entire deserialized Json message from server for debugging:
-  // Serial.println("📥 Full WebSocket message:");
-  // Serial.println(wsBuffer);
-  wsBuffer.clear();
-
-  if (err) {
-    Serial.print(F("❌ JSON parse failed:"));
-    Serial.println(err.c_str());
-    return;
+// FUNCTION completeBlock:
+// all events of the blocks up to `blockHeight` are received: applies the final control value among them, once
+// they continue the applied eventSequence without gaps, and records the block as processed. A gap is backfilled
+// first; if that fails, the event stream is abandoned and false is returned.
+bool completeBlock(unsigned long blockHeight) {
+  if (!backfilling && !controlUpdates->contiguous(blockHeight, lastAppliedEventSequence)) {
+    ++eventSequenceGaps;
+    Serial.printf("🕳️ Control events up to block %lu don't follow event sequence %" PRIu64 ": events were lost\n", blockHeight, lastAppliedEventSequence);
+    // the missed events are in the blocks since the last applied one, possibly in this block
+    if (!backfillEvents(lastEventBlockHeight + 1, blockHeight)) {
+      abandonEventStream();
+      return false;
+    }
   }
+  applyControlUpdates(blockHeight);
+  recordProcessedBlock(blockHeight);
+  return true;
+}
 
-  const char *topic = doc["topic"];
-  if (topic && strcmp(topic, "events") == 0) { // for websockets message in the `events` topic
-    // pull out extra metadata:
-    long blockHeight = atol(doc["payload"]["block_height"]);
-    const char *ts = doc["payload"]["block_timestamp"]; // ISO‑8601
-    int msgIndex = doc["payload"]["message_index"] | 0; // int fallback
-
-    // print summary of events
-    JsonArray events = doc["payload"]["events"];
-    if (events.size() > 0) {
-      Serial.printf("\n🔔[msg index %4d] block at height %ld, time stamp %s, has %d relevant event(s)\n", msgIndex, blockHeight, ts, events.size());
-      for (JsonObject e : events) {
-        Serial.printf("  • %-50s tx=%.*s…\n", (const char *)e["type"], 8, ((const char *)e["transaction_id"]));
-        processControlInstruction((const char *)e["payload"]); // decode and print payload
-      }
-      Serial.println("");
-    } else {
-      Serial.printf("⏳[msg index %4d] heartbeat @ block hight %ld, time stamp %s\n", msgIndex, blockHeight, ts);
-      greenToggler->trigger(); // blink green LED to indicate heartbeat
-    }
-  } else { // for websockets message _not_ the `events` topic
-    Serial.println(F("⚙️ Non‑event message:"));
+// FUNCTION applyControlUpdates:
+// applies the last of the buffered control updates up to `blockHeight`; the earlier ones are superseded by it
+void applyControlUpdates(unsigned long blockHeight) {
+  EventOrderingStage::Update final;
+  const size_t events = controlUpdates->take(blockHeight, lastAppliedEventSequence, final);
+  if (events == 0) return;
+  if (events > 1) Serial.printf("    ⏩ %zu control events collapsed into the last one, event sequence %" PRIu64 "\n", events, final.eventSequence);
+
+  /* ── Sate machine update - eventually consistend; information-driven approach ──────────────────── */
+  publishControllerState(final.value); // applied by the actuator on the other core
+  lastAppliedEventSequence = final.eventSequence;
+  lastEventBlockHeight = final.blockHeight;
+  recordControllerState(final.value, final.eventSequence);
+}
+
+// FUNCTION processEventsError:
+// the node answered the events subscription with an error
+void processEventsError(JsonDocument &doc) {
+  if (subscribedWithStartHeight) { // e.g. the node can't replay from the requested start height
+    Serial.println(F("❌ Resuming the subscription failed, re-reading on-chain state:"));
     serializeJsonPretty(doc, Serial);
     Serial.println("\n");
+    resubscribePending = true;
+    return;
   }
+  Serial.println(F("❌ Subscription failed:"));
+  serializeJsonPretty(doc, Serial);
+  Serial.println("\n");
+  subscriptionRejected = true;
+}
+
+// FUNCTION processBlockDigestMessage:
+// keeps track of the sealed head
+void processBlockDigestMessage(JsonDocument &doc) {
+  const unsigned long height = strtoul(doc["payload"]["height"] | "0", nullptr, 10);
+  if (height == 0) return;
+  sealedHeadHeight = height;
+  strlcpy(sealedHeadBlockId, doc["payload"]["block_id"] | "", sizeof(sealedHeadBlockId));
+  sealedHeadMS = millis();
+}
+
+// FUNCTION processBlockDigestError:
+// The controller works without the sealed head (state reads then look up the latest sealed block), so a failed
+// digest subscription is only logged.
+void processBlockDigestError(JsonDocument &doc) {
+  Serial.println(F("⚠️ Block digest subscription failed, state reads look up the latest sealed block instead:"));
+  serializeJsonPretty(doc, Serial);
+  Serial.println("\n");
+}
+
+// FUNCTION sealedHeadIsFresh:
+// true if a digest arrived recently enough for `sealedHeadHeight` to name the latest sealed block
+bool sealedHeadIsFresh() {
+  return sealedHeadHeight > 0 && millis() - sealedHeadMS <= maxSealedHeadAgeMS;
+}
+
+// FUNCTION canResumeEventStream:
+// true if the node can replay the events since the last processed block, so no script execution is needed
+bool canResumeEventStream() {
+  return lastProcessedBlockHeight > 0 && millis() - lastProcessedBlockMS <= maxResumeGapMS;
+}
+
+// FUNCTION recordProcessedBlock:
+// marks all events up to and including `blockHeight` as processed; reports when the controller became
+// consistent again after a reconnect
+void recordProcessedBlock(unsigned long blockHeight) {
+  if (blockHeight == 0 || blockHeight < lastProcessedBlockHeight) return;
+  lastProcessedBlockHeight = blockHeight;
+  lastProcessedBlockMS = millis();
+
+  // the block's events are applied completely, so the checkpoint is consistent
+  ControllerCheckpoint::Record record = checkpoint->current();
+  record.blockHeight = blockHeight;
+  checkpoint->update(record);
+  checkpoint->persistIfDue();
+  if (disconnectedSinceMS != 0) {
+    Serial.printf("✅ Consistent again at block %lu, %lu ms after losing the connection\n", blockHeight, lastProcessedBlockMS - disconnectedSinceMS);
+    disconnectedSinceMS = 0;
+  }
+}
+
+// FUNCTION recordControllerState:
+// notes the latest controller state for the next checkpoint; persisted once its block is processed completely
+void recordControllerState(int64_t state, uint64_t eventSequence) {
+  ControllerCheckpoint::Record record = checkpoint->current();
+  record.controllerState = state;
+  record.eventSequence = eventSequence;
+  checkpoint->update(record);
+}
+
+// FUNCTION restoreCheckpoint:
+// restores the controller state and the event stream's starting point from flash, if a valid checkpoint exists
+bool restoreCheckpoint() {
+  ControllerCheckpoint::Record record;
+  if (!checkpoint->begin() || !checkpoint->load(record)) {
+    Serial.println(F("💾 No checkpoint found, reading the on-chain state"));
+    return false;
+  }
+  Serial.printf("💾 Restored checkpoint: block %" PRIu64 ", event sequence %" PRIu64 ", controller state %" PRId64 "\n",
+                record.blockHeight, record.eventSequence, record.controllerState);
+  setControllerState(record.controllerState); // still on the actuator's core, as the network task is not running yet
+  lastProcessedBlockHeight = record.blockHeight;
+  lastAppliedEventSequence = record.eventSequence;
+  lastEventBlockHeight = record.blockHeight; // the event was applied at or before this block
+  lastProcessedBlockMS = millis(); // downtime is unknown; if the node can't replay from there, we fall back to a script read
+  return true;
 }
 
 /* Flow-Specific processing of websocket messages
@@ -537,28 +1272,9 @@ void processWebSocketMessage() {
 // FUNCTION: processControlInstruction
 // processes the json-representation of a control event's PAYLOAD. The payload is base64-encoded json of the cadence representation.
 // St the moment, only events of type `A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged` are supported.
+// The payload is decoded and parsed in a single streaming pass, without any heap allocations.
 void processControlInstruction(const char *encodedPayload) {
-  const size_t encpayloadLen = strlen(encodedPayload);
-
-  // Allocate a buffer big enough for decoded data and decode Base64 into it.
-  // mbedTLS provides a two-step approach (safe and recommended) for dynamic buffer allocation.
-  size_t decodedLen = 0; // calling `mbedtls_base64_decode` with first input *dst = NULL or second input dlen = 0 writes the required buffer size in `decodedLen` (third input)
-  mbedtls_base64_decode(nullptr, 0, &decodedLen, reinterpret_cast<const unsigned char *>(encodedPayload), encpayloadLen);
-  char *decoded = static_cast<char *>(malloc(decodedLen + 1)); // +1 for null terminator
-  if (!decoded) {
-    Serial.println(F("❌ malloc failed"));
-    return;
-  }
-  int rc = mbedtls_base64_decode(reinterpret_cast<unsigned char *>(decoded), decodedLen, &decodedLen,
-                                 reinterpret_cast<const unsigned char *>(encodedPayload), encpayloadLen);
-  if (rc != 0) { // `mbedtls_base64_decode` returning 0 indicates successful decoding
-    Serial.printf("❌ Base64 decode error (code %d)\n", rc);
-    free(decoded);
-    return;
-  }
-  decoded[decodedLen] = '\0'; // Ensure null‑terminated string
-
-  // extract fields; example payload:
+  // extract fields; example payload (after base64 decoding):
   /*
   {
   "value": {
@@ -590,82 +1306,112 @@ void processControlInstruction(const char *encodedPayload) {
   "type": "Event"
   }
   */
-
-  // 3. Parse JSON and extract fields
-  StaticJsonDocument<4096> cadenceEvent;
-  DeserializationError err = deserializeJson(cadenceEvent, decoded);
-  if (err) {
-    Serial.print(F("❌ JSON parse failed: "));
-    Serial.println(err.c_str());
-    free(decoded);
+  Base64DecodingStream decoded(encodedPayload);
+  JsonCadenceReader cadenceEvent(decoded);
+  JsonCadenceReader::IntegerField fields[] = {
+      {"value", true, false, 0, 0},          // Int64
+      {"oldValue", true, false, 0, 0},       // Int64
+      {"eventSequence", false, false, 0, 0}, // UInt64
+  };
+  JsonCadenceReader::Result result = cadenceEvent.readEvent("A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged", fields, 3);
+  if (decoded.failed()) {
+    Serial.println(F("❌ Base64 decode error"));
     return;
   }
+  switch (result) {
+    case JsonCadenceReader::Result::Ok:
+      break;
+    case JsonCadenceReader::Result::NotAnEvent:
+      Serial.println(F("❌ Payload type does not represent Cadence event"));
+      return;
+    case JsonCadenceReader::Result::UnexpectedEventId:
+      Serial.println(F("❌ Payload does not conform with the expected event id"));
+      return;
+    case JsonCadenceReader::Result::MissingFields:
+      Serial.println(F("❌ Payload does not contain all expected fields"));
+      return;
+    default:
+      Serial.println(F("❌ JSON parse failed"));
+      return;
+  }
+
+  const int64_t newValue = fields[0].int64Value;
+  const int64_t oldValue = fields[1].int64Value;
+  const uint64_t eventSequence = fields[2].uint64Value;
 
-  // 4. Verify type and id
-  const char *type = cadenceEvent["type"];
-  if (!type || strcmp(type, "Event") != 0) {
-    Serial.println(F("❌ Payload type does not represent Cadence event"));
-    free(decoded);
+  // Print extracted values
+  Serial.printf("    Event Sequence %2" PRIu64 "; updated value: %" PRId64 "  oldValue: %" PRId64 "\n", eventSequence, newValue, oldValue);
+
+  /* ── Order: skip events applied already, buffer the others until their block is complete ────────── */
+  if (lastAppliedEventSequence > 0 && eventSequence <= lastAppliedEventSequence) {
+    ++duplicateEvents;
+    Serial.println(F("    ↩️ applied already, skipped"));
     return;
   }
-  const char *id = cadenceEvent["value"]["id"]; // all cadence events should have an id - we just assume that here
-  if (!id || strcmp(id, "A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged") != 0) {
-    Serial.println(F("❌ Payload does not conform with the expected event id"));
-    free(decoded);
-    return;
+  const unsigned long blockHeight = currentEventBlockHeight;
+  EventOrderingStage::Insert inserted = controlUpdates->add(blockHeight, eventSequence, newValue);
+  if (inserted == EventOrderingStage::Insert::Full) { // the blocks before this one are complete: make room
+    if (!completeBlock(blockHeight - 1)) return;
+    currentEventBlockHeight = blockHeight;
+    inserted = controlUpdates->add(blockHeight, eventSequence, newValue);
   }
-
-  // 5. Extract fields from payload of event `A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged`
-  JsonArray fields = cadenceEvent["value"]["fields"];
-  String newValueStr, oldValueStr, eventSequenceStr; // we expect _all_ of these fields to be present
-  for (JsonObject field : fields) {
-    const char *fieldName = field["name"];
-    const char *fieldValue = field["value"]["value"]; // string
-    if (!fieldName || !fieldValue) continue;
-    // Use switch on first character for efficiency
-    switch (fieldName[0]) {
-      case 'v':
-        if (strcmp(fieldName, "value") == 0)
-          newValueStr = fieldValue;
-        break;
-      case 'o':
-        if (strcmp(fieldName, "oldValue") == 0)
-          oldValueStr = fieldValue;
-        break;
-      case 'e':
-        if (strcmp(fieldName, "eventSequence") == 0)
-          eventSequenceStr = fieldValue;
-        break;
-      default:
-        break;
-    }
+  if (inserted == EventOrderingStage::Insert::Full) { // scattered over this very block: apply them early, in order
+    Serial.println(F("    ⚠️ too many out-of-order control events in this block, applying them early"));
+    applyControlUpdates(blockHeight);
+    inserted = controlUpdates->add(blockHeight, eventSequence, newValue);
   }
-  // verify that newValueStr, oldValueStr, eventSequenceStr have been set
-  if (newValueStr.isEmpty() || oldValueStr.isEmpty() || eventSequenceStr.isEmpty()) {
-    Serial.println(F("❌ Payload does not contain all expected fields"));
-    free(decoded);
-    return;
+  if (inserted == EventOrderingStage::Insert::Duplicate) {
+    ++duplicateEvents;
+    Serial.println(F("    ↩️ received already, skipped"));
   }
+}
 
-  // Convert to int64_t/uint64_t using strtoll/strtoull for large values
-  int64_t newValue = strtoll(newValueStr.c_str(), nullptr, 10);
-  int64_t oldValue = strtoll(oldValueStr.c_str(), nullptr, 10);
-  uint64_t eventSequence = strtoull(eventSequenceStr.c_str(), nullptr, 10);
-
-  // Print extracted values
-  Serial.printf("    Event Sequence %2d; updated value: %lld  oldValue: %lld\n");
+// FUNCTION backfillEvents:
+// applies the events of blocks `startHeight` to `endHeight` (inclusive) that have a handler, as obtained from
+// the REST API; returns false if they couldn't be obtained completely
+bool backfillEvents(unsigned long startHeight, unsigned long endHeight) {
+  if (endHeight < startHeight) return true;
+  if (endHeight - startHeight >= maxBackfillBlocks) {
+    Serial.printf("    ⚠️ %lu blocks are too many to backfill\n", endHeight - startHeight + 1);
+    return false;
+  }
+  Serial.printf("🩹 Backfilling events of blocks %lu to %lu from '%s'\n", startHeight, endHeight, scriptExecuter->getURL().c_str());
+  backfilling = true;
+  bool success = true;
+  for (size_t i = 0; i < EVENT_REGISTRY.size() && success; ++i) {
+    if (EVENT_REGISTRY[i].handler) success = scriptExecuter->forEachEvent(EVENT_REGISTRY[i].id, startHeight, endHeight, applyBackfilledEvent);
+  }
+  backfilling = false;
+  return success;
+}
 
-  /* ── Sate machine update - eventually consistend; information-driven approach ──────────────────── */
-  setControllerState(newValue);
+// FUNCTION applyBackfilledEvent:
+// routes an event obtained via the REST API to its handler, just like events received via the WebSocket
+void applyBackfilledEvent(unsigned long blockHeight, const char *type, const char *payload) {
+  const EventType *registered = EVENT_REGISTRY.find(type);
+  if (!registered || !registered->handler) return;
+  Serial.printf("  • [backfill, block %lu] %s\n", blockHeight, type);
+  ++backfilledEvents;
+  currentEventBlockHeight = blockHeight;
+  registered->handler(payload);
+}
 
-  // ALWAYS free the decoded buffer to prevent memory leaks
-  free(decoded);
-  return;
+// FUNCTION abandonEventStream:
+// gives up on the current connection after a gap that couldn't be closed. Blocks after the last completely
+// processed one are not recorded as processed, so resuming the subscription makes the node replay them.
+void abandonEventStream() {
+  Serial.printf("❌ Could not close the gap, reconnecting to resume after block %lu\n", lastProcessedBlockHeight);
+  eventStreamBroken = true;
+  ingestQueue->clear(); // events after the gap must not be processed; the node replays them
+  controlUpdates->rewind(lastProcessedBlockHeight);
+  client->stop();
 }
 
 void setControllerState(int64_t newValue) {
   blueToggler->trigger(); // trigger blue LED blinking
+  const bool wasOn = extLoadOn;
   extLoadOn = (newValue < 0);
+  if (extLoadOn != wasOn) loadSwitches.fetch_add(1, std::memory_order_relaxed);
   if (extLoadOn) {
     Serial.printf(F("    ⚡ External load ON"));
     digitalWrite(EXT_LOAD_SWITCH, EXT_LOAD_ON);
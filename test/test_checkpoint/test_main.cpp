@@ -0,0 +1,263 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <unity.h>
+
+#include "ControllerCheckpoint.h"
+
+// ControllerCheckpoint against the in-memory Preferences of the native build, on the simulated clock. The
+// stored blob is 32 bytes: version (2 bytes), reserved (2), CRC32 of the record (4), the record (24). The shim lays
+// the values out in pages as NVS does, which tells the entries and page erases the writes cost, and can lose power
+// in the middle of a write.
+
+const unsigned long writeIntervalMS = 60000;
+const ControllerCheckpoint::Record someRecord = {123456789012ULL, 42, -1};
+
+// FUNCTION storedBlob, storeBlob:
+// direct access to the checkpoint's NVS entry, to corrupt it
+size_t storedBlob(uint8_t *blob, size_t size) {
+  Preferences preferences;
+  preferences.begin("checkpoint", true);
+  const size_t length = preferences.getBytes("record", blob, size);
+  preferences.end();
+  return length;
+}
+
+void storeBlob(const uint8_t *blob, size_t size) {
+  Preferences preferences;
+  preferences.begin("checkpoint", false);
+  preferences.putBytes("record", blob, size);
+  preferences.end();
+}
+
+void assertRecordsEqual(const ControllerCheckpoint::Record &expected, const ControllerCheckpoint::Record &actual) {
+  TEST_ASSERT_EQUAL_UINT64(expected.blockHeight, actual.blockHeight);
+  TEST_ASSERT_EQUAL_UINT64(expected.eventSequence, actual.eventSequence);
+  TEST_ASSERT_EQUAL_INT64(expected.controllerState, actual.controllerState);
+}
+
+// FUNCTION writeCheckpoint:
+// persists `record` via a checkpoint of its own, as the previous boot would have
+void writeCheckpoint(const ControllerCheckpoint::Record &record) {
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  TEST_ASSERT_TRUE(checkpoint.begin());
+  checkpoint.update(record);
+  TEST_ASSERT_TRUE(checkpoint.persistIfDue());
+}
+
+void setUp() {
+  eraseSimulatedNvs();
+  startSimulatedClock(1000);
+}
+
+void tearDown() {
+}
+
+void test_round_trip() {
+  writeCheckpoint(someRecord);
+
+  ControllerCheckpoint restored(writeIntervalMS);
+  TEST_ASSERT_TRUE(restored.begin());
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_TRUE(restored.load(record));
+  assertRecordsEqual(someRecord, record);
+  assertRecordsEqual(someRecord, restored.current());
+  TEST_ASSERT_FALSE(restored.persistIfDue()); // what was loaded is in flash already
+  TEST_ASSERT_EQUAL(0, restored.writes());
+}
+
+void test_nothing_stored() {
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_FALSE(checkpoint.load(record)); // not opened yet
+  TEST_ASSERT_TRUE(checkpoint.begin());
+  TEST_ASSERT_FALSE(checkpoint.load(record));
+}
+
+void test_writes_are_rate_bounded() {
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  TEST_ASSERT_TRUE(checkpoint.begin());
+  TEST_ASSERT_FALSE(checkpoint.persistIfDue()); // nothing to write
+
+  checkpoint.update(someRecord);
+  TEST_ASSERT_TRUE(checkpoint.persistIfDue()); // the first write since boot is due right away
+  TEST_ASSERT_EQUAL(1, checkpoint.writes());
+
+  ControllerCheckpoint::Record next = someRecord;
+  next.blockHeight += 10;
+  next.eventSequence += 1;
+  next.controllerState = 1;
+  checkpoint.update(next);
+  TEST_ASSERT_FALSE(checkpoint.persistIfDue());
+  advanceSimulatedClock(writeIntervalMS - 1);
+  TEST_ASSERT_FALSE(checkpoint.persistIfDue());
+  advanceSimulatedClock(1);
+  TEST_ASSERT_TRUE(checkpoint.persistIfDue());
+  TEST_ASSERT_EQUAL(2, checkpoint.writes());
+
+  advanceSimulatedClock(10 * writeIntervalMS);
+  checkpoint.update(next); // unchanged
+  TEST_ASSERT_FALSE(checkpoint.persistIfDue());
+  TEST_ASSERT_EQUAL(2, checkpoint.writes());
+
+  ControllerCheckpoint restored(writeIntervalMS);
+  restored.begin();
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_TRUE(restored.load(record));
+  assertRecordsEqual(next, record);
+}
+
+void test_updates_within_the_interval_are_coalesced() {
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  checkpoint.begin();
+  checkpoint.update(someRecord);
+  checkpoint.persistIfDue();
+
+  ControllerCheckpoint::Record latest = someRecord;
+  for (int i = 0; i < 100; ++i) { // one update per second
+    advanceSimulatedClock(1000);
+    ++latest.blockHeight;
+    checkpoint.update(latest);
+    checkpoint.persistIfDue();
+  }
+  TEST_ASSERT_EQUAL(1 + 100 / (writeIntervalMS / 1000), checkpoint.writes());
+}
+
+void test_corrupt_record_is_rejected() {
+  writeCheckpoint(someRecord);
+  uint8_t blob[32];
+  TEST_ASSERT_EQUAL(sizeof(blob), storedBlob(blob, sizeof(blob)));
+  blob[8] ^= 0x01; // the lowest byte of the block height
+  storeBlob(blob, sizeof(blob));
+
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  checkpoint.begin();
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_FALSE(checkpoint.load(record));
+}
+
+void test_corrupt_crc_is_rejected() {
+  writeCheckpoint(someRecord);
+  uint8_t blob[32];
+  storedBlob(blob, sizeof(blob));
+  blob[4] ^= 0x80;
+  storeBlob(blob, sizeof(blob));
+
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  checkpoint.begin();
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_FALSE(checkpoint.load(record));
+}
+
+void test_wrong_size_is_rejected() {
+  writeCheckpoint(someRecord);
+  uint8_t blob[32];
+  storedBlob(blob, sizeof(blob));
+  storeBlob(blob, 24); // e.g. written by a firmware with a different record layout
+
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  checkpoint.begin();
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_FALSE(checkpoint.load(record));
+}
+
+void test_wrong_version_is_rejected() {
+  writeCheckpoint(someRecord);
+  uint8_t blob[32];
+  storedBlob(blob, sizeof(blob));
+  const uint16_t version = ControllerCheckpoint::FORMAT_VERSION + 1;
+  memcpy(blob, &version, sizeof(version)); // the CRC covers the record only, so it still matches
+  storeBlob(blob, sizeof(blob));
+
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  checkpoint.begin();
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_FALSE(checkpoint.load(record));
+}
+
+void test_a_day_of_writes_stays_within_the_flash_wear_budget() {
+  // the budget in `ControllerCheckpoint.h`: 3 entries per write, a page erased every 42 writes, at most 1440 writes
+  // and ≈34 page erases a day, ≈9 per page of the 4 usable ones
+  const unsigned long writesPerDay = 24 * 60 * 60 * 1000UL / writeIntervalMS;
+  TEST_ASSERT_EQUAL(1440, writesPerDay);
+  const unsigned long pageErasesPerDay = (writesPerDay + 41) / 42;
+
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  TEST_ASSERT_TRUE(checkpoint.begin());
+  ControllerCheckpoint::Record record = someRecord, persisted = someRecord;
+  SimulatedNvsStatistics dayStart = simulatedNvsStatistics();
+  for (int day = 1; day <= 7; ++day) {
+    for (unsigned long minute = 0; minute < 24 * 60; ++minute) { // a busy contract: something changes every second
+      for (int second = 0; second < 60; ++second) {
+        advanceSimulatedClock(1000);
+        ++record.blockHeight;
+        record.controllerState = second;
+        checkpoint.update(record);
+        if (checkpoint.persistIfDue()) persisted = record;
+      }
+    }
+    const SimulatedNvsStatistics dayEnd = simulatedNvsStatistics();
+    const unsigned long entries = dayEnd.entriesWritten - dayStart.entriesWritten;
+    const unsigned long pageErases = dayEnd.pageErases - dayStart.pageErases;
+    char message[128];
+    snprintf(message, sizeof(message), "day %d: %lu writes, %lu entries, %lu page erases, at most %.1f per page a day",
+             day, checkpoint.writes() / day, entries, pageErases, (double)dayEnd.mostErasesOfAPage / day);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(writesPerDay * day, checkpoint.writes());
+    TEST_ASSERT_LESS_OR_EQUAL(3 * writesPerDay + pageErases, entries); // and live entries moved along, if any
+    TEST_ASSERT_LESS_OR_EQUAL(pageErasesPerDay, pageErases);
+    TEST_ASSERT_LESS_OR_EQUAL(9 * day, dayEnd.mostErasesOfAPage);
+    dayStart = dayEnd;
+  }
+
+  ControllerCheckpoint restored(writeIntervalMS);
+  restored.begin();
+  ControllerCheckpoint::Record loaded = {};
+  TEST_ASSERT_TRUE(restored.load(loaded));
+  assertRecordsEqual(persisted, loaded);
+}
+
+void test_torn_write_leaves_the_previous_record_loadable() {
+  ControllerCheckpoint::Record next = someRecord;
+  for (size_t entriesWritten = 0; entriesWritten < 3; ++entriesWritten) { // power lost within the write
+    writeCheckpoint(someRecord);
+    ++next.blockHeight;
+    ControllerCheckpoint checkpoint(writeIntervalMS);
+    checkpoint.begin();
+    checkpoint.update(next);
+    tearNextSimulatedNvsWrite(entriesWritten);
+    TEST_ASSERT_FALSE(checkpoint.persistIfDue());
+
+    ControllerCheckpoint restored(writeIntervalMS); // after the reboot
+    restored.begin();
+    ControllerCheckpoint::Record record = {};
+    TEST_ASSERT_TRUE(restored.load(record));
+    assertRecordsEqual(someRecord, record);
+  }
+
+  // power lost once all entries were written, before those of the previous record were erased: the new one counts
+  ControllerCheckpoint checkpoint(writeIntervalMS);
+  checkpoint.begin();
+  checkpoint.update(next);
+  tearNextSimulatedNvsWrite(3);
+  TEST_ASSERT_FALSE(checkpoint.persistIfDue());
+  ControllerCheckpoint restored(writeIntervalMS);
+  restored.begin();
+  ControllerCheckpoint::Record record = {};
+  TEST_ASSERT_TRUE(restored.load(record));
+  assertRecordsEqual(next, record);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_nothing_stored);
+  RUN_TEST(test_writes_are_rate_bounded);
+  RUN_TEST(test_updates_within_the_interval_are_coalesced);
+  RUN_TEST(test_corrupt_record_is_rejected);
+  RUN_TEST(test_corrupt_crc_is_rejected);
+  RUN_TEST(test_wrong_size_is_rejected);
+  RUN_TEST(test_wrong_version_is_rejected);
+  RUN_TEST(test_a_day_of_writes_stays_within_the_flash_wear_budget);
+  RUN_TEST(test_torn_write_leaves_the_previous_record_loadable);
+  return UNITY_END();
+}
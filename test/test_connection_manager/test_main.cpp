@@ -0,0 +1,236 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <random>
+
+#include "ConnectionManager.h"
+
+// ConnectionManager's timing on a simulated clock and with a controlled source of randomness, both injected
+// through its constructor. The step function lets each stage succeed, fail or stay pending, as a test demands.
+
+typedef ConnectionManager::Stage Stage;
+typedef ConnectionManager::Progress Progress;
+
+const unsigned long baseBackoffMS = 2000;
+const unsigned long maxBackoffMS = 60000;
+
+unsigned long simulatedMS = 0;
+unsigned long simulatedClock() {
+  return simulatedMS;
+}
+void advance(unsigned long ms) {
+  simulatedMS += ms;
+}
+
+enum class Draw { Lowest, Highest, Uniform } draw = Draw::Lowest;
+std::mt19937 generator;
+uint32_t controlledRandom(uint32_t bound) {
+  switch (draw) {
+    case Draw::Lowest: return 0;
+    case Draw::Highest: return bound - 1;
+    case Draw::Uniform: return std::uniform_int_distribution<uint32_t>(0, bound - 1)(generator);
+  }
+  return 0;
+}
+
+// what the step function reports for each stage; `Pending` keeps the manager in that stage
+Progress outcome[6];
+Stage lastAborted;
+unsigned int aborts = 0;
+
+Progress step(Stage stage, bool) {
+  return outcome[static_cast<size_t>(stage)];
+}
+
+void abortAttempt(Stage failedStage) {
+  lastAborted = failedStage;
+  ++aborts;
+}
+
+ConnectionManager newManager() {
+  return ConnectionManager(step, abortAttempt, baseBackoffMS, maxBackoffMS, simulatedClock, controlledRandom);
+}
+
+// FUNCTION succeedUpTo:
+// lets all stages before `stage` succeed, and `stage` report `progress`
+void succeedUpTo(Stage stage, Progress progress) {
+  for (size_t i = 0; i < 6; ++i)
+    outcome[i] = i < static_cast<size_t>(stage) ? Progress::Done : Progress::Pending;
+  outcome[static_cast<size_t>(stage)] = progress;
+}
+
+// FUNCTION pollUntilBackoff:
+// polls (without advancing the clock) until the attempt failed; returns the backoff drawn for the next one
+unsigned long pollUntilBackoff(ConnectionManager &manager) {
+  int polls = 0;
+  do {
+    manager.poll();
+  } while (manager.stage() != Stage::Backoff && ++polls < 10);
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Backoff);
+  return manager.currentBackoffMS();
+}
+
+// FUNCTION waitOutBackoff:
+// advances the clock to the end of the backoff; the next poll starts the next attempt
+void waitOutBackoff(ConnectionManager &manager) {
+  const unsigned long backoffMS = manager.currentBackoffMS();
+  advance(backoffMS - 1);
+  manager.poll();
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Backoff); // not a millisecond early
+  advance(1);
+}
+
+void setUp() {
+  simulatedMS = 1000;
+  draw = Draw::Lowest;
+  aborts = 0;
+}
+
+void tearDown() {
+}
+
+void test_backoff_doubles_up_to_the_cap() {
+  succeedUpTo(Stage::Transport, Progress::Failed);
+  const unsigned long expectedCeilingMS[] = {2000, 4000, 8000, 16000, 32000, 60000, 60000, 60000};
+  for (const Draw bound : {Draw::Lowest, Draw::Highest}) {
+    draw = bound;
+    ConnectionManager manager = newManager();
+    for (unsigned long ceilingMS : expectedCeilingMS) {
+      const unsigned long backoffMS = pollUntilBackoff(manager);
+      TEST_ASSERT_EQUAL(bound == Draw::Lowest ? ceilingMS / 2 : ceilingMS, backoffMS); // drawn from [d/2, d]
+      TEST_ASSERT_TRUE(lastAborted == Stage::Transport);
+      waitOutBackoff(manager);
+    }
+    TEST_ASSERT_EQUAL(sizeof(expectedCeilingMS) / sizeof(expectedCeilingMS[0]), manager.failures());
+    TEST_ASSERT_EQUAL(0, manager.established());
+  }
+}
+
+void test_backoff_is_jittered_within_its_window() {
+  draw = Draw::Uniform;
+  generator.seed(1);
+  ConnectionManager manager = newManager();
+  succeedUpTo(Stage::WifiJoining, Progress::Failed);
+  unsigned long ceilingMS = baseBackoffMS;
+  for (int attempt = 0; attempt < 12; ++attempt) {
+    const unsigned long backoffMS = pollUntilBackoff(manager);
+    TEST_ASSERT_GREATER_OR_EQUAL(ceilingMS / 2, backoffMS);
+    TEST_ASSERT_LESS_OR_EQUAL(ceilingMS, backoffMS);
+    waitOutBackoff(manager);
+    ceilingMS = ceilingMS * 2 > maxBackoffMS ? maxBackoffMS : ceilingMS * 2;
+  }
+}
+
+void test_stage_timeout() {
+  ConnectionManager manager = newManager();
+  manager.setStageTimeout(Stage::Upgrade, 5000);
+  succeedUpTo(Stage::Upgrade, Progress::Pending);
+  manager.poll(); // Wi-Fi
+  manager.poll(); // TCP/TLS
+  manager.poll(); // enters the upgrade
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Upgrade);
+
+  advance(4999);
+  manager.poll();
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Upgrade);
+  TEST_ASSERT_EQUAL(0, aborts);
+  advance(1);
+  manager.poll();
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Backoff);
+  TEST_ASSERT_TRUE(lastAborted == Stage::Upgrade);
+  TEST_ASSERT_EQUAL(1, manager.failures());
+}
+
+void test_stage_without_timeout_never_times_out() {
+  ConnectionManager manager = newManager();
+  succeedUpTo(Stage::Subscribing, Progress::Pending);
+  for (int i = 0; i < 10; ++i)
+    manager.poll();
+  advance(24UL * 60 * 60 * 1000);
+  manager.poll();
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Subscribing);
+}
+
+void test_timeout_restarts_with_each_stage() {
+  ConnectionManager manager = newManager();
+  manager.setStageTimeout(Stage::WifiJoining, 3000);
+  manager.setStageTimeout(Stage::Transport, 3000);
+  succeedUpTo(Stage::Transport, Progress::Pending);
+  outcome[static_cast<size_t>(Stage::WifiJoining)] = Progress::Pending;
+  manager.poll();
+  advance(2000);
+  outcome[static_cast<size_t>(Stage::WifiJoining)] = Progress::Done;
+  manager.poll(); // joined after 2 s; the transport gets its own 3 s
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Transport);
+  advance(2999);
+  manager.poll();
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Transport);
+  advance(1);
+  manager.poll();
+  TEST_ASSERT_TRUE(manager.stage() == Stage::Backoff);
+}
+
+void test_reaching_connected_resets_the_backoff() {
+  draw = Draw::Highest;
+  ConnectionManager manager = newManager();
+  succeedUpTo(Stage::Transport, Progress::Failed);
+  for (int i = 0; i < 4; ++i) {
+    pollUntilBackoff(manager);
+    waitOutBackoff(manager);
+  }
+  TEST_ASSERT_EQUAL(16000, manager.currentBackoffMS());
+
+  succeedUpTo(Stage::Connected, Progress::Pending);
+  for (int i = 0; i < 6; ++i)
+    manager.poll();
+  TEST_ASSERT_TRUE(manager.isConnected());
+  TEST_ASSERT_EQUAL(1, manager.established());
+  TEST_ASSERT_EQUAL(0, manager.currentBackoffMS());
+
+  // a lost connection is retried after the base backoff, not after the ceiling reached before
+  outcome[static_cast<size_t>(Stage::Connected)] = Progress::Failed;
+  TEST_ASSERT_EQUAL(baseBackoffMS, pollUntilBackoff(manager));
+  TEST_ASSERT_TRUE(lastAborted == Stage::Connected);
+  TEST_ASSERT_EQUAL(5, manager.failures());
+}
+
+void test_first_retries_of_a_fleet_are_spread() {
+  // an Access Node restarts and drops 1000 devices at the same time
+  draw = Draw::Uniform;
+  generator.seed(2);
+  const int devices = 1000;
+  const int buckets = 10;
+  int histogram[buckets] = {};
+  unsigned long earliestMS = maxBackoffMS, latestMS = 0;
+  for (int device = 0; device < devices; ++device) {
+    ConnectionManager manager = newManager();
+    succeedUpTo(Stage::Connected, Progress::Pending);
+    for (int i = 0; i < 6; ++i)
+      manager.poll();
+    outcome[static_cast<size_t>(Stage::Connected)] = Progress::Failed;
+    const unsigned long backoffMS = pollUntilBackoff(manager);
+    if (backoffMS < earliestMS) earliestMS = backoffMS;
+    if (backoffMS > latestMS) latestMS = backoffMS;
+    ++histogram[(backoffMS - baseBackoffMS / 2) * buckets / (baseBackoffMS / 2 + 1)];
+  }
+  // the first retries cover [base/2, base] evenly, rather than arriving in lockstep
+  TEST_ASSERT_GREATER_OR_EQUAL(baseBackoffMS / 2, earliestMS);
+  TEST_ASSERT_LESS_OR_EQUAL(baseBackoffMS / 2 + 50, earliestMS);
+  TEST_ASSERT_LESS_OR_EQUAL(baseBackoffMS, latestMS);
+  TEST_ASSERT_GREATER_OR_EQUAL(baseBackoffMS - 50, latestMS);
+  for (int bucket = 0; bucket < buckets; ++bucket) {
+    TEST_ASSERT_INT_WITHIN(devices / buckets / 2, devices / buckets, histogram[bucket]);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_backoff_doubles_up_to_the_cap);
+  RUN_TEST(test_backoff_is_jittered_within_its_window);
+  RUN_TEST(test_stage_timeout);
+  RUN_TEST(test_stage_without_timeout_never_times_out);
+  RUN_TEST(test_timeout_restarts_with_each_stage);
+  RUN_TEST(test_reaching_connected_resets_the_backoff);
+  RUN_TEST(test_first_retries_of_a_fleet_are_spread);
+  return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "DesiredState.h"
+#include "PinnedTask.h"
+
+// DesiredState between two threads, as between the network task and the actuator: the writer runs as a pinned task
+// (a std::thread in the native build) and publishes millions of 64-bit values, each telling its position in both
+// halves and in the timestamp; the test's own thread takes them, as the actuator does. Values may be skipped, as
+// they are superseded, but the reader must never see a torn value or go back to an older one, and the last value
+// published must always arrive. Run it in `native_tsan` as well, where ThreadSanitizer checks the sequence lock.
+
+const unsigned long valuesToPublish = 2000000;
+const unsigned long timeoutMS = 120000;
+
+DesiredState latestState;
+std::atomic<unsigned long> publishedCount(0);
+
+// FUNCTION valueOf: the `i`th value, negative as a `value` of the contract can be, its position in both halves
+int64_t valueOf(unsigned long i) {
+  return -static_cast<int64_t>((static_cast<uint64_t>(i) << 32) | (~static_cast<uint32_t>(i) & 0x7FFFFFFF));
+}
+
+// FUNCTION publish: the writer task's iteration
+bool publish() {
+  const unsigned long i = publishedCount.load(std::memory_order_relaxed);
+  if (i == valuesToPublish) return false; // done; sleeps from now on
+  latestState.publish(valueOf(i + 1), static_cast<uint32_t>(i + 1));
+  publishedCount.store(i + 1, std::memory_order_release);
+  std::this_thread::yield(); // let the reader in between values, even on a single core
+  return true;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_reader_sees_intact_increasing_values_and_the_last_one() {
+  TEST_ASSERT_TRUE(startPinnedTask("writer", publish, 0, 4096, 1));
+
+  unsigned long taken = 0, torn = 0, backwards = 0, lastTaken = 0;
+  const unsigned long startMS = millis();
+  while (lastTaken < valuesToPublish && millis() - startMS < timeoutMS) {
+    int64_t value;
+    uint32_t publishedAtUS;
+    if (!latestState.take(value, publishedAtUS)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ++taken;
+    const unsigned long i = publishedAtUS; // the timestamp is the value's position
+    if (value != valueOf(i)) ++torn;      // halves (or timestamp) of different values
+    if (i <= lastTaken) ++backwards;      // an older value, or the same one twice
+    lastTaken = i;
+  }
+  char message[128];
+  snprintf(message, sizeof(message), "took %lu of %lu values in %lu ms, the last one %lu", taken, valuesToPublish,
+           millis() - startMS, lastTaken);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_EQUAL(0, torn);
+  TEST_ASSERT_EQUAL(0, backwards);
+  TEST_ASSERT_EQUAL(valuesToPublish, lastTaken); // the final value arrived
+
+  int64_t value;
+  uint32_t publishedAtUS;
+  TEST_ASSERT_FALSE(latestState.take(value, publishedAtUS)); // nothing new since
+  TEST_ASSERT_EQUAL(valuesToPublish, latestState.published());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_reader_sees_intact_increasing_values_and_the_last_one);
+  return UNITY_END();
+}
@@ -0,0 +1,188 @@
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "HttpBodyStream.h"
+
+// Reads response bodies via HttpBodyStream over the HTTPClient shim, against a minimal HTTP/1.1 server on a
+// thread of its own: a body with Content-Length on a kept-alive connection, a chunked body, and a response
+// that closes the connection.
+//
+//   /length   200, Content-Length, body {"x":<length of the request body>}
+//   /chunked  200, Transfer-Encoding: chunked, body "hello world" in two chunks
+//   /close    404, Connection: close, body "bye"
+
+int serverSocket = -1;
+uint16_t serverPort = 0;
+std::atomic<int> acceptedConnections(0); // written by the server thread
+
+// FUNCTION readLine:
+// reads one line (without CRLF) from the socket; false when the connection was closed
+bool readLine(int fd, std::string &line) {
+  line.clear();
+  char c;
+  while (recv(fd, &c, 1, 0) == 1) {
+    if (c == '\n') return true;
+    if (c != '\r') line += c;
+  }
+  return false;
+}
+
+// FUNCTION serveConnection:
+// answers requests on one connection until the client or the `/close` request closes it
+void serveConnection(int fd) {
+  std::string line;
+  while (readLine(fd, line)) {
+    const std::string path = line.substr(line.find(' ') + 1, line.rfind(' ') - line.find(' ') - 1);
+    size_t contentLength = 0;
+    while (readLine(fd, line) && !line.empty()) {
+      if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) contentLength = strtoul(line.c_str() + 15, nullptr, 10);
+    }
+    std::string body(contentLength, '\0');
+    if (contentLength > 0 && recv(fd, &body[0], contentLength, MSG_WAITALL) != (ssize_t)contentLength) break;
+
+    std::string response;
+    if (path == "/length") {
+      const std::string json = "{\"x\":" + std::to_string(body.size()) + "}";
+      response = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(json.size()) + "\r\n\r\n" + json;
+    } else if (path == "/chunked") {
+      response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+    } else {
+      response = "HTTP/1.1 404 Not Found\r\nConnection: close\r\nContent-Length: 3\r\n\r\nbye";
+    }
+    send(fd, response.data(), response.size(), 0);
+    if (path == "/close") break;
+  }
+  close(fd);
+}
+
+// FUNCTION startServer:
+// listens on an ephemeral port of the loopback interface; serves one connection at a time
+void startServer() {
+  serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(serverSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+  socklen_t length = sizeof(address);
+  getsockname(serverSocket, reinterpret_cast<sockaddr *>(&address), &length);
+  serverPort = ntohs(address.sin_port);
+  listen(serverSocket, 4);
+  std::thread([] {
+    int fd;
+    while ((fd = accept(serverSocket, nullptr, nullptr)) >= 0) {
+      ++acceptedConnections;
+      serveConnection(fd);
+    }
+  }).detach();
+}
+
+String serverURL(const char *path) {
+  return String("http://127.0.0.1:") + String((unsigned int)serverPort) + path;
+}
+
+const char *collectedHeaders[] = {"Transfer-Encoding"};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_content_length_on_kept_alive_connection() {
+  HTTPClient http;
+  http.setReuse(true);
+  const int connectionsBefore = acceptedConnections.load();
+  for (int i = 0; i < 3; ++i) {
+    TEST_ASSERT_TRUE(http.begin(serverURL("/length")));
+    http.collectHeaders(collectedHeaders, 1);
+    http.addHeader(F("Content-Type"), F("application/json"));
+    const char *requestBody = "{\"script\":1}";
+    TEST_ASSERT_EQUAL(200, http.POST((uint8_t *)requestBody, strlen(requestBody)));
+    TEST_ASSERT_EQUAL(8, http.getSize());
+    TEST_ASSERT_EQUAL_STRING("", http.header("Transfer-Encoding").c_str());
+
+    HttpBodyStream body(http.getStream(), false, http.getSize());
+    char text[32] = {};
+    TEST_ASSERT_EQUAL(8, body.readBytes(text, sizeof(text) - 1)); // stops at the end of the body
+    TEST_ASSERT_EQUAL_STRING("{\"x\":12}", text);
+    TEST_ASSERT_EQUAL(-1, body.read());
+    TEST_ASSERT_TRUE(body.drain());
+    http.end();
+    TEST_ASSERT_TRUE(http.connected()); // kept alive for the next request
+  }
+  TEST_ASSERT_EQUAL(connectionsBefore + 1, acceptedConnections.load());
+  http.setReuse(false);
+  http.end();
+}
+
+void test_chunked_body() {
+  HTTPClient http;
+  http.setReuse(true);
+  TEST_ASSERT_TRUE(http.begin(serverURL("/chunked")));
+  http.collectHeaders(collectedHeaders, 1);
+  TEST_ASSERT_EQUAL(200, http.GET());
+  TEST_ASSERT_EQUAL(-1, http.getSize());
+  String transferEncoding = http.header("Transfer-Encoding");
+  transferEncoding.toLowerCase();
+  TEST_ASSERT_TRUE(transferEncoding.indexOf("chunked") >= 0);
+
+  HttpBodyStream body(http.getStream(), true, -1);
+  TEST_ASSERT_EQUAL('h', body.peek());
+  char text[32] = {};
+  TEST_ASSERT_EQUAL(11, body.readBytes(text, sizeof(text) - 1)); // across the chunk boundary
+  TEST_ASSERT_EQUAL_STRING("hello world", text);
+  TEST_ASSERT_TRUE(body.drain()); // consumes the last chunk, so the connection can be reused
+  TEST_ASSERT_FALSE(body.failed());
+  TEST_ASSERT_EQUAL(11, body.bodyBytes());
+  http.end();
+  TEST_ASSERT_TRUE(http.connected());
+
+  // the next response on the same connection starts right after the last chunk
+  TEST_ASSERT_TRUE(http.begin(serverURL("/length")));
+  TEST_ASSERT_EQUAL(200, http.GET());
+  TEST_ASSERT_EQUAL_STRING("{\"x\":0}", http.getString().c_str());
+  http.setReuse(false);
+  http.end();
+}
+
+void test_connection_close() {
+  HTTPClient http;
+  http.setReuse(true);
+  TEST_ASSERT_TRUE(http.begin(serverURL("/close")));
+  TEST_ASSERT_EQUAL(404, http.GET());
+  HttpBodyStream body(http.getStream(), false, http.getSize());
+  char text[8] = {};
+  body.readBytes(text, sizeof(text) - 1);
+  TEST_ASSERT_EQUAL_STRING("bye", text);
+  TEST_ASSERT_TRUE(body.drain());
+  http.end();
+  TEST_ASSERT_FALSE(http.connected()); // the server asked to close it
+}
+
+void test_connection_refused() {
+  HTTPClient http;
+  TEST_ASSERT_TRUE(http.begin("http://127.0.0.1:1/x"));
+  TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_REFUSED, http.GET());
+  http.end();
+}
+
+int main() {
+  signal(SIGPIPE, SIG_IGN); // as the native build's main() does
+  startServer();
+  UNITY_BEGIN();
+  RUN_TEST(test_content_length_on_kept_alive_connection);
+  RUN_TEST(test_chunked_body);
+  RUN_TEST(test_connection_close);
+  RUN_TEST(test_connection_refused);
+  return UNITY_END();
+}
@@ -0,0 +1,234 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "MessageArena.h"
+
+// MessageArena soaked with the allocations of a long run of messages, as the network task makes them: per
+// message, a JsonDocument's pools and strings (allocated, grown and shrunk in place, grown and moved while something
+// else was allocated after them, released) until the message is processed and the arena reset. Each kind of message
+// repeats the same pattern, as a heartbeat or a block with N events does. Over time, the high-water mark must not
+// creep, every reset must leave the whole arena free in one piece, and the bytes stranded by moved allocations must
+// stay those of the message at hand, not accumulate.
+
+const size_t arenaCapacity = 8192; // as `wsMessageArenaCapacity` in `../../src/main.cpp`
+const unsigned long soakMessages = 200000;
+
+// CLASS MessageShape
+// the allocations of one kind of message, replayed the same way each time from `seed`
+struct MessageShape {
+  const char *name;
+  uint32_t seed;
+  int operations;
+  size_t largestAllocation;
+};
+
+const MessageShape shapes[] = {
+    {"subscription acknowledgement", 11, 6, 96},
+    {"heartbeat", 23, 12, 160},
+    {"block digest", 37, 14, 200},
+    {"control event", 41, 20, 200},
+    {"block with 6 events", 53, 70, 200},
+};
+const size_t shapeCount = sizeof(shapes) / sizeof(shapes[0]);
+
+struct Allocation {
+  uint8_t *ptr;
+  size_t size;
+  uint8_t fill; // every byte of the allocation holds this value
+};
+
+struct MessageStats {
+  size_t peak;     // largest `used()` while processing the message
+  size_t stranded; // bytes of the arena in use at the end of the message that no live allocation holds
+};
+
+// FUNCTION nextRandom: xorshift32, so a shape replays identically
+uint32_t nextRandom(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+size_t footprint(size_t size) { // header and alignment as in MessageArena
+  return 8 + ((size + 7) & ~(size_t)7);
+}
+
+void fillAllocation(Allocation &allocation, uint8_t fill) {
+  allocation.fill = fill;
+  memset(allocation.ptr, fill, allocation.size);
+}
+
+void assertIntact(const Allocation &allocation) {
+  size_t i = 0;
+  while (i < allocation.size && allocation.ptr[i] == allocation.fill)
+    ++i;
+  TEST_ASSERT_EQUAL(allocation.size, i);
+}
+
+// FUNCTION processMessage:
+// replays the allocations of `shape` in `arena`, checks that the contents survive, and resets the arena
+MessageStats processMessage(MessageArena &arena, const MessageShape &shape) {
+  uint32_t state = shape.seed;
+  std::vector<Allocation> live;
+  bool backIsMostRecent = false; // `live.back()` is the arena's most recent allocation, resizable in place
+  MessageStats stats = {0, 0};
+  for (int operation = 0; operation < shape.operations; ++operation) {
+    const uint32_t choice = nextRandom(state) % 10;
+    const size_t size = 1 + nextRandom(state) % shape.largestAllocation;
+    const uint8_t fill = nextRandom(state);
+    if (choice < 5 || live.empty()) { // a new pool page or string
+      Allocation allocation = {static_cast<uint8_t *>(arena.allocate(size)), size, 0};
+      TEST_ASSERT_NOT_NULL(allocation.ptr);
+      fillAllocation(allocation, fill);
+      live.push_back(allocation);
+      backIsMostRecent = true;
+    } else if (choice < 7 && backIsMostRecent) { // a string being built grows or shrinks, in place
+      Allocation &allocation = live.back();
+      uint8_t *resized = static_cast<uint8_t *>(arena.reallocate(allocation.ptr, size));
+      TEST_ASSERT_EQUAL_PTR(allocation.ptr, resized);
+      allocation.size = std::min(allocation.size, size);
+      assertIntact(allocation);
+      allocation.size = size;
+      fillAllocation(allocation, fill);
+    } else if (choice < 9) { // an earlier pool grows, and moves to the top unless it fits
+      Allocation &allocation = live[nextRandom(state) % live.size()];
+      const size_t grown = allocation.size + size;
+      uint8_t *moved = static_cast<uint8_t *>(arena.reallocate(allocation.ptr, grown));
+      TEST_ASSERT_NOT_NULL(moved);
+      allocation.ptr = moved;
+      assertIntact(allocation); // the old contents came along
+      allocation.size = grown;
+      fillAllocation(allocation, fill);
+      if (&allocation != &live.back()) std::swap(allocation, live.back()); // the moved one is the most recent now
+      backIsMostRecent = true;
+    } else { // a temporary string is released
+      arena.deallocate(live.back().ptr); // reclaimed right away only if it is the most recent
+      live.pop_back();
+      backIsMostRecent = false;
+    }
+    stats.peak = std::max(stats.peak, arena.used());
+  }
+
+  size_t held = 0;
+  for (const Allocation &allocation : live) {
+    assertIntact(allocation);
+    held += footprint(allocation.size);
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(held, arena.used());
+  stats.stranded = arena.used() - held;
+  arena.reset();
+  TEST_ASSERT_EQUAL(0, arena.used());
+  return stats;
+}
+
+// FUNCTION shapeOf: the next message of the soak; mostly heartbeats and digests, now and then events
+const MessageShape &shapeOf(uint32_t &state) {
+  const uint32_t roll = nextRandom(state) % 100;
+  if (roll < 40) return shapes[1];
+  if (roll < 80) return shapes[2];
+  if (roll < 92) return shapes[3];
+  if (roll < 97) return shapes[4];
+  return shapes[0];
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_soak_high_water_mark_settles() {
+  MessageArena arena(arenaCapacity);
+  MessageStats first[shapeCount];
+  for (size_t i = 0; i < shapeCount; ++i)
+    first[i] = processMessage(arena, shapes[i]);
+  size_t largestPeak = 0;
+  for (size_t i = 0; i < shapeCount; ++i) {
+    char line[96];
+    snprintf(line, sizeof(line), "%-28s: peak %4zu B, %4zu B stranded", shapes[i].name, first[i].peak,
+             first[i].stranded);
+    TEST_MESSAGE(line);
+    largestPeak = std::max(largestPeak, first[i].peak);
+  }
+  TEST_ASSERT_EQUAL(largestPeak, arena.highWaterMark());
+  TEST_ASSERT_LESS_OR_EQUAL(arenaCapacity, largestPeak);
+
+  uint32_t state = 2025;
+  for (unsigned long message = 1; message <= soakMessages; ++message) {
+    const MessageShape &shape = shapeOf(state);
+    const MessageStats stats = processMessage(arena, shape);
+    TEST_ASSERT_EQUAL(first[&shape - shapes].peak, stats.peak); // the same message takes the same memory, always
+    if (message % 50000 == 0) {
+      char line[96];
+      snprintf(line, sizeof(line), "after %6lu messages: high-water mark %zu of %zu B, %lu failures", message,
+               arena.highWaterMark(), arena.getCapacity(), arena.failures());
+      TEST_MESSAGE(line);
+      TEST_ASSERT_EQUAL(largestPeak, arena.highWaterMark());
+    }
+  }
+  TEST_ASSERT_EQUAL(0, arena.failures());
+}
+
+void test_soak_no_fragmentation_across_messages() {
+  MessageArena arena(arenaCapacity);
+  MessageStats first[shapeCount];
+  for (size_t i = 0; i < shapeCount; ++i)
+    first[i] = processMessage(arena, shapes[i]);
+
+  uint32_t state = 7;
+  size_t mostStranded = 0;
+  for (unsigned long message = 1; message <= soakMessages; ++message) {
+    const MessageShape &shape = shapeOf(state);
+    const MessageStats stats = processMessage(arena, shape);
+    TEST_ASSERT_EQUAL(first[&shape - shapes].stranded, stats.stranded); // stranded bytes don't outlive a message
+    mostStranded = std::max(mostStranded, stats.stranded);
+    if (message % 10000 == 0) { // after a reset, the whole arena is one free block again
+      void *everything = arena.allocate(arena.getCapacity() - 8);
+      TEST_ASSERT_NOT_NULL(everything);
+      arena.reset();
+    }
+  }
+  char line[96];
+  snprintf(line, sizeof(line), "at most %zu B stranded by moved allocations within a message", mostStranded);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL(0, arena.failures());
+}
+
+void test_oversized_message_fails_and_arena_recovers() {
+  MessageArena arena(arenaCapacity);
+  void *fits = arena.allocate(arenaCapacity / 2);
+  TEST_ASSERT_NOT_NULL(fits);
+  TEST_ASSERT_NULL(arena.allocate(arenaCapacity / 2)); // the header doesn't fit any more
+  TEST_ASSERT_NULL(arena.reallocate(fits, arenaCapacity)); // in place, neither
+  TEST_ASSERT_EQUAL(2, arena.failures());
+  arena.reset();
+
+  for (size_t i = 0; i < shapeCount; ++i)
+    processMessage(arena, shapes[i]);
+  TEST_ASSERT_EQUAL(2, arena.failures());
+}
+
+void test_string_builder_grows_in_place() {
+  MessageArena arena(arenaCapacity);
+  ArenaStringBuilder builder(&arena);
+  const char chunk[] = "{\"subscription_id\":\"20charIDStreamEvents\"}";
+  for (int i = 0; i < 40; ++i)
+    builder.write(reinterpret_cast<const uint8_t *>(chunk), sizeof(chunk) - 1);
+  TEST_ASSERT_FALSE(builder.overflowed());
+  TEST_ASSERT_EQUAL(40 * (sizeof(chunk) - 1), builder.length());
+  TEST_ASSERT_EQUAL(footprint(2048 + 1), arena.used()); // grew by doubling, in place: nothing stranded
+  arena.reset();
+  TEST_ASSERT_EQUAL(0, arena.used());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_soak_high_water_mark_settles);
+  RUN_TEST(test_soak_no_fragmentation_across_messages);
+  RUN_TEST(test_oversized_message_fails_and_arena_recovers);
+  RUN_TEST(test_string_builder_grows_in_place);
+  return UNITY_END();
+}
@@ -0,0 +1,328 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Client.h>
+#include <Preferences.h>
+#include <unity.h>
+
+#include <chrono>
+#include <inttypes.h>
+#include <string>
+#include <vector>
+
+#include "ControllerCheckpoint.h"
+#include "DesiredState.h"
+#include "EventOrderingStage.h"
+#include "IngestQueue.h"
+#include "MessageArena.h"
+#include "RxRingBuffer.h"
+#include "SpscQueue.h"
+#include "StreamWatchdog.h"
+#include "SubscriptionManager.h"
+#include "WebSocketFrameParser.h"
+#include "WebSocketFrameWriter.h"
+#include "WebSocketMessageStream.h"
+
+// The whole path of a message through the network task, as `../../src/main.cpp` runs it: the frame parser on the
+// receive buffer, WebSocketMessageStream, the filtered JsonDocument in the message arena, routing by subscription,
+// the ingest queue, processControlInstruction() and the ordering stage, up to the state published to the actuator
+// and the checkpoint. A recording of an `events` subscription -- heartbeats and blocks with control events, some of
+// them fragmented, PINGs in between -- is replayed through main.cpp's own functions. After a warm-up, in which the
+// subscription is sent and the checkpoint first written, a message must not touch the heap at all: every
+// allocation is counted via glibc's `__libc_malloc`, as in `../../experiments/Frame_receive_benchmark`.
+// The clock stands still, so the checkpoint's once-a-minute write (see test_checkpoint) is not part of it.
+
+const unsigned long warmUpMessages = 200;
+const unsigned long measuredMessages = 3000;
+const size_t segmentSize = 1436; // TCP payload per segment
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define COUNTS_ALLOCATIONS 0 // the sanitizers' own allocator can't be bypassed
+#else
+/* ── allocation counting ─────────────────────────────────────────────────────────────────────────── */
+unsigned long allocations = 0;
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) {
+  ++allocations;
+  return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+  ++allocations;
+  return __libc_calloc(count, size);
+}
+void *realloc(void *pointer, size_t size) {
+  ++allocations;
+  return __libc_realloc(pointer, size);
+}
+}
+#define COUNTS_ALLOCATIONS 1
+#endif
+
+/* ── main.cpp's state and functions ──────────────────────────────────────────────────────────────── */
+extern Client *client;
+extern RxRingBuffer *wsRxBuffer;
+extern WebSocketFrameParser *wsParser;
+extern WebSocketMessageStream *wsMessage;
+extern WebSocketFrameWriter *wsWriter;
+extern MessageArena *wsArena;
+extern ArenaJsonAllocator *wsJsonAllocator;
+extern SubscriptionManager *subscriptions;
+extern size_t eventsSubscription;
+extern size_t digestsSubscription;
+extern const char *eventsSubscriptionId;
+extern const char *digestsSubscriptionId;
+extern IngestQueue *ingestQueue;
+extern EventOrderingStage *controlUpdates;
+extern ControllerCheckpoint *checkpoint;
+extern StreamWatchdog *streamWatchdog;
+extern DesiredState desiredState;
+extern SpscQueue<unsigned long, 16> heartbeatQueue;
+extern unsigned long lastProcessedBlockHeight;
+extern uint64_t lastAppliedEventSequence;
+extern unsigned long messageIndexGaps;
+extern unsigned long eventSequenceGaps;
+extern unsigned long duplicateEvents;
+
+bool readWebSocketFrame();
+void processWebSocketMessage();
+bool processIngestQueue(size_t budget);
+void buildWebSocketMessageFilter();
+bool sendWebSocketFrame(const char *payload, size_t length);
+void buildEventsArguments(JsonObject args);
+void buildBlockDigestArguments(JsonObject args);
+void processEventsMessage(JsonDocument &doc);
+void processEventsError(JsonDocument &doc);
+void processBlockDigestMessage(JsonDocument &doc);
+void processBlockDigestError(JsonDocument &doc);
+
+// CLASS ReplayClient
+// a `Client` that has the recorded `bytes` to read, a TCP segment per read, and counts the PONGs written to it
+class ReplayClient : public Client {
+  public:
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char *, uint16_t) override { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    if (size > 0 && buffer[0] == (0x80 | WebSocketFrameWriter::OPCODE_PONG)) ++pongs; // a frame per write
+    return size;
+  }
+  int available() override { return bytes.size() - position; }
+  int read() override { return position < bytes.size() ? bytes[position++] : -1; }
+  int read(uint8_t *buffer, size_t size) override {
+    size = std::min(std::min(size, segmentSize), bytes.size() - position);
+    memcpy(buffer, bytes.data() + position, size);
+    position += size;
+    return size;
+  }
+  int peek() override { return position < bytes.size() ? bytes[position] : -1; }
+  void flush() override {}
+  void stop() override { stopped = true; }
+  uint8_t connected() override { return !stopped; }
+  operator bool() override { return !stopped; }
+
+  std::vector<uint8_t> bytes;
+  size_t position = 0;
+  unsigned long pongs = 0;
+  bool stopped = false;
+};
+
+/* ── the recording ───────────────────────────────────────────────────────────────────────────────── */
+ReplayClient replay;
+unsigned long recordedMessages = 0; // events messages, i.e. blocks
+unsigned long recordedPings = 0;
+uint64_t recordedEventSequence = 0; // of the last control event recorded
+int64_t recordedValue = 0;          // ... and its value
+
+std::string base64(const std::string &text) {
+  static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  for (size_t i = 0; i < text.size(); i += 3) {
+    uint32_t group = (uint8_t)text[i] << 16;
+    if (i + 1 < text.size()) group |= (uint8_t)text[i + 1] << 8;
+    if (i + 2 < text.size()) group |= (uint8_t)text[i + 2];
+    encoded += digits[group >> 18];
+    encoded += digits[(group >> 12) & 0x3F];
+    encoded += i + 1 < text.size() ? digits[(group >> 6) & 0x3F] : '=';
+    encoded += i + 2 < text.size() ? digits[group & 0x3F] : '=';
+  }
+  return encoded;
+}
+
+// FUNCTION appendFrame: an unmasked frame with a payload of less than 64 KB
+void appendFrame(bool isFinal, uint8_t opcode, const std::string &payload) {
+  replay.bytes.push_back((isFinal ? 0x80 : 0x00) | opcode);
+  if (payload.size() < 126) {
+    replay.bytes.push_back(payload.size());
+  } else {
+    replay.bytes.push_back(126);
+    replay.bytes.push_back(payload.size() >> 8);
+    replay.bytes.push_back(payload.size() & 0xFF);
+  }
+  replay.bytes.insert(replay.bytes.end(), payload.begin(), payload.end());
+}
+
+// FUNCTION controlEvent: a `ControlValueChanged` event as the node sends it, continuing the event sequence
+std::string controlEvent(unsigned long blockHeight, int eventIndex) {
+  const int64_t oldValue = recordedValue;
+  recordedValue = (int64_t)(recordedEventSequence * 37 % 201) - 100;
+  ++recordedEventSequence;
+  const std::string cadence =
+      "{\"value\":{\"id\":\"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged\",\"fields\":["
+      "{\"value\":{\"value\":\"" + std::to_string(recordedValue) + "\",\"type\":\"Int64\"},\"name\":\"value\"},"
+      "{\"value\":{\"value\":\"" + std::to_string(oldValue) + "\",\"type\":\"Int64\"},\"name\":\"oldValue\"},"
+      "{\"value\":{\"value\":\"" + std::to_string(recordedEventSequence) + "\",\"type\":\"UInt64\"},\"name\":\"eventSequence\"}"
+      "]},\"type\":\"Event\"}";
+  char transactionId[65];
+  snprintf(transactionId, sizeof(transactionId), "%064lx", blockHeight * 16 + eventIndex);
+  return std::string("{\"type\":\"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged\",\"transaction_id\":\"") +
+         transactionId + "\",\"transaction_index\":\"0\",\"event_index\":\"" + std::to_string(eventIndex) +
+         "\",\"payload\":\"" + base64(cadence) + "\"}";
+}
+
+// FUNCTION recordEventsMessage:
+// the next block: mostly heartbeats, every other one with 1 to 3 control events; now and then fragmented, and
+// now and then a PING before it or between its fragments
+void recordEventsMessage() {
+  const unsigned long i = recordedMessages++;
+  const unsigned long blockHeight = 1000 + i;
+  const int eventCount = i % 2 == 0 ? 0 : 1 + (i / 2) % 3;
+  std::string events;
+  for (int e = 0; e < eventCount; ++e)
+    events += (e > 0 ? "," : "") + controlEvent(blockHeight, e);
+  const std::string message =
+      std::string("{\"subscription_id\":\"") + eventsSubscriptionId + "\",\"topic\":\"events\",\"payload\":{" +
+      "\"block_id\":\"" + std::string(64, 'a' + i % 6) + "\",\"block_height\":\"" + std::to_string(blockHeight) +
+      "\",\"block_timestamp\":\"2025-06-01T12:" + std::to_string(10 + i / 60 % 50) + ":" + std::to_string(10 + i % 50) +
+      ".000000000Z\",\"events\":[" + events + "],\"message_index\":" + std::to_string(i) + "}}";
+
+  if (i % 10 == 0) {
+    appendFrame(true, 0x9, "ping " + std::to_string(i));
+    ++recordedPings;
+  }
+  if (i % 7 != 0) {
+    appendFrame(true, 0x1, message);
+    return;
+  }
+  const size_t third = message.size() / 3;
+  appendFrame(false, 0x1, message.substr(0, third));
+  if (i % 21 == 0) {
+    appendFrame(true, 0x9, "between fragments " + std::to_string(i));
+    ++recordedPings;
+  }
+  appendFrame(false, 0x0, message.substr(third, third));
+  appendFrame(true, 0x0, message.substr(2 * third));
+}
+
+/* ── the network task's message handling ─────────────────────────────────────────────────────────── */
+const size_t ingestItemsPerIteration = 4; // as in main.cpp
+
+// FUNCTION networkPass: the part of main.cpp's controllerIteration() that handles messages
+bool networkPass() {
+  const bool ingestPending = processIngestQueue(ingestItemsPerIteration);
+  const bool messageReady = !ingestQueue->congested() && readWebSocketFrame();
+  if (messageReady) processWebSocketMessage();
+  return messageReady || ingestPending;
+}
+
+// FUNCTION processRecordedMessages: runs network passes until `messages` more events messages were processed
+void processRecordedMessages(unsigned long messages) {
+  const unsigned long target = subscriptions->messages(eventsSubscription) + messages;
+  for (unsigned long passes = 0; subscriptions->messages(eventsSubscription) < target && passes < 20 * messages; ++passes) {
+    networkPass();
+    unsigned long queuedAtUS;
+    while (heartbeatQueue.pop(queuedAtUS)) { // the actuator's part
+    }
+  }
+  while (processIngestQueue(ingestItemsPerIteration)) { // the last message's events and end of block
+  }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_message_path_allocates_nothing_after_warm_up() {
+  startSimulatedClock(1000000);
+  eraseSimulatedNvs();
+
+  // as setup() does, without the connection management and the tasks
+  client = &replay;
+  wsRxBuffer = new RxRingBuffer(16384);
+  wsParser = new WebSocketFrameParser(wsRxBuffer);
+  wsMessage = new WebSocketMessageStream(wsParser);
+  wsWriter = new WebSocketFrameWriter(1024);
+  wsArena = new MessageArena(8192);
+  wsJsonAllocator = new ArenaJsonAllocator(wsArena);
+  buildWebSocketMessageFilter();
+  ingestQueue = new IngestQueue(32, 768, 24);
+  controlUpdates = new EventOrderingStage(16, 64);
+  subscriptions = new SubscriptionManager(wsArena, wsJsonAllocator, sendWebSocketFrame);
+  digestsSubscription = subscriptions->add(digestsSubscriptionId, "block_digests", buildBlockDigestArguments, processBlockDigestMessage, processBlockDigestError);
+  eventsSubscription = subscriptions->add(eventsSubscriptionId, "events", buildEventsArguments, processEventsMessage, processEventsError);
+  checkpoint = new ControllerCheckpoint(60000);
+  TEST_ASSERT_TRUE(checkpoint->begin());
+  streamWatchdog = new StreamWatchdog(5 * 1500, 3);
+
+  const std::string acknowledgement =
+      std::string("{\"subscription_id\":\"") + eventsSubscriptionId + "\",\"topic\":\"events\",\"action\":\"subscribe\"}";
+  appendFrame(true, 0x1, acknowledgement);
+  while (recordedMessages < warmUpMessages + measuredMessages)
+    recordEventsMessage();
+  TEST_ASSERT_EQUAL(2, subscriptions->subscribeAll());
+  streamWatchdog->arm();
+
+  processRecordedMessages(warmUpMessages);
+  TEST_ASSERT_EQUAL(warmUpMessages, subscriptions->messages(eventsSubscription));
+  TEST_ASSERT_TRUE(subscriptions->state(eventsSubscription) == SubscriptionManager::State::Active);
+
+#if COUNTS_ALLOCATIONS
+  const unsigned long allocationsBefore = allocations;
+#endif
+  const auto start = std::chrono::steady_clock::now(); // micros() stands still with the clock
+  processRecordedMessages(measuredMessages);
+  const double elapsedUS = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+#if COUNTS_ALLOCATIONS
+  const unsigned long allocationCount = allocations - allocationsBefore;
+#else
+  const unsigned long allocationCount = 0;
+#endif
+  char line[160];
+  snprintf(line, sizeof(line), "%lu messages, %" PRIu64 " control events, %lu PINGs: %.1f us and %.2f allocations per message",
+           measuredMessages + warmUpMessages, recordedEventSequence, recordedPings, elapsedUS / measuredMessages,
+           (double)allocationCount / measuredMessages);
+  TEST_MESSAGE(line);
+
+  // every message arrived and took effect
+  TEST_ASSERT_FALSE(replay.stopped);
+  TEST_ASSERT_EQUAL(replay.bytes.size(), replay.position);
+  TEST_ASSERT_EQUAL(warmUpMessages + measuredMessages, subscriptions->messages(eventsSubscription));
+  TEST_ASSERT_EQUAL(recordedPings, replay.pongs);
+  TEST_ASSERT_EQUAL(0, messageIndexGaps);
+  TEST_ASSERT_EQUAL(0, eventSequenceGaps);
+  TEST_ASSERT_EQUAL(0, duplicateEvents);
+  TEST_ASSERT_EQUAL(0, ingestQueue->depth());
+  TEST_ASSERT_EQUAL(1000 + warmUpMessages + measuredMessages - 1, lastProcessedBlockHeight);
+  TEST_ASSERT_EQUAL_UINT64(recordedEventSequence, lastAppliedEventSequence);
+  int64_t value;
+  uint32_t publishedAtUS;
+  TEST_ASSERT_TRUE(desiredState.take(value, publishedAtUS));
+  TEST_ASSERT_EQUAL_INT64(recordedValue, value);
+  TEST_ASSERT_EQUAL(0, wsArena->failures());
+
+#if COUNTS_ALLOCATIONS
+  TEST_ASSERT_EQUAL(0, allocationCount);
+#else
+  TEST_IGNORE_MESSAGE("allocations not counted under the sanitizers");
+#endif
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_message_path_allocates_nothing_after_warm_up);
+  return UNITY_END();
+}
@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <unity.h>
+
+// Checks that the host shims of the Arduino core behave like the ESP32's where the firmware relies on it:
+// String's parsing and formatting, and Preferences surviving end() and re-opening the namespace.
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_string_concatenation() {
+  const String url = String("http://") + "host" + ":" + String(8070) + "/v1/";
+  TEST_ASSERT_EQUAL_STRING("http://host:8070/v1/", url.c_str());
+  TEST_ASSERT_EQUAL(4, url.indexOf("://"));
+  TEST_ASSERT_EQUAL_STRING("host", url.substring(7, 11).c_str());
+  TEST_ASSERT_EQUAL(8070, url.substring(12).toInt());
+}
+
+void test_string_number_formatting() {
+  TEST_ASSERT_EQUAL_STRING("-42", String(-42).c_str());
+  TEST_ASSERT_EQUAL_STRING("ff", String(255u, 16).c_str());
+  TEST_ASSERT_EQUAL_STRING("1.50", String(1.5).c_str());
+  TEST_ASSERT_EQUAL_STRING("18446744073709551615", String(18446744073709551615ULL).c_str());
+}
+
+void test_string_header_parsing() {
+  String header = "  Chunked, gzip \r";
+  header.trim();
+  header.toLowerCase();
+  TEST_ASSERT_EQUAL_STRING("chunked, gzip", header.c_str());
+  TEST_ASSERT_EQUAL(0, header.indexOf("chunked"));
+
+  const String parameter = "server_max_window_bits=10";
+  TEST_ASSERT_EQUAL(10, parameter.substring(parameter.indexOf("=") + 1).toInt());
+  TEST_ASSERT_EQUAL(0, String("x").toInt()); // not a number
+}
+
+void test_strlcpy_truncates() {
+  char buffer[4];
+  TEST_ASSERT_EQUAL(6, strlcpy(buffer, "abcdef", sizeof(buffer))); // the length of the source
+  TEST_ASSERT_EQUAL_STRING("abc", buffer);
+}
+
+void test_preferences_survive_reopening() {
+  Preferences writer;
+  TEST_ASSERT_TRUE(writer.begin("shims", false));
+  const uint32_t value = 7;
+  TEST_ASSERT_EQUAL(sizeof(value), writer.putBytes("key", &value, sizeof(value)));
+  writer.end();
+
+  Preferences reader;
+  TEST_ASSERT_TRUE(reader.begin("shims", true));
+  uint32_t read = 0;
+  TEST_ASSERT_EQUAL(sizeof(read), reader.getBytesLength("key"));
+  TEST_ASSERT_EQUAL(sizeof(read), reader.getBytes("key", &read, sizeof(read)));
+  TEST_ASSERT_EQUAL(7, read);
+  TEST_ASSERT_EQUAL(0, reader.putBytes("key", &value, sizeof(value))); // opened read-only
+  reader.end();
+}
+
+void test_preferences_namespaces_are_separate() {
+  Preferences other;
+  TEST_ASSERT_TRUE(other.begin("shims-other", false));
+  TEST_ASSERT_FALSE(other.isKey("key"));
+  TEST_ASSERT_EQUAL(0, other.getBytesLength("key"));
+  const uint8_t value = 1;
+  other.putBytes("key", &value, sizeof(value));
+  TEST_ASSERT_TRUE(other.remove("key"));
+  TEST_ASSERT_FALSE(other.isKey("key"));
+  other.end();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_string_concatenation);
+  RUN_TEST(test_string_number_formatting);
+  RUN_TEST(test_string_header_parsing);
+  RUN_TEST(test_strlcpy_truncates);
+  RUN_TEST(test_preferences_survive_reopening);
+  RUN_TEST(test_preferences_namespaces_are_separate);
+  return UNITY_END();
+}
@@ -0,0 +1,282 @@
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "JsonCadenceReader.h"
+#include "OnChainState.h"
+
+// Decoding script results that carry several values at once: JsonCadenceReader::readFields on JSON-Cadence text,
+// and OnChainState::executeScript end to end, against a loopback server standing in for the Access Node's
+// `scripts` endpoint.
+
+typedef JsonCadenceReader::IntegerField IntegerField;
+typedef JsonCadenceReader::Result Result;
+
+// CLASS TextStream
+// a Stream over a string, as the decoded script result would be
+class TextStream : public Stream {
+  public:
+  explicit TextStream(const char *text) : text(text), position(0) {}
+  int available() override { return text.size() - position; }
+  int read() override { return position < text.size() ? (uint8_t)text[position++] : -1; }
+  int peek() override { return position < text.size() ? (uint8_t)text[position] : -1; }
+  size_t write(uint8_t) override { return 0; }
+
+  private:
+  std::string text;
+  size_t position;
+};
+
+// FUNCTION base64:
+// RFC 4648, with padding
+std::string base64(const std::string &data) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < data.size(); i += 3) {
+    const size_t n = data.size() - i < 3 ? data.size() - i : 3;
+    uint32_t bits = (uint32_t)(uint8_t)data[i] << 16;
+    if (n > 1) bits |= (uint32_t)(uint8_t)data[i + 1] << 8;
+    if (n > 2) bits |= (uint8_t)data[i + 2];
+    out += ALPHABET[(bits >> 18) & 63];
+    out += ALPHABET[(bits >> 12) & 63];
+    out += n > 1 ? ALPHABET[(bits >> 6) & 63] : '=';
+    out += n > 2 ? ALPHABET[bits & 63] : '=';
+  }
+  return out;
+}
+
+/* ── script results ─────────────────────────────────────────────────────────────────────────────── */
+
+const char *STRUCT_RESULT =
+    R"({"value":{"id":"s.0d3c8d02b02ceb4c.Outputs","fields":[)"
+    R"({"name":"label","value":{"value":"load one","type":"String"}},)"
+    R"({"name":"load1","value":{"value":"-5","type":"Int64"}},)"
+    R"({"name":"sequence","value":{"value":"18446744073709551615","type":"UInt64"}},)"
+    R"({"name":"nested","value":{"value":{"id":"s.x.Inner","fields":[{"name":"load1","value":{"value":"99","type":"Int64"}}]},"type":"Struct"}}]},)"
+    R"("type":"Struct"})";
+
+// {String: Int64}, with its keys in a different order than requested, and `type` ahead of `value`
+const char *DICTIONARY_RESULT =
+    R"({"type":"Dictionary","value":[)"
+    R"({"key":{"value":"load3","type":"String"},"value":{"value":"3","type":"Int64"}},)"
+    R"({"key":{"value":"load1","type":"String"},"value":{"value":"-9223372036854775808","type":"Int64"}},)"
+    R"({"key":{"value":"unrelated","type":"String"},"value":{"value":"7","type":"Int64"}},)"
+    R"({"key":{"value":"load2","type":"String"},"value":{"value":"9223372036854775807","type":"Int64"}}]})";
+
+IntegerField loadFields[3];
+
+void resetLoadFields() {
+  loadFields[0] = {"load1", true, false, 0, 0};
+  loadFields[1] = {"load2", true, false, 0, 0};
+  loadFields[2] = {"load3", true, false, 0, 0};
+}
+
+Result readFields(const char *text, IntegerField *fields, size_t fieldCount) {
+  TextStream stream(text);
+  JsonCadenceReader reader(stream);
+  return reader.readFields(fields, fieldCount);
+}
+
+/* ── loopback server, answering every request with `response` ────────────────────────────────────── */
+
+uint16_t serverPort = 0;
+std::mutex serverMutex;
+std::string response;     // guarded by `serverMutex`
+std::string lastTarget;   // ... as are the request target
+std::string lastBody;     // ... and body last received
+
+bool readLine(int fd, std::string &line) {
+  line.clear();
+  char c;
+  while (recv(fd, &c, 1, 0) == 1) {
+    if (c == '\n') return true;
+    if (c != '\r') line += c;
+  }
+  return false;
+}
+
+void serveConnection(int fd) {
+  std::string line;
+  while (readLine(fd, line)) {
+    const std::string target = line.substr(line.find(' ') + 1, line.rfind(' ') - line.find(' ') - 1);
+    size_t contentLength = 0;
+    while (readLine(fd, line) && !line.empty()) {
+      if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) contentLength = strtoul(line.c_str() + 15, nullptr, 10);
+    }
+    std::string body(contentLength, '\0');
+    if (contentLength > 0 && recv(fd, &body[0], contentLength, MSG_WAITALL) != (ssize_t)contentLength) break;
+    std::string answer;
+    {
+      std::lock_guard<std::mutex> lock(serverMutex);
+      lastTarget = target;
+      lastBody = body;
+      answer = response;
+    }
+    send(fd, answer.data(), answer.size(), 0);
+  }
+  close(fd);
+}
+
+void startServer() {
+  const int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(serverSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+  socklen_t length = sizeof(address);
+  getsockname(serverSocket, reinterpret_cast<sockaddr *>(&address), &length);
+  serverPort = ntohs(address.sin_port);
+  listen(serverSocket, 4);
+  std::thread([serverSocket] {
+    int fd;
+    while ((fd = accept(serverSocket, nullptr, nullptr)) >= 0)
+      std::thread(serveConnection, fd).detach();
+  }).detach();
+}
+
+// FUNCTION respondWith:
+// the script result `cadence`, as the Access Node returns it: a JSON string holding its base64 encoding
+void respondWith(const char *cadence) {
+  const std::string body = "\"" + base64(cadence) + "\"\n";
+  std::lock_guard<std::mutex> lock(serverMutex);
+  response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+             "\r\n\r\n" + body;
+}
+
+String restURL() {
+  return String("http://127.0.0.1:") + String((unsigned int)serverPort) + "/v1/";
+}
+
+/* ── tests ─────────────────────────────────────────────────────────────────────────────────────── */
+
+void setUp() {
+  resetLoadFields();
+}
+
+void tearDown() {
+}
+
+void test_struct_fields() {
+  IntegerField fields[] = {{"sequence", false, false, 0, 0}, {"load1", true, false, 0, 0}};
+  TEST_ASSERT_TRUE(readFields(STRUCT_RESULT, fields, 2) == Result::Ok);
+  TEST_ASSERT_TRUE(fields[0].found);
+  TEST_ASSERT_EQUAL_UINT64(18446744073709551615ULL, fields[0].uint64Value);
+  TEST_ASSERT_TRUE(fields[1].found);
+  TEST_ASSERT_EQUAL_INT64(-5, fields[1].int64Value); // not the nested struct's field of the same name
+}
+
+void test_struct_field_that_is_not_an_integer() {
+  IntegerField fields[] = {{"label", true, false, 0, 0}, {"load1", true, false, 0, 0}};
+  TEST_ASSERT_TRUE(readFields(STRUCT_RESULT, fields, 2) == Result::MissingFields);
+  TEST_ASSERT_FALSE(fields[0].found);
+  TEST_ASSERT_TRUE(fields[1].found);
+}
+
+void test_dictionary_in_any_key_order() {
+  TEST_ASSERT_TRUE(readFields(DICTIONARY_RESULT, loadFields, 3) == Result::Ok);
+  TEST_ASSERT_EQUAL_INT64(INT64_MIN, loadFields[0].int64Value);
+  TEST_ASSERT_EQUAL_INT64(INT64_MAX, loadFields[1].int64Value);
+  TEST_ASSERT_EQUAL_INT64(3, loadFields[2].int64Value);
+}
+
+void test_dictionary_with_missing_key() {
+  const char *result = R"({"value":[{"key":{"value":"load2","type":"String"},"value":{"value":"2","type":"Int64"}}],"type":"Dictionary"})";
+  TEST_ASSERT_TRUE(readFields(result, loadFields, 3) == Result::MissingFields);
+  TEST_ASSERT_FALSE(loadFields[0].found);
+  TEST_ASSERT_TRUE(loadFields[1].found);
+  TEST_ASSERT_EQUAL_INT64(2, loadFields[1].int64Value);
+  TEST_ASSERT_FALSE(loadFields[2].found);
+}
+
+void test_dictionary_with_values_that_are_no_int64() {
+  const char *result =
+      R"({"value":[)"
+      R"({"key":{"value":"load1","type":"String"},"value":{"value":"1.50000000","type":"Fix64"}},)"
+      R"({"key":{"value":"load2","type":"String"},"value":{"value":"9223372036854775808","type":"Int64"}},)"
+      R"({"key":{"value":"load3","type":"String"},"value":{"value":null,"type":"Optional"}}],"type":"Dictionary"})";
+  TEST_ASSERT_TRUE(readFields(result, loadFields, 3) == Result::MissingFields);
+  TEST_ASSERT_FALSE(loadFields[0].found); // not an integer
+  TEST_ASSERT_FALSE(loadFields[1].found); // out of range
+  TEST_ASSERT_FALSE(loadFields[2].found); // nil
+}
+
+void test_results_that_are_not_composites() {
+  TEST_ASSERT_TRUE(readFields(R"({"value":"0","type":"Int64"})", loadFields, 3) == Result::NotAComposite);
+  TEST_ASSERT_TRUE(readFields(R"({"value":[{"key":)", loadFields, 3) == Result::MalformedJson);
+  TEST_ASSERT_TRUE(readFields("", loadFields, 3) == Result::MalformedJson);
+}
+
+void test_execute_script_returning_a_dictionary() {
+  respondWith(DICTIONARY_RESULT);
+  OnChainState state(restURL());
+  const OnChainState::ScriptArgument arguments[] = {{"Address", "0x0d3c8d02b02ceb4c"}, {"UInt8", "3"}};
+  TEST_ASSERT_TRUE(state.executeScript("c2NyaXB0", arguments, 2, 123456, loadFields, 3));
+  TEST_ASSERT_EQUAL_INT64(INT64_MIN, loadFields[0].int64Value);
+  TEST_ASSERT_EQUAL_INT64(INT64_MAX, loadFields[1].int64Value);
+  TEST_ASSERT_EQUAL_INT64(3, loadFields[2].int64Value);
+
+  std::lock_guard<std::mutex> lock(serverMutex);
+  TEST_ASSERT_EQUAL_STRING("/v1/scripts?block_height=123456", lastTarget.c_str());
+  const std::string expectedBody = "{\"script\": \"c2NyaXB0\", \"arguments\": [\"" +
+                                   base64("{\"type\":\"Address\",\"value\":\"0x0d3c8d02b02ceb4c\"}") + "\", \"" +
+                                   base64("{\"type\":\"UInt8\",\"value\":\"3\"}") + "\"]}";
+  TEST_ASSERT_EQUAL_STRING(expectedBody.c_str(), lastBody.c_str());
+}
+
+void test_execute_script_returning_a_struct() {
+  respondWith(STRUCT_RESULT);
+  OnChainState state(restURL());
+  IntegerField fields[] = {{"load1", true, false, 0, 0}, {"sequence", false, false, 0, 0}};
+  TEST_ASSERT_TRUE(state.executeScript("c2NyaXB0", nullptr, 0, 1, fields, 2));
+  TEST_ASSERT_EQUAL_INT64(-5, fields[0].int64Value);
+  TEST_ASSERT_EQUAL_UINT64(18446744073709551615ULL, fields[1].uint64Value);
+  TEST_ASSERT_EQUAL(1, state.requests());
+}
+
+void test_execute_script_with_missing_value_fails() {
+  respondWith(R"({"value":[{"key":{"value":"load1","type":"String"},"value":{"value":"1","type":"Int64"}}],"type":"Dictionary"})");
+  OnChainState state(restURL());
+  TEST_ASSERT_FALSE(state.executeScript("c2NyaXB0", nullptr, 0, 1, loadFields, 3));
+  TEST_ASSERT_TRUE(loadFields[0].found);
+  TEST_ASSERT_FALSE(loadFields[1].found);
+
+  // the kept-alive connection is still usable for the next request
+  respondWith(DICTIONARY_RESULT);
+  TEST_ASSERT_TRUE(state.executeScript("c2NyaXB0", nullptr, 0, 1, loadFields, 3));
+  TEST_ASSERT_EQUAL(1, state.reusedRequests());
+}
+
+void test_execute_script_with_error_response_fails() {
+  {
+    const std::string body = R"({"code": 400, "message": "Invalid Flow request: block height 0 is below the spork root"})";
+    std::lock_guard<std::mutex> lock(serverMutex);
+    response = "HTTP/1.1 400 Bad Request\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+  }
+  OnChainState state(restURL());
+  TEST_ASSERT_FALSE(state.executeScript("c2NyaXB0", nullptr, 0, 1, loadFields, 3));
+}
+
+int main() {
+  signal(SIGPIPE, SIG_IGN); // as the native build's main() does
+  startServer();
+  UNITY_BEGIN();
+  RUN_TEST(test_struct_fields);
+  RUN_TEST(test_struct_field_that_is_not_an_integer);
+  RUN_TEST(test_dictionary_in_any_key_order);
+  RUN_TEST(test_dictionary_with_missing_key);
+  RUN_TEST(test_dictionary_with_values_that_are_no_int64);
+  RUN_TEST(test_results_that_are_not_composites);
+  RUN_TEST(test_execute_script_returning_a_dictionary);
+  RUN_TEST(test_execute_script_returning_a_struct);
+  RUN_TEST(test_execute_script_with_missing_value_fails);
+  RUN_TEST(test_execute_script_with_error_response_fails);
+  return UNITY_END();
+}
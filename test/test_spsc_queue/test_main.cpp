@@ -0,0 +1,77 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "PinnedTask.h"
+#include "SpscQueue.h"
+
+// SpscQueue between two threads, as between the network task and the actuator: the producer runs as a pinned task
+// (a std::thread in the native build) and pushes millions of 64-bit values, each telling its position in both
+// halves; the test's own thread pops them, as the actuator does. Every value must arrive, intact and in order. Run it
+// in `native_tsan` as well, where ThreadSanitizer checks that the queue's memory ordering publishes each element.
+
+const unsigned long elementsToPass = 2000000;
+const unsigned long timeoutMS = 120000;
+
+SpscQueue<uint64_t, 16> queue; // as small as `heartbeatQueue` in `../../src/main.cpp`, so it runs full often
+std::atomic<unsigned long> pushed(0);
+std::atomic<unsigned long> fullPushes(0);
+
+// FUNCTION element: the `i`th value, its position in both halves, so a torn copy shows
+uint64_t element(unsigned long i) {
+  return (static_cast<uint64_t>(i) << 32) | (~static_cast<uint32_t>(i));
+}
+
+// FUNCTION produce: the producer task's iteration
+bool produce() {
+  const unsigned long i = pushed.load(std::memory_order_relaxed);
+  if (i == elementsToPass) return false; // done; sleeps from now on
+  if (queue.push(element(i + 1))) {
+    pushed.store(i + 1, std::memory_order_relaxed);
+  } else {
+    fullPushes.fetch_add(1, std::memory_order_relaxed);
+    std::this_thread::yield(); // let the consumer catch up, even on a single core
+  }
+  return true;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_elements_arrive_intact_and_in_order() {
+  TEST_ASSERT_TRUE(startPinnedTask("producer", produce, 0, 4096, 1));
+
+  unsigned long popped = 0, outOfOrder = 0, emptyPops = 0;
+  const unsigned long startMS = millis();
+  while (popped < elementsToPass && millis() - startMS < timeoutMS) {
+    uint64_t value;
+    if (!queue.pop(value)) {
+      ++emptyPops;
+      std::this_thread::yield();
+      continue;
+    }
+    if (value != element(popped + 1)) ++outOfOrder; // lost, repeated, reordered, or torn
+    ++popped;
+  }
+  char message[128];
+  snprintf(message, sizeof(message), "%lu elements in %lu ms; %lu pushes found the queue full, %lu pops empty",
+           popped, millis() - startMS, fullPushes.load(), emptyPops);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_EQUAL(elementsToPass, popped);
+  TEST_ASSERT_EQUAL(0, outOfOrder);
+
+  uint64_t value;
+  TEST_ASSERT_FALSE(queue.pop(value)); // nothing beyond what was pushed
+  TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_elements_arrive_intact_and_in_order);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "StreamWatchdog.h"
+
+// StreamWatchdog on the simulated clock of the native build, configured as in main.cpp: a heartbeat every 5 blocks,
+// blocks at most 1500 ms apart, a stall after 3 missed heartbeat intervals -- a deadline of 22.5 s.
+
+const unsigned int heartbeatIntervalBlocks = 5;
+const unsigned long maxBlockIntervalMS = 1500;
+const unsigned int stallAfterMissedHeartbeats = 3;
+const unsigned long heartbeatIntervalMS = heartbeatIntervalBlocks * maxBlockIntervalMS;
+const unsigned long deadlineMS = heartbeatIntervalMS * stallAfterMissedHeartbeats;
+
+void setUp() {
+  startSimulatedClock(1000);
+}
+
+void tearDown() {
+}
+
+// FUNCTION silenceUntilStalled:
+// advances the clock in 100 ms steps until the watchdog reports a stall; returns how long that took
+unsigned long silenceUntilStalled(StreamWatchdog &watchdog) {
+  const unsigned long startMS = millis();
+  while (!watchdog.isStalled()) {
+    advanceSimulatedClock(100);
+    TEST_ASSERT_LESS_THAN(10 * deadlineMS, millis() - startMS);
+  }
+  return millis() - startMS;
+}
+
+void test_stall_detected_after_three_heartbeat_intervals() {
+  StreamWatchdog watchdog(heartbeatIntervalMS, stallAfterMissedHeartbeats);
+  watchdog.arm();
+  unsigned long blockHeight = 100;
+  for (int heartbeat = 0; heartbeat < 10; ++heartbeat) { // a healthy stream: a heartbeat every 5 blocks
+    advanceSimulatedClock(heartbeatIntervalMS);
+    blockHeight += heartbeatIntervalBlocks;
+    watchdog.feed(heartbeat, blockHeight);
+    TEST_ASSERT_FALSE(watchdog.isStalled());
+  }
+
+  // the connection goes half-open: nothing arrives any more
+  const unsigned long detectedAfterMS = silenceUntilStalled(watchdog);
+  TEST_ASSERT_EQUAL(deadlineMS, detectedAfterMS);
+  TEST_ASSERT_EQUAL(stallAfterMissedHeartbeats, detectedAfterMS / heartbeatIntervalMS);
+  TEST_ASSERT_EQUAL(1, watchdog.stalls());
+  char message[80];
+  snprintf(message, sizeof(message), "stall detected after %lu ms (%.1f heartbeat intervals)", detectedAfterMS,
+           (double)detectedAfterMS / heartbeatIntervalMS);
+  TEST_MESSAGE(message);
+}
+
+void test_stall_reported_once() {
+  StreamWatchdog watchdog(heartbeatIntervalMS, stallAfterMissedHeartbeats);
+  watchdog.arm();
+  silenceUntilStalled(watchdog);
+  advanceSimulatedClock(deadlineMS);
+  TEST_ASSERT_FALSE(watchdog.isStalled()); // disarmed until re-armed, e.g. after reconnecting
+  watchdog.arm();
+  TEST_ASSERT_EQUAL(deadlineMS, silenceUntilStalled(watchdog));
+  TEST_ASSERT_EQUAL(2, watchdog.stalls());
+}
+
+void test_messages_without_progress_are_no_sign_of_life() {
+  StreamWatchdog watchdog(heartbeatIntervalMS, stallAfterMissedHeartbeats);
+  watchdog.arm();
+  watchdog.feed(1, 200);
+  unsigned long messageIndex = 2;
+  const unsigned long startMS = millis();
+  while (!watchdog.isStalled()) { // the node keeps repeating the same block, e.g. a stuck replay
+    advanceSimulatedClock(500);
+    watchdog.feed(messageIndex++, 200);
+  }
+  TEST_ASSERT_EQUAL(deadlineMS, millis() - startMS);
+}
+
+void test_slow_blocks_within_the_deadline_are_tolerated() {
+  StreamWatchdog watchdog(heartbeatIntervalMS, stallAfterMissedHeartbeats);
+  watchdog.arm();
+  unsigned long blockHeight = 300;
+  for (int heartbeat = 0; heartbeat < 20; ++heartbeat) { // two heartbeats lost in a row, every time
+    advanceSimulatedClock(deadlineMS - 1);
+    TEST_ASSERT_FALSE(watchdog.isStalled());
+    blockHeight += 3 * heartbeatIntervalBlocks;
+    watchdog.feed(heartbeat, blockHeight);
+  }
+  TEST_ASSERT_EQUAL(0, watchdog.stalls());
+}
+
+void test_rearmed_watchdog_accepts_replay_below_old_height() {
+  StreamWatchdog watchdog(heartbeatIntervalMS, stallAfterMissedHeartbeats);
+  watchdog.arm();
+  watchdog.feed(40, 1000);
+  watchdog.disarm(); // the connection drops at block 1000
+
+  // the new subscription resumes from a checkpoint and replays blocks 950, 955, ... up to the head again
+  watchdog.arm();
+  unsigned long blockHeight = 950;
+  for (int heartbeat = 0; heartbeat < 10; ++heartbeat) {
+    advanceSimulatedClock(heartbeatIntervalMS);
+    watchdog.feed(heartbeat, blockHeight);
+    TEST_ASSERT_FALSE(watchdog.isStalled()); // each replayed block is progress, though below 1000
+    blockHeight += heartbeatIntervalBlocks;
+  }
+  TEST_ASSERT_EQUAL(0, watchdog.stalls());
+  TEST_ASSERT_EQUAL(deadlineMS, silenceUntilStalled(watchdog));
+}
+
+void test_disarmed_watchdog_stays_silent() {
+  StreamWatchdog watchdog(heartbeatIntervalMS, stallAfterMissedHeartbeats);
+  advanceSimulatedClock(10 * deadlineMS);
+  TEST_ASSERT_FALSE(watchdog.isStalled()); // never armed
+  watchdog.arm();
+  watchdog.disarm();
+  advanceSimulatedClock(10 * deadlineMS);
+  TEST_ASSERT_FALSE(watchdog.isStalled());
+  TEST_ASSERT_EQUAL(0, watchdog.stalls());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_stall_detected_after_three_heartbeat_intervals);
+  RUN_TEST(test_stall_reported_once);
+  RUN_TEST(test_messages_without_progress_are_no_sign_of_life);
+  RUN_TEST(test_slow_blocks_within_the_deadline_are_tolerated);
+  RUN_TEST(test_rearmed_watchdog_accepts_replay_below_old_height);
+  RUN_TEST(test_disarmed_watchdog_stays_silent);
+  return UNITY_END();
+}
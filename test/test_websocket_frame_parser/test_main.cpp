@@ -0,0 +1,177 @@
+#include <Arduino.h>
+#include <Client.h>
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "RxRingBuffer.h"
+#include "WebSocketFrameParser.h"
+
+// WebSocketFrameParser on server-to-client frames written here, handed to the receive buffer all at once: fragmented
+// messages, and control frames (PING, PONG, CLOSE) the server sends in between the fragments of a message. Each of
+// those must be reported, with its own payload and in order of arrival, once the message was read.
+
+const size_t rxBufferCapacity = 4096;
+
+// CLASS BufferClient
+// a `Client` that has `bytes` to read, in bulk, and nothing more
+class BufferClient : public Client {
+  public:
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char *, uint16_t) override { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t *, size_t size) override { return size; }
+  int available() override { return bytes.size() - position; }
+  int read() override { return position < bytes.size() ? bytes[position++] : -1; }
+  int read(uint8_t *buffer, size_t size) override {
+    size = std::min(size, bytes.size() - position);
+    memcpy(buffer, bytes.data() + position, size);
+    position += size;
+    return size;
+  }
+  int peek() override { return position < bytes.size() ? bytes[position] : -1; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+
+  std::vector<uint8_t> bytes;
+  size_t position = 0;
+};
+
+// FUNCTION appendFrame: an unmasked frame with a payload of less than 64 KB
+void appendFrame(std::vector<uint8_t> &bytes, bool isFinal, uint8_t opcode, const std::string &payload) {
+  bytes.push_back((isFinal ? 0x80 : 0x00) | opcode);
+  if (payload.size() < 126) {
+    bytes.push_back(payload.size());
+  } else {
+    bytes.push_back(126);
+    bytes.push_back(payload.size() >> 8);
+    bytes.push_back(payload.size() & 0xFF);
+  }
+  bytes.insert(bytes.end(), payload.begin(), payload.end());
+}
+
+// FUNCTION readWholeMessage: reads the message reported ready and finishes it
+std::string readWholeMessage(WebSocketFrameParser &parser) {
+  std::string message;
+  uint8_t chunk[64];
+  for (size_t n; (n = parser.readMessage(chunk, sizeof(chunk))) > 0;)
+    message.append(reinterpret_cast<const char *>(chunk), n);
+  parser.finishMessage();
+  return message;
+}
+
+std::string controlPayloadOf(const WebSocketFrameParser &parser) {
+  return std::string(reinterpret_cast<const char *>(parser.controlPayload()), parser.controlPayloadLength());
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_fragmented_message_read_in_place() {
+  BufferClient client;
+  appendFrame(client.bytes, false, 0x1, std::string(300, 'a'));
+  appendFrame(client.bytes, false, 0x0, std::string(200, 'b'));
+  appendFrame(client.bytes, true, 0x0, "c");
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  rx.fill(&client);
+
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::MessageReady);
+  TEST_ASSERT_TRUE(std::string(300, 'a') + std::string(200, 'b') + "c" == readWholeMessage(parser));
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::None);
+  TEST_ASSERT_EQUAL(0, rx.available());
+}
+
+void test_control_frames_between_fragments_reported_in_order() {
+  BufferClient client;
+  appendFrame(client.bytes, false, 0x1, "{\"topic\":");
+  appendFrame(client.bytes, true, 0x9, "first ping");
+  appendFrame(client.bytes, false, 0x0, "\"events\",");
+  appendFrame(client.bytes, true, 0xA, "pong");
+  appendFrame(client.bytes, true, 0x9, "second ping");
+  appendFrame(client.bytes, true, 0x0, "\"payload\":{}}");
+  appendFrame(client.bytes, true, 0x9, "after the message");
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  rx.fill(&client);
+
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::MessageReady);
+  TEST_ASSERT_TRUE("{\"topic\":\"events\",\"payload\":{}}" == readWholeMessage(parser));
+
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::Ping);
+  TEST_ASSERT_TRUE("first ping" == controlPayloadOf(parser));
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::Pong);
+  TEST_ASSERT_TRUE("pong" == controlPayloadOf(parser));
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::Ping); // overwrote the first one before
+  TEST_ASSERT_TRUE("second ping" == controlPayloadOf(parser));
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::Ping);
+  TEST_ASSERT_TRUE("after the message" == controlPayloadOf(parser));
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::None);
+}
+
+void test_control_frames_reported_after_every_message() {
+  BufferClient client;
+  for (int message = 0; message < 3; ++message) { // the queue empties between messages
+    appendFrame(client.bytes, false, 0x1, "part one,");
+    for (size_t i = 0; i < WebSocketFrameParser::MAX_INTERLEAVED_CONTROL_FRAMES; ++i)
+      appendFrame(client.bytes, true, 0x9, std::to_string(message) + "." + std::to_string(i));
+    appendFrame(client.bytes, true, 0x0, "part two");
+  }
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  rx.fill(&client);
+
+  for (int message = 0; message < 3; ++message) {
+    TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::MessageReady);
+    TEST_ASSERT_TRUE("part one,part two" == readWholeMessage(parser));
+    for (size_t i = 0; i < WebSocketFrameParser::MAX_INTERLEAVED_CONTROL_FRAMES; ++i) {
+      TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::Ping);
+      TEST_ASSERT_TRUE(std::to_string(message) + "." + std::to_string(i) == controlPayloadOf(parser));
+    }
+  }
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::None);
+}
+
+void test_close_between_fragments_reported_after_the_message() {
+  BufferClient client;
+  appendFrame(client.bytes, false, 0x1, "{\"topic\":");
+  appendFrame(client.bytes, true, 0x8, "\x03\xE8going away");
+  appendFrame(client.bytes, true, 0x0, "\"events\"}");
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  rx.fill(&client);
+
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::MessageReady);
+  parser.finishMessage(); // not read at all: the control frames are still collected
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::Close);
+  TEST_ASSERT_TRUE(std::string("\x03\xE8going away") == controlPayloadOf(parser));
+}
+
+void test_too_many_control_frames_between_fragments_are_a_protocol_error() {
+  BufferClient client;
+  appendFrame(client.bytes, false, 0x1, "{\"topic\":");
+  for (size_t i = 0; i <= WebSocketFrameParser::MAX_INTERLEAVED_CONTROL_FRAMES; ++i)
+    appendFrame(client.bytes, true, 0x9, "ping");
+  appendFrame(client.bytes, true, 0x0, "\"events\"}");
+  RxRingBuffer rx(rxBufferCapacity);
+  WebSocketFrameParser parser(&rx);
+  rx.fill(&client);
+
+  TEST_ASSERT_TRUE(parser.poll() == WebSocketFrameParser::Event::ProtocolError);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fragmented_message_read_in_place);
+  RUN_TEST(test_control_frames_between_fragments_reported_in_order);
+  RUN_TEST(test_control_frames_reported_after_every_message);
+  RUN_TEST(test_close_between_fragments_reported_after_the_message);
+  RUN_TEST(test_too_many_control_frames_between_fragments_are_a_protocol_error);
+  return UNITY_END();
+}
@@ -0,0 +1,140 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <zlib.h>
+
+#include <string>
+
+#include "WebSocketInflater.h"
+
+// Inflates permessage-deflate messages, compressed here with zlib as a server would (raw deflate, flushed
+// per message, the trailing 0x00 0x00 0xFF 0xFF stripped), through the smallest window the firmware accepts.
+// The messages are larger than the window, so the window wraps around, and are fed in in pieces of varying size.
+
+const uint8_t windowBits = WebSocketInflater::MIN_WINDOW_BITS + 1; // 512 bytes
+
+// FUNCTION eventsMessage:
+// a JSON message like those of the `events` topic, about `length` bytes long
+std::string eventsMessage(unsigned long blockHeight, size_t length) {
+  std::string message = "{\"subscription_id\":\"20charIDStreamEvents\",\"topic\":\"events\",\"payload\":{\"block_height\":\"" +
+                        std::to_string(blockHeight) + "\",\"events\":[";
+  for (unsigned i = 0; message.size() < length; ++i) {
+    message += "{\"type\":\"A.0d3c8d02b02ceb4c.MicrocontrollerTest.ControlValueChanged\",\"event_index\":\"" +
+               std::to_string(i) + "\"},";
+  }
+  return message + "]}}";
+}
+
+// CLASS Compressor
+// the sending side: one deflate stream across all messages, unless the context is not taken over
+class Compressor {
+  public:
+  explicit Compressor(bool noContextTakeover) : noContextTakeover(noContextTakeover) {
+    stream = {};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -windowBits, 8, Z_DEFAULT_STRATEGY);
+  }
+  ~Compressor() { deflateEnd(&stream); }
+
+  std::string compress(const std::string &message) {
+    if (noContextTakeover) deflateReset(&stream);
+    std::string compressed(deflateBound(&stream, message.size()) + 16, '\0');
+    stream.next_in = (Bytef *)message.data();
+    stream.avail_in = message.size();
+    stream.next_out = (Bytef *)&compressed[0];
+    stream.avail_out = compressed.size();
+    deflate(&stream, Z_SYNC_FLUSH);
+    compressed.resize(compressed.size() - stream.avail_out);
+    TEST_ASSERT_EQUAL_MEMORY(WebSocketInflater::MESSAGE_TAIL, compressed.data() + compressed.size() - 4, 4);
+    compressed.resize(compressed.size() - 4); // stripped by the sender, per RFC 7692
+    return compressed;
+  }
+
+  private:
+  z_stream stream;
+  const bool noContextTakeover;
+};
+
+// FUNCTION inflateMessage:
+// feeds `compressed` and the message tail to `inflater` in pieces of at most `pieceSize` bytes
+std::string inflateMessage(WebSocketInflater &inflater, const std::string &compressed, size_t pieceSize) {
+  const std::string input = compressed + std::string(reinterpret_cast<const char *>(WebSocketInflater::MESSAGE_TAIL), 4);
+  std::string inflated;
+  size_t position = 0;
+  while (true) {
+    const size_t piece = std::min(pieceSize, input.size() - position);
+    size_t consumed, produced;
+    const uint8_t *out;
+    const WebSocketInflater::Result result =
+        inflater.inflate(reinterpret_cast<const uint8_t *>(input.data()) + position, piece, &consumed, &out, &produced);
+    TEST_ASSERT_TRUE(result != WebSocketInflater::Result::Failed);
+    position += consumed;
+    inflated.append(reinterpret_cast<const char *>(out), produced);
+    if (position == input.size() && result == WebSocketInflater::Result::NeedsInput) break;
+  }
+  inflater.finishMessage();
+  return inflated;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_messages_larger_than_the_window() {
+  WebSocketInflater inflater;
+  TEST_ASSERT_TRUE(inflater.configure(windowBits, true));
+  Compressor compressor(true);
+  const size_t pieceSizes[] = {1, 7, 100, 4096};
+  for (size_t pieceSize : pieceSizes) {
+    const std::string message = eventsMessage(1000 + pieceSize, 3000);
+    const std::string inflated = inflateMessage(inflater, compressor.compress(message), pieceSize);
+    TEST_ASSERT_EQUAL(message.size(), inflated.size());
+    TEST_ASSERT_TRUE(message == inflated);
+  }
+}
+
+void test_context_takeover_across_messages() {
+  WebSocketInflater inflater;
+  TEST_ASSERT_TRUE(inflater.configure(windowBits, false));
+  Compressor compressor(false);
+  for (unsigned long blockHeight = 1; blockHeight <= 5; ++blockHeight) {
+    const std::string message = eventsMessage(blockHeight, 200); // refers back to the previous messages
+    TEST_ASSERT_TRUE(message == inflateMessage(inflater, compressor.compress(message), 13));
+  }
+}
+
+void test_statistics_exclude_the_message_tail() {
+  WebSocketInflater inflater;
+  TEST_ASSERT_TRUE(inflater.configure(windowBits, true));
+  Compressor compressor(true);
+  const std::string message = eventsMessage(1, 1000);
+  const std::string compressed = compressor.compress(message);
+  inflateMessage(inflater, compressed, 64);
+  TEST_ASSERT_EQUAL(compressed.size(), inflater.compressedBytes());
+  TEST_ASSERT_EQUAL(message.size(), inflater.inflatedBytes());
+}
+
+void test_corrupt_input_fails() {
+  WebSocketInflater inflater;
+  TEST_ASSERT_TRUE(inflater.configure(windowBits, true));
+  const uint8_t corrupt[] = {0xFF, 0xFF, 0xFF, 0xFF}; // a block of the reserved type 3
+  size_t consumed, produced;
+  const uint8_t *out;
+  TEST_ASSERT_TRUE(inflater.inflate(corrupt, sizeof(corrupt), &consumed, &out, &produced) == WebSocketInflater::Result::Failed);
+}
+
+void test_unsupported_window_is_rejected() {
+  WebSocketInflater inflater;
+  TEST_ASSERT_FALSE(inflater.configure(WebSocketInflater::MIN_WINDOW_BITS - 1, true));
+  TEST_ASSERT_FALSE(inflater.configure(WebSocketInflater::MAX_WINDOW_BITS + 1, true));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_messages_larger_than_the_window);
+  RUN_TEST(test_context_takeover_across_messages);
+  RUN_TEST(test_statistics_exclude_the_message_tail);
+  RUN_TEST(test_corrupt_input_fails);
+  RUN_TEST(test_unsupported_window_is_rejected);
+  return UNITY_END();
+}